@@ -0,0 +1,343 @@
+/**
+* @file BinaryModelFile.cpp
+* @brief Versioned binary container for storing models as named sections, readable via mmap (Implementation)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+
+// STL includes
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/BinaryModelFile.h"
+
+using namespace NICE;
+
+const uint BinaryModelFile::VERSION;
+const uint BinaryModelFile::ALIGNMENT;
+const uint BinaryModelFile::MAX_NAME_LENGTH;
+
+// identifies binary model containers
+static const char MAGIC[8] = { 'G', 'P', 'H', 'I', 'K', 'B', 'I', 'N' };
+
+// written in native byte order, reads differently on machines with another byte order
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+static size_t alignOffset ( const size_t & _offset )
+{
+  return ( ( _offset + BinaryModelFile::ALIGNMENT - 1 ) / BinaryModelFile::ALIGNMENT ) * BinaryModelFile::ALIGNMENT;
+}
+
+static void checkHeader ( const BinaryModelFile::Header & _header )
+{
+  if ( memcmp ( _header.magic, MAGIC, sizeof(MAGIC) ) != 0 )
+    fthrow ( Exception, "BinaryModelReader: no binary model container found" );
+  if ( _header.byteOrderMark != BYTE_ORDER_MARK )
+    fthrow ( Exception, "BinaryModelReader: container was written on a machine with a different byte order" );
+  if ( _header.version != BinaryModelFile::VERSION )
+    fthrow ( Exception, "BinaryModelReader: unsupported container version " << _header.version << " (expected " << BinaryModelFile::VERSION << ")" );
+}
+
+///////////////////// BinaryModelWriter /////////////////////
+
+BinaryModelWriter::BinaryModelWriter()
+{
+}
+
+BinaryModelWriter::~BinaryModelWriter()
+{
+}
+
+BinaryModelWriter::Section & BinaryModelWriter::getSection ( const std::string & _name )
+{
+  for ( std::vector<Section>::iterator it = this->sections.begin(); it != this->sections.end(); it++ )
+    if ( it->name == _name )
+      return *it;
+
+  if ( _name.size() >= BinaryModelFile::MAX_NAME_LENGTH )
+    fthrow ( Exception, "BinaryModelWriter: section name " << _name << " is too long" );
+
+  Section section;
+  section.name = _name;
+  section.size = 0;
+  this->sections.push_back ( section );
+  return this->sections.back();
+}
+
+void BinaryModelWriter::addSection ( const std::string & _name,
+                                     const void * _data,
+                                     const size_t & _size
+                                   )
+{
+  Section & section = this->getSection ( _name );
+  if ( _size == 0 )
+    return;
+
+  Chunk chunk;
+  chunk.data = static_cast<const char *> ( _data );
+  chunk.size = _size;
+  section.chunks.push_back ( chunk );
+  section.size += _size;
+}
+
+void BinaryModelWriter::addSectionCopy ( const std::string & _name,
+                                         const void * _data,
+                                         const size_t & _size
+                                       )
+{
+  const char * data = static_cast<const char *> ( _data );
+  this->ownedData.push_back ( std::vector<char> ( data, data + _size ) );
+  this->addSection ( _name, _size > 0 ? &(this->ownedData.back()[0]) : NULL, _size );
+}
+
+void BinaryModelWriter::addString ( const std::string & _name,
+                                    const std::string & _content
+                                  )
+{
+  this->addSectionCopy ( _name, _content.data(), _content.size() );
+}
+
+void BinaryModelWriter::write ( std::ostream & _os ) const
+{
+  // align the container within the file, such that it can be used in place after mapping the file
+  std::streampos position = _os.tellp();
+  if ( position != std::streampos ( -1 ) )
+  {
+    size_t remainder = static_cast<size_t> ( position ) % BinaryModelFile::ALIGNMENT;
+    if ( remainder != 0 )
+      _os << std::string ( BinaryModelFile::ALIGNMENT - remainder, ' ' );
+  }
+
+  BinaryModelFile::Header header;
+  memset ( &header, 0, sizeof(header) );
+  memcpy ( header.magic, MAGIC, sizeof(MAGIC) );
+  header.version = BinaryModelFile::VERSION;
+  header.byteOrderMark = BYTE_ORDER_MARK;
+  header.numSections = this->sections.size();
+  header.tableOffset = sizeof(header);
+
+  std::vector<BinaryModelFile::SectionEntry> table ( this->sections.size() );
+  size_t offset = alignOffset ( header.tableOffset + table.size() * sizeof(BinaryModelFile::SectionEntry) );
+  for ( uint i = 0; i < this->sections.size(); i++ )
+  {
+    memset ( &(table[i]), 0, sizeof(BinaryModelFile::SectionEntry) );
+    strncpy ( table[i].name, this->sections[i].name.c_str(), BinaryModelFile::MAX_NAME_LENGTH - 1 );
+    table[i].offset = offset;
+    table[i].size = this->sections[i].size;
+    offset = alignOffset ( offset + this->sections[i].size );
+  }
+  header.totalSize = offset;
+
+  _os.write ( reinterpret_cast<const char *> ( &header ), sizeof(header) );
+  if ( ! table.empty() )
+    _os.write ( reinterpret_cast<const char *> ( &(table[0]) ), table.size() * sizeof(BinaryModelFile::SectionEntry) );
+
+  const std::vector<char> padding ( BinaryModelFile::ALIGNMENT, 0 );
+  size_t written = header.tableOffset + table.size() * sizeof(BinaryModelFile::SectionEntry);
+  for ( uint i = 0; i < this->sections.size(); i++ )
+  {
+    _os.write ( &(padding[0]), table[i].offset - written );
+    written = table[i].offset;
+
+    for ( std::vector<Chunk>::const_iterator chunk = this->sections[i].chunks.begin(); chunk != this->sections[i].chunks.end(); chunk++ )
+      _os.write ( chunk->data, chunk->size );
+    written += this->sections[i].size;
+  }
+  _os.write ( &(padding[0]), header.totalSize - written );
+
+  if ( ! _os.good() )
+    fthrow ( Exception, "BinaryModelWriter: writing the container failed" );
+}
+
+///////////////////// BinaryModelReader /////////////////////
+
+BinaryModelReader::BinaryModelReader()
+{
+  this->data = NULL;
+  this->size = 0;
+  this->mappedMemory = NULL;
+  this->mappedSize = 0;
+  this->buffer = NULL;
+}
+
+BinaryModelReader::~BinaryModelReader()
+{
+  this->close();
+}
+
+void BinaryModelReader::close ()
+{
+  if ( this->mappedMemory != NULL )
+    munmap ( this->mappedMemory, this->mappedSize );
+  if ( this->buffer != NULL )
+    free ( this->buffer );
+
+  this->data = NULL;
+  this->size = 0;
+  this->mappedMemory = NULL;
+  this->mappedSize = 0;
+  this->buffer = NULL;
+  this->sections.clear();
+}
+
+void BinaryModelReader::parseHeader ()
+{
+  if ( this->size < sizeof(BinaryModelFile::Header) )
+    fthrow ( Exception, "BinaryModelReader: container is truncated" );
+
+  BinaryModelFile::Header header;
+  memcpy ( &header, this->data, sizeof(header) );
+  checkHeader ( header );
+
+  if ( header.totalSize > this->size )
+    fthrow ( Exception, "BinaryModelReader: container is truncated (" << this->size << " of " << header.totalSize << " bytes)" );
+  this->size = header.totalSize;
+
+  if ( header.tableOffset + (uint64_t) header.numSections * sizeof(BinaryModelFile::SectionEntry) > this->size )
+    fthrow ( Exception, "BinaryModelReader: section table exceeds the container" );
+
+  this->sections.resize ( header.numSections );
+  if ( header.numSections > 0 )
+    memcpy ( &(this->sections[0]), this->data + header.tableOffset, header.numSections * sizeof(BinaryModelFile::SectionEntry) );
+
+  for ( uint i = 0; i < this->sections.size(); i++ )
+  {
+    this->sections[i].name[BinaryModelFile::MAX_NAME_LENGTH - 1] = 0;
+    if ( ( this->sections[i].offset > this->size ) || ( this->sections[i].size > this->size - this->sections[i].offset ) )
+      fthrow ( Exception, "BinaryModelReader: section " << this->sections[i].name << " exceeds the container" );
+  }
+}
+
+void BinaryModelReader::readIntoBuffer ( std::istream & _is,
+                                         const BinaryModelFile::Header & _header
+                                       )
+{
+  if ( _header.totalSize < sizeof(_header) )
+    fthrow ( Exception, "BinaryModelReader: invalid container size " << _header.totalSize );
+
+  if ( posix_memalign ( &(this->buffer), BinaryModelFile::ALIGNMENT, _header.totalSize ) != 0 )
+  {
+    this->buffer = NULL;
+    fthrow ( Exception, "BinaryModelReader: unable to allocate " << _header.totalSize << " bytes" );
+  }
+
+  char * content = static_cast<char *> ( this->buffer );
+  memcpy ( content, &_header, sizeof(_header) );
+  _is.read ( content + sizeof(_header), _header.totalSize - sizeof(_header) );
+  if ( ! _is.good() )
+  {
+    this->close();
+    fthrow ( Exception, "BinaryModelReader: container is truncated" );
+  }
+
+  this->data = content;
+  this->size = _header.totalSize;
+  this->parseHeader();
+}
+
+void BinaryModelReader::read ( std::istream & _is )
+{
+  this->close();
+
+  // skip whitespace in front of the container (see BinaryModelWriter::write)
+  _is >> std::ws;
+
+  BinaryModelFile::Header header;
+  _is.read ( reinterpret_cast<char *> ( &header ), sizeof(header) );
+  if ( ! _is.good() )
+    fthrow ( Exception, "BinaryModelReader: unable to read the container header" );
+  checkHeader ( header );
+
+  this->readIntoBuffer ( _is, header );
+}
+
+void BinaryModelReader::open ( const std::string & _filename,
+                               const size_t & _offset
+                             )
+{
+  this->close();
+
+  int fd = ::open ( _filename.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    fthrow ( Exception, "BinaryModelReader: unable to open " << _filename );
+
+  struct stat fileStatus;
+  if ( fstat ( fd, &fileStatus ) != 0 )
+  {
+    ::close ( fd );
+    fthrow ( Exception, "BinaryModelReader: unable to determine the size of " << _filename );
+  }
+  size_t fileSize = fileStatus.st_size;
+  if ( _offset >= fileSize )
+  {
+    ::close ( fd );
+    fthrow ( Exception, "BinaryModelReader: offset " << _offset << " exceeds the size of " << _filename );
+  }
+
+  void * memory = mmap ( NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0 );
+  ::close ( fd );
+  if ( memory == MAP_FAILED )
+    fthrow ( Exception, "BinaryModelReader: unable to map " << _filename );
+
+  const char * fileContent = static_cast<const char *> ( memory );
+  size_t offset = _offset;
+  while ( ( offset < fileSize ) && isspace ( fileContent[offset] ) )
+    offset++;
+
+  if ( offset % BinaryModelFile::ALIGNMENT == 0 )
+  {
+    this->mappedMemory = memory;
+    this->mappedSize = fileSize;
+    this->data = fileContent + offset;
+    this->size = fileSize - offset;
+    this->parseHeader();
+    return;
+  }
+
+  // arrays would not be aligned within the mapped memory, read the container into a buffer instead
+  munmap ( memory, fileSize );
+
+  std::ifstream ifs ( _filename.c_str(), std::ios::in | std::ios::binary );
+  ifs.seekg ( offset );
+  this->read ( ifs );
+}
+
+const BinaryModelFile::SectionEntry * BinaryModelReader::findSection ( const std::string & _name ) const
+{
+  for ( std::vector<BinaryModelFile::SectionEntry>::const_iterator it = this->sections.begin(); it != this->sections.end(); it++ )
+    if ( _name.compare ( it->name ) == 0 )
+      return &(*it);
+  return NULL;
+}
+
+bool BinaryModelReader::hasSection ( const std::string & _name ) const
+{
+  return ( this->findSection ( _name ) != NULL );
+}
+
+const char * BinaryModelReader::getSection ( const std::string & _name,
+                                             size_t & _size
+                                           ) const
+{
+  const BinaryModelFile::SectionEntry * entry = this->findSection ( _name );
+  if ( entry == NULL )
+    fthrow ( Exception, "BinaryModelReader: container has no section " << _name );
+
+  _size = entry->size;
+  return this->data + entry->offset;
+}
+
+std::string BinaryModelReader::getString ( const std::string & _name ) const
+{
+  size_t length;
+  const char * content = this->getSection ( _name, length );
+  return std::string ( content, length );
+}
@@ -0,0 +1,294 @@
+/**
+* @file BinaryModelFile.h
+* @brief Versioned binary container for storing models as named sections, readable via mmap (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_BINARYMODELFILEINCLUDE
+#define _NICE_BINARYMODELFILEINCLUDE
+
+// STL includes
+#include <stdint.h>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+// NICE-core includes
+#include <core/basics/types.h>
+#include <core/basics/Exception.h>
+
+namespace NICE {
+
+ /**
+ * @class BinaryModelFile
+ * @brief Layout and format constants of the binary model container.
+ *
+ * A container consists of a header (magic, version, byte order mark, number of sections, offset of
+ * the section table), the section table (name, offset, and size of every section), and the sections.
+ * All offsets are relative to the beginning of the container and every section starts at a multiple
+ * of ALIGNMENT bytes, such that arrays of doubles can be used in place if the container is mapped
+ * into memory. Numbers are stored in the native byte order, containers written on machines with a
+ * different byte order are rejected.
+ */
+
+class BinaryModelFile
+{
+  public:
+
+    /** values of the _format argument of the Persistent interface */
+    enum Format
+    {
+      FORMAT_TEXT = 0,
+      FORMAT_BINARY = 1
+    };
+
+    /** current version of the container layout */
+    static const uint VERSION = 1;
+
+    /** alignment of the sections in bytes (size of a cache line) */
+    static const uint ALIGNMENT = 64;
+
+    /** maximum length of section names (including the terminating zero) */
+    static const uint MAX_NAME_LENGTH = 48;
+
+    /** header at the beginning of every container */
+    struct Header
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t byteOrderMark;
+      uint32_t numSections;
+      uint32_t reserved;
+      uint64_t tableOffset;
+      uint64_t totalSize;
+    };
+
+    /** entry of the section table */
+    struct SectionEntry
+    {
+      char name[MAX_NAME_LENGTH];
+      uint64_t offset;
+      uint64_t size;
+    };
+};
+
+ /**
+ * @class BinaryModelWriter
+ * @brief Collects named sections and writes them as binary container.
+ *
+ * Data added with addSection is only referenced and has to stay valid until write is called,
+ * which allows for writing large arrays without copying them. Small data created on the fly
+ * can be added with addSectionCopy or addString.
+ */
+
+class BinaryModelWriter
+{
+
+  protected:
+
+    struct Chunk
+    {
+      const char * data;
+      size_t size;
+    };
+
+    struct Section
+    {
+      std::string name;
+      std::vector<Chunk> chunks;
+      size_t size;
+    };
+
+    /** all sections in the order of writing */
+    std::vector<Section> sections;
+
+    /** copies of data added with addSectionCopy and addString (a list keeps the addresses stable) */
+    std::list< std::vector<char> > ownedData;
+
+    /** find or create the section with the given name */
+    Section & getSection ( const std::string & _name );
+
+  public:
+
+    /** simple constructor */
+    BinaryModelWriter();
+
+    /** simple destructor */
+    virtual ~BinaryModelWriter();
+
+    /**
+    * @brief append data to a section (created if necessary), the data is only referenced
+    *
+    * @param _name section name (shorter than BinaryModelFile::MAX_NAME_LENGTH)
+    * @param _data pointer to the data, has to stay valid until write is called
+    * @param _size number of bytes
+    */
+    void addSection ( const std::string & _name,
+                      const void * _data,
+                      const size_t & _size
+                    );
+
+    /** append a copy of the given data to a section (created if necessary) */
+    void addSectionCopy ( const std::string & _name,
+                          const void * _data,
+                          const size_t & _size
+                        );
+
+    /** append an array to a section, the data is only referenced */
+    template<class S> void addArray ( const std::string & _name,
+                                      const S * _data,
+                                      const size_t & _count
+                                    )
+    {
+      this->addSection ( _name, _data, _count * sizeof(S) );
+    };
+
+    /** append a copy of an array to a section */
+    template<class S> void addArrayCopy ( const std::string & _name,
+                                          const std::vector<S> & _data
+                                        )
+    {
+      this->addSectionCopy ( _name, _data.empty() ? NULL : &(_data[0]), _data.size() * sizeof(S) );
+    };
+
+    /** add a string as section (copied) */
+    void addString ( const std::string & _name,
+                     const std::string & _content
+                   );
+
+    /**
+    * @brief write the container
+    *
+    * If the position of the stream is known, whitespace is written first such that the container
+    * starts at a multiple of BinaryModelFile::ALIGNMENT bytes within the file. BinaryModelReader skips it.
+    */
+    void write ( std::ostream & _os ) const;
+};
+
+ /**
+ * @class BinaryModelReader
+ * @brief Read-only access to the sections of a binary container, either mapped into memory or read from a stream.
+ *
+ * Pointers returned by getSection and getArray point directly into the container and stay valid
+ * as long as the reader exists.
+ */
+
+class BinaryModelReader
+{
+
+  protected:
+
+    /** beginning of the container */
+    const char * data;
+
+    /** size of the container in bytes */
+    size_t size;
+
+    /** memory obtained by mmap (NULL if the container was read into a buffer) */
+    void * mappedMemory;
+
+    /** size of the mapped memory */
+    size_t mappedSize;
+
+    /** buffer holding the container if it was not mapped */
+    void * buffer;
+
+    /** section table */
+    std::vector<BinaryModelFile::SectionEntry> sections;
+
+    /** release the current container */
+    void close ();
+
+    /** check the header and read the section table */
+    void parseHeader ();
+
+    /** read the container into an aligned buffer */
+    void readIntoBuffer ( std::istream & _is,
+                          const BinaryModelFile::Header & _header
+                        );
+
+    /** find the entry of the section with the given name (NULL if there is none) */
+    const BinaryModelFile::SectionEntry * findSection ( const std::string & _name ) const;
+
+  private:
+
+    // copying the mapped memory is not supported
+    BinaryModelReader ( const BinaryModelReader & );
+    BinaryModelReader & operator= ( const BinaryModelReader & );
+
+  public:
+
+    /** simple constructor */
+    BinaryModelReader();
+
+    /** simple destructor, unmaps the file */
+    virtual ~BinaryModelReader();
+
+    /**
+    * @brief map a container stored in a file into memory (read-only)
+    *
+    * If _offset is not a multiple of BinaryModelFile::ALIGNMENT, the container is read into an
+    * aligned buffer instead, such that arrays can be used in place in any case.
+    *
+    * @param _filename file containing the container
+    * @param _offset position of the container within the file (leading whitespace is skipped)
+    */
+    void open ( const std::string & _filename,
+                const size_t & _offset = 0
+              );
+
+    /**
+    * @brief read a container from a stream into memory, the stream is left behind the container
+    */
+    void read ( std::istream & _is );
+
+    /** check whether the container is mapped into memory */
+    bool isMapped () const { return ( this->mappedMemory != NULL ); };
+
+    /** total size of the container in bytes (without leading whitespace) */
+    size_t getSize () const { return this->size; };
+
+    /** check whether there is a section with the given name */
+    bool hasSection ( const std::string & _name ) const;
+
+    /**
+    * @brief access a section
+    *
+    * @param _name section name
+    * @param _size resulting size in bytes
+    * @return pointer to the content, an exception is thrown if there is no such section
+    */
+    const char * getSection ( const std::string & _name,
+                              size_t & _size
+                            ) const;
+
+    /** access a section as array, an exception is thrown if the size is no multiple of sizeof(S) */
+    template<class S> const S * getArray ( const std::string & _name,
+                                           size_t & _count
+                                         ) const
+    {
+      size_t bytes;
+      const char * section = this->getSection ( _name, bytes );
+      if ( bytes % sizeof(S) != 0 )
+        fthrow ( Exception, "BinaryModelReader: size of section " << _name << " (" << bytes << " bytes) is no multiple of the element size " << sizeof(S) );
+      _count = bytes / sizeof(S);
+      return reinterpret_cast<const S *> ( section );
+    };
+
+    /** copy an array section into a vector */
+    template<class S> void getArrayCopy ( const std::string & _name,
+                                          std::vector<S> & _array
+                                        ) const
+    {
+      size_t count;
+      const S * array = this->getArray<S> ( _name, count );
+      _array.assign ( array, array + count );
+    };
+
+    /** get a section as string */
+    std::string getString ( const std::string & _name ) const;
+};
+
+} // namespace
+
+#endif
@@ -6,8 +6,17 @@
 */
 
 // STL includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <sstream>
+
+#ifdef NICE_USELIB_OPENMP
+#include <omp.h>
+#endif
 
 // NICE-core includes
 #include <core/algebra/ILSConjugateGradients.h>
@@ -32,6 +41,7 @@
 #include "gp-hik-core/FastMinKernel.h"
 #include "gp-hik-core/GMHIKernel.h"
 #include "gp-hik-core/IKMNoise.h"
+#include "gp-hik-core/algebra/BoundedLBFGS.h"
 // 
 #include "gp-hik-core/parameterizedFunctions/PFIdentity.h"
 #include "gp-hik-core/parameterizedFunctions/PFAbsExp.h"
@@ -48,6 +58,65 @@
 using namespace NICE;
 using namespace std;
 
+namespace {
+
+// likelihood and gradient as a function of the hyperparameters, see GPLikelihoodApprox::evaluateWithGradient
+class GPLikelihoodApproxObjective : public DifferentiableFunction
+{
+  protected:
+    GPLikelihoodApprox & gplike;
+
+  public:
+    GPLikelihoodApproxObjective ( GPLikelihoodApprox & _gplike ) : gplike ( _gplike ) {};
+
+    virtual double evaluate ( const NICE::Vector & _x, NICE::Vector & _gradient )
+    {
+      return this->gplike.evaluateWithGradient ( _x, _gradient );
+    };
+};
+
+// name of the binary section holding the data of a single class, e.g., "A.3"
+std::string classSectionName ( const std::string & _prefix, const uint & _classno )
+{
+  std::ostringstream name;
+  name << _prefix << "." << _classno;
+  return name.str();
+}
+
+// all vectors are written contiguously to section _name, their sizes to section _name.sizes
+void storeVVectorBinary ( BinaryModelWriter & _writer, const std::string & _name, const VVector & _v )
+{
+  std::vector<uint> sizes ( _v.size() );
+  for ( uint k = 0; k < _v.size(); k++ )
+  {
+    sizes[k] = _v[k].size();
+    _writer.addArray ( _name, _v[k].getDataPointer(), _v[k].size() );
+  }
+  _writer.addArrayCopy ( _name + ".sizes", sizes );
+}
+
+void restoreVVectorBinary ( const BinaryModelReader & _reader, const std::string & _name, VVector & _v )
+{
+  size_t numVectors;
+  size_t numValues;
+  const uint * sizes = _reader.getArray<uint> ( _name + ".sizes", numVectors );
+  const double * values = _reader.getArray<double> ( _name, numValues );
+
+  _v.clear();
+  _v.resize ( numVectors );
+  size_t offset ( 0 );
+  for ( uint k = 0; k < numVectors; k++ )
+  {
+    if ( offset + sizes[k] > numValues )
+      fthrow ( Exception, "restoreVVectorBinary: section " << _name << " is too small" );
+    _v[k].resize ( sizes[k] );
+    std::copy ( values + offset, values + offset + sizes[k], _v[k].getDataPointer() );
+    offset += sizes[k];
+  }
+}
+
+} // namespace
+
 /////////////////////////////////////////////////////
 /////////////////////////////////////////////////////
 //                 PROTECTED METHODS
@@ -112,26 +181,30 @@ void FMKGPHyperparameterOptimization::updateAfterIncrement (
     }
     
     
-    std::map<uint, NICE::Vector>::const_iterator binaryLabelsIt = binaryLabels.begin();
-    
     for ( std::map<uint, NICE::Vector>::iterator prevAlphaIt = this->previousAlphas.begin();
          prevAlphaIt != this->previousAlphas.end();
          prevAlphaIt++
         )
     {
-      int oldSize ( prevAlphaIt->second.size() );
-      prevAlphaIt->second.resize ( oldSize + 1 );
-
-  
+      // the previous alphas do not necessarily cover all binary problems (new or vanished classes)
+      std::map<uint, NICE::Vector>::const_iterator binaryLabelsIt = binaryLabels.find ( prevAlphaIt->first );
+      if ( binaryLabelsIt == binaryLabels.end() )
+        continue;
 
-      if ( binaryLabelsIt->second[oldSize] > 0 ) //we only have +1 and -1, so this might be benefitial in terms of speed
-        prevAlphaIt->second[oldSize] = factor;
-      else
-        prevAlphaIt->second[oldSize] = -factor; //we follow the initialization as done in previous steps
-        //prevAlphaIt->second[oldSize] = 0.0; // following the suggestion of Yeh and Darrell
+      // one entry for every added example (addMultipleExamples adds several at once)
+      uint oldSize ( prevAlphaIt->second.size() );
+      uint newSize ( binaryLabelsIt->second.size() );
+      if ( oldSize < newSize )
+        prevAlphaIt->second.resize ( newSize );
 
-      binaryLabelsIt++;
-      
+      for ( uint i = oldSize; i < newSize; i++ )
+      {
+        if ( binaryLabelsIt->second[i] > 0 ) //we only have +1 and -1, so this might be benefitial in terms of speed
+          prevAlphaIt->second[i] = factor;
+        else
+          prevAlphaIt->second[i] = -factor; //we follow the initialization as done in previous steps
+          //prevAlphaIt->second[i] = 0.0; // following the suggestion of Yeh and Darrell
+      }
     }
 
     //compute unaffected alpha-vectors for the new classes
@@ -153,13 +226,20 @@ void FMKGPHyperparameterOptimization::updateAfterIncrement (
   if ( this->b_verboseTime )
     std::cerr << "Time used for setting up the alpha-objects: " << t1.getLast() << std::endl;
 
+  // the incremental update keeps the hyperparameters and classes, i.e., A, B, and T only follow the changes of alpha
+  bool incrementalUpdate ( this->b_incrementalUpdate && newClasses.empty() && !this->lutAlphas.empty() &&
+                           ( !performOptimizationAfterIncrement || ( this->optimizationMethod == OPT_NONE ) ) );
+
   if ( this->b_verbose ) 
     std::cerr << "update Eigendecomposition " << std::endl;
   
   t1.start();
   // we compute all needed eigenvectors for standard classification and variance prediction at ones.
   // nrOfEigenvaluesToConsiderForVarApprox should NOT be larger than 1 if a method different than approximate_fine is used!
-  this->updateEigenDecomposition(  std::max ( this->nrOfEigenvaluesToConsider, this->nrOfEigenvaluesToConsiderForVarApprox) );
+  if ( incrementalUpdate )
+    this->updateEigenDecompositionIfDrifted ( std::max ( this->nrOfEigenvaluesToConsider, this->nrOfEigenvaluesToConsiderForVarApprox) );
+  else
+    this->updateEigenDecomposition(  std::max ( this->nrOfEigenvaluesToConsider, this->nrOfEigenvaluesToConsiderForVarApprox) );
   t1.stop();
   if ( this->b_verboseTime )
     std::cerr << "Time used for setting up the eigenvectors-objects: " << t1.getLast() << std::endl;
@@ -218,11 +298,11 @@ void FMKGPHyperparameterOptimization::updateAfterIncrement (
 
   
   //NOTE unfortunately, the whole vector alpha differs, and not only its last entry.
-  // If we knew any method, which could update this efficiently, we could also compute A and B more efficiently by updating them.
-  // Since we are not aware of any such method, we have to compute them completely new
-  // :/
+  // In the incremental mode, A, B, and T are updated with the (significant) changes of alpha,
+  // unless computing them completely new is cheaper.
   t1.start();
-  this->computeMatricesAndLUTs ( *gplike );
+  if ( !incrementalUpdate || !this->updateMatricesAndLUTs ( *gplike ) )
+    this->computeMatricesAndLUTs ( *gplike );
   t1.stop();
   if ( this->b_verboseTime )
     std::cerr << "Time used for setting up the A'nB -objects: " << t1.getLast() << std::endl;
@@ -231,6 +311,157 @@ void FMKGPHyperparameterOptimization::updateAfterIncrement (
   delete gplike;
 }
 
+void FMKGPHyperparameterOptimization::removeExamplesWithoutUpdate ( const std::vector<uint> & _indices,
+                                                                    std::set<uint> & _newClasses
+                                                                  )
+{
+  uint n ( this->labels.size() );
+  std::vector<bool> isRemoved ( n, false );
+  for ( std::vector<uint>::const_iterator it = _indices.begin(); it != _indices.end(); it++ )
+  {
+    if ( *it >= n )
+      fthrow ( Exception, "FMKGPHyperparameterOptimization: example " << *it << " can not be removed, there are only " << n << " examples" );
+    isRemoved[ *it ] = true;
+  }
+
+  // labels and previous alphas keep the order of the remaining examples
+  // (previous alphas do not cover examples which were just added)
+  uint nNew ( 0 );
+  for ( uint i = 0; i < n; i++ )
+  {
+    if ( isRemoved[i] )
+      continue;
+    this->labels[nNew] = this->labels[i];
+    nNew++;
+  }
+  if ( nNew == 0 )
+    fthrow ( Exception, "FMKGPHyperparameterOptimization: at least one example has to remain" );
+  this->labels.resize ( nNew );
+
+  for ( std::map<uint, NICE::Vector>::iterator prevAlphaIt = this->previousAlphas.begin(); prevAlphaIt != this->previousAlphas.end(); prevAlphaIt++ )
+  {
+    NICE::Vector & alpha = prevAlphaIt->second;
+    uint nAlpha ( 0 );
+    for ( uint i = 0; ( i < alpha.size() ) && ( i < n ); i++ )
+    {
+      if ( isRemoved[i] )
+        continue;
+      alpha[nAlpha] = alpha[i];
+      nAlpha++;
+    }
+    alpha.resize ( nAlpha );
+  }
+
+  this->fmk->removeMultipleExamples ( _indices );
+  if ( this->q != NULL )
+    this->fmk->prepareBinIndices ( this->q );
+
+  this->ikmsum->removeMultipleExamples ( _indices );
+
+  // the positions of the examples changed, A, B, and T have to be computed from scratch
+  this->lutAlphas.clear();
+
+  if ( this->b_performRegression )
+    return;
+
+  std::set<uint> remainingClasses;
+  for ( NICE::Vector::const_iterator it = this->labels.begin(); it != this->labels.end(); it++ )
+    remainingClasses.insert ( *it );
+
+  if ( remainingClasses == this->knownClasses )
+    return;
+
+  if ( this->b_verbose )
+    std::cerr << "FMKGPHyperparameterOptimization: " << this->knownClasses.size() - remainingClasses.size() << " classes vanished" << std::endl;
+
+  // binary problems after the update, see prepareBinaryLabels
+  this->knownClasses = remainingClasses;
+  std::set<uint> problems;
+  if ( this->knownClasses.size() == 2 )
+    problems.insert ( *(this->knownClasses.rbegin()) );
+  else
+    problems = this->knownClasses;
+
+  std::map<uint, NICE::Vector> remainingAlphas;
+  _newClasses.clear();
+  for ( std::set<uint>::const_iterator it = problems.begin(); it != problems.end(); it++ )
+  {
+    std::map<uint, NICE::Vector>::const_iterator prevAlphaIt = this->previousAlphas.find ( *it );
+    if ( prevAlphaIt != this->previousAlphas.end() )
+      remainingAlphas.insert ( *prevAlphaIt );
+    else
+      _newClasses.insert ( *it );
+  }
+  this->previousAlphas = remainingAlphas;
+}
+
+void FMKGPHyperparameterOptimization::selectExamplesToForget ( const uint & _numNewExamples,
+                                                               std::vector<uint> & _indices
+                                                             )
+{
+  _indices.clear();
+
+  uint n ( this->labels.size() );
+  uint numOld ( n - _numNewExamples );
+  this->ui_numExamplesSeen = std::max ( this->ui_numExamplesSeen, numOld );
+
+  if ( ( this->ui_maxNumExamples == 0 ) || ( n <= this->ui_maxNumExamples ) )
+  {
+    this->ui_numExamplesSeen += _numNewExamples;
+    return;
+  }
+
+  if ( this->s_forgettingStrategy == "sliding_window" )
+  {
+    // examples are stored in the order of insertion, the oldest ones are forgotten
+    this->ui_numExamplesSeen += _numNewExamples;
+    for ( uint i = 0; i < n - this->ui_maxNumExamples; i++ )
+      _indices.push_back ( i );
+    return;
+  }
+
+  // reservoir sampling: the reservoir holds the indices of the kept examples
+  std::vector<uint> reservoir;
+  for ( uint i = 0; i < numOld; i++ )
+    reservoir.push_back ( i );
+
+  // the reservoir might be too large already, e.g., after a larger initial training set
+  while ( reservoir.size() > this->ui_maxNumExamples )
+  {
+    uint k ( this->drawForgettingIndex ( reservoir.size() ) );
+    _indices.push_back ( reservoir[k] );
+    reservoir[k] = reservoir.back();
+    reservoir.pop_back();
+  }
+
+  for ( uint i = numOld; i < n; i++ )
+  {
+    this->ui_numExamplesSeen++;
+    if ( reservoir.size() < this->ui_maxNumExamples )
+    {
+      reservoir.push_back ( i );
+      continue;
+    }
+
+    // the new example replaces a random one with probability ui_maxNumExamples / ui_numExamplesSeen
+    uint k ( this->drawForgettingIndex ( this->ui_numExamplesSeen ) );
+    if ( k < this->ui_maxNumExamples )
+    {
+      _indices.push_back ( reservoir[k] );
+      reservoir[k] = i;
+    }
+    else
+      _indices.push_back ( i );
+  }
+}
+
+uint FMKGPHyperparameterOptimization::drawForgettingIndex ( const uint & _range )
+{
+  this->ui_forgettingState = 1664525u * this->ui_forgettingState + 1013904223u;
+  // the higher bits have the longer periods, hence no modulo
+  return std::min ( (uint) ( ( this->ui_forgettingState / 4294967296.0 ) * _range ), _range - 1 );
+}
+
 /////////////////////////////////////////////////////
 /////////////////////////////////////////////////////
 //                 PUBLIC METHODS
@@ -242,16 +473,21 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization( )
   // initialize pointer variables
   this->pf = NULL;
   this->eig = NULL;
+  this->subspaceIteration = NULL;
+  this->logDetApprox = NULL;
   this->linsolver = NULL;
+  this->blockLinsolver = NULL;
   this->fmk = NULL;
   this->q = NULL;
   this->precomputedTForVarEst = NULL;
+  this->ui_varianceBlockSize = 64;
   this->ikmsum  = NULL;
   
   // initialize boolean flags
   this->b_verbose = false;
   this->b_verboseTime = false;
   this->b_debug = false;
+  this->ui_numThreads = 1;
   
   //stupid unneeded default values
   this->i_binaryLabelPositive = 0;
@@ -259,6 +495,22 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization( )
   this->knownClasses.clear();  
   
   this->b_usePreviousAlphas = false;
+  this->b_incrementalUpdate = false;
+  this->d_incrementalAlphaTolerance = 1e-3;
+  this->d_eigenDriftTolerance = 0.1;
+  this->ui_maxNumExamples = 0;
+  this->s_forgettingStrategy = "sliding_window";
+  this->ui_numExamplesSeen = 0;
+  this->ui_forgettingSeed = 0;
+  this->ui_forgettingState = 0;
+  this->b_usePackedLUT = false;
+  this->b_parallelGridSearch = false;
+  this->b_lazyTransform = false;
+  this->gradientMaxIterations = 30;
+  this->gradientNumProbes = 10;
+  this->gradientSeed = 0;
+  this->lutPrecision = CompactLookupTable::PRECISION_DOUBLE;
+  this->modelFile = NULL;
   this->b_performRegression = false;
 }
 
@@ -271,16 +523,21 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization( const bool & _
   // initialize pointer variables
   this->pf = NULL;
   this->eig = NULL;
+  this->subspaceIteration = NULL;
+  this->logDetApprox = NULL;
   this->linsolver = NULL;
+  this->blockLinsolver = NULL;
   this->fmk = NULL;
   this->q = NULL;
   this->precomputedTForVarEst = NULL;
+  this->ui_varianceBlockSize = 64;
   this->ikmsum  = NULL;
   
   // initialize boolean flags
   this->b_verbose = false;
   this->b_verboseTime = false;
   this->b_debug = false;
+  this->ui_numThreads = 1;
   
   //stupid unneeded default values
   this->i_binaryLabelPositive = 0;
@@ -288,6 +545,22 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization( const bool & _
   this->knownClasses.clear();   
   
   this->b_usePreviousAlphas = false;
+  this->b_incrementalUpdate = false;
+  this->d_incrementalAlphaTolerance = 1e-3;
+  this->d_eigenDriftTolerance = 0.1;
+  this->ui_maxNumExamples = 0;
+  this->s_forgettingStrategy = "sliding_window";
+  this->ui_numExamplesSeen = 0;
+  this->ui_forgettingSeed = 0;
+  this->ui_forgettingState = 0;
+  this->b_usePackedLUT = false;
+  this->b_parallelGridSearch = false;
+  this->b_lazyTransform = false;
+  this->gradientMaxIterations = 30;
+  this->gradientNumProbes = 10;
+  this->gradientSeed = 0;
+  this->lutPrecision = CompactLookupTable::PRECISION_DOUBLE;
+  this->modelFile = NULL;
   this->b_performRegression = false;  
   
   ///////////
@@ -307,16 +580,21 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization ( const Config
   // initialize pointer variables
   this->pf = NULL;
   this->eig = NULL;
+  this->subspaceIteration = NULL;
+  this->logDetApprox = NULL;
   this->linsolver = NULL;
+  this->blockLinsolver = NULL;
   this->fmk = NULL;
   this->q = NULL;
   this->precomputedTForVarEst = NULL;
+  this->ui_varianceBlockSize = 64;
   this->ikmsum  = NULL;
   
   // initialize boolean flags
   this->b_verbose = false;
   this->b_verboseTime = false;
   this->b_debug = false;
+  this->ui_numThreads = 1;
   
   //stupid unneeded default values
   this->i_binaryLabelPositive = 0;
@@ -324,6 +602,22 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization ( const Config
   this->knownClasses.clear();  
   
   this->b_usePreviousAlphas = false;
+  this->b_incrementalUpdate = false;
+  this->d_incrementalAlphaTolerance = 1e-3;
+  this->d_eigenDriftTolerance = 0.1;
+  this->ui_maxNumExamples = 0;
+  this->s_forgettingStrategy = "sliding_window";
+  this->ui_numExamplesSeen = 0;
+  this->ui_forgettingSeed = 0;
+  this->ui_forgettingState = 0;
+  this->b_usePackedLUT = false;
+  this->b_parallelGridSearch = false;
+  this->b_lazyTransform = false;
+  this->gradientMaxIterations = 30;
+  this->gradientNumProbes = 10;
+  this->gradientSeed = 0;
+  this->lutPrecision = CompactLookupTable::PRECISION_DOUBLE;
+  this->modelFile = NULL;
   this->b_performRegression = false;  
   
   ///////////
@@ -344,16 +638,21 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization ( const Config
   // initialize pointer variables
   this->pf = NULL;
   this->eig = NULL;
+  this->subspaceIteration = NULL;
+  this->logDetApprox = NULL;
   this->linsolver = NULL;
+  this->blockLinsolver = NULL;
   this->fmk = NULL;
   this->q = NULL;
   this->precomputedTForVarEst = NULL;
+  this->ui_varianceBlockSize = 64;
   this->ikmsum  = NULL;
   
   // initialize boolean flags
   this->b_verbose = false;
   this->b_verboseTime = false;
   this->b_debug = false;
+  this->ui_numThreads = 1;
   
   //stupid unneeded default values
   this->i_binaryLabelPositive = 0;
@@ -361,6 +660,22 @@ FMKGPHyperparameterOptimization::FMKGPHyperparameterOptimization ( const Config
   this->knownClasses.clear();    
   
   this->b_usePreviousAlphas = false;
+  this->b_incrementalUpdate = false;
+  this->d_incrementalAlphaTolerance = 1e-3;
+  this->d_eigenDriftTolerance = 0.1;
+  this->ui_maxNumExamples = 0;
+  this->s_forgettingStrategy = "sliding_window";
+  this->ui_numExamplesSeen = 0;
+  this->ui_forgettingSeed = 0;
+  this->ui_forgettingState = 0;
+  this->b_usePackedLUT = false;
+  this->b_parallelGridSearch = false;
+  this->b_lazyTransform = false;
+  this->gradientMaxIterations = 30;
+  this->gradientNumProbes = 10;
+  this->gradientSeed = 0;
+  this->lutPrecision = CompactLookupTable::PRECISION_DOUBLE;
+  this->modelFile = NULL;
   this->b_performRegression = false;  
   
   ///////////
@@ -385,8 +700,14 @@ FMKGPHyperparameterOptimization::~FMKGPHyperparameterOptimization()
   if ( this->pf != NULL )
     delete this->pf;  
   
+  // LUTs referring to a binary model are not deleted
+  this->releaseModelFile();
+
   for ( uint i = 0 ; i < this->precomputedT.size(); i++ )
     delete [] ( this->precomputedT[i] );
+
+  for ( std::map< uint, CompactLookupTable * >::iterator itT = this->compactT.begin(); itT != this->compactT.end(); itT++ )
+    delete itT->second;
   
   if ( this->ikmsum != NULL )
     delete this->ikmsum;  
@@ -397,19 +718,28 @@ FMKGPHyperparameterOptimization::~FMKGPHyperparameterOptimization()
   if ( this->linsolver != NULL )
     delete this->linsolver; 
   
+  if ( this->blockLinsolver != NULL )
+    delete this->blockLinsolver;
+  
   //////////////////////////////////////////////
   // likelihood computation related variables //
   //////////////////////////////////////////////   
   if ( this->eig != NULL )
     delete this->eig;    
 
+  if ( this->subspaceIteration != NULL )
+    delete this->subspaceIteration;
+
+  if ( this->logDetApprox != NULL )
+    delete this->logDetApprox;
+
   ////////////////////////////////////////////
   // variance computation related variables //
   ////////////////////////////////////////////  
   if ( this->precomputedTForVarEst != NULL )
     delete this->precomputedTForVarEst;
 
-
+  this->clearVarianceApproximationFineTables();
 }
 
 void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf, 
@@ -423,6 +753,12 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
   this->b_verboseTime = _conf->gB ( _confSection, "verboseTime", false );
   this->b_debug = _conf->gB ( _confSection, "debug", false );
 
+  //////////////////////////////////////
+  // parallelization related settings //
+  //////////////////////////////////////
+  // only effective if compiled with OpenMP support
+  this->ui_numThreads = std::max ( 0, _conf->gI ( _confSection, "num_threads", 1 ) );
+
   if ( this->b_verbose )
   {  
     std::cerr << "------------" << std::endl;
@@ -443,6 +779,14 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
     std::cerr << "_confSection: " << _confSection << std::endl;
     std::cerr << "use_quantization: " << useQuantization << std::endl;
   }
+
+  this->b_usePackedLUT = _conf->gB ( _confSection, "use_packed_lut", false );
+  this->lutPrecision = CompactLookupTable::precisionFromString ( _conf->gS ( _confSection, "lut_precision", "double" ) );
+  if ( this->b_verbose )
+  {
+    std::cerr << "use_packed_lut: " << this->b_usePackedLUT << std::endl;
+    std::cerr << "lut_precision: " << CompactLookupTable::precisionToString ( this->lutPrecision ) << std::endl;
+  }
   
   if ( _conf->gB ( _confSection, "use_quantization", false ) )
   {
@@ -553,6 +897,20 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
     std::cerr << "FMKGPHyperparameterOptimization: " << _confSection << ":ils_method (" << ils_method << ") does not match any type (CG,CGL,SYMMLQ,MINRES), I will use CG" << std::endl;
     this->linsolver = new ILSConjugateGradients ( ils_verbose , ils_max_iterations, ils_min_delta, ils_min_residual );
   }  
+  
+  // solve the linear equation systems of all classes simultaneously (block CG), such that 
+  // every iteration only needs a single pass over the training data
+  if ( this->blockLinsolver != NULL )
+  {
+    delete this->blockLinsolver;
+    this->blockLinsolver = NULL;
+  }
+  if ( _conf->gB ( _confSection, "ils_block_solver", false ) )
+  {
+    this->blockLinsolver = new ILSBlockConjugateGradients ( ils_verbose , ils_max_iterations, ils_min_delta, ils_min_residual );
+    if ( this->b_verbose )
+      std::cerr << "FMKGPHyperparameterOptimization: using block CG for all classes at once" << std::endl;
+  }
  
   
   /////////////////////////////////////
@@ -566,6 +924,8 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
     optimizationMethod = OPT_DOWNHILLSIMPLEX;
   else if ( optimizationMethod_s == "none" )
     optimizationMethod = OPT_NONE;
+  else if ( optimizationMethod_s == "gradient" )
+    optimizationMethod = OPT_GRADIENT;
   else
     fthrow ( Exception, "Optimization method " << optimizationMethod_s << " is not known." );
 
@@ -573,6 +933,8 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
     std::cerr << "Using optimization method: " << optimizationMethod_s << std::endl;
 
   this->parameterStepSize = _conf->gD ( _confSection, "parameter_step_size", 0.1 );  
+  this->b_parallelGridSearch = _conf->gB ( _confSection, "parallel_grid_search", false );
+  this->b_lazyTransform = _conf->gB ( _confSection, "lazy_transform", false );
   
   this->optimizeNoise = _conf->gB ( _confSection, "optimize_noise", false );
   if ( this->b_verbose )
@@ -592,6 +954,10 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
   downhillSimplexTimeLimit     = _conf->gD ( _confSection, "downhillsimplex_time_limit", 24 * 60 * 60 );
   downhillSimplexParamTol      = _conf->gD ( _confSection, "downhillsimplex_delta", 0.01 );
 
+  gradientMaxIterations = _conf->gI ( _confSection, "gradient_max_iterations", 30 );
+  gradientNumProbes     = std::max ( 1, _conf->gI ( _confSection, "gradient_num_probes", 10 ) );
+  gradientSeed          = std::max ( 0, _conf->gI ( _confSection, "gradient_seed", 0 ) );
+
 
   //////////////////////////////////////////////
   // likelihood computation related variables //
@@ -607,12 +973,52 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
                                eigValueMaxIterations /*eigValueMaxIterations*/
                             );
 
+  // reuse the eigenvectors of the previous likelihood evaluation as starting subspace (and as deflation subspace of the block solver)
+  if ( this->subspaceIteration != NULL )
+  {
+    delete this->subspaceIteration;
+    this->subspaceIteration = NULL;
+  }
+  if ( _conf->gB ( _confSection, "recycle_krylov", false ) )
+  {
+    this->subspaceIteration = new EVSubspaceIteration ( eigValueMaxIterations, _conf->gD ( _confSection, "recycle_krylov_tolerance", 1e-4 ) );
+    if ( this->b_verbose && ( this->blockLinsolver == NULL ) )
+      std::cerr << "FMKGPHyperparameterOptimization: recycle_krylov only warm-starts the eigenvalue computation, deflation needs ils_block_solver" << std::endl;
+  }
+
   this->nrOfEigenvaluesToConsider = std::max ( 1, _conf->gI ( _confSection, "nrOfEigenvaluesToConsider", 1 ) );
+
+  // approximation of logdet(K + sigma^2 I): upper bound of Bai and Golub (default) or
+  // stochastic Lanczos quadrature, whose probe vectors are kept for all evaluations
+  if ( this->logDetApprox != NULL )
+  {
+    delete this->logDetApprox;
+    this->logDetApprox = NULL;
+  }
+  std::string logdet_approx = _conf->gS ( _confSection, "logdet_approx", "baigolub" );
+  if ( logdet_approx.compare ( "slq" ) == 0 )
+  {
+    int logdet_num_probes = std::max ( 1, _conf->gI ( _confSection, "logdet_num_probes", 30 ) );
+    int logdet_lanczos_depth = std::max ( 1, _conf->gI ( _confSection, "logdet_lanczos_depth", 20 ) );
+    int logdet_seed = std::max ( 0, _conf->gI ( _confSection, "logdet_seed", 0 ) );
+    this->logDetApprox = new LogDetApproxStochasticLanczos ( logdet_num_probes, logdet_lanczos_depth, logdet_seed );
+    if ( this->b_verbose )
+      std::cerr << "FMKGPHyperparameterOptimization: stochastic Lanczos logdet with " << logdet_num_probes << " probes and depth " << logdet_lanczos_depth << std::endl;
+  }
+  else if ( logdet_approx.compare ( "baigolub" ) != 0 )
+  {
+    std::cerr << "FMKGPHyperparameterOptimization: " << _confSection << ":logdet_approx (" << logdet_approx << ") does not match any type (baigolub,slq), I will use baigolub" << std::endl;
+  }
+
+  // the gradient belongs to the exact logdet, the Bai and Golub bound might not decrease along it
+  if ( ( this->optimizationMethod == OPT_GRADIENT ) && ( this->logDetApprox == NULL ) )
+    std::cerr << "FMKGPHyperparameterOptimization: optimization_method gradient is used with the Bai and Golub logdet bound, logdet_approx = slq is recommended" << std::endl;
   
   ////////////////////////////////////////////
   // variance computation related variables //
   ////////////////////////////////////////////  
   this->nrOfEigenvaluesToConsiderForVarApprox = std::max ( 1, _conf->gI ( _confSection, "nrOfEigenvaluesToConsiderForVarApprox", 1 ) );
+  this->ui_varianceBlockSize = std::max ( 1, _conf->gI ( _confSection, "variance_block_size", 64 ) );
 
 
   /////////////////////////////////////////////////////
@@ -620,6 +1026,24 @@ void FMKGPHyperparameterOptimization::initFromConfig ( const Config *_conf,
   /////////////////////////////////////////////////////
   
   this->b_usePreviousAlphas = _conf->gB ( _confSection, "b_usePreviousAlphas", true );
+
+  // incremental update of A, B, and T after adding examples, warm-started with the previous alphas
+  this->b_incrementalUpdate = _conf->gB ( _confSection, "incremental_update", false );
+  this->d_incrementalAlphaTolerance = std::max ( 0.0, _conf->gD ( _confSection, "incremental_alpha_tolerance", 1e-3 ) );
+  this->d_eigenDriftTolerance = std::max ( 0.0, _conf->gD ( _confSection, "eigen_drift_tolerance", 0.1 ) );
+  if ( this->b_incrementalUpdate && !this->b_usePreviousAlphas )
+  {
+    std::cerr << "FMKGPHyperparameterOptimization: incremental_update needs the previous alphas, b_usePreviousAlphas is switched on" << std::endl;
+    this->b_usePreviousAlphas = true;
+  }
+
+  // bounded training set for long-running online learning
+  this->ui_maxNumExamples = std::max ( 0, _conf->gI ( _confSection, "max_num_examples", 0 ) );
+  this->s_forgettingStrategy = _conf->gS ( _confSection, "forgetting_strategy", "sliding_window" );
+  if ( ( this->s_forgettingStrategy != "sliding_window" ) && ( this->s_forgettingStrategy != "reservoir" ) )
+    fthrow ( Exception, "FMKGPHyperparameterOptimization: unknown forgetting_strategy " << this->s_forgettingStrategy << " (sliding_window or reservoir)" );
+  this->ui_forgettingSeed = std::max ( 0, _conf->gI ( _confSection, "forgetting_seed", 0 ) );
+  this->ui_forgettingState = this->ui_forgettingSeed;
   
   if ( this->b_verbose )
   {
@@ -671,11 +1095,16 @@ void FMKGPHyperparameterOptimization::setFastMinKernel ( FastMinKernel * _fmk )
     this->fmk = _fmk;
   }
   
+  if ( this->fmk != NULL )
+    this->fmk->setNumberOfThreads ( this->ui_numThreads );
+  
   //
   if ( this->q != NULL )
   {  
     NICE::Vector _maxValuesPerDimension = this->fmk->featureMatrix().getLargestValuePerDimension();
     this->q->computeParametersFromData ( _maxValuesPerDimension );
+    // the training data is quantized with fixed parameters from now on
+    this->fmk->prepareBinIndices ( this->q );
   }
 }
 
@@ -695,6 +1124,11 @@ inline void FMKGPHyperparameterOptimization::setupGPLikelihoodApprox ( GPLikelih
                                                                        uint & _parameterVectorSize )
 {
   _gplike = new GPLikelihoodApprox ( _binaryLabels, ikmsum, linsolver, eig, verifyApproximation, nrOfEigenvaluesToConsider );
+  _gplike->setBlockLinsolver( this->blockLinsolver );
+  _gplike->setLogDetApprox( this->logDetApprox );
+  _gplike->setGradientProbes( this->gradientNumProbes, this->gradientSeed );
+  _gplike->setSubspaceIteration( this->subspaceIteration );
+  _gplike->setNumberOfThreads( this->ui_numThreads );
   _gplike->setDebug( this->b_debug );
   _gplike->setVerbose( this->b_verbose );
   _parameterVectorSize = this->ikmsum->getNumParameters();
@@ -702,6 +1136,9 @@ inline void FMKGPHyperparameterOptimization::setupGPLikelihoodApprox ( GPLikelih
 
 void FMKGPHyperparameterOptimization::updateEigenDecomposition( const int & _noEigenValues )
 {
+  // the tables for the fine variance approximation refer to the previous eigenvectors
+  this->clearVarianceApproximationFineTables();
+
   //compute the largest eigenvalue of K + noise   
   
   try 
@@ -718,12 +1155,65 @@ void FMKGPHyperparameterOptimization::updateEigenDecomposition( const int & _noE
   
 }
 
+bool FMKGPHyperparameterOptimization::updateEigenDecompositionIfDrifted ( const int & _noEigenValues )
+{
+  uint n ( this->ikmsum->rows() );
+  uint numOldExamples ( this->eigenMaxVectors.rows() );
+  uint k ( this->eigenMaxVectors.cols() );
+
+  if ( ( numOldExamples == 0 ) || ( numOldExamples > n ) || ( k < (uint) _noEigenValues ) || ( this->eigenMax.size() < k ) )
+  {
+    this->updateEigenDecomposition ( _noEigenValues );
+    return true;
+  }
+
+  // the new examples get zero entries, such that only the kernel values between old and new examples
+  // (and the accuracy of the previous decomposition) contribute to the residuals
+  NICE::Matrix extendedVectors ( n, k, 0.0 );
+  double maxDrift ( 0.0 );
+  for ( uint c = 0; c < k; c++ )
+  {
+    NICE::Vector v ( n, 0.0 );
+    for ( uint i = 0; i < numOldExamples; i++ )
+    {
+      v[i] = this->eigenMaxVectors ( i, c );
+      extendedVectors ( i, c ) = v[i];
+    }
+
+    NICE::Vector residual;
+    this->ikmsum->multiply ( residual, v );
+    for ( uint i = 0; i < n; i++ )
+      residual[i] -= this->eigenMax[c] * v[i];
+
+    maxDrift = std::max ( maxDrift, residual.normL2() / std::max ( fabs ( this->eigenMax[c] ), numeric_limits<double>::min() ) );
+  }
+
+  if ( this->b_verbose )
+    std::cerr << "FMKGPHyperparameterOptimization: drift of the eigenvectors after the increment: " << maxDrift << std::endl;
+
+  if ( maxDrift > this->d_eigenDriftTolerance )
+  {
+    this->updateEigenDecomposition ( _noEigenValues );
+    return true;
+  }
+
+  this->clearVarianceApproximationFineTables();
+  this->eigenMaxVectors.resize ( n, k );
+  this->eigenMaxVectors = extendedVectors;
+  return false;
+}
+
 void FMKGPHyperparameterOptimization::performOptimization ( GPLikelihoodApprox & _gplike, 
                                                             const uint & _parameterVectorSize 
                                                           )
 {
   if ( this->b_verbose )
     std::cerr << "perform optimization" << std::endl;
+
+  // candidates are evaluated without rewriting the features, the stored features are
+  // brought up to date when the lazy mode is switched off again
+  if ( this->b_lazyTransform )
+    this->setLazyTransformOfKernels ( true );
     
   if ( optimizationMethod == OPT_GREEDY )
   {
@@ -741,10 +1231,17 @@ void FMKGPHyperparameterOptimization::performOptimization ( GPLikelihoodApprox &
       std::cerr << "lower bound " << lB << " upper bound " << uB << " parameterStepSize: " << parameterStepSize << std::endl;
 
     
+    std::vector<double> grid;
     for ( double mypara = lB[0]; mypara <= uB[0]; mypara += this->parameterStepSize )
+      grid.push_back ( mypara );
+
+    if ( !this->b_parallelGridSearch || !this->performParallelGridSearch ( _gplike, grid ) )
     {
-      OPTIMIZATION::matrix_type hyperp ( 1, 1, mypara );
-      _gplike.evaluate ( hyperp );
+      for ( uint i = 0; i < grid.size(); i++ )
+      {
+        OPTIMIZATION::matrix_type hyperp ( 1, 1, grid[i] );
+        _gplike.evaluate ( hyperp );
+      }
     }
   }
   else if ( optimizationMethod == OPT_DOWNHILLSIMPLEX )
@@ -779,6 +1276,30 @@ void FMKGPHyperparameterOptimization::performOptimization ( GPLikelihoodApprox &
     
     optimizer.optimizeProb ( optProblem );
   }
+  else if ( optimizationMethod == OPT_GRADIENT )
+  {
+    if ( this->b_verbose )
+      std::cerr << "GRADIENT!!! " << std::endl;
+
+    // quasi-Newton method within the parameter bounds, suitable for many parameters (e.g., one weight per dimension)
+    NICE::Vector parameters;
+    ikmsum->getParameters ( parameters );
+    NICE::Vector lB = ikmsum->getParameterLowerBounds();
+    NICE::Vector uB = ikmsum->getParameterUpperBounds();
+
+    if ( this->b_verbose )
+      std::cerr << "Initial parameters: " << parameters << std::endl;
+
+    GPLikelihoodApproxObjective objective ( _gplike );
+    BoundedLBFGS optimizer ( this->gradientMaxIterations );
+    optimizer.setVerbose ( this->b_verbose );
+
+    double nlikelihood ( 0.0 );
+    optimizer.minimize ( objective, parameters, lB, uB, nlikelihood );
+
+    if ( this->b_verbose )
+      std::cerr << "L-BFGS needed " << optimizer.getNumberOfEvaluations() << " likelihood evaluations" << std::endl;
+  }
   else if ( optimizationMethod == OPT_NONE )
   {
     if ( this->b_verbose )
@@ -806,12 +1327,179 @@ void FMKGPHyperparameterOptimization::performOptimization ( GPLikelihoodApprox &
     _gplike.computeAlphaDirect( hyperp, eigenMax );
   }
 
+  if ( this->b_lazyTransform )
+    this->setLazyTransformOfKernels ( false );
+
   if ( this->b_verbose )
   {
     std::cerr << "Optimal hyperparameter was: " << _gplike.getBestParameters() << std::endl;
   }
 }
 
+void FMKGPHyperparameterOptimization::setLazyTransformOfKernels ( const bool & _lazyTransform )
+{
+  for ( int i = 0; i < this->ikmsum->getNumberOfModels(); i++ )
+  {
+    GMHIKernel *gmhik = dynamic_cast<GMHIKernel *> ( this->ikmsum->getModel ( i ) );
+    if ( gmhik != NULL )
+      gmhik->setLazyTransform ( _lazyTransform );
+  }
+}
+
+bool FMKGPHyperparameterOptimization::performParallelGridSearch ( GPLikelihoodApprox & _gplike,
+                                                                  const std::vector<double> & _grid
+                                                                )
+{
+#ifdef NICE_USELIB_OPENMP
+  int numWorkers = ( this->ui_numThreads == 0 ) ? omp_get_max_threads() : (int) this->ui_numThreads;
+  numWorkers = std::min ( numWorkers, (int) _grid.size() );
+  if ( numWorkers <= 1 )
+    return false;
+
+  // every worker needs its own copy of the solvers, the parameterized function and the kernel matrices
+  ILSConjugateGradients *linsolver_cg = dynamic_cast<ILSConjugateGradients *> ( this->linsolver );
+  EVArnoldi *eig_arnoldi = dynamic_cast<EVArnoldi *> ( this->eig );
+  ParameterizedFunction *pfCopy = ( this->pf != NULL ) ? this->pf->clone() : NULL;
+  bool supported = ( linsolver_cg != NULL ) && ( eig_arnoldi != NULL ) && ( pfCopy != NULL );
+  if ( pfCopy != NULL )
+    delete pfCopy;
+  for ( int i = 0; supported && ( i < this->ikmsum->getNumberOfModels() ); i++ )
+  {
+    ImplicitKernelMatrix *model = this->ikmsum->getModel ( i );
+    supported = ( dynamic_cast<IKMNoise *> ( model ) != NULL ) || ( dynamic_cast<GMHIKernel *> ( model ) != NULL );
+  }
+  if ( !supported )
+  {
+    if ( this->b_verbose )
+      std::cerr << "FMKGPHyperparameterOptimization: parallel grid search needs ils_method CG, the Arnoldi eigenvalue method, and a copyable transformation, evaluating sequentially" << std::endl;
+    return false;
+  }
+
+  if ( this->b_verbose )
+    std::cerr << "FMKGPHyperparameterOptimization: evaluating " << _grid.size() << " grid points with " << numWorkers << " workers" << std::endl;
+
+  std::vector<GPLikelihoodApprox *> workerLikelihoods ( numWorkers, (GPLikelihoodApprox *) NULL );
+  std::vector<std::string> errors ( numWorkers );
+
+#pragma omp parallel for num_threads( numWorkers ) schedule( static, 1 )
+  for ( int w = 0; w < numWorkers; w++ )
+  {
+    // contiguous part of the grid, such that warm starts from the previous grid point stay useful
+    uint begin = ( _grid.size() * w ) / numWorkers;
+    uint end = ( _grid.size() * ( w + 1 ) ) / numWorkers;
+
+    FastMinKernel *workerFmk = NULL;
+    ParameterizedFunction *workerPf = NULL;
+    IKMLinearCombination *workerIkm = NULL;
+    ILSConjugateGradients *workerLinsolver = NULL;
+    EVArnoldi *workerEig = NULL;
+    ILSBlockConjugateGradients *workerBlockLinsolver = NULL;
+    LogDetApproxStochasticLanczos *workerLogDetApprox = NULL;
+    EVSubspaceIteration *workerSubspaceIteration = NULL;
+
+    // exceptions must not leave the parallel region
+    try
+    {
+      // without the lazy mode, every worker needs its own copy of the features, which is transformed in-place for every grid point
+      if ( !this->b_lazyTransform )
+      {
+        workerFmk = new FastMinKernel ( *(this->fmk) );
+        workerFmk->setNumberOfThreads ( 1 );
+      }
+      workerPf = this->pf->clone();
+
+      workerIkm = new IKMLinearCombination ();
+      for ( int i = 0; i < this->ikmsum->getNumberOfModels(); i++ )
+      {
+        ImplicitKernelMatrix *model = this->ikmsum->getModel ( i );
+        IKMNoise *noiseModel = dynamic_cast<IKMNoise *> ( model );
+        if ( noiseModel != NULL )
+          workerIkm->addModel ( new IKMNoise ( *noiseModel ) );
+        else
+        {
+          // in the lazy mode, the shared features are only read
+          GMHIKernel *workerKernel = new GMHIKernel ( ( workerFmk != NULL ) ? workerFmk : this->fmk, workerPf, dynamic_cast<GMHIKernel *> ( model )->getQuantization() );
+          workerKernel->setLazyTransform ( this->b_lazyTransform );
+          workerIkm->addModel ( workerKernel );
+        }
+      }
+
+      workerLinsolver = new ILSConjugateGradients ( *linsolver_cg );
+      workerEig = new EVArnoldi ( *eig_arnoldi );
+
+      workerLikelihoods[w] = new GPLikelihoodApprox ( _gplike, workerIkm, workerLinsolver, workerEig );
+      // outputs of several workers would be interleaved
+      workerLikelihoods[w]->setVerbose ( false );
+
+      if ( this->blockLinsolver != NULL )
+        workerBlockLinsolver = new ILSBlockConjugateGradients ( *(this->blockLinsolver) );
+      workerLikelihoods[w]->setBlockLinsolver ( workerBlockLinsolver );
+
+      // same probes in all workers, such that the likelihoods of all grid points remain comparable
+      if ( this->logDetApprox != NULL )
+        workerLogDetApprox = new LogDetApproxStochasticLanczos ( *(this->logDetApprox) );
+      workerLikelihoods[w]->setLogDetApprox ( workerLogDetApprox );
+
+      if ( this->subspaceIteration != NULL )
+        workerSubspaceIteration = new EVSubspaceIteration ( *(this->subspaceIteration) );
+      workerLikelihoods[w]->setSubspaceIteration ( workerSubspaceIteration );
+
+      for ( uint i = begin; i < end; i++ )
+      {
+        OPTIMIZATION::matrix_type hyperp ( 1, 1, _grid[i] );
+        workerLikelihoods[w]->evaluate ( hyperp );
+      }
+    }
+    catch ( std::exception & e )
+    {
+      errors[w] = e.what();
+    }
+    catch ( ... )
+    {
+      errors[w] = "unknown exception";
+    }
+
+    // the best solution of this worker is kept in workerLikelihoods[w]
+    if ( workerSubspaceIteration != NULL )
+      delete workerSubspaceIteration;
+    if ( workerLogDetApprox != NULL )
+      delete workerLogDetApprox;
+    if ( workerBlockLinsolver != NULL )
+      delete workerBlockLinsolver;
+    if ( workerEig != NULL )
+      delete workerEig;
+    if ( workerLinsolver != NULL )
+      delete workerLinsolver;
+    if ( workerIkm != NULL )
+      delete workerIkm;
+    if ( workerPf != NULL )
+      delete workerPf;
+    if ( workerFmk != NULL )
+      delete workerFmk;
+  }
+
+  // merge in the order of the grid, such that ties are resolved as in the sequential evaluation
+  std::string error;
+  for ( int w = 0; w < numWorkers; w++ )
+  {
+    if ( errors[w].empty() )
+      _gplike.mergeBestSolution ( *workerLikelihoods[w] );
+    else if ( error.empty() )
+      error = errors[w];
+
+    if ( workerLikelihoods[w] != NULL )
+      delete workerLikelihoods[w];
+  }
+
+  if ( !error.empty() )
+    fthrow ( Exception, "FMKGPHyperparameterOptimization: parallel grid search failed: " << error );
+
+  return true;
+#else
+  return false;
+#endif
+}
+
 void FMKGPHyperparameterOptimization::transformFeaturesWithOptimalParameters ( const GPLikelihoodApprox & _gplike, 
                                                                                const uint & parameterVectorSize 
                                                                              )
@@ -824,6 +1512,8 @@ void FMKGPHyperparameterOptimization::computeMatricesAndLUTs ( const GPLikelihoo
 {
   this->precomputedA.clear();
   this->precomputedB.clear();
+  // LUTs of a restored binary model are replaced by newly allocated ones
+  this->releaseModelFile();
 
   for ( std::map<uint, NICE::Vector>::const_iterator i = _gplike.getBestAlphas().begin(); i != _gplike.getBestAlphas().end(); i++ )
   {
@@ -863,6 +1553,43 @@ void FMKGPHyperparameterOptimization::computeMatricesAndLUTs ( const GPLikelihoo
     }
   }
 
+  // the LUTs represent the alphas exactly
+  this->lutAlphas.clear();
+  if ( this->b_incrementalUpdate )
+    this->lutAlphas = _gplike.getBestAlphas();
+
+  this->finishMatricesAndLUTs ( _gplike );
+}
+
+void FMKGPHyperparameterOptimization::finishMatricesAndLUTs ( const GPLikelihoodApprox & _gplike )
+{
+  // class-interleaved copy of all LUTs for scoring all classes with a single pass over the test example
+  // the LUTs of the single classes are not kept next to the packed one
+  this->packedT.clear();
+  if ( ( this->q != NULL ) && this->b_usePackedLUT && !this->precomputedT.empty() )
+  {
+    this->packedT.pack ( this->precomputedT, this->fmk->get_d(), this->q->getNumberOfBins() );
+    for ( std::map< uint, double * >::iterator itT = this->precomputedT.begin(); itT != this->precomputedT.end(); itT++ )
+      delete [] itT->second;
+    this->precomputedT.clear();
+  }
+
+  // optionally replace the LUTs by tables with reduced precision (the packed LUT is kept in double precision)
+  for ( std::map< uint, CompactLookupTable * >::iterator itT = this->compactT.begin(); itT != this->compactT.end(); itT++ )
+    delete itT->second;
+  this->compactT.clear();
+
+  if ( ( this->q != NULL ) && this->packedT.empty() && ( this->lutPrecision != CompactLookupTable::PRECISION_DOUBLE ) )
+  {
+    for ( std::map< uint, double * >::iterator itT = this->precomputedT.begin(); itT != this->precomputedT.end(); itT++ )
+    {
+      this->compactT.insert ( std::pair<uint, CompactLookupTable *> ( itT->first,
+                                new CompactLookupTable ( itT->second, this->fmk->get_d(), this->q->getNumberOfBins(), this->lutPrecision ) ) );
+      delete [] itT->second;
+    }
+    this->precomputedT.clear();
+  }
+
   
   if ( this->precomputedTForVarEst != NULL )
   {
@@ -879,31 +1606,139 @@ void FMKGPHyperparameterOptimization::computeMatricesAndLUTs ( const GPLikelihoo
 
 }
 
-#ifdef NICE_USELIB_MATIO
-void FMKGPHyperparameterOptimization::optimizeBinary ( const sparse_t & _data, 
-                                                       const NICE::Vector & _yl, 
-                                                       const std::set<uint> & _positives, 
-                                                       const std::set<uint> & _negatives, 
-                                                       double _noise 
-                                                     )
+bool FMKGPHyperparameterOptimization::updateMatricesAndLUTs ( const GPLikelihoodApprox & _gplike )
 {
-  std::map<uint, uint> examples;
-  NICE::Vector y ( _yl.size() );
-  uint ind = 0;
-  for ( uint i = 0 ; i < _yl.size(); i++ )
+  const std::map<uint, NICE::Vector> & alphas = _gplike.getBestAlphas();
+
+  // LUTs pointing into a binary model or belonging to other classes are computed from scratch
+  if ( ( this->modelFile != NULL ) || this->lutAlphas.empty() || ( alphas.size() != this->lutAlphas.size() ) || ( this->precomputedA.size() != alphas.size() ) )
+    return false;
+
+  uint n ( this->fmk->get_n() );
+  uint numOldExamples ( this->lutAlphas.begin()->second.size() );
+  if ( numOldExamples > n )
+    return false;
+
+  // changes of alpha per class, small changes of old examples are deferred to later increments
+  std::map<uint, NICE::Vector> diffOfAlpha;
+  std::map<uint, std::vector<uint> > changedExamples;
+  uint numChanges ( 0 );
+  for ( std::map<uint, NICE::Vector>::const_iterator alphaIt = alphas.begin(); alphaIt != alphas.end(); alphaIt++ )
   {
-    if ( _positives.find ( i ) != _positives.end() ) {
-      y[ examples.size() ] = 1.0;
-      examples.insert ( pair<uint, uint> ( i, ind ) );
-      ind++;
-    } else if ( _negatives.find ( i ) != _negatives.end() ) {
-      y[ examples.size() ] = -1.0;
-      examples.insert ( pair<uint, uint> ( i, ind ) );
-      ind++;
+    std::map<uint, NICE::Vector>::const_iterator lutAlphaIt = this->lutAlphas.find ( alphaIt->first );
+    if ( ( lutAlphaIt == this->lutAlphas.end() ) || ( lutAlphaIt->second.size() != numOldExamples ) ||
+         ( alphaIt->second.size() != n ) || ( this->precomputedA.find ( alphaIt->first ) == this->precomputedA.end() ) )
+      return false;
+
+    double threshold ( this->d_incrementalAlphaTolerance * alphaIt->second.normInf() );
+
+    NICE::Vector & diff = diffOfAlpha[ alphaIt->first ];
+    diff.resize ( n );
+    diff.set ( 0.0 );
+    std::vector<uint> & changed = changedExamples[ alphaIt->first ];
+    for ( uint i = 0; i < n; i++ )
+    {
+      double change ( alphaIt->second[i] - ( ( i < numOldExamples ) ? lutAlphaIt->second[i] : 0.0 ) );
+      if ( ( change != 0.0 ) && ( ( i >= numOldExamples ) || ( fabs ( change ) > threshold ) ) )
+      {
+        diff[i] = change;
+        changed.push_back ( i );
+      }
     }
+    numChanges += changed.size();
   }
-  y.resize ( examples.size() );
-  std::cerr << "Examples: " << examples.size() << std::endl;
+
+  // estimated costs: the computation from scratch sweeps over all non-zero elements and fills all LUTs,
+  // every change costs locating the example and a range update of the LUT in each non-zero dimension of it
+  uint d ( this->fmk->get_d() );
+  double hmax ( ( this->q != NULL ) ? this->q->getNumberOfBins() : 0.0 );
+  double numNonZero ( 0.0 );
+  for ( uint dim = 0; dim < d; dim++ )
+    numNonZero += this->fmk->featureMatrix().getNumberOfNonZeroElementsPerDimension ( dim );
+
+  double costFromScratch ( alphas.size() * ( numNonZero + d * hmax ) );
+  double costIncremental ( numChanges * ( numNonZero / std::max ( n, (uint) 1 ) ) * ( hmax + log ( (double) n + 1.0 ) / log ( 2.0 ) ) );
+
+  if ( this->b_verbose )
+    std::cerr << "FMKGPHyperparameterOptimization: " << numChanges << " changes of alpha, estimated costs incremental " << costIncremental << " vs. from scratch " << costFromScratch << std::endl;
+
+  if ( costIncremental > costFromScratch )
+    return false;
+
+  // the LUTs of a packed model are updated separately and packed again in finishMatricesAndLUTs
+  if ( ( this->q != NULL ) && !this->packedT.empty() && this->precomputedT.empty() )
+    this->packedT.unpack ( this->precomputedT );
+
+  for ( std::map<uint, NICE::Vector>::const_iterator diffIt = diffOfAlpha.begin(); diffIt != diffOfAlpha.end(); diffIt++ )
+  {
+    uint classNo ( diffIt->first );
+    const std::vector<uint> & changed = changedExamples[ classNo ];
+
+    this->fmk->hik_update_alpha_multiplications ( diffIt->second, changed, numOldExamples, this->precomputedA[ classNo ], this->precomputedB[ classNo ] );
+
+    if ( this->q != NULL )
+    {
+      std::map<uint, double *>::iterator itT = this->precomputedT.find ( classNo );
+      if ( ( itT != this->precomputedT.end() ) && ( itT->second != NULL ) )
+        this->fmk->hikUpdateLookupTable ( itT->second, diffIt->second, changed, this->q, this->pf );
+      else
+      {
+        // only LUTs with reduced precision are kept, these are compacted again in finishMatricesAndLUTs
+        this->precomputedT[ classNo ] = this->fmk->hik_prepare_alpha_multiplications_fast ( this->precomputedA[ classNo ], this->precomputedB[ classNo ], this->q, this->pf );
+      }
+    }
+
+    NICE::Vector & lutAlpha = this->lutAlphas[ classNo ];
+    lutAlpha.resize ( n );
+    for ( uint i = numOldExamples; i < n; i++ )
+      lutAlpha[i] = 0.0;
+    for ( std::vector<uint>::const_iterator exIt = changed.begin(); exIt != changed.end(); exIt++ )
+      lutAlpha[*exIt] += diffIt->second[*exIt];
+  }
+
+  this->finishMatricesAndLUTs ( _gplike );
+
+  return true;
+}
+
+void FMKGPHyperparameterOptimization::releaseModelFile ( )
+{
+  if ( this->modelFile == NULL )
+    return;
+
+  // the LUTs point into the binary model
+  this->precomputedT.clear();
+  this->packedT.clear();
+
+  delete this->modelFile;
+  this->modelFile = NULL;
+}
+
+#ifdef NICE_USELIB_MATIO
+void FMKGPHyperparameterOptimization::optimizeBinary ( const sparse_t & _data, 
+                                                       const NICE::Vector & _yl, 
+                                                       const std::set<uint> & _positives, 
+                                                       const std::set<uint> & _negatives, 
+                                                       double _noise 
+                                                     )
+{
+  std::map<uint, uint> examples;
+  NICE::Vector y ( _yl.size() );
+  uint ind = 0;
+  for ( uint i = 0 ; i < _yl.size(); i++ )
+  {
+    if ( _positives.find ( i ) != _positives.end() ) {
+      y[ examples.size() ] = 1.0;
+      examples.insert ( pair<uint, uint> ( i, ind ) );
+      ind++;
+    } else if ( _negatives.find ( i ) != _negatives.end() ) {
+      y[ examples.size() ] = -1.0;
+      examples.insert ( pair<uint, uint> ( i, ind ) );
+      ind++;
+    }
+  }
+  y.resize ( examples.size() );
+  std::cerr << "Examples: " << examples.size() << std::endl;
 
   optimize ( _data, y, examples, _noise );
 }
@@ -920,6 +1755,7 @@ void FMKGPHyperparameterOptimization::optimize ( const sparse_t & _data,
   std::cerr << "Initializing data structure ..." << std::endl;
   if ( fmk != NULL ) delete fmk;
   fmk = new FastMinKernel ( _data, _noise, _examples );
+  fmk->setNumberOfThreads ( this->ui_numThreads );
   t.stop();
   if ( this->b_verboseTime )
     std::cerr << "Time used for initializing the FastMinKernel structure: " << t.getLast() << std::endl;
@@ -1010,6 +1846,8 @@ void FMKGPHyperparameterOptimization::optimize ( const NICE::Vector & _y )
     fthrow ( Exception, "FastMinKernel object was not initialized!" );
 
   this->labels  = _y;
+  this->ui_numExamplesSeen = _y.size();
+  this->ui_forgettingState = this->ui_forgettingSeed;
   
   std::map< uint, NICE::Vector > binaryLabels;
   
@@ -1157,6 +1995,81 @@ void FMKGPHyperparameterOptimization::prepareVarianceApproximationFine()
     std::cerr << "Current number of EV: " <<  this->eigenMax.size() << " but required: " << (uint) this->nrOfEigenvaluesToConsiderForVarApprox << std::endl;
     this->updateEigenDecomposition(  this->nrOfEigenvaluesToConsiderForVarApprox ); 
   }
+
+  // tables are still valid if the eigenvectors did not change since the last call
+  if ( this->hasVarianceApproximationFineTables() )
+    return;
+
+  this->clearVarianceApproximationFineTables();
+
+  // the projections are computed like classification scores with alpha = v_j, hikComputeKernelVector compares
+  // the original feature values, so the tables are computed with the original values as well
+  NICE::PFIdentity originalValues;
+  uint n ( this->eigenMaxVectors.rows() );
+  for ( int tmpJ = 0; tmpJ < this->nrOfEigenvaluesToConsiderForVarApprox-1; tmpJ++ )
+  {
+    NICE::Vector eigenVector ( n );
+    for ( uint i = 0; i < n; i++ )
+      eigenVector[i] = this->eigenMaxVectors ( i, tmpJ );
+
+    PrecomputedType A;
+    PrecomputedType B;
+    this->fmk->hik_prepare_alpha_multiplications ( eigenVector, A, B, &originalValues );
+    A.setIoUntilEndOfFile ( false );
+    B.setIoUntilEndOfFile ( false );
+    this->precomputedAForVarEstFine.push_back ( A );
+    this->precomputedBForVarEstFine.push_back ( B );
+
+    if ( this->q != NULL )
+      this->precomputedTForVarEstFine.push_back ( this->fmk->hik_prepare_alpha_multiplications_fast ( A, B, this->q, NULL ) );
+  }
+}
+
+void FMKGPHyperparameterOptimization::clearVarianceApproximationFineTables ()
+{
+  this->precomputedAForVarEstFine.clear();
+  this->precomputedBForVarEstFine.clear();
+
+  for ( std::vector< double * >::iterator itT = this->precomputedTForVarEstFine.begin(); itT != this->precomputedTForVarEstFine.end(); itT++ )
+    delete [] *itT;
+  this->precomputedTForVarEstFine.clear();
+}
+
+bool FMKGPHyperparameterOptimization::hasVarianceApproximationFineTables () const
+{
+  if ( this->nrOfEigenvaluesToConsiderForVarApprox <= 1 )
+    return true;
+
+  return ( ( this->precomputedAForVarEstFine.size() == (uint) ( this->nrOfEigenvaluesToConsiderForVarApprox-1 ) ) &&
+           ( ( this->q == NULL ) || ( this->precomputedTForVarEstFine.size() == this->precomputedAForVarEstFine.size() ) ) );
+}
+
+void FMKGPHyperparameterOptimization::projectOntoEigenVectors ( const NICE::SparseVector & _x,
+                                                                NICE::Vector & _projections
+                                                              ) const
+{
+  _projections.resize ( this->precomputedAForVarEstFine.size() );
+  for ( uint tmpJ = 0; tmpJ < this->precomputedAForVarEstFine.size(); tmpJ++ )
+  {
+    if ( this->q != NULL )
+      this->fmk->hik_kernel_sum_fast ( this->precomputedTForVarEstFine[tmpJ], this->q, _x, _projections[tmpJ] );
+    else
+      this->fmk->hik_kernel_sum ( this->precomputedAForVarEstFine[tmpJ], this->precomputedBForVarEstFine[tmpJ], _x, _projections[tmpJ] );
+  }
+}
+
+void FMKGPHyperparameterOptimization::projectOntoEigenVectors ( const NICE::Vector & _x,
+                                                                NICE::Vector & _projections
+                                                              ) const
+{
+  _projections.resize ( this->precomputedAForVarEstFine.size() );
+  for ( uint tmpJ = 0; tmpJ < this->precomputedAForVarEstFine.size(); tmpJ++ )
+  {
+    if ( this->q != NULL )
+      this->fmk->hik_kernel_sum_fast ( this->precomputedTForVarEstFine[tmpJ], this->q, _x, _projections[tmpJ] );
+    else
+      this->fmk->hik_kernel_sum ( this->precomputedAForVarEstFine[tmpJ], this->precomputedBForVarEstFine[tmpJ], _x, _projections[tmpJ] );
+  }
 }
 
 uint FMKGPHyperparameterOptimization::classify ( const NICE::SparseVector & _xstar, 
@@ -1169,32 +2082,48 @@ uint FMKGPHyperparameterOptimization::classify ( const NICE::SparseVector & _xst
     fthrow ( Exception, "The precomputation vector is zero...have you trained this classifier?" );
   }
 
-  for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
+  if ( ( this->q != NULL ) && !this->packedT.empty() )
   {
-    uint classno = i->first;
-    double beta;
-
-    if ( this->q != NULL ) {
-      std::map<uint, double *>::const_iterator j = this->precomputedT.find ( classno );
-      double *T = j->second;
-      this->fmk->hik_kernel_sum_fast ( T, this->q, _xstar, beta );
-    } else {
-      const PrecomputedType & A = i->second;
-      std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
-      const PrecomputedType & B = j->second;
-
-      // fmk->hik_kernel_sum ( A, B, _xstar, beta ); if A, B are of type Matrix
-      // Giving the transformation pf as an additional
-      // argument is necessary due to the following reason:
-      // FeatureMatrixT is sorted according to the original values, therefore,
-      // searching for upper and lower bounds ( findFirst... functions ) require original feature
-      // values as inputs. However, for calculation we need the transformed features values.
+    // scores of all classes at once using the class-interleaved LUT
+    NICE::Vector packedScores;
+    this->packedT.computeScores ( _xstar, this->q, packedScores );
+    const std::vector<uint> & classNumbers = this->packedT.getClassNumbers();
+    for ( uint c = 0; c < classNumbers.size(); c++ )
+      _scores[ classNumbers[c] ] = packedScores[c];
+  }
+  else if ( ( this->q != NULL ) && !this->compactT.empty() )
+  {
+    // LUTs with reduced precision
+    for ( std::map< uint, CompactLookupTable * >::const_iterator itT = this->compactT.begin(); itT != this->compactT.end(); itT++ )
+      _scores[ itT->first ] = itT->second->sumQuantized ( _xstar, this->q );
+  }
+  else
+    for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
+    {
+      uint classno = i->first;
+      double beta;
+
+      if ( this->q != NULL ) {
+        std::map<uint, double *>::const_iterator j = this->precomputedT.find ( classno );
+        double *T = j->second;
+        this->fmk->hik_kernel_sum_fast ( T, this->q, _xstar, beta );
+      } else {
+        const PrecomputedType & A = i->second;
+        std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
+        const PrecomputedType & B = j->second;
+
+        // fmk->hik_kernel_sum ( A, B, _xstar, beta ); if A, B are of type Matrix
+        // Giving the transformation pf as an additional
+        // argument is necessary due to the following reason:
+        // FeatureMatrixT is sorted according to the original values, therefore,
+        // searching for upper and lower bounds ( findFirst... functions ) require original feature
+        // values as inputs. However, for calculation we need the transformed features values.
+
+        this->fmk->hik_kernel_sum ( A, B, _xstar, beta, pf );
+      }
 
-      this->fmk->hik_kernel_sum ( A, B, _xstar, beta, pf );
+      _scores[ classno ] = beta;
     }
-
-    _scores[ classno ] = beta;
-  }
   _scores.setDim ( *(this->knownClasses.rbegin() ) + 1 );
   
   if ( this->precomputedA.size() > 1 )
@@ -1229,33 +2158,49 @@ uint FMKGPHyperparameterOptimization::classify ( const NICE::SparseVector & _xst
     fthrow ( Exception, "The precomputation vector is zero...have you trained this classifier?" );
   }
 
-  for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
+  if ( ( this->q != NULL ) && !this->packedT.empty() )
   {
-    uint classno = i->first;
-    double beta;
-
-    if ( this->q != NULL ) {
-      std::map<uint, double *>::const_iterator j = this->precomputedT.find ( classno );
-      double *T = j->second;
-      this->fmk->hik_kernel_sum_fast ( T, this->q, _xstar, beta );
-    } else {
-      const PrecomputedType & A = i->second;
-      std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
-      const PrecomputedType & B = j->second;
-
-      // fmk->hik_kernel_sum ( A, B, _xstar, beta ); if A, B are of type Matrix
-      // Giving the transformation pf as an additional
-      // argument is necessary due to the following reason:
-      // FeatureMatrixT is sorted according to the original values, therefore,
-      // searching for upper and lower bounds ( findFirst... functions ) require original feature
-      // values as inputs. However, for calculation we need the transformed features values.
+    // scores of all classes at once using the class-interleaved LUT
+    NICE::Vector packedScores;
+    this->packedT.computeScores ( _xstar, this->q, packedScores );
+    const std::vector<uint> & classNumbers = this->packedT.getClassNumbers();
+    for ( uint c = 0; c < classNumbers.size(); c++ )
+      _scores[ classNumbers[c] ] = packedScores[c];
+  }
+  else if ( ( this->q != NULL ) && !this->compactT.empty() )
+  {
+    // LUTs with reduced precision
+    for ( std::map< uint, CompactLookupTable * >::const_iterator itT = this->compactT.begin(); itT != this->compactT.end(); itT++ )
+      _scores[ itT->first ] = itT->second->sumQuantized ( _xstar, this->q );
+  }
+  else
+    for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
+    {
+      uint classno = i->first;
+      double beta;
+
+      if ( this->q != NULL ) {
+        std::map<uint, double *>::const_iterator j = this->precomputedT.find ( classno );
+        double *T = j->second;
+        this->fmk->hik_kernel_sum_fast ( T, this->q, _xstar, beta );
+      } else {
+        const PrecomputedType & A = i->second;
+        std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
+        const PrecomputedType & B = j->second;
+
+        // fmk->hik_kernel_sum ( A, B, _xstar, beta ); if A, B are of type Matrix
+        // Giving the transformation pf as an additional
+        // argument is necessary due to the following reason:
+        // FeatureMatrixT is sorted according to the original values, therefore,
+        // searching for upper and lower bounds ( findFirst... functions ) require original feature
+        // values as inputs. However, for calculation we need the transformed features values.
+
+        this->fmk->hik_kernel_sum ( A, B, _xstar, beta, pf );
+      }
 
-      this->fmk->hik_kernel_sum ( A, B, _xstar, beta, pf );
+      _scores[ classno ] = beta;
     }
 
-    _scores[ classno ] = beta;
-  }
-
   if ( this->precomputedA.size() > 1 )
   { // multi-class classification
     return _scores.MaxIndex();
@@ -1282,37 +2227,53 @@ uint FMKGPHyperparameterOptimization::classify ( const NICE::Vector & _xstar,
     fthrow ( Exception, "The precomputation vector is zero...have you trained this classifier?" );
   }
 
-  for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
+  if ( ( this->q != NULL ) && !this->packedT.empty() )
   {
-    uint classno = i->first;
-    
-    double beta;
-
-    if ( this->q != NULL )
-    {
-      std::map<uint, double *>::const_iterator j = this->precomputedT.find ( classno );
-      double *T = j->second;
-      this->fmk->hik_kernel_sum_fast ( T, this->q, _xstar, beta );
-    }
-    else
+    // scores of all classes at once using the class-interleaved LUT
+    NICE::Vector packedScores;
+    this->packedT.computeScores ( _xstar, this->q, packedScores );
+    const std::vector<uint> & classNumbers = this->packedT.getClassNumbers();
+    for ( uint c = 0; c < classNumbers.size(); c++ )
+      _scores[ classNumbers[c] ] = packedScores[c];
+  }
+  else if ( ( this->q != NULL ) && !this->compactT.empty() )
+  {
+    // LUTs with reduced precision
+    for ( std::map< uint, CompactLookupTable * >::const_iterator itT = this->compactT.begin(); itT != this->compactT.end(); itT++ )
+      _scores[ itT->first ] = itT->second->sumQuantized ( _xstar, this->q );
+  }
+  else
+    for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
     {
-      const PrecomputedType & A = i->second;
-      std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
-      const PrecomputedType & B = j->second;
+      uint classno = i->first;
+    
+      double beta;
 
-      // fmk->hik_kernel_sum ( A, B, _xstar, beta ); if A, B are of type Matrix
-      // Giving the transformation pf as an additional
-      // argument is necessary due to the following reason:
-      // FeatureMatrixT is sorted according to the original values, therefore,
-      // searching for upper and lower bounds ( findFirst... functions ) require original feature
-      // values as inputs. However, for calculation we need the transformed features values.
+      if ( this->q != NULL )
+      {
+        std::map<uint, double *>::const_iterator j = this->precomputedT.find ( classno );
+        double *T = j->second;
+        this->fmk->hik_kernel_sum_fast ( T, this->q, _xstar, beta );
+      }
+      else
+      {
+        const PrecomputedType & A = i->second;
+        std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
+        const PrecomputedType & B = j->second;
+
+        // fmk->hik_kernel_sum ( A, B, _xstar, beta ); if A, B are of type Matrix
+        // Giving the transformation pf as an additional
+        // argument is necessary due to the following reason:
+        // FeatureMatrixT is sorted according to the original values, therefore,
+        // searching for upper and lower bounds ( findFirst... functions ) require original feature
+        // values as inputs. However, for calculation we need the transformed features values.
+
+        this->fmk->hik_kernel_sum ( A, B, _xstar, beta, this->pf );
+      }
 
-      this->fmk->hik_kernel_sum ( A, B, _xstar, beta, this->pf );
+      _scores[ classno ] = beta;
     }
 
-    _scores[ classno ] = beta;
-  }
-
   _scores.setDim ( *(this->knownClasses.rbegin() ) + 1 );
   
   
@@ -1436,17 +2397,23 @@ void FMKGPHyperparameterOptimization::computePredictiveVarianceApproximateFine (
     
     
     
-    NICE::Matrix::const_iterator eigenVecIt = this->eigenMaxVectors.begin();
+    if ( this->hasVarianceApproximationFineTables() )
     {
-    NICE::Vector::iterator multResIt = multiplicationResults.begin();
-    for ( int tmpJ = 0; tmpJ < this->nrOfEigenvaluesToConsiderForVarApprox-1; tmpJ++, multResIt++)
+      // O(nnz(x) log n) per eigenvector, see prepareVarianceApproximationFine
+      this->projectOntoEigenVectors ( _x, multiplicationResults );
+    }
+    else
     {
-      for ( NICE::Vector::const_iterator kStarIt = kStar.begin(); kStarIt != kStar.end(); kStarIt++ ,eigenVecIt++)
+      NICE::Matrix::const_iterator eigenVecIt = this->eigenMaxVectors.begin();
+      NICE::Vector::iterator multResIt = multiplicationResults.begin();
+      for ( int tmpJ = 0; tmpJ < this->nrOfEigenvaluesToConsiderForVarApprox-1; tmpJ++, multResIt++)
       {
-        (*multResIt) += (*kStarIt) * (*eigenVecIt);
+        for ( NICE::Vector::const_iterator kStarIt = kStar.begin(); kStarIt != kStar.end(); kStarIt++ ,eigenVecIt++)
+        {
+          (*multResIt) += (*kStarIt) * (*eigenVecIt);
+        }
       }
     }
-   }
     
   if ( this->b_debug )
   {
@@ -1481,6 +2448,109 @@ void FMKGPHyperparameterOptimization::computePredictiveVarianceApproximateFine (
     _predVariance = kSelf - currentSecondTerm; 
 }
 
+void FMKGPHyperparameterOptimization::computePredictiveVarianceApproximateFine ( const std::vector< const NICE::SparseVector * > & _x, 
+                                                                                 NICE::Vector & _predVariances 
+                                                                               ) const
+{
+  // security check!
+  if ( this->eigenMaxVectors.rows() == 0 )
+  {
+      fthrow ( Exception, "eigenMaxVectors is empty...have you trained this classifer? Aborting..." );
+  }
+
+  _predVariances.resize ( _x.size() );
+  if ( _x.empty() )
+    return;
+
+  // every block writes to its own entries of _predVariances only
+  int numBlocks = ( _x.size() + this->ui_varianceBlockSize - 1 ) / this->ui_varianceBlockSize;
+#ifdef NICE_USELIB_OPENMP
+  int numThreads = ( this->ui_numThreads == 0 ) ? omp_get_max_threads() : (int) this->ui_numThreads;
+  numThreads = std::max ( 1, std::min ( numThreads, numBlocks ) );
+#pragma omp parallel for num_threads( numThreads ) schedule( dynamic ) if ( numThreads > 1 )
+#endif
+  for ( int blockCnt = 0; blockCnt < numBlocks; blockCnt++ )
+  {
+    uint begin = blockCnt * this->ui_varianceBlockSize;
+    uint end   = std::min<uint> ( begin + this->ui_varianceBlockSize, _x.size() );
+    this->computePredictiveVarianceApproximateFineForBlock ( _x, begin, end, _predVariances );
+  }
+}
+
+void FMKGPHyperparameterOptimization::computePredictiveVarianceApproximateFineForBlock ( const std::vector< const NICE::SparseVector * > & _x,
+                                                                                         const uint & _begin,
+                                                                                         const uint & _end,
+                                                                                         NICE::Vector & _predVariances
+                                                                                       ) const
+{
+  std::vector< const NICE::SparseVector * > block ( _x.begin() + _begin, _x.begin() + _end );
+  uint m ( block.size() );
+
+  // kernel vectors of the whole block, one column per example
+  NICE::Matrix kStars;
+  this->fmk->hikComputeKernelVectors ( block, kStars );
+  uint n ( kStars.rows() );
+
+  // projections onto the first k-1 eigenvectors, the remaining part of |k_*|^2 is weighted with the k-th eigenvalue
+  uint numProjections ( this->nrOfEigenvaluesToConsiderForVarApprox - 1 );
+  std::vector<double> multiplicationResults ( numProjections * m, 0.0 );
+  std::vector<double> normKStar ( m, 0.0 );
+  std::vector<double> kStarRow ( m );
+
+  // with the tables of the eigenvectors, only |k_*|^2 needs the kernel vectors
+  bool useTables ( this->hasVarianceApproximationFineTables() );
+  if ( useTables )
+  {
+    NICE::Vector projections;
+    for ( uint j = 0; j < m; j++ )
+    {
+      this->projectOntoEigenVectors ( *(block[j]), projections );
+      for ( uint tmpJ = 0; tmpJ < numProjections; tmpJ++ )
+        multiplicationResults[tmpJ * m + j] = projections[tmpJ];
+    }
+  }
+
+  for ( uint i = 0; i < n; i++ )
+  {
+    for ( uint j = 0; j < m; j++ )
+    {
+      kStarRow[j] = kStars ( i, j );
+      normKStar[j] += kStarRow[j] * kStarRow[j];
+    }
+
+    if ( useTables )
+      continue;
+
+    for ( uint tmpJ = 0; tmpJ < numProjections; tmpJ++ )
+    {
+      double eigenVecValue ( this->eigenMaxVectors ( i, tmpJ ) );
+      double * multRes = &(multiplicationResults[tmpJ * m]);
+      for ( uint j = 0; j < m; j++ )
+        multRes[j] += eigenVecValue * kStarRow[j];
+    }
+  }
+
+  for ( uint j = 0; j < m; j++ )
+  {
+    double kSelf ( 0.0 );
+    for ( NICE::SparseVector::const_iterator it = block[j]->begin(); it != block[j]->end(); it++ )
+      kSelf += this->pf->f ( 0, it->second );
+
+    double currentSecondTerm ( 0.0 );
+    double sumOfProjectionLengths ( 0.0 );
+    for ( uint tmpJ = 0; tmpJ < numProjections; tmpJ++ )
+    {
+      double projectionLength ( multiplicationResults[tmpJ * m + j] );
+      currentSecondTerm      += ( 1.0 / this->eigenMax[tmpJ] ) * pow ( projectionLength, 2 );
+      sumOfProjectionLengths += pow ( projectionLength, 2 );
+    }
+
+    currentSecondTerm += ( 1.0 / this->eigenMax[numProjections] ) * ( normKStar[j] - sumOfProjectionLengths );
+
+    _predVariances[_begin + j] = kSelf - currentSecondTerm;
+  }
+}
+
 void FMKGPHyperparameterOptimization::computePredictiveVarianceExact ( const NICE::SparseVector & x, double & predVariance ) const
 {
   // security check!  
@@ -1616,12 +2686,19 @@ void FMKGPHyperparameterOptimization::computePredictiveVarianceApproximateFine (
 //     multiplicationResults.multiply ( *eigenMaxVectorIt, kStar, true/* transpose */ );
 
     NICE::Vector multiplicationResults(this-> nrOfEigenvaluesToConsiderForVarApprox-1, 0.0 );
-    NICE::Matrix::const_iterator eigenVecIt = this->eigenMaxVectors.begin();
-    for ( int tmpJ = 0; tmpJ < this->nrOfEigenvaluesToConsiderForVarApprox-1; tmpJ++)
+    if ( this->hasVarianceApproximationFineTables() )
     {
-      for ( NICE::Vector::const_iterator kStarIt = kStar.begin(); kStarIt != kStar.end(); kStarIt++,eigenVecIt++)
-      {        
-        multiplicationResults[tmpJ] += (*kStarIt) * (*eigenVecIt);//eigenMaxVectors(tmpI,tmpJ);
+      this->projectOntoEigenVectors ( _x, multiplicationResults );
+    }
+    else
+    {
+      NICE::Matrix::const_iterator eigenVecIt = this->eigenMaxVectors.begin();
+      for ( int tmpJ = 0; tmpJ < this->nrOfEigenvaluesToConsiderForVarApprox-1; tmpJ++)
+      {
+        for ( NICE::Vector::const_iterator kStarIt = kStar.begin(); kStarIt != kStar.end(); kStarIt++,eigenVecIt++)
+        {        
+          multiplicationResults[tmpJ] += (*kStarIt) * (*eigenVecIt);//eigenMaxVectors(tmpI,tmpJ);
+        }
       }
     }
 
@@ -1721,6 +2798,57 @@ void FMKGPHyperparameterOptimization::computePredictiveVarianceExact ( const NIC
 void FMKGPHyperparameterOptimization::restore ( std::istream & _is, 
                                                 int _format 
                                               )
+{
+  if ( _format == BinaryModelFile::FORMAT_BINARY )
+  {
+    BinaryModelReader * reader = new BinaryModelReader();
+    try
+    {
+      reader->read ( _is );
+    }
+    catch ( ... )
+    {
+      delete reader;
+      throw;
+    }
+    this->restoreBinary ( reader );
+  }
+  else
+  {
+    this->restoreText ( _is, _format );
+    this->finishRestore();
+  }
+}
+
+void FMKGPHyperparameterOptimization::restoreMapped ( std::istream & _is,
+                                                      const std::string & _filename
+                                                    )
+{
+  _is >> std::ws;
+  std::streampos position = _is.tellg();
+  if ( position == std::streampos ( -1 ) )
+    fthrow ( Exception, "FMKGPHyperparameterOptimization::restoreMapped: position of the binary model within " << _filename << " is unknown" );
+
+  BinaryModelReader * reader = new BinaryModelReader();
+  try
+  {
+    reader->open ( _filename, static_cast<size_t> ( position ) );
+  }
+  catch ( ... )
+  {
+    delete reader;
+    throw;
+  }
+
+  // continue behind the binary model
+  _is.seekg ( position + static_cast<std::streamoff> ( reader->getSize() ) );
+
+  this->restoreBinary ( reader );
+}
+
+void FMKGPHyperparameterOptimization::restoreText ( std::istream & _is, 
+                                                    int _format 
+                                                  )
 {
   bool b_restoreVerbose ( false );
 
@@ -1742,6 +2870,12 @@ void FMKGPHyperparameterOptimization::restore ( std::istream & _is,
       throw;
     } 
 
+    // only the LUTs are restored and not the alphas they represent, the next increment computes them from scratch
+    this->lutAlphas.clear();
+
+    // the tables of the eigenvectors are not stored, see prepareVarianceApproximationFine
+    this->clearVarianceApproximationFineTables();
+
     if (fmk != NULL)
     {
       delete fmk;
@@ -1753,6 +2887,10 @@ void FMKGPHyperparameterOptimization::restore ( std::istream & _is,
       delete ikmsum;
     }
     ikmsum = new IKMLinearCombination (); 
+
+    // LUTs of a previously restored binary model
+    this->releaseModelFile();
+    this->packedT.clear();
     if ( b_restoreVerbose ) 
       std::cerr << "ikmsum object created" << std::endl;
     
@@ -1813,6 +2951,7 @@ void FMKGPHyperparameterOptimization::restore ( std::istream & _is,
           delete this->fmk;        
         this->fmk = new FastMinKernel();
         this->fmk->restore( _is, _format );
+        this->fmk->setNumberOfThreads ( this->ui_numThreads );
 
         _is >> tmp; // end of block 
         tmp = this->removeEndTag ( tmp );
@@ -1985,6 +3124,46 @@ void FMKGPHyperparameterOptimization::restore ( std::istream & _is,
         _is >> tmp; // end of block 
         tmp = this->removeEndTag ( tmp );
       }
+      else if  ( tmp.compare("b_usePackedLUT") == 0 )
+      {
+        _is >> this->b_usePackedLUT;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("lutPrecision") == 0 )
+      {
+        std::string s_precision;
+        _is >> s_precision;
+        this->lutPrecision = CompactLookupTable::precisionFromString ( s_precision );
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("compactT") == 0 )
+      {
+        _is >> tmp; // size
+        uint compactTSize ( 0 );
+        _is >> compactTSize;
+
+        for ( std::map< uint, CompactLookupTable * >::iterator itT = this->compactT.begin(); itT != this->compactT.end(); itT++ )
+          delete itT->second;
+        this->compactT.clear();
+
+        if ( b_restoreVerbose ) 
+          std::cerr << "restore compactT with size: " << compactTSize << std::endl;
+
+        for ( uint i = 0; i < compactTSize; i++ )
+        {
+          _is >> tmp;
+          uint index;
+          _is >> index;
+          CompactLookupTable * table = new CompactLookupTable();
+          table->restore ( _is, _format );
+          this->compactT.insert ( std::pair<uint, CompactLookupTable *> ( index, table ) );
+        }
+
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
       else if  ( tmp.compare("labels") == 0 )
       {
         _is >> this->labels;        
@@ -2119,6 +3298,24 @@ void FMKGPHyperparameterOptimization::restore ( std::istream & _is,
         _is >> tmp; // end of block 
         tmp = this->removeEndTag ( tmp );
       }
+      else if  ( tmp.compare("gradientMaxIterations") == 0 )
+      {
+        _is >> gradientMaxIterations;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("gradientNumProbes") == 0 )
+      {
+        _is >> gradientNumProbes;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("gradientSeed") == 0 )
+      {
+        _is >> gradientSeed;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
       //////////////////////////////////////////////
       // likelihood computation related variables //
       //////////////////////////////////////////////
@@ -2222,6 +3419,54 @@ void FMKGPHyperparameterOptimization::restore ( std::istream & _is,
         _is >> tmp; // end of block 
         tmp = this->removeEndTag ( tmp );
       }
+      else if  ( tmp.compare("b_incrementalUpdate") == 0 )
+      {
+        _is >> b_incrementalUpdate;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("d_incrementalAlphaTolerance") == 0 )
+      {
+        _is >> d_incrementalAlphaTolerance;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("d_eigenDriftTolerance") == 0 )
+      {
+        _is >> d_eigenDriftTolerance;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("ui_maxNumExamples") == 0 )
+      {
+        _is >> ui_maxNumExamples;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("s_forgettingStrategy") == 0 )
+      {
+        _is >> s_forgettingStrategy;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("ui_numExamplesSeen") == 0 )
+      {
+        _is >> ui_numExamplesSeen;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("ui_forgettingSeed") == 0 )
+      {
+        _is >> ui_forgettingSeed;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
+      else if  ( tmp.compare("ui_forgettingState") == 0 )
+      {
+        _is >> ui_forgettingState;
+        _is >> tmp; // end of block 
+        tmp = this->removeEndTag ( tmp );
+      }
       else if  ( tmp.compare("previousAlphas") == 0 )
       {        
         _is >> tmp; // size
@@ -2251,54 +3496,87 @@ void FMKGPHyperparameterOptimization::restore ( std::istream & _is,
       
  
     }
+  }
+  else
+  {
+    std::cerr << "InStream not initialized - restoring not possible!" << std::endl;
+    throw;
+  }
+}
 
-    
+void FMKGPHyperparameterOptimization::finishRestore ( )
+{
+  bool b_restoreVerbose ( false );
 
+#ifdef B_RESTOREVERBOSE
+  b_restoreVerbose = true;
+#endif
 
-    //NOTE are there any more models you added? then add them here respectively in the correct order
-    //.....  
+  //NOTE are there any more models you added? then add them here respectively in the correct order
+  //.....  
 
-    //the last one is the GHIK - which we do not have to restore, but simply reset it
-    if ( b_restoreVerbose ) 
-      std::cerr << " add GMHIKernel" << std::endl;
-    ikmsum->addModel ( new GMHIKernel ( fmk, this->pf, this->q ) );    
-    
-    if ( b_restoreVerbose ) 
-      std::cerr << " restore positive and negative label" << std::endl;
+  //the last one is the GHIK - which we do not have to restore, but simply reset it
+  if ( b_restoreVerbose ) 
+    std::cerr << " add GMHIKernel" << std::endl;
+  ikmsum->addModel ( new GMHIKernel ( fmk, this->pf, this->q ) );    
+  
+  if ( this->q != NULL )
+    this->fmk->prepareBinIndices ( this->q );
 
-      
+  // packed LUTs of a binary model are already in place
+  if ( ( this->q != NULL ) && this->b_usePackedLUT && !this->precomputedT.empty() && this->packedT.empty() )
+  {
+    if ( b_restoreVerbose ) 
+      std::cerr << " pack restored LUTs" << std::endl;
+    this->packedT.pack ( this->precomputedT, this->fmk->get_d(), this->q->getNumberOfBins() );
+    // LUTs of a binary model belong to its memory
+    if ( this->modelFile == NULL )
+      for ( std::map< uint, double * >::iterator itT = this->precomputedT.begin(); itT != this->precomputedT.end(); itT++ )
+        delete [] itT->second;
+    this->precomputedT.clear();
+  }
 
+  if ( b_restoreVerbose ) 
+    std::cerr << " restore positive and negative label" << std::endl;
 
-    this->knownClasses.clear();
     
+
+
+  this->knownClasses.clear();
+  
+  if ( b_restoreVerbose ) 
+    std::cerr << " fill known classes object " << std::endl;
+  
+  if ( this->precomputedA.size() == 1)
+  {
+    this->knownClasses.insert( this->i_binaryLabelPositive );
+    this->knownClasses.insert( this->i_binaryLabelNegative );
     if ( b_restoreVerbose ) 
-      std::cerr << " fill known classes object " << std::endl;
-    
-    if ( this->precomputedA.size() == 1)
-    {
-      this->knownClasses.insert( this->i_binaryLabelPositive );
-      this->knownClasses.insert( this->i_binaryLabelNegative );
-      if ( b_restoreVerbose ) 
-        std::cerr << " binary setting - added corresp. two class numbers" << std::endl;
-    }
-    else
-    {
-      for ( std::map<uint, PrecomputedType>::const_iterator itA = this->precomputedA.begin(); itA != this->precomputedA.end(); itA++)
-          knownClasses.insert ( itA->first );
-      if ( b_restoreVerbose ) 
-        std::cerr << " multi class setting - added corresp. multiple class numbers" << std::endl;
-    }
+      std::cerr << " binary setting - added corresp. two class numbers" << std::endl;
   }
   else
   {
-    std::cerr << "InStream not initialized - restoring not possible!" << std::endl;
-    throw;
+    for ( std::map<uint, PrecomputedType>::const_iterator itA = this->precomputedA.begin(); itA != this->precomputedA.end(); itA++)
+        knownClasses.insert ( itA->first );
+    if ( b_restoreVerbose ) 
+      std::cerr << " multi class setting - added corresp. multiple class numbers" << std::endl;
   }
 }
 
 void FMKGPHyperparameterOptimization::store ( std::ostream & _os, 
                                               int _format 
                                             ) const
+{
+  if ( _format == BinaryModelFile::FORMAT_BINARY )
+    this->storeBinary ( _os );
+  else
+    this->storeText ( _os, _format, true );
+}
+
+void FMKGPHyperparameterOptimization::storeText ( std::ostream & _os, 
+                                                  int _format,
+                                                  const bool & _withData
+                                                ) const
 {
   if ( _os.good() )
   {
@@ -2332,9 +3610,12 @@ void FMKGPHyperparameterOptimization::store ( std::ostream & _os,
     _os << b_performRegression << std::endl;
     _os << this->createEndTag( "b_performRegression" ) << std::endl;
     
-    _os << this->createStartTag( "fmk" ) << std::endl;
-    this->fmk->store ( _os, _format );
-    _os << this->createEndTag( "fmk" ) << std::endl;
+    if ( _withData )
+    {
+      _os << this->createStartTag( "fmk" ) << std::endl;
+      this->fmk->store ( _os, _format );
+      _os << this->createEndTag( "fmk" ) << std::endl;
+    }
     
     _os << this->createStartTag( "q" ) << std::endl;
     if ( q != NULL )
@@ -2361,55 +3642,92 @@ void FMKGPHyperparameterOptimization::store ( std::ostream & _os,
     this->pf->store(_os, _format);
     _os << this->createEndTag( "pf" ) << std::endl;     
     
-    _os << this->createStartTag( "precomputedA" ) << std::endl;
-    _os << "size: " << this->precomputedA.size() << std::endl;
-    std::map< uint, PrecomputedType >::const_iterator preCompIt = this->precomputedA.begin();
-    for ( uint i = 0; i < this->precomputedA.size(); i++ )
+    if ( _withData )
     {
-      _os << preCompIt->first << std::endl;
-      ( preCompIt->second ).store ( _os, _format );
-      preCompIt++;
-    }    
-    _os << this->createEndTag( "precomputedA" ) << std::endl;  
+      _os << this->createStartTag( "precomputedA" ) << std::endl;
+      _os << "size: " << this->precomputedA.size() << std::endl;
+      std::map< uint, PrecomputedType >::const_iterator preCompIt = this->precomputedA.begin();
+      for ( uint i = 0; i < this->precomputedA.size(); i++ )
+      {
+        _os << preCompIt->first << std::endl;
+        ( preCompIt->second ).store ( _os, _format );
+        preCompIt++;
+      }    
+      _os << this->createEndTag( "precomputedA" ) << std::endl;  
     
     
-    _os << this->createStartTag( "precomputedB" ) << std::endl;
-    _os << "size: " << this->precomputedB.size() << std::endl;
-    preCompIt = this->precomputedB.begin();
-    for ( uint i = 0; i < this->precomputedB.size(); i++ )
-    {
-      _os << preCompIt->first << std::endl;
-      ( preCompIt->second ).store ( _os, _format );
-      preCompIt++;
-    }    
-    _os << this->createEndTag( "precomputedB" ) << std::endl; 
+      _os << this->createStartTag( "precomputedB" ) << std::endl;
+      _os << "size: " << this->precomputedB.size() << std::endl;
+      preCompIt = this->precomputedB.begin();
+      for ( uint i = 0; i < this->precomputedB.size(); i++ )
+      {
+        _os << preCompIt->first << std::endl;
+        ( preCompIt->second ).store ( _os, _format );
+        preCompIt++;
+      }    
+      _os << this->createEndTag( "precomputedB" ) << std::endl; 
       
     
     
-    _os << this->createStartTag( "precomputedT" ) << std::endl;
-    _os << "size: " << this->precomputedT.size() << std::endl;
-    if ( this->precomputedT.size() > 0 )
-    {
-      int sizeOfLUT ( 0 );
-      if ( q != NULL )
-        sizeOfLUT = q->getNumberOfBins() * this->fmk->get_d();
-      _os << "SizeOfLUTs: " << sizeOfLUT << std::endl;      
-      for ( std::map< uint, double * >::const_iterator it = this->precomputedT.begin(); it != this->precomputedT.end(); it++ )
+      // a packed model keeps the LUTs in packed form only, the text format stores them per class
+      std::map< uint, double * > unpackedT;
+      if ( !this->packedT.empty() )
+        this->packedT.unpack ( unpackedT );
+      const std::map< uint, double * > & precomputedTToStore = this->packedT.empty() ? this->precomputedT : unpackedT;
+
+      _os << this->createStartTag( "precomputedT" ) << std::endl;
+      _os << "size: " << precomputedTToStore.size() << std::endl;
+      if ( precomputedTToStore.size() > 0 )
       {
-        _os << "index: " << it->first << std::endl;
-        for ( int i = 0; i < sizeOfLUT; i++ )
+        int sizeOfLUT ( 0 );
+        if ( q != NULL )
+          sizeOfLUT = q->getNumberOfBins() * this->fmk->get_d();
+        _os << "SizeOfLUTs: " << sizeOfLUT << std::endl;      
+        for ( std::map< uint, double * >::const_iterator it = precomputedTToStore.begin(); it != precomputedTToStore.end(); it++ )
         {
-          _os << ( it->second ) [i] << " ";
+          _os << "index: " << it->first << std::endl;
+          for ( int i = 0; i < sizeOfLUT; i++ )
+          {
+            _os << ( it->second ) [i] << " ";
+          }
+          _os << std::endl;
         }
-        _os << std::endl;
+      } 
+      _os << this->createEndTag( "precomputedT" ) << std::endl;
+
+      for ( std::map< uint, double * >::iterator it = unpackedT.begin(); it != unpackedT.end(); it++ )
+        delete [] it->second;
+    }
+
+    _os << this->createStartTag( "b_usePackedLUT" ) << std::endl;
+    _os << this->b_usePackedLUT << std::endl;
+    _os << this->createEndTag( "b_usePackedLUT" ) << std::endl;
+
+    _os << this->createStartTag( "lutPrecision" ) << std::endl;
+    _os << CompactLookupTable::precisionToString ( this->lutPrecision ) << std::endl;
+    _os << this->createEndTag( "lutPrecision" ) << std::endl;
+
+    // LUTs with reduced precision are written in their storage precision,
+    // binary models contain them as separate sections (see storeBinary)
+    if ( _format != BinaryModelFile::FORMAT_BINARY )
+    {
+      _os << this->createStartTag( "compactT" ) << std::endl;
+      _os << "size: " << this->compactT.size() << std::endl;
+      for ( std::map< uint, CompactLookupTable * >::const_iterator it = this->compactT.begin(); it != this->compactT.end(); it++ )
+      {
+        _os << "index: " << it->first << std::endl;
+        it->second->store ( _os, _format );
       }
-    } 
-    _os << this->createEndTag( "precomputedT" ) << std::endl;
+      _os << this->createEndTag( "compactT" ) << std::endl;
+    }
     
     
-    _os << this->createStartTag( "labels" ) << std::endl;
-    _os << this->labels << std::endl;
-    _os << this->createEndTag( "labels" ) << std::endl;  
+    if ( _withData )
+    {
+      _os << this->createStartTag( "labels" ) << std::endl;
+      _os << this->labels << std::endl;
+      _os << this->createEndTag( "labels" ) << std::endl;  
+    }
     
     //store the class numbers for binary settings (if mc-settings, these values will be negative by default)
     _os << this->createStartTag( "binaryLabelPositive" ) << std::endl;
@@ -2482,6 +3800,18 @@ void FMKGPHyperparameterOptimization::store ( std::ostream & _os,
     _os << this->downhillSimplexParamTol << std::endl;
     _os << this->createEndTag( "downhillSimplexParamTol" ) << std::endl;
     
+    _os << this->createStartTag( "gradientMaxIterations" ) << std::endl;
+    _os << this->gradientMaxIterations << std::endl;
+    _os << this->createEndTag( "gradientMaxIterations" ) << std::endl;
+    
+    _os << this->createStartTag( "gradientNumProbes" ) << std::endl;
+    _os << this->gradientNumProbes << std::endl;
+    _os << this->createEndTag( "gradientNumProbes" ) << std::endl;
+    
+    _os << this->createStartTag( "gradientSeed" ) << std::endl;
+    _os << this->gradientSeed << std::endl;
+    _os << this->createEndTag( "gradientSeed" ) << std::endl;
+    
     //////////////////////////////////////////////
     // likelihood computation related variables //
     //////////////////////////////////////////////     
@@ -2516,37 +3846,40 @@ void FMKGPHyperparameterOptimization::store ( std::ostream & _os,
     _os << this->nrOfEigenvaluesToConsiderForVarApprox << std::endl;
     _os << this->createEndTag( "nrOfEigenvaluesToConsiderForVarApprox" ) << std::endl;
     
-    _os << this->createStartTag( "precomputedAForVarEst" ) << std::endl;
-    _os << precomputedAForVarEst.size() << std::endl;
-    
-    if ( this->precomputedAForVarEst.size() > 0)
+    if ( _withData )
     {
-      this->precomputedAForVarEst.store ( _os, _format );
-      _os << std::endl; 
-    }
-    _os << this->createEndTag( "precomputedAForVarEst" ) << std::endl;
+      _os << this->createStartTag( "precomputedAForVarEst" ) << std::endl;
+      _os << precomputedAForVarEst.size() << std::endl;
     
+      if ( this->precomputedAForVarEst.size() > 0)
+      {
+        this->precomputedAForVarEst.store ( _os, _format );
+        _os << std::endl; 
+      }
+      _os << this->createEndTag( "precomputedAForVarEst" ) << std::endl;
     
-    _os << this->createStartTag( "precomputedTForVarEst" ) << std::endl;
-    if ( this->precomputedTForVarEst != NULL )
-    {
-      _os << "NOTNULL" << std::endl;
-      int sizeOfLUT ( 0 );
-      if ( q != NULL )
-        sizeOfLUT = q->getNumberOfBins() * this->fmk->get_d();
+    
+      _os << this->createStartTag( "precomputedTForVarEst" ) << std::endl;
+      if ( this->precomputedTForVarEst != NULL )
+      {
+        _os << "NOTNULL" << std::endl;
+        int sizeOfLUT ( 0 );
+        if ( q != NULL )
+          sizeOfLUT = q->getNumberOfBins() * this->fmk->get_d();
       
-      _os << sizeOfLUT << std::endl;
-      for ( int i = 0; i < sizeOfLUT; i++ )
+        _os << sizeOfLUT << std::endl;
+        for ( int i = 0; i < sizeOfLUT; i++ )
+        {
+          _os << this->precomputedTForVarEst[i] << " ";
+        }
+        _os << std::endl;
+      }
+      else
       {
-        _os << this->precomputedTForVarEst[i] << " ";
+        _os << "NULL" << std::endl;
       }
-      _os << std::endl;
-    }
-    else
-    {
-      _os << "NULL" << std::endl;
+      _os << this->createEndTag( "precomputedTForVarEst" ) << std::endl;    
     }
-    _os << this->createEndTag( "precomputedTForVarEst" ) << std::endl;    
     
     /////////////////////////////////////////////////////
     // online / incremental learning related variables //
@@ -2554,17 +3887,52 @@ void FMKGPHyperparameterOptimization::store ( std::ostream & _os,
     _os << this->createStartTag( "b_usePreviousAlphas" ) << std::endl;
     _os << this->b_usePreviousAlphas << std::endl;
     _os << this->createEndTag( "b_usePreviousAlphas" ) << std::endl;    
+
+    _os << this->createStartTag( "b_incrementalUpdate" ) << std::endl;
+    _os << this->b_incrementalUpdate << std::endl;
+    _os << this->createEndTag( "b_incrementalUpdate" ) << std::endl;
+
+    _os << this->createStartTag( "d_incrementalAlphaTolerance" ) << std::endl;
+    _os << this->d_incrementalAlphaTolerance << std::endl;
+    _os << this->createEndTag( "d_incrementalAlphaTolerance" ) << std::endl;
+
+    _os << this->createStartTag( "d_eigenDriftTolerance" ) << std::endl;
+    _os << this->d_eigenDriftTolerance << std::endl;
+    _os << this->createEndTag( "d_eigenDriftTolerance" ) << std::endl;
+
+    _os << this->createStartTag( "ui_maxNumExamples" ) << std::endl;
+    _os << this->ui_maxNumExamples << std::endl;
+    _os << this->createEndTag( "ui_maxNumExamples" ) << std::endl;
+
+    _os << this->createStartTag( "s_forgettingStrategy" ) << std::endl;
+    _os << this->s_forgettingStrategy << std::endl;
+    _os << this->createEndTag( "s_forgettingStrategy" ) << std::endl;
+
+    _os << this->createStartTag( "ui_numExamplesSeen" ) << std::endl;
+    _os << this->ui_numExamplesSeen << std::endl;
+    _os << this->createEndTag( "ui_numExamplesSeen" ) << std::endl;
+
+    _os << this->createStartTag( "ui_forgettingSeed" ) << std::endl;
+    _os << this->ui_forgettingSeed << std::endl;
+    _os << this->createEndTag( "ui_forgettingSeed" ) << std::endl;
+
+    _os << this->createStartTag( "ui_forgettingState" ) << std::endl;
+    _os << this->ui_forgettingState << std::endl;
+    _os << this->createEndTag( "ui_forgettingState" ) << std::endl;
     
-    _os << this->createStartTag( "previousAlphas" ) << std::endl;
-    _os << "size: " << this->previousAlphas.size() << std::endl;
-    std::map< uint, NICE::Vector >::const_iterator prevAlphaIt = this->previousAlphas.begin();
-    for ( uint i = 0; i < this->previousAlphas.size(); i++ )
+    if ( _withData )
     {
-      _os << prevAlphaIt->first << std::endl;
-      _os << prevAlphaIt->second << std::endl;
-      prevAlphaIt++;
+      _os << this->createStartTag( "previousAlphas" ) << std::endl;
+      _os << "size: " << this->previousAlphas.size() << std::endl;
+      std::map< uint, NICE::Vector >::const_iterator prevAlphaIt = this->previousAlphas.begin();
+      for ( uint i = 0; i < this->previousAlphas.size(); i++ )
+      {
+        _os << prevAlphaIt->first << std::endl;
+        _os << prevAlphaIt->second << std::endl;
+        prevAlphaIt++;
+      }
+      _os << this->createEndTag( "previousAlphas" ) << std::endl;
     }
-    _os << this->createEndTag( "previousAlphas" ) << std::endl;
 
     
     
@@ -2577,6 +3945,213 @@ void FMKGPHyperparameterOptimization::store ( std::ostream & _os,
   }
 }
 
+void FMKGPHyperparameterOptimization::storeBinary ( std::ostream & _os ) const
+{
+  if ( ! _os.good() )
+  {
+    std::cerr << "OutStream not initialized - storing not possible!" << std::endl;
+    return;
+  }
+
+  BinaryModelWriter writer;
+
+  // settings and small objects (quantization, transformation, noise model, ...) are kept as text
+  std::ostringstream settings;
+  settings.precision ( numeric_limits<double>::digits10 + 1 );
+  this->storeText ( settings, BinaryModelFile::FORMAT_BINARY, false );
+  writer.addString ( "settings", settings.str() );
+
+  this->fmk->storeBinary ( writer, "fmk." );
+
+  writer.addArray ( "labels", this->labels.getDataPointer(), this->labels.size() );
+
+  std::vector<uint> classesA;
+  for ( std::map< uint, PrecomputedType >::const_iterator it = this->precomputedA.begin(); it != this->precomputedA.end(); it++ )
+  {
+    classesA.push_back ( it->first );
+    storeVVectorBinary ( writer, classSectionName ( "A", it->first ), it->second );
+  }
+  writer.addArrayCopy ( "A.classes", classesA );
+
+  std::vector<uint> classesB;
+  for ( std::map< uint, PrecomputedType >::const_iterator it = this->precomputedB.begin(); it != this->precomputedB.end(); it++ )
+  {
+    classesB.push_back ( it->first );
+    storeVVectorBinary ( writer, classSectionName ( "B", it->first ), it->second );
+  }
+  writer.addArrayCopy ( "B.classes", classesB );
+
+  // LUTs are aligned within the model, such that they can be used in place after restoring
+  if ( ( this->q != NULL ) && ! this->precomputedT.empty() )
+  {
+    size_t sizeOfLUT = (size_t) this->q->getNumberOfBins() * this->fmk->get_d();
+    std::vector<uint> classesT;
+    for ( std::map< uint, double * >::const_iterator it = this->precomputedT.begin(); it != this->precomputedT.end(); it++ )
+    {
+      classesT.push_back ( it->first );
+      writer.addArray ( classSectionName ( "T", it->first ), it->second, sizeOfLUT );
+    }
+    writer.addArrayCopy ( "T.classes", classesT );
+  }
+
+  if ( ! this->packedT.empty() )
+  {
+    std::vector<uint> layout ( 3 );
+    layout[0] = this->packedT.getNumberOfDimensions();
+    layout[1] = this->packedT.getNumberOfBins();
+    layout[2] = this->packedT.getStride();
+    writer.addArrayCopy ( "packedT.layout", layout );
+    writer.addArrayCopy ( "packedT.classes", this->packedT.getClassNumbers() );
+    writer.addArray ( "packedT", this->packedT.getTable(), this->packedT.getTableSize() );
+  }
+
+  if ( ! this->compactT.empty() )
+  {
+    std::vector<uint> classesCompactT;
+    for ( std::map< uint, CompactLookupTable * >::const_iterator it = this->compactT.begin(); it != this->compactT.end(); it++ )
+    {
+      classesCompactT.push_back ( it->first );
+      it->second->storeBinary ( writer, classSectionName ( "compactT", it->first ) + "." );
+    }
+    writer.addArrayCopy ( "compactT.classes", classesCompactT );
+  }
+
+  if ( this->precomputedAForVarEst.size() > 0 )
+    storeVVectorBinary ( writer, "AForVarEst", this->precomputedAForVarEst );
+
+  if ( ( this->precomputedTForVarEst != NULL ) && ( this->q != NULL ) )
+    writer.addArray ( "TForVarEst", this->precomputedTForVarEst, (size_t) this->q->getNumberOfBins() * this->fmk->get_d() );
+
+  std::vector<uint> classesAlphas;
+  for ( std::map< uint, NICE::Vector >::const_iterator it = this->previousAlphas.begin(); it != this->previousAlphas.end(); it++ )
+  {
+    classesAlphas.push_back ( it->first );
+    writer.addArray ( classSectionName ( "previousAlphas", it->first ), it->second.getDataPointer(), it->second.size() );
+  }
+  writer.addArrayCopy ( "previousAlphas.classes", classesAlphas );
+
+  writer.write ( _os );
+}
+
+void FMKGPHyperparameterOptimization::restoreBinary ( BinaryModelReader * _reader )
+{
+  try
+  {
+    std::istringstream settings ( _reader->getString ( "settings" ) );
+    this->restoreText ( settings, BinaryModelFile::FORMAT_BINARY );
+  }
+  catch ( ... )
+  {
+    delete _reader;
+    throw;
+  }
+
+  // from now on, the LUTs refer to the memory of the model (see releaseModelFile)
+  this->modelFile = _reader;
+
+  if ( this->fmk != NULL )
+    delete this->fmk;
+  this->fmk = new FastMinKernel();
+  this->fmk->restoreBinary ( *_reader, "fmk." );
+  this->fmk->setNumberOfThreads ( this->ui_numThreads );
+
+  size_t count;
+  const double * labelValues = _reader->getArray<double> ( "labels", count );
+  this->labels.resize ( count );
+  std::copy ( labelValues, labelValues + count, this->labels.getDataPointer() );
+
+  std::vector<uint> classes;
+  _reader->getArrayCopy ( "A.classes", classes );
+  this->precomputedA.clear();
+  for ( std::vector<uint>::const_iterator it = classes.begin(); it != classes.end(); it++ )
+  {
+    PrecomputedType & A = this->precomputedA[ *it ];
+    restoreVVectorBinary ( *_reader, classSectionName ( "A", *it ), A );
+    A.setIoUntilEndOfFile ( false );
+  }
+
+  _reader->getArrayCopy ( "B.classes", classes );
+  this->precomputedB.clear();
+  for ( std::vector<uint>::const_iterator it = classes.begin(); it != classes.end(); it++ )
+  {
+    PrecomputedType & B = this->precomputedB[ *it ];
+    restoreVVectorBinary ( *_reader, classSectionName ( "B", *it ), B );
+    B.setIoUntilEndOfFile ( false );
+  }
+
+  if ( _reader->hasSection ( "T.classes" ) )
+  {
+    if ( this->q == NULL )
+      fthrow ( Exception, "FMKGPHyperparameterOptimization::restoreBinary: model contains LUTs, but no quantization" );
+
+    size_t sizeOfLUT = (size_t) this->q->getNumberOfBins() * this->fmk->get_d();
+    _reader->getArrayCopy ( "T.classes", classes );
+    for ( std::vector<uint>::const_iterator it = classes.begin(); it != classes.end(); it++ )
+    {
+      const double * T = _reader->getArray<double> ( classSectionName ( "T", *it ), count );
+      if ( count != sizeOfLUT )
+        fthrow ( Exception, "FMKGPHyperparameterOptimization::restoreBinary: size of the LUT of class " << *it << " (" << count << ") does not match " << sizeOfLUT );
+      // used in place and only read during classification
+      this->precomputedT.insert ( std::pair<uint, double *> ( *it, const_cast<double *> ( T ) ) );
+    }
+  }
+
+  if ( _reader->hasSection ( "packedT" ) )
+  {
+    const uint * layout = _reader->getArray<uint> ( "packedT.layout", count );
+    if ( count != 3 )
+      fthrow ( Exception, "FMKGPHyperparameterOptimization::restoreBinary: invalid layout of the packed LUTs" );
+    _reader->getArrayCopy ( "packedT.classes", classes );
+    const double * table = _reader->getArray<double> ( "packedT", count );
+    if ( count != (size_t) layout[0] * layout[1] * layout[2] )
+      fthrow ( Exception, "FMKGPHyperparameterOptimization::restoreBinary: size of the packed LUTs (" << count << ") does not match their layout" );
+    this->packedT.setExternal ( table, layout[0], layout[1], layout[2], classes );
+  }
+
+  if ( _reader->hasSection ( "compactT.classes" ) )
+  {
+    for ( std::map< uint, CompactLookupTable * >::iterator itT = this->compactT.begin(); itT != this->compactT.end(); itT++ )
+      delete itT->second;
+    this->compactT.clear();
+
+    _reader->getArrayCopy ( "compactT.classes", classes );
+    for ( std::vector<uint>::const_iterator it = classes.begin(); it != classes.end(); it++ )
+    {
+      CompactLookupTable * table = new CompactLookupTable();
+      this->compactT.insert ( std::pair<uint, CompactLookupTable *> ( *it, table ) );
+      table->restoreBinary ( *_reader, classSectionName ( "compactT", *it ) + "." );
+    }
+  }
+
+  if ( _reader->hasSection ( "AForVarEst" ) )
+  {
+    restoreVVectorBinary ( *_reader, "AForVarEst", this->precomputedAForVarEst );
+    this->precomputedAForVarEst.setIoUntilEndOfFile ( false );
+  }
+
+  if ( _reader->hasSection ( "TForVarEst" ) )
+  {
+    // modified by the variance approximation, hence copied
+    const double * T = _reader->getArray<double> ( "TForVarEst", count );
+    if ( this->precomputedTForVarEst != NULL )
+      delete this->precomputedTForVarEst;
+    this->precomputedTForVarEst = new double [ count ];
+    std::copy ( T, T + count, this->precomputedTForVarEst );
+  }
+
+  _reader->getArrayCopy ( "previousAlphas.classes", classes );
+  this->previousAlphas.clear();
+  for ( std::vector<uint>::const_iterator it = classes.begin(); it != classes.end(); it++ )
+  {
+    const double * alpha = _reader->getArray<double> ( classSectionName ( "previousAlphas", *it ), count );
+    NICE::Vector & classAlpha = this->previousAlphas[ *it ];
+    classAlpha.resize ( count );
+    std::copy ( alpha, alpha + count, classAlpha.getDataPointer() );
+  }
+
+  this->finishRestore();
+}
+
 void FMKGPHyperparameterOptimization::clear ( ) {};
 
 ///////////////////// INTERFACE ONLINE LEARNABLE /////////////////////
@@ -2615,7 +4190,13 @@ void FMKGPHyperparameterOptimization::addExample( const NICE::SparseVector * exa
   // It is necessary to do this already here and not lateron for internal reasons (see GMHIKernel for more details)
   NICE::Timer tFmk;
   tFmk.start();
+  // the incremental update of the LUTs accesses single examples, which is O(nnz_i) with the example mirror
+  // (computed once, afterwards appended to by the feature matrix)
+  if ( this->b_incrementalUpdate && ( this->q != NULL ) && !this->fmk->featureMatrix().getKeepExampleMirror() )
+    this->fmk->featureMatrix().setKeepExampleMirror ( true );
   this->fmk->addExample ( example, pf );
+  if ( this->q != NULL )
+    this->fmk->prepareBinIndices ( this->q );
   tFmk.stop();
   if ( this->b_verboseTime)
     std::cerr << "Time used for adding the data to the fmk object: " << tFmk.getLast() << std::endl;
@@ -2623,6 +4204,12 @@ void FMKGPHyperparameterOptimization::addExample( const NICE::SparseVector * exa
   
   // add examples to all implicite kernel matrices we currently use
   this->ikmsum->addExample ( example, label, performOptimizationAfterIncrement );
+
+  // keep at most ui_maxNumExamples examples
+  std::vector< uint > forgottenExamples;
+  this->selectExamplesToForget ( 1, forgottenExamples );
+  if ( !forgottenExamples.empty() )
+    this->removeExamplesWithoutUpdate ( forgottenExamples, newClasses );
   
   
   // update the corresponding matrices A, B and lookup tables T  
@@ -2702,13 +4289,25 @@ void FMKGPHyperparameterOptimization::addMultipleExamples( const std::vector< co
   // It is necessary to do this already here and not lateron for internal reasons (see GMHIKernel for more details)
   NICE::Timer tFmk;
   tFmk.start();
+  // the incremental update of the LUTs accesses single examples, which is O(nnz_i) with the example mirror
+  // (computed once, afterwards appended to by the feature matrix)
+  if ( this->b_incrementalUpdate && ( this->q != NULL ) && !this->fmk->featureMatrix().getKeepExampleMirror() )
+    this->fmk->featureMatrix().setKeepExampleMirror ( true );
   this->fmk->addMultipleExamples ( newExamples, pf );
+  if ( this->q != NULL )
+    this->fmk->prepareBinIndices ( this->q );
   tFmk.stop();
   if ( this->b_verboseTime)
     std::cerr << "Time used for adding the data to the fmk object: " << tFmk.getLast() << std::endl;
   
   // add examples to all implicite kernel matrices we currently use
   this->ikmsum->addMultipleExamples ( newExamples, newLabels, performOptimizationAfterIncrement );
+
+  // keep at most ui_maxNumExamples examples
+  std::vector< uint > forgottenExamples;
+  this->selectExamplesToForget ( newExamples.size(), forgottenExamples );
+  if ( !forgottenExamples.empty() )
+    this->removeExamplesWithoutUpdate ( forgottenExamples, newClasses );
   
   // update the corresponding matrices A, B and lookup tables T  
   // optional: do the optimization again using the previously known solutions as initialization
@@ -2732,3 +4331,42 @@ void FMKGPHyperparameterOptimization::addMultipleExamples( const std::vector< co
   if ( this->b_verbose )
     std::cerr << " --- FMKGPHyperparameterOptimization::addMultipleExamples done --- " << std::endl;    
 }
+
+void FMKGPHyperparameterOptimization::removeExample( const uint & exampleIndex,
+                                                     const bool & performOptimizationAfterDecrement
+                                                   )
+{
+  this->removeMultipleExamples ( std::vector< uint > ( 1, exampleIndex ), performOptimizationAfterDecrement );
+}
+
+void FMKGPHyperparameterOptimization::removeMultipleExamples( const std::vector< uint > & exampleIndices,
+                                                              const bool & performOptimizationAfterDecrement
+                                                            )
+{
+  if ( this->b_verbose )
+    std::cerr << " --- FMKGPHyperparameterOptimization::removeMultipleExamples --- " << std::endl;
+
+  if ( exampleIndices.empty() )
+    return;
+
+  if ( ( this->fmk == NULL ) || ( this->ikmsum == NULL ) )
+    fthrow ( Exception, "FMKGPHyperparameterOptimization: examples can only be removed after training" );
+
+  NICE::Timer t;
+  t.start();
+
+  // remove the examples from all data structures, the previous alphas of the remaining examples are kept for warm-starting
+  std::set< uint > newClasses;
+  this->removeExamplesWithoutUpdate ( exampleIndices, newClasses );
+
+  // update the corresponding matrices A, B and lookup tables T
+  // optional: do the optimization again using the previously known solutions as initialization
+  this->updateAfterIncrement ( newClasses, performOptimizationAfterDecrement );
+
+  t.stop();
+  if ( this->b_verboseTime )
+    std::cerr << "Time used for removing examples: " << t.getLast() << std::endl;
+
+  if ( this->b_verbose )
+    std::cerr << " --- FMKGPHyperparameterOptimization::removeMultipleExamples done --- " << std::endl;
+}
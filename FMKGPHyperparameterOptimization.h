@@ -24,12 +24,18 @@
 #endif
 
 // gp-hik-core includes
+#include "gp-hik-core/BinaryModelFile.h"
 #include "gp-hik-core/FastMinKernel.h"
 #include "gp-hik-core/GPLikelihoodApprox.h"
 #include "gp-hik-core/IKMLinearCombination.h"
 #include "gp-hik-core/OnlineLearnable.h"
+#include "gp-hik-core/algebra/EVSubspaceIteration.h"
+#include "gp-hik-core/algebra/ILSBlockConjugateGradients.h"
+#include "gp-hik-core/algebra/LogDetApproxStochasticLanczos.h"
 
 #include "gp-hik-core/quantization/Quantization.h"
+#include "gp-hik-core/quantization/PackedLookupTables.h"
+#include "gp-hik-core/quantization/CompactLookupTable.h"
 #include "gp-hik-core/parameterizedFunctions/ParameterizedFunction.h"
 
 namespace NICE {
@@ -61,6 +67,13 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     /** debug flag for several outputs useful for debugging*/
     bool b_debug;    
     
+    //////////////////////////////////////
+    // parallelization related settings //
+    //////////////////////////////////////
+    
+    /** number of threads used for loops over dimensions in the FastMinKernel (0 = all available cores, 1 = sequential) */
+    uint ui_numThreads;
+    
     //////////////////////////////////////
     // classification related variables //
     //////////////////////////////////////
@@ -97,6 +110,21 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     
     /** precomputed LUTs (1 per class) needed for classification with quantization  */
     std::map< uint, double * > precomputedT;  
+
+    /** use packed LUTs with layout [dim][bin][class] for classification with quantization */
+    bool b_usePackedLUT;
+
+    /** LUTs of all classes packed into a single array, only filled if b_usePackedLUT is set and replaces precomputedT then */
+    PackedLookupTables packedT;
+
+    /** storage precision of the LUTs used for classification with quantization */
+    CompactLookupTable::Precision lutPrecision;
+
+    /** LUTs (1 per class) with reduced precision, replace precomputedT if lutPrecision is not double */
+    std::map< uint, CompactLookupTable * > compactT;
+
+    /** binary model restored last, precomputedT and packedT refer to its memory (NULL if the LUTs are owned) */
+    BinaryModelReader * modelFile;
     
     //! storing the labels is needed for Incremental Learning (re-optimization)
     NICE::Vector labels; 
@@ -119,6 +147,9 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     /** method for solving linear equation systems - needed to compute K^-1 \times y */
     IterativeLinearSolver *linsolver;    
     
+    /** optional method for solving the linear equation systems of all classes at once (NULL if not used) */
+    ILSBlockConjugateGradients *blockLinsolver;
+    
     /** Max. number of iterations the iterative linear solver is allowed to run */
     int ils_max_iterations;    
   
@@ -129,7 +160,8 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     enum OPTIMIZATIONTECHNIQUE{
       OPT_GREEDY = 0,
       OPT_DOWNHILLSIMPLEX,
-      OPT_NONE
+      OPT_NONE,
+      OPT_GRADIENT
     };
 
     /** specify the optimization method used (see corresponding enum) */
@@ -141,6 +173,12 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
         // specific to greedy optimization
     /** step size used in grid based greedy optimization technique */
     double parameterStepSize;
+
+    /** evaluate the grid points of the greedy optimization concurrently (ui_numThreads workers, each with its own copy of the features unless b_lazyTransform is set) */
+    bool b_parallelGridSearch;
+
+    /** transform the features on the fly during the optimization instead of rewriting them for every parameter (see GMHIKernel::setLazyTransform) */
+    bool b_lazyTransform;
     
      
     
@@ -153,6 +191,16 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     
     /** Max. number of iterations the iterative linear solver is allowed to run */
     double downhillSimplexParamTol;
+
+        // specific to gradient-based optimization
+    /** Max. number of iterations of the bounded L-BFGS optimizer */
+    int gradientMaxIterations;
+
+    /** number of probe vectors for estimating the trace term of the gradient */
+    int gradientNumProbes;
+
+    /** seed of the random number generator used for the probe vectors */
+    int gradientSeed;
     
     
     //////////////////////////////////////////////
@@ -164,9 +212,15 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
 
     /** method computing eigenvalues and eigenvectors*/
     NICE::EigValues *eig;
+
+    /** optional warm-started eigenvalue method for successive likelihood evaluations, whose Ritz vectors also deflate the block solver (NULL if not used) */
+    NICE::EVSubspaceIteration *subspaceIteration;
     
     /** number of Eigenvalues to consider in the approximation of |K|_F used for approximating the likelihood */
     int nrOfEigenvaluesToConsider;
+
+    /** optional stochastic Lanczos estimate of logdet(K + sigma^2 I) used for the likelihood (NULL: upper bound of Bai and Golub) */
+    NICE::LogDetApproxStochasticLanczos *logDetApprox;
     
     //! k largest eigenvalues of the kernel matrix (k == nrOfEigenvaluesToConsider)
     NICE::Vector eigenMax;
@@ -187,6 +241,18 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     
     /** precomputed LUT needed for rough variance approximation with quantization  */
     double * precomputedTForVarEst;    
+
+    /** precomputed arrays A for the projections onto the eigenvectors (fine approximation only, one entry per eigenvector except the last one considered) */
+    std::vector< PrecomputedType > precomputedAForVarEstFine;
+
+    /** precomputed arrays B for the projections onto the eigenvectors (see precomputedAForVarEstFine) */
+    std::vector< PrecomputedType > precomputedBForVarEstFine;
+
+    /** precomputed LUTs for the projections onto the eigenvectors with quantization (see precomputedAForVarEstFine) */
+    std::vector< double * > precomputedTForVarEstFine;
+
+    /** number of test examples whose kernel vectors are computed together in the batch version of the fine variance approximation */
+    uint ui_varianceBlockSize;
     
     /////////////////////////////////////////////////////
     // online / incremental learning related variables //
@@ -198,6 +264,33 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     //! store alpha vectors for good initializations in the IL setting, if activated
     std::map<uint, NICE::Vector> previousAlphas;     
 
+    /** update A, B, and T with the changes of alpha after adding examples instead of computing them from scratch, and refresh the eigen decomposition only if it drifted */
+    bool b_incrementalUpdate;
+
+    /** changes of alpha smaller than this value times max |alpha| are deferred to later increments (incremental update only) */
+    double d_incrementalAlphaTolerance;
+
+    /** the eigen decomposition is re-computed if the relative residual ||K v - lambda v|| / lambda of an extended eigenvector exceeds this value (incremental update only) */
+    double d_eigenDriftTolerance;
+
+    //! alpha vectors currently represented by A, B, and T (incremental update only)
+    std::map<uint, NICE::Vector> lutAlphas;
+
+    /** maximum number of training examples kept when adding examples online (0: unbounded), see s_forgettingStrategy */
+    uint ui_maxNumExamples;
+
+    /** examples forgotten if ui_maxNumExamples is exceeded: "sliding_window" (the oldest ones) or "reservoir" (reservoir sampling, all examples seen so far are kept with equal probability) */
+    std::string s_forgettingStrategy;
+
+    /** number of training examples seen so far, including forgotten ones (needed for reservoir sampling) */
+    uint ui_numExamplesSeen;
+
+    /** seed of the random number generator used for reservoir sampling */
+    uint ui_forgettingSeed;
+
+    /** current state of this random number generator, see drawForgettingIndex */
+    unsigned int ui_forgettingState;
+
     
     /////////////////////////
     /////////////////////////
@@ -238,6 +331,18 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
                                      const uint & parameterVectorSize
                                    );
     
+    /**
+    * @brief evaluate the likelihood of all grid points concurrently, the best solution is merged into _gplike
+    *
+    * @return false if the current setting can not be evaluated concurrently (e.g., unsupported solvers), nothing was done in this case
+    */
+    bool performParallelGridSearch( GPLikelihoodApprox & _gplike,
+                                    const std::vector<double> & _grid
+                                  );
+
+    /** switch the lazy transformation of all GMHIKernel objects in ikmsum on or off */
+    void setLazyTransformOfKernels( const bool & _lazyTransform );
+    
     /**
     * @brief apply the optimized transformation values to the underlying features
     * @author Alexander Freytag
@@ -251,7 +356,27 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     * @author Alexander Freytag
     */
     inline void computeMatricesAndLUTs( const GPLikelihoodApprox & _gplike);
-    
+
+    /**
+    * @brief derived structures shared by the full and the incremental computation of A, B, and T
+    * (packed and compact LUTs, variance approximation, previous alphas)
+    */
+    void finishMatricesAndLUTs ( const GPLikelihoodApprox & _gplike );
+
+    /**
+    * @brief update A, B, and T with the changes of the alpha vectors after examples were added (see b_incrementalUpdate)
+    *
+    * @return false if the matrices can not be updated or a computation from scratch is cheaper, nothing was changed in this case
+    */
+    bool updateMatricesAndLUTs ( const GPLikelihoodApprox & _gplike );
+
+    /**
+    * @brief re-compute the eigen decomposition only if the previous eigenvectors, extended by zeros for the
+    * new examples, do not approximate the eigenvectors of the current kernel matrix anymore (see d_eigenDriftTolerance)
+    *
+    * @return true if the eigen decomposition was re-computed
+    */
+    bool updateEigenDecompositionIfDrifted ( const int & _noEigenValues );
      
 
     /**
@@ -262,6 +387,94 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
       const std::set<uint> _newClasses,
       const bool & _performOptimizationAfterIncrement = false
     );    
+
+    /**
+    * @brief remove examples from labels, previous alphas, fmk, and ikmsum without re-computing the model (see updateAfterIncrement).
+    * Classes without remaining examples are removed. If the set of binary problems changes, the previous alphas are
+    * reduced to the remaining problems and problems without previous alphas are added to _newClasses.
+    *
+    * @param _indices indices of the examples to remove (in the order of insertion)
+    * @param _newClasses classes whose alpha vectors are initialized from scratch
+    */
+    void removeExamplesWithoutUpdate ( const std::vector<uint> & _indices,
+                                       std::set<uint> & _newClasses
+                                     );
+
+    /**
+    * @brief select the examples to forget after _numNewExamples examples were appended, such that at most
+    * ui_maxNumExamples examples are kept (see s_forgettingStrategy)
+    */
+    void selectExamplesToForget ( const uint & _numNewExamples,
+                                  std::vector<uint> & _indices
+                                );
+
+    /**
+    * @brief random index in [0, _range) for reservoir sampling, drawn by an own linear congruential generator
+    * (see LogDetApproxStochasticLanczos), such that the forgotten examples neither depend on nor change the
+    * state of the global random number generator
+    */
+    uint drawForgettingIndex ( const uint & _range );
+
+    /**
+    * @brief fine approximation of the predictive variance for the examples _begin, ..., _end-1 (see computePredictiveVarianceApproximateFine),
+    * the results are stored in the corresponding entries of _predVariances
+    */
+    void computePredictiveVarianceApproximateFineForBlock ( const std::vector< const NICE::SparseVector * > & _x,
+                                                            const uint & _begin,
+                                                            const uint & _end,
+                                                            NICE::Vector & _predVariances
+                                                          ) const;
+
+    /** release the tables for the projections onto the eigenvectors, needed whenever the eigenvectors change */
+    void clearVarianceApproximationFineTables ();
+
+    /** check whether the tables for the projections onto the eigenvectors are available for the current number of eigenvalues */
+    bool hasVarianceApproximationFineTables () const;
+
+    /**
+    * @brief projections v_j^T k_* of the kernel vector of _x onto the first nrOfEigenvaluesToConsiderForVarApprox-1 eigenvectors,
+    * computed like classification scores with the tables of prepareVarianceApproximationFine
+    */
+    void projectOntoEigenVectors ( const NICE::SparseVector & _x,
+                                   NICE::Vector & _projections
+                                 ) const;
+
+    /** dense version of projectOntoEigenVectors */
+    void projectOntoEigenVectors ( const NICE::Vector & _x,
+                                   NICE::Vector & _projections
+                                 ) const;
+
+    /** forget the binary model the LUTs refer to (see restoreBinary), the LUTs are discarded as well */
+    void releaseModelFile ( );
+
+    /**
+    * @brief store as text
+    * @param _withData if false, the training data and all precomputed arrays and LUTs are skipped (see storeBinary)
+    */
+    void storeText ( std::ostream & _os,
+                     int _format,
+                     const bool & _withData
+                   ) const;
+
+    /** parse the tagged text blocks written by storeText (missing blocks are left untouched) */
+    void restoreText ( std::istream & _is,
+                       int _format
+                     );
+
+    /** set up everything which is derived from the restored data (kernel matrices, bin indices, packed LUTs, known classes) */
+    void finishRestore ( );
+
+    /**
+    * @brief store as binary model: the settings are written as text section, the training data,
+    * the arrays A and B, and the LUTs are written as contiguous binary sections
+    */
+    void storeBinary ( std::ostream & _os ) const;
+
+    /**
+    * @brief restore from a binary model, the LUTs are used in place (i.e., without copying them)
+    * @param _reader binary model, ownership is taken over
+    */
+    void restoreBinary ( BinaryModelReader * _reader );
   
 
     
@@ -423,6 +636,8 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     
     /**
     * @brief Compute the necessary variables for fine appxorimations of predictive variance (EVs), assuming an already initialized fmk object
+    * Additionally, the tables A, B (and T with quantization) of the eigenvectors are computed, such that the projections
+    * of a kernel vector onto the eigenvectors can be computed like classification scores.
     * @author Alexander Freytag
     * @date 11-04-2012 (dd-mm-yyyy)
     */       
@@ -495,6 +710,18 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     void computePredictiveVarianceApproximateFine(const NICE::SparseVector & _x, 
                                                   double & _predVariance 
                                                  ) const; 
+
+    /**
+    * @brief compute the fine approximation of the predictive variance for several test examples at once.
+    * The kernel vectors of variance_block_size examples are computed together (see FastMinKernel::hikComputeKernelVectors),
+    * such that the projections onto the eigenvectors become a single matrix product per block (or lookups in the tables of prepareVarianceApproximationFine, if available).
+    * Blocks are distributed among num_threads threads.
+    * @param _x input examples
+    * @param _predVariances contains the approximation of the predictive variance for every example
+    */
+    void computePredictiveVarianceApproximateFine(const std::vector< const NICE::SparseVector * > & _x, 
+                                                  NICE::Vector & _predVariances 
+                                                 ) const; 
     
     /**
     * @brief compute exact predictive variance for a given test example using ILS methods (exact, but more time consuming than approx versions)
@@ -572,10 +799,22 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
     /** 
      * @brief Save current object to external file (stream)
      * @author Alexander Freytag
+     * @param _format BinaryModelFile::FORMAT_TEXT (tagged text) or BinaryModelFile::FORMAT_BINARY (binary model)
      */      
     void store ( std::ostream & _os,
                  int _format = 0 
                ) const;
+
+    /**
+    * @brief Restore a binary model by mapping the file into memory (read-only). The LUTs are used in place
+    * for classification, i.e., restoring does not depend on the size of the LUTs.
+    *
+    * @param _is stream reading _filename, positioned in front of the binary model, the stream is left behind the model
+    * @param _filename file containing the binary model written by store with BinaryModelFile::FORMAT_BINARY
+    */
+    void restoreMapped ( std::istream & _is,
+                         const std::string & _filename
+                       );
     
     /** 
      * @brief Clear current object
@@ -604,6 +843,21 @@ class FMKGPHyperparameterOptimization : public NICE::Persistent, public NICE::On
                                       const NICE::Vector & _newLabels,
                                       const bool & _performOptimizationAfterIncrement = true
                                     );         
+
+    /** 
+     * @brief remove a single example, see removeMultipleExamples
+     */
+    virtual void removeExample( const uint & _exampleIndex,
+                                const bool & _performOptimizationAfterDecrement = true
+                              );
+
+    /** 
+     * @brief remove several examples and update the model, warm-started with the previous alphas of the remaining examples
+     * (if b_usePreviousAlphas is set). The remaining examples keep their order and are numbered consecutively afterwards.
+     */
+    virtual void removeMultipleExamples( const std::vector< uint > & _exampleIndices,
+                                         const bool & _performOptimizationAfterDecrement = true
+                                       );
 };
 
 }
@@ -6,7 +6,14 @@
 */
 
 // STL includes
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <sstream>
+
+#ifdef NICE_USELIB_OPENMP
+#include <omp.h>
+#endif
 
 // NICE-core includes
 #include <core/basics/vectorio.h>
@@ -20,6 +27,284 @@ using namespace NICE;
 
 /* protected methods*/
 
+/**
+* @brief transformed values of all non-zero elements of a sparse example (in the order of its iterator), computed with a single call of _pf
+*/
+static void transformExample ( const ParameterizedFunction * _pf,
+                               const NICE::SparseVector & _x,
+                               std::vector<double> & _transformed
+                             )
+{
+  std::vector<uint> dims;
+  std::vector<double> values;
+  dims.reserve ( _x.size() );
+  values.reserve ( _x.size() );
+  for ( NICE::SparseVector::const_iterator i = _x.begin(); i != _x.end(); i++ )
+  {
+    dims.push_back ( i->first );
+    values.push_back ( i->second );
+  }
+
+  _transformed.resize ( values.size() );
+  if ( !values.empty() )
+    _pf->fPerDimension ( &(dims[0]), &(values[0]), &(_transformed[0]), values.size() );
+}
+
+/**
+* @brief transformed values of all dimensions of a dense example, computed with a single call of _pf
+*/
+static void transformExample ( const ParameterizedFunction * _pf,
+                               const NICE::Vector & _x,
+                               std::vector<double> & _transformed
+                             )
+{
+  _transformed.resize ( _x.size() );
+  if ( _x.size() > 0 )
+    _pf->fPerDimension ( NULL, _x.getDataPointer(), &(_transformed[0]), _x.size() );
+}
+
+/**
+* @brief add the contribution of a single dimension to the gradient of the bilinear forms, see FastMinKernel::hikBilinearFormGradient
+*
+* @param _URows, _VRows example-wise storage of the m columns of U and V
+* @param _weightedSums buffer, overwritten with sum_c w_c (u_jc V_c(>=j) + v_jc U_c(>j)) for every sorted position j
+* @param _suffixSums buffer for the suffix sums of all columns
+* @return false if _pf does not provide analytic derivatives
+*/
+static bool addBilinearFormGradientDimension ( const SortedVectorSparse<double>::elementcontainer & _nonzeroElements,
+                                               const uint & _dim,
+                                               const uint & _m,
+                                               const double * _URows,
+                                               const double * _VRows,
+                                               const double * _weights,
+                                               const ParameterizedFunction * _pf,
+                                               std::vector<double> & _weightedSums,
+                                               std::vector<double> & _suffixSums,
+                                               std::vector<uint> & _parameterIndices,
+                                               std::vector<double> & _derivatives,
+                                               double * _gradient
+                                             )
+{
+  uint nnz = _nonzeroElements.size();
+  if ( nnz == 0 )
+    return true;
+
+  if ( !_pf->parameterDerivatives ( _dim, _nonzeroElements.getValues(), nnz, _parameterIndices, _derivatives ) )
+    return false;
+
+  // dimension is not influenced by any parameter
+  if ( _parameterIndices.empty() )
+    return true;
+
+  const uint * indices = _nonzeroElements.getIndices();
+
+  // every pair of examples contributes at the sorted position of its smaller value
+  // (zero elements do not contribute at all, since the derivative of f(0) = 0 vanishes)
+  _suffixSums.assign ( 2*_m, 0.0 );
+  double * uSuffix = &(_suffixSums[0]);
+  double * vSuffix = uSuffix + _m;
+  _weightedSums.resize ( nnz );
+  for ( int j = nnz - 1; j >= 0; j-- )
+  {
+    const double * u = _URows + indices[j]*_m;
+    const double * v = _VRows + indices[j]*_m;
+    double sum ( 0.0 );
+    for ( uint c = 0; c < _m; c++ )
+    {
+      vSuffix[c] += v[c];
+      sum += _weights[c] * ( u[c] * vSuffix[c] + v[c] * uSuffix[c] );
+      uSuffix[c] += u[c];
+    }
+    _weightedSums[j] = sum;
+  }
+
+  for ( uint k = 0; k < _parameterIndices.size(); k++ )
+  {
+    const double * derivatives = &(_derivatives[k*nnz]);
+    double sum ( 0.0 );
+    for ( uint j = 0; j < nnz; j++ )
+      sum += derivatives[j] * _weightedSums[j];
+    _gradient[ _parameterIndices[k] ] += sum;
+  }
+  return true;
+}
+
+int FastMinKernel::getEffectiveNumberOfThreads ( ) const
+{
+#ifdef NICE_USELIB_OPENMP
+  // called from within a parallel region (e.g., one thread per class), stay sequential
+  if ( omp_in_parallel() )
+    return 1;
+  if ( this->ui_numThreads == 0 )
+    return omp_get_max_threads();
+#endif
+  return std::max<int> ( 1, this->ui_numThreads );
+}
+
+uint FastMinKernel::getNumberOfDimensionsPerChunk ( ) const
+{
+  // every chunk covers about 4*n non-zero elements, such that adding its partial result (O(n))
+  // is cheap compared to its computation
+  double nnz ( 0.0 );
+  for ( uint dim = 0; dim < this->ui_d; dim++ )
+    nnz += this->X_sorted.getNumberOfNonZeroElementsPerDimension ( dim );
+
+  double dimsPerChunk ( this->ui_d );
+  if ( nnz > 0.0 )
+    dimsPerChunk = ceil ( 4.0 * this->ui_n * this->ui_d / nnz );
+
+  return (uint) std::max<double> ( 1.0, std::min<double> ( dimsPerChunk, this->ui_d ) );
+}
+
+void FastMinKernel::hik_kernel_multiply_dimension ( const uint & _dim,
+                                                    const NICE::VVector & _A,
+                                                    const NICE::VVector & _B,
+                                                    NICE::Vector & _beta,
+                                                    const ParameterizedFunction *_transformView,
+                                                    std::vector<double> & _transformedBuffer
+                                                  ) const
+{
+  // -- efficient sparse solution
+  const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(_dim).nonzeroElements();
+  uint nrZeroIndices = this->X_sorted.getNumberOfZeroElementsPerDimension(_dim);
+
+  if ( nrZeroIndices == this->ui_n ) {
+    // all values are zero in this dimension :) and we can simply ignore the feature
+    return;
+  }
+
+  // sum_{u \in U_k} alpha_u for all elements of this dimension
+  double alphaSumDim ( _B[_dim][this->ui_n-1-nrZeroIndices] );
+
+  const uint * indices        = nonzeroElements.getIndices();
+  const double * transformed  = this->X_sorted.getTransformedValues ( _dim, _transformView, _transformedBuffer );
+  const NICE::Vector & A = _A[_dim];
+  const NICE::Vector & B = _B[_dim];
+
+  for ( uint inversePosition = 0; inversePosition < nonzeroElements.size(); inversePosition++ )
+  {
+    // in which position was the element sorted in? actually we only care about the nonzero elements, so we have to subtract the number of zero elements.
+    //NOTE pay attention: this is only valid if all entries are positiv! - if not, ask wether the current feature is greater than zero. If so, subtract the nrZeroIndices, if not do not
+
+    // sum_{l \in L_k} \alpha_l x^l_k
+    //
+    // A is zero for zero feature values (x^l_k is zero for all l \in L_k)
+    double firstPart( A[inversePosition] );
+    // sum_{u \in U_k} alpha_u
+    // B is not zero for zero feature values, but we do not
+    // have to care about them, because it is multiplied with
+    // the feature value
+    double secondPart( alphaSumDim - B[inversePosition] );
+
+    _beta[ indices[inversePosition] ] += firstPart + transformed[inversePosition] * secondPart;
+  }
+}
+
+void FastMinKernel::hik_kernel_multiply_fast_dimension ( const uint & _dim,
+                                                         const double *_Tlookup,
+                                                         const Quantization * _q,
+                                                         NICE::Vector & _beta
+                                                       ) const
+{
+  // -- efficient sparse solution
+  const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(_dim).nonzeroElements();
+
+  const double * values              = nonzeroElements.getValues();
+  const uint * indices               = nonzeroElements.getIndices();
+  const double * TlookupDim          = _Tlookup + _dim*_q->getNumberOfBins();
+  uint nnz                           = nonzeroElements.size();
+
+  if ( nnz == 0 )
+    return;
+
+  // with cached bin indices, this is a pure gather from the LUT
+  if ( this->hasBinIndices ( _q ) && !this->binIndices8.empty() )
+  {
+    const unsigned char * bins = &(this->binIndices8[_dim][0]);
+    for ( uint cnt = 0; cnt < nnz; cnt++ )
+      _beta[ indices[cnt] ] += TlookupDim[ bins[cnt] ];
+  }
+  else if ( this->hasBinIndices ( _q ) )
+  {
+    const unsigned short * bins = &(this->binIndices16[_dim][0]);
+    for ( uint cnt = 0; cnt < nnz; cnt++ )
+      _beta[ indices[cnt] ] += TlookupDim[ bins[cnt] ];
+  }
+  else
+  {
+    std::vector<uint> bins ( nnz );
+    _q->quantize( values, _dim, &(bins[0]), nnz );
+    for ( uint cnt = 0; cnt < nnz; cnt++ )
+      _beta[ indices[cnt] ] += TlookupDim[ bins[cnt] ];
+  }
+}
+
+
+void FastMinKernel::hik_kernel_multiply_block_dimension ( const uint & _dim,
+                                                          const uint & _m,
+                                                          const double * _alphaRows,
+                                                          double * _betaRows,
+                                                          std::vector<double> & _partialSums,
+                                                          const ParameterizedFunction *_transformView,
+                                                          std::vector<double> & _transformedBuffer
+                                                        ) const
+{
+  const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(_dim).nonzeroElements();
+  uint nnz = nonzeroElements.size();
+
+  if ( nnz == 0 )
+    return;
+
+  const uint * indices       = nonzeroElements.getIndices();
+  const double * transformed = this->X_sorted.getTransformedValues ( _dim, _transformView, _transformedBuffer );
+
+  // layout of the buffer: A (nnz x m) followed by B (nnz x m)
+  if ( _partialSums.size() < 2*nnz*_m )
+    _partialSums.resize ( 2*nnz*_m );
+  double * A = &(_partialSums[0]);
+  double * B = A + nnz*_m;
+
+  // first pass: partial sums a_{k,j} and b_{k,j} (see hik_prepare_alpha_multiplications) for all m columns
+  double * itA = A;
+  double * itB = B;
+  for ( uint j = 0; j < nnz; j++, itA += _m, itB += _m )
+  {
+    const double * alpha = _alphaRows + indices[j]*_m;
+    double elem          = transformed[j];
+    if ( j == 0 )
+    {
+      for ( uint c = 0; c < _m; c++ )
+      {
+        itA[c] = alpha[c] * elem;
+        itB[c] = alpha[c];
+      }
+    }
+    else
+    {
+      const double * prevA = itA - _m;
+      const double * prevB = itB - _m;
+      for ( uint c = 0; c < _m; c++ )
+      {
+        itA[c] = prevA[c] + alpha[c] * elem;
+        itB[c] = prevB[c] + alpha[c];
+      }
+    }
+  }
+
+  // second pass: scatter the results, see hik_kernel_multiply_dimension
+  const double * alphaSumDim = B + (nnz-1)*_m;
+  itA = A;
+  itB = B;
+  for ( uint j = 0; j < nnz; j++, itA += _m, itB += _m )
+  {
+    double * beta = _betaRows + indices[j]*_m;
+    double fval   = transformed[j];
+    for ( uint c = 0; c < _m; c++ )
+    {
+      beta[c] += itA[c] + fval * ( alphaSumDim[c] - itB[c] );
+    }
+  }
+}
 
 /////////////////////////////////////////////////////
 /////////////////////////////////////////////////////
@@ -35,6 +320,10 @@ FastMinKernel::FastMinKernel()
   this->d_noise      = 1.0;
   this->approxScheme = MEDIAN;
   this->b_verbose    = false;
+  this->ui_numThreads = 1;
+  this->binIndicesQuantization = NULL;
+  this->prototypeCacheQuantization = NULL;
+  this->prototypeCacheFunction = NULL;
   this->setDebug(false);
 }
 
@@ -51,6 +340,10 @@ FastMinKernel::FastMinKernel( const std::vector<std::vector<double> > & _X,
   this->d_noise      = _noise;
   this->approxScheme = MEDIAN;
   this->b_verbose    = false;
+  this->ui_numThreads = 1;
+  this->binIndicesQuantization = NULL;
+  this->prototypeCacheQuantization = NULL;
+  this->prototypeCacheFunction = NULL;
 }
 
 #ifdef NICE_USELIB_MATIO
@@ -66,6 +359,10 @@ FastMinKernel::FastMinKernel ( const sparse_t & _X,
   this->d_noise      = _noise;
   this->approxScheme = MEDIAN;
   this->b_verbose    = false;
+  this->ui_numThreads = 1;
+  this->binIndicesQuantization = NULL;
+  this->prototypeCacheQuantization = NULL;
+  this->prototypeCacheFunction = NULL;
   this->setDebug(_debug);
 }
 #endif
@@ -83,6 +380,10 @@ FastMinKernel::FastMinKernel ( const std::vector< const NICE::SparseVector * > &
   this->d_noise      = _noise;
   this->approxScheme = MEDIAN;
   this->b_verbose    = false;
+  this->ui_numThreads = 1;
+  this->binIndicesQuantization = NULL;
+  this->prototypeCacheQuantization = NULL;
+  this->prototypeCacheFunction = NULL;
 }
 
 FastMinKernel::~FastMinKernel()
@@ -132,6 +433,16 @@ bool FastMinKernel::getDebug( )   const
   return this->b_debug;
 }
 
+void FastMinKernel::setNumberOfThreads( const uint & _numThreads )
+{
+  this->ui_numThreads = _numThreads;
+}
+
+uint FastMinKernel::getNumberOfThreads( )   const
+{
+  return this->ui_numThreads;
+}
+
 
 
 ///////////////////// ///////////////////// /////////////////////
@@ -145,7 +456,8 @@ void FastMinKernel::applyFunctionToFeatureMatrix ( const NICE::ParameterizedFunc
 
 void FastMinKernel::hik_prepare_alpha_multiplications(const NICE::Vector & _alpha,
                                                       NICE::VVector & _A,
-                                                      NICE::VVector & _B) const
+                                                      NICE::VVector & _B,
+                                                      const ParameterizedFunction *_transformView) const
 {
 //  //debug
 //    std::cerr << "alpha: " << _alpha << std::endl;
@@ -194,25 +506,27 @@ void FastMinKernel::hik_prepare_alpha_multiplications(const NICE::Vector & _alph
     _B[i].resize( numNonZero  );
   }
 
-  for (uint dim = 0; dim < this->ui_d; dim++)
+  // every dimension only writes its own entries of A and B, so we can process them independently
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel for num_threads( this->getEffectiveNumberOfThreads() ) schedule( dynamic )
+#endif
+  for (int dim = 0; dim < (int) this->ui_d; dim++)
   {
     double alpha_sum         = 0.0;
     double alpha_times_x_sum = 0.0;
 
     //////////
     // loop through all elements in sorted order
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
-    uint cntNonzeroFeat = 0;
-    for ( SortedVectorSparse<double>::const_elementpointer i = nonzeroElements.begin();
-          i != nonzeroElements.end();
-          i++, cntNonzeroFeat++ )
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const uint * indices = nonzeroElements.getIndices();
+    std::vector<double> transformedBuffer;
+    const double * transformed = this->X_sorted.getTransformedValues ( dim, _transformView, transformedBuffer );
+    for ( uint cntNonzeroFeat = 0; cntNonzeroFeat < nonzeroElements.size(); cntNonzeroFeat++ )
     {
-      const SortedVectorSparse<double>::dataelement & de = i->second;
-
       // index of the feature
-      int index   = de.first;
+      uint index  = indices[cntNonzeroFeat];
       // element of the feature
-      double elem = de.second;
+      double elem = transformed[cntNonzeroFeat];
 
       alpha_times_x_sum += _alpha[index] * elem;
       alpha_sum         += _alpha[index];
@@ -224,6 +538,110 @@ void FastMinKernel::hik_prepare_alpha_multiplications(const NICE::Vector & _alph
 
 }
 
+void FastMinKernel::hik_update_alpha_multiplications ( const NICE::Vector & _diffOfAlpha,
+                                                       const std::vector<uint> & _changedExamples,
+                                                       const uint & _numOldExamples,
+                                                       NICE::VVector & _A,
+                                                       NICE::VVector & _B
+                                                     ) const
+{
+  if ( ( _A.size() != this->ui_d ) || ( _B.size() != this->ui_d ) || ( _diffOfAlpha.size() != this->ui_n ) || ( _numOldExamples > this->ui_n ) )
+    fthrow(Exception, "FastMinKernel::hik_update_alpha_multiplications -- sizes of A (" << _A.size() << "), B (" << _B.size() << "), or the alpha changes (" << _diffOfAlpha.size() << ") do not match the data (" << this->ui_d << " x " << this->ui_n << ")" );
+
+  for ( uint dim = 0; dim < this->ui_d; dim++ )
+  {
+    uint numNonZero = this->X_sorted.getNumberOfNonZeroElementsPerDimension(dim);
+    if ( ( _A[dim].size() != _B[dim].size() ) || ( _A[dim].size() > numNonZero ) )
+      fthrow(Exception, "FastMinKernel::hik_update_alpha_multiplications -- A and B do not belong to the current data in dimension " << dim );
+  }
+
+  // locating the changed examples costs O(log nnz) each and is only worth it for a few of them,
+  // otherwise every dimension is swept completely (which is still cheaper than allocating A and B again)
+  bool locateChanges ( _changedExamples.size() * ( log ( (double) this->ui_n + 1.0 ) / log ( 2.0 ) ) < this->ui_n );
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel for num_threads( this->getEffectiveNumberOfThreads() ) schedule( dynamic )
+#endif
+  for (int dim = 0; dim < (int) this->ui_d; dim++)
+  {
+    const SortedVectorSparse<double> & featureValues = this->X_sorted.getFeatureValues(dim);
+    uint numNonZero    ( featureValues.getNonZeros() );
+    uint numOldNonZero ( _A[dim].size() );
+
+    // first position whose partial sums change, new examples have to be inserted in any case
+    uint start ( locateChanges ? numNonZero : 0 );
+    uint position;
+    if ( locateChanges )
+    {
+      for ( std::vector<uint>::const_iterator exIt = _changedExamples.begin(); exIt != _changedExamples.end(); exIt++ )
+        if ( featureValues.getNonZeroPosition ( *exIt, position ) )
+          start = std::min ( start, position );
+    }
+    if ( numNonZero != numOldNonZero )
+    {
+      for ( uint idx = _numOldExamples; idx < this->ui_n; idx++ )
+        if ( featureValues.getNonZeroPosition ( idx, position ) )
+          start = std::min ( start, position );
+    }
+
+    if ( start >= numNonZero )
+      continue;
+
+    // no new element precedes start, i.e., the positions of the old and new partial sums agree up to start
+    std::vector<double> oldA;
+    std::vector<double> oldB;
+    if ( numNonZero != numOldNonZero )
+    {
+      oldA.assign ( _A[dim].begin(), _A[dim].end() );
+      oldB.assign ( _B[dim].begin(), _B[dim].end() );
+      _A[dim].resize ( numNonZero );
+      _B[dim].resize ( numNonZero );
+      for ( uint j = 0; j < start; j++ )
+      {
+        _A[dim][j] = oldA[j];
+        _B[dim][j] = oldB[j];
+      }
+    }
+    // without new elements, the partial sums are updated in place
+    const double * sourceA = _A[dim].getDataPointer();
+    const double * sourceB = _B[dim].getDataPointer();
+    if ( numNonZero != numOldNonZero )
+    {
+      sourceA = oldA.empty() ? NULL : &(oldA[0]);
+      sourceB = oldB.empty() ? NULL : &(oldB[0]);
+    }
+
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = featureValues.nonzeroElements();
+    const uint * indices = nonzeroElements.getIndices();
+    std::vector<double> transformedBuffer;
+    const double * transformed = this->X_sorted.getTransformedValues ( dim, NULL, transformedBuffer );
+
+    double previousA ( start > 0 ? sourceA[start-1] : 0.0 );
+    double previousB ( start > 0 ? sourceB[start-1] : 0.0 );
+    double diffTimesXSum ( 0.0 );
+    double diffSum       ( 0.0 );
+    uint oldPosition ( start );
+    for ( uint cntNonzeroFeat = start; cntNonzeroFeat < numNonZero; cntNonzeroFeat++ )
+    {
+      uint index = indices[cntNonzeroFeat];
+
+      // new elements start with the partial sums of their predecessor
+      if ( index < _numOldExamples )
+      {
+        previousA = sourceA[oldPosition];
+        previousB = sourceB[oldPosition];
+        oldPosition++;
+      }
+
+      diffTimesXSum += _diffOfAlpha[index] * transformed[cntNonzeroFeat];
+      diffSum       += _diffOfAlpha[index];
+
+      _A[dim][cntNonzeroFeat] = previousA + diffTimesXSum;
+      _B[dim][cntNonzeroFeat] = previousB + diffSum;
+    }
+  }
+}
+
 double *FastMinKernel::hik_prepare_alpha_multiplications_fast(const NICE::VVector & _A,
                                                               const NICE::VVector & _B,
                                                               const Quantization * _q,
@@ -246,21 +664,24 @@ double *FastMinKernel::hik_prepare_alpha_multiplications_fast(const NICE::VVecto
   {
     for ( uint i = 0 ; i < hmax ; i++ )
     {
-      if ( _pf != NULL )
-      {
-        *p_prototypes = _pf->f ( dim, _q->getPrototype( i, dim ) );
-      } else
-      {
-        *p_prototypes = _q->getPrototype( i, dim );
-      }
+      p_prototypes[i] = _q->getPrototype( i, dim );
+    }
 
-      p_prototypes++;
+    // all prototypes of this dimension are transformed at once
+    if ( _pf != NULL )
+    {
+      _pf->f ( dim, &(*p_prototypes), &(*p_prototypes), hmax );
     }
+
+    p_prototypes += hmax;
   }
 
   // allocate memory for LUT T
   double *Tlookup = new double [ hmax * this->ui_d ];
 
+  // bins of the sorted non-zero elements of the current dimension
+  std::vector<uint> binsOfDim;
+
   // start the actual computation of  T
   for ( uint dim = 0; dim < this->ui_d; dim++ )
   {
@@ -279,19 +700,18 @@ double *FastMinKernel::hik_prepare_alpha_multiplications_fast(const NICE::VVecto
         continue;
     }
 
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
 
-    SortedVectorSparse<double>::const_elementpointer i = nonzeroElements.begin();
-    SortedVectorSparse<double>::const_elementpointer iPredecessor = nonzeroElements.begin();
+    // we use the quantization of the original features! the transformed feature were
+    // already used to calculate A and B, this of course assumes monotonic functions!!!
+    // all non-zero elements of this dimension are quantized at once
+    binsOfDim.resize ( nnz );
+    _q->quantize ( nonzeroElements.getValues(), dim, &(binsOfDim[0]), nnz );
 
     // index of the element, which is always bigger than the current value fval
     int indexElem = 0;
-    // element of the feature
-    double elem = i->first;
 
-    // we use the quantization of the original features! the transformed feature were
-    // already used to calculate A and B, this of course assumes monotonic functions!!!
-    uint idxProtoElem = _q->quantize ( elem, dim );// denotes the bin number in dim i of a quantized example, previously termed qBin
+    uint idxProtoElem = binsOfDim[0];// denotes the bin number in dim i of a quantized example, previously termed qBin
 
     uint idxProto;
     double * itProtoVal = prototypes + dim*hmax;
@@ -317,14 +737,7 @@ double *FastMinKernel::hik_prepare_alpha_multiplications_fast(const NICE::VVecto
         while ( (idxProto >= idxProtoElem) && ( indexElem  < ( nnz - 1)  ) ) //(this->ui_n-1-nrZeroIndices)) )
         {
           indexElem++;
-          iPredecessor = i;
-          i++;
-
-          // only quantize if value changed
-          if ( i->first !=  iPredecessor->first )
-          {
-            idxProtoElem = _q->quantize ( i->first, dim );
-          }
+          idxProtoElem = binsOfDim[indexElem];
         }
 
         // did we looped over the largest element in this dimension?
@@ -393,7 +806,8 @@ double *FastMinKernel::hik_prepare_alpha_multiplications_fast(const NICE::VVecto
 
 double *FastMinKernel::hikPrepareLookupTable(const NICE::Vector & _alpha,
                                              const Quantization * _q,
-                                             const ParameterizedFunction *_pf
+                                             const ParameterizedFunction *_pf,
+                                             const ParameterizedFunction *_transformView
                                             ) const
 {
   // number of quantization bins
@@ -407,16 +821,16 @@ double *FastMinKernel::hikPrepareLookupTable(const NICE::Vector & _alpha,
   {
     for ( uint i = 0 ; i < hmax ; i++ )
     {
-      if ( _pf != NULL )
-      {
-        *p_prototypes = _pf->f ( dim, _q->getPrototype( i, dim ) );
-      } else
-      {
-        *p_prototypes = _q->getPrototype( i, dim );
-      }
+      p_prototypes[i] = _q->getPrototype( i, dim );
+    }
 
-      p_prototypes++;
+    // all prototypes of this dimension are transformed at once
+    if ( _pf != NULL )
+    {
+      _pf->f ( dim, &(*p_prototypes), &(*p_prototypes), hmax );
     }
+
+    p_prototypes += hmax;
   }
 
   // creating the lookup table as pure C, which might be beneficial
@@ -424,6 +838,10 @@ double *FastMinKernel::hikPrepareLookupTable(const NICE::Vector & _alpha,
   double *Tlookup = new double [ hmax * this->ui_d ];
 //   sizeOfLUT = hmax * this->d;
 
+  // bins of the sorted non-zero elements of the current dimension
+  std::vector<uint> binsOfDim;
+  std::vector<double> transformedBuffer;
+
   // loop through all dimensions
   for (uint dim = 0; dim < this->ui_d; dim++)
   {
@@ -431,24 +849,26 @@ double *FastMinKernel::hikPrepareLookupTable(const NICE::Vector & _alpha,
     if ( nrZeroIndices == this->ui_n )
       continue;
 
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const uint * indices = nonzeroElements.getIndices();
+    const double * transformed = this->X_sorted.getTransformedValues ( dim, _transformView, transformedBuffer );
 
     double alphaSumTotalInDim(0.0);
     double alphaTimesXSumTotalInDim(0.0);
-    for ( SortedVectorSparse<double>::const_elementpointer i = nonzeroElements.begin(); i != nonzeroElements.end(); i++ )
+    for ( uint k = 0; k < nonzeroElements.size(); k++ )
     {
-      alphaSumTotalInDim += _alpha[i->second.first];
-      alphaTimesXSumTotalInDim += _alpha[i->second.first] * i->second.second;
+      alphaSumTotalInDim += _alpha[indices[k]];
+      alphaTimesXSumTotalInDim += _alpha[indices[k]] * transformed[k];
     }
 
-    SortedVectorSparse<double>::const_elementpointer i = nonzeroElements.begin();
-    SortedVectorSparse<double>::const_elementpointer iPredecessor = nonzeroElements.begin();
-
     // index of the element, which is always bigger than the current value fval
     uint index = 0;
 
     // we use the quantization of the original features! Nevetheless, the resulting lookupTable is computed using the transformed ones
-    uint qBin = _q->quantize ( i->first, dim );
+    // all non-zero elements of this dimension are quantized at once
+    binsOfDim.resize ( nonzeroElements.size() );
+    _q->quantize ( nonzeroElements.getValues(), dim, &(binsOfDim[0]), nonzeroElements.size() );
+    uint qBin = binsOfDim[0];
 
     double alpha_sum(0.0);
     double alpha_times_x_sum(0.0);
@@ -472,15 +892,12 @@ double *FastMinKernel::hikPrepareLookupTable(const NICE::Vector & _alpha,
         {
           alpha_times_x_sum_prev = alpha_times_x_sum;
           alpha_sum_prev = alpha_sum;
-          alpha_times_x_sum += _alpha[i->second.first] * i->second.second; //i->dataElement.transformedFeatureValue
-          alpha_sum += _alpha[i->second.first]; //i->dataElement.OrigIndex
+          alpha_times_x_sum += _alpha[indices[index]] * transformed[index];
+          alpha_sum += _alpha[indices[index]];
 
           index++;
-          iPredecessor = i;
-          i++;
 
-          if ( i->first !=  iPredecessor->first )
-            qBin = _q->quantize ( i->first, dim );
+          qBin = binsOfDim[index];
         }
         // compute current element in the lookup table and keep in mind that
         // index is the next element and not the previous one
@@ -507,6 +924,132 @@ double *FastMinKernel::hikPrepareLookupTable(const NICE::Vector & _alpha,
 }
 
 
+void FastMinKernel::computePrototypes ( const Quantization * _q,
+                                        const ParameterizedFunction * _pf,
+                                        std::vector<double> & _prototypes
+                                      ) const
+{
+  uint hmax = _q->getNumberOfBins();
+  _prototypes.resize ( hmax * this->ui_d );
+
+  std::vector<double>::iterator p_prototypes = _prototypes.begin();
+  for (uint dim = 0; dim < this->ui_d; dim++)
+  {
+    for ( uint i = 0 ; i < hmax ; i++ )
+    {
+      p_prototypes[i] = _q->getPrototype( i, dim );
+    }
+
+    // all prototypes of this dimension are transformed at once
+    if ( _pf != NULL )
+    {
+      _pf->f ( dim, &(*p_prototypes), &(*p_prototypes), hmax );
+    }
+
+    p_prototypes += hmax;
+  }
+}
+
+// exact comparison of two vectors, vectors of different size are not equal
+static bool equalValues ( const NICE::Vector & _a,
+                          const NICE::Vector & _b
+                        )
+{
+  if ( _a.size() != _b.size() )
+    return false;
+  for ( uint i = 0; i < _a.size(); i++ )
+    if ( _a[i] != _b[i] )
+      return false;
+  return true;
+}
+
+const std::vector<double> & FastMinKernel::getCachedPrototypes ( const Quantization * _q,
+                                                                 const ParameterizedFunction * _pf
+                                                               ) const
+{
+  // the prototypes only depend on the bins and upper bounds of the quantization and on the parameters of the transformation
+  bool valid = ( this->prototypeCacheQuantization == _q ) &&
+               ( this->prototypeCacheFunction == _pf ) &&
+               ( this->prototypeCache.size() == _q->getNumberOfBins() * this->ui_d ) &&
+               equalValues ( this->prototypeCacheUpperBounds, _q->getUpperBounds() ) &&
+               ( ( _pf == NULL ) || equalValues ( this->prototypeCacheParameters, _pf->parameters() ) );
+
+  if ( !valid )
+  {
+    this->computePrototypes ( _q, _pf, this->prototypeCache );
+    this->prototypeCacheQuantization = _q;
+    this->prototypeCacheUpperBounds  = _q->getUpperBounds();
+    this->prototypeCacheFunction     = _pf;
+    this->prototypeCacheParameters   = ( _pf != NULL ) ? _pf->parameters() : NICE::Vector();
+  }
+
+  return this->prototypeCache;
+}
+
+void FastMinKernel::getNonZeroElementsOfExample ( const uint & _idx,
+                                                 std::vector<uint> & _dims,
+                                                 std::vector<double> & _values,
+                                                 std::vector<double> & _transformedValues
+                                               ) const
+{
+  _dims.clear();
+  _values.clear();
+  _transformedValues.clear();
+
+  if ( this->X_sorted.getKeepExampleMirror() )
+  {
+    const uint * exampleDims;
+    const double * exampleValues;
+    const double * exampleTransformedValues;
+    uint nnz = this->X_sorted.getExample ( _idx, exampleDims, exampleValues, exampleTransformedValues );
+
+    _dims.assign ( exampleDims, exampleDims + nnz );
+    _values.assign ( exampleValues, exampleValues + nnz );
+    _transformedValues.assign ( exampleTransformedValues, exampleTransformedValues + nnz );
+  }
+  else
+  {
+    for ( uint dim = 0; dim < this->ui_d; dim++ )
+    {
+      const NICE::SortedVectorSparse<double> & featureValues = this->X_sorted.getFeatureValues ( dim );
+      uint position;
+      if ( !featureValues.getNonZeroPosition ( _idx, position ) ) //nothing to do in this dimension
+        continue;
+
+      _dims.push_back ( dim );
+      _values.push_back ( featureValues.nonzeroElements().getValues()[position] );
+      _transformedValues.push_back ( featureValues.nonzeroElements().getTransformedValues()[position] );
+    }
+  }
+}
+
+void FastMinKernel::hikUpdateLookupTableOfExample ( double * _T,
+                                                    const double & _diffOfAlpha,
+                                                    const double * _prototypes,
+                                                    const uint & _hmax,
+                                                    const uint * _dims,
+                                                    const double * _values,
+                                                    const uint * _bins,
+                                                    const uint & _nnz
+                                                  ) const
+{
+  for ( uint k = 0; k < _nnz; k++ )
+  {
+    double * TDim                = _T + _dims[k]*_hmax;
+    const double * prototypesDim = _prototypes + _dims[k]*_hmax;
+    uint q_bin                   = _bins[k];
+
+    // prototypes smaller than the example: min(x_i, p_j) = p_j
+    for ( uint j = 0; j < q_bin; j++ )
+      TDim[j] += _diffOfAlpha*prototypesDim[j];
+
+    // all remaining prototypes: min(x_i, p_j) = x_i
+    double update ( _diffOfAlpha*_values[k] );
+    for ( uint j = q_bin; j < _hmax; j++ )
+      TDim[j] += update;
+  }
+}
+
 void FastMinKernel::hikUpdateLookupTable(double * _T,
                                          const double & _alphaNew,
                                          const double & _alphaOld,
@@ -525,110 +1068,114 @@ void FastMinKernel::hikUpdateLookupTable(double * _T,
   // number of quantization bins
   uint hmax = _q->getNumberOfBins();
 
-  // store (transformed) prototypes
-  double * prototypes   = new double [ hmax * this->ui_d ];
-  double * p_prototypes = prototypes;
+  // (transformed) prototypes, only computed again if q or pf changed
+  const std::vector<double> & prototypes = this->getCachedPrototypes ( _q, _pf );
 
-  for (uint dim = 0; dim < this->ui_d; dim++)
-  {
-    for ( uint i = 0 ; i < hmax ; i++ )
-    {
-      if ( _pf != NULL )
-      {
-        *p_prototypes = _pf->f ( dim, _q->getPrototype( i, dim ) );
-      } else
-      {
-        *p_prototypes = _q->getPrototype( i, dim );
-      }
+  // non-zero dimensions of the example
+  std::vector<uint> dims;
+  std::vector<double> values;
+  std::vector<double> transformedValues;
+  this->getNonZeroElementsOfExample ( _idx, dims, values, transformedValues );
 
-      p_prototypes++;
-    }
-  }
+  if ( dims.empty() )
+    return;
 
-  double diffOfAlpha(_alphaNew - _alphaOld);
+  // the bins refer to the original values, just as in hikPrepareLookupTable
+  std::vector<uint> bins ( dims.size() );
+  _q->quantize( &(values[0]), &(dims[0]), &(bins[0]), dims.size() );
 
-  // loop through all dimensions
-  for ( uint dim = 0; dim < this->ui_d; dim++ )
+  this->hikUpdateLookupTableOfExample ( _T, _alphaNew - _alphaOld, &(prototypes[0]), hmax, &(dims[0]), &(transformedValues[0]), &(bins[0]), dims.size() );
+}
+
+void FastMinKernel::hikUpdateLookupTable ( double * _T,
+                                           const NICE::Vector & _diffOfAlpha,
+                                           const std::vector<uint> & _examples,
+                                           const Quantization * _q,
+                                           const ParameterizedFunction *_pf
+                                         ) const
+{
+  if (_T == NULL)
   {
-    double x_i ( (this->X_sorted( dim, _idx)) );
+    fthrow(Exception, "FastMinKernel::hikUpdateLookupTable LUT not initialized, run FastMinKernel::hikPrepareLookupTable first!");
+  }
+
+  uint hmax = _q->getNumberOfBins();
+
+  // the prototypes are shared by all examples and kept for further updates
+  const std::vector<double> & prototypes = this->getCachedPrototypes ( _q, _pf );
 
-    //TODO we could also check wether x_i < tol, if we would store the tol explicitely
-    if ( x_i == 0.0 ) //nothing to do in this dimension
+  std::vector<uint> dims;
+  std::vector<double> values;
+  std::vector<double> transformedValues;
+  std::vector<uint> bins;
+  for ( std::vector<uint>::const_iterator exIt = _examples.begin(); exIt != _examples.end(); exIt++ )
+  {
+    if ( _diffOfAlpha[*exIt] == 0.0 )
       continue;
 
-    //TODO we could speed up this by first doing a binary search for the position where the min changes, and then do two separate for-loops
-    for (uint j = 0; j < hmax; j++)
-    {
-        double fval;
-        uint q_bin = _q->quantize( x_i, dim );
+    this->getNonZeroElementsOfExample ( *exIt, dims, values, transformedValues );
+    if ( dims.empty() )
+      continue;
 
-        if ( q_bin > j )
-          fval = prototypes[ dim*hmax + j ];
-        else
-          fval = x_i;
+    // bins of the original values, the transformed values are only needed for the constant part of the update
+    bins.resize ( dims.size() );
+    _q->quantize( &(values[0]), &(dims[0]), &(bins[0]), dims.size() );
 
-      _T[ dim*hmax + j ] += diffOfAlpha*fval;
-    }
+    this->hikUpdateLookupTableOfExample ( _T, _diffOfAlpha[*exIt], &(prototypes[0]), hmax, &(dims[0]), &(transformedValues[0]), &(bins[0]), dims.size() );
   }
-
-  delete [] prototypes;
 }
 
 
 void FastMinKernel::hik_kernel_multiply(const NICE::VVector & _A,
                                         const NICE::VVector & _B,
                                         const NICE::Vector & _alpha,
-                                        NICE::Vector & _beta
+                                        NICE::Vector & _beta,
+                                        const ParameterizedFunction *_transformView
                                        ) const
 {
   _beta.resize( this->ui_n );
   _beta.set(0.0);
 
-  // runtime is O(n*d), we do no benefit from an additional lookup table here
+  // DEBUG for Björns code
+  // (checked in advance, since we must not throw from within a parallel region)
+  if ( ( _A.size() < this->ui_d ) || ( _B.size() < this->ui_d ) )
+    fthrow(Exception, "d exceeds A.size or B.size: " << this->ui_d << " " << _A.size() << " " << _B.size() );
   for (uint dim = 0; dim < this->ui_d; dim++)
   {
-    // -- efficient sparse solution
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
-    uint nrZeroIndices = this->X_sorted.getNumberOfZeroElementsPerDimension(dim);
+    uint numNonZero = this->X_sorted.getNumberOfNonZeroElementsPerDimension(dim);
+    if ( ( numNonZero > 0 ) && ( ( _A[dim].size() < numNonZero ) || ( _B[dim].size() < numNonZero ) ) )
+      fthrow(Exception, "A[dim] or B[dim] is too small: " << _A[dim].size() << " " << _B[dim].size() << " nnz: " << numNonZero << " dim: " << dim );
+  }
 
-    if ( nrZeroIndices == this->ui_n ) {
-      // all values are zero in this dimension :) and we can simply ignore the feature
-      continue;
-    }
+  // runtime is O(n*d), we do no benefit from an additional lookup table here
+  // The dimensions are split into chunks which only depend on the data, every chunk is accumulated
+  // into its own partial result, and the partial results are added up in the order of the chunks.
+  // Therefore, the result does neither depend on the number of threads nor on the scheduling.
+  uint dimsPerChunk = this->getNumberOfDimensionsPerChunk();
+  int numChunks = ( this->ui_d + dimsPerChunk - 1 ) / dimsPerChunk;
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel num_threads( this->getEffectiveNumberOfThreads() )
+#endif
+  {
+    NICE::Vector betaChunk ( this->ui_n );
+    std::vector<double> transformedBuffer;
 
-    uint cnt(0);
-    for ( multimap< double, SortedVectorSparse<double>::dataelement>::const_iterator i = nonzeroElements.begin(); i != nonzeroElements.end(); i++, cnt++)
+#ifdef NICE_USELIB_OPENMP
+#pragma omp for schedule( dynamic ) ordered
+#endif
+    for (int chunk = 0; chunk < numChunks; chunk++)
     {
-      const SortedVectorSparse<double>::dataelement & de = i->second;
-      uint feat = de.first;
-      uint inversePosition = cnt;
-      double fval = de.second;
-
-      // in which position was the element sorted in? actually we only care about the nonzero elements, so we have to subtract the number of zero elements.
-      //NOTE pay attention: this is only valid if all entries are positiv! - if not, ask wether the current feature is greater than zero. If so, subtract the nrZeroIndices, if not do not
-
-      //we definitly know that this element exists in inversePermutation, so we have not to check wether find returns .end() or not
-      //int inversePosition(inversePermutation.find(feat)->second - nrZeroIndices);
-      // sum_{l \in L_k} \alpha_l x^l_k
-      //
-      // A is zero for zero feature values (x^l_k is zero for all l \in L_k)
-      double firstPart( _A[dim][inversePosition] );
-      // sum_{u \in U_k} alpha_u
-      // B is not zero for zero feature values, but we do not
-      // have to care about them, because it is multiplied with
-      // the feature value
-      // DEBUG for Björns code
-      if ( dim >= _B.size() )
-        fthrow(Exception, "dim exceeds B.size: " << dim << " " << _B.size() );
-      if ( _B[dim].size() == 0 )
-        fthrow(Exception, "B[dim] is empty");
-      if ( (this->ui_n-1-nrZeroIndices < 0)  || ((uint)(this->ui_n-1-nrZeroIndices) >= _B[dim].size() ) )
-        fthrow(Exception, "n-1-nrZeroIndices is invalid: " << this->ui_n << " " << nrZeroIndices << " " << _B[dim].size() << " d: " << this->ui_d);
-      if ( inversePosition < 0 || (uint)inversePosition >= _B[dim].size() )
-        fthrow(Exception, "inverse position is invalid: " << inversePosition << " " << _B[dim].size() );
-      double secondPart( _B[dim][this->ui_n-1-nrZeroIndices] - _B[dim][inversePosition]);
-
-      _beta[feat] += firstPart + fval * secondPart; // i->elementpointer->dataElement->Value
+      betaChunk.set ( 0.0 );
+      uint dimEnd = std::min<uint> ( ( chunk + 1 ) * dimsPerChunk, this->ui_d );
+      for (uint dim = chunk * dimsPerChunk; dim < dimEnd; dim++)
+      {
+        this->hik_kernel_multiply_dimension ( dim, _A, _B, betaChunk, _transformView, transformedBuffer );
+      }
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp ordered
+#endif
+      _beta += betaChunk;
     }
   }
 
@@ -652,18 +1199,31 @@ void FastMinKernel::hik_kernel_multiply_fast(const double *_Tlookup,
   _beta.set(0.0);
 
   // runtime is O(n*d), we do no benefit from an additional lookup table here
-  for (uint dim = 0; dim < this->ui_d; dim++)
+  // see hik_kernel_multiply for the parallelization scheme
+  uint dimsPerChunk = this->getNumberOfDimensionsPerChunk();
+  int numChunks = ( this->ui_d + dimsPerChunk - 1 ) / dimsPerChunk;
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel num_threads( this->getEffectiveNumberOfThreads() )
+#endif
   {
-    // -- efficient sparse solution
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    NICE::Vector betaChunk ( this->ui_n );
 
-    uint cnt(0);
-    for ( multimap< double, SortedVectorSparse<double>::dataelement>::const_iterator i = nonzeroElements.begin(); i != nonzeroElements.end(); i++, cnt++)
+#ifdef NICE_USELIB_OPENMP
+#pragma omp for schedule( dynamic ) ordered
+#endif
+    for (int chunk = 0; chunk < numChunks; chunk++)
     {
-      const SortedVectorSparse<double>::dataelement & de = i->second;
-      uint feat = de.first;
-      uint qBin = _q->quantize( i->first, dim );
-      _beta[feat] += _Tlookup[dim*_q->getNumberOfBins() + qBin];
+      betaChunk.set ( 0.0 );
+      uint dimEnd = std::min<uint> ( ( chunk + 1 ) * dimsPerChunk, this->ui_d );
+      for (uint dim = chunk * dimsPerChunk; dim < dimEnd; dim++)
+      {
+        this->hik_kernel_multiply_fast_dimension ( dim, _Tlookup, _q, betaChunk );
+      }
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp ordered
+#endif
+      _beta += betaChunk;
     }
   }
 
@@ -674,6 +1234,194 @@ void FastMinKernel::hik_kernel_multiply_fast(const double *_Tlookup,
   }
 }
 
+void FastMinKernel::prepareBinIndices ( const Quantization * _q )
+{
+  this->clearBinIndices();
+
+  if ( _q == NULL )
+    return;
+
+  uint hmax = _q->getNumberOfBins();
+  // bin indices which do not fit into 16 bit are not cached
+  if ( hmax > 65536 )
+    return;
+
+  if ( hmax <= 256 )
+    this->binIndices8.resize ( this->ui_d );
+  else
+    this->binIndices16.resize ( this->ui_d );
+
+  std::vector<uint> bins;
+  for ( uint dim = 0; dim < this->ui_d; dim++ )
+  {
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const double * values = nonzeroElements.getValues();
+    uint nnz              = nonzeroElements.size();
+    if ( nnz == 0 )
+      continue;
+
+    bins.resize ( nnz );
+    _q->quantize( values, dim, &(bins[0]), nnz );
+
+    if ( hmax <= 256 )
+      this->binIndices8[dim].assign ( bins.begin(), bins.end() );
+    else
+      this->binIndices16[dim].assign ( bins.begin(), bins.end() );
+  }
+
+  this->binIndicesQuantization = _q;
+}
+
+void FastMinKernel::clearBinIndices ( )
+{
+  this->binIndicesQuantization = NULL;
+  this->binIndices8.clear();
+  this->binIndices16.clear();
+}
+
+bool FastMinKernel::hasBinIndices ( const Quantization * _q ) const
+{
+  return ( _q != NULL ) && ( this->binIndicesQuantization == _q );
+}
+
+void FastMinKernel::hik_kernel_multiply_block ( const NICE::Matrix & _alpha,
+                                               NICE::Matrix & _beta,
+                                               const ParameterizedFunction *_transformView
+                                             ) const
+{
+  uint m = _alpha.cols();
+
+  if ( _alpha.rows() != this->ui_n )
+    fthrow(Exception, "FastMinKernel::hik_kernel_multiply_block: number of rows (" << _alpha.rows() << ") does not fit to the number of examples (" << this->ui_n << ")" );
+
+  _beta.resize ( this->ui_n, m );
+  _beta.set ( 0.0 );
+
+  if ( m == 0 )
+    return;
+
+  // store alpha example-wise, such that all columns belonging to a single example are
+  // located next to each other during the loop over the sorted features
+  std::vector<double> alphaRows ( this->ui_n * m );
+  for ( uint i = 0; i < this->ui_n; i++ )
+    for ( uint c = 0; c < m; c++ )
+      alphaRows[i*m + c] = _alpha(i,c);
+
+  std::vector<double> betaRows ( this->ui_n * m, 0.0 );
+
+  // see hik_kernel_multiply for the parallelization scheme
+  uint dimsPerChunk = this->getNumberOfDimensionsPerChunk();
+  int numChunks = ( this->ui_d + dimsPerChunk - 1 ) / dimsPerChunk;
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel num_threads( this->getEffectiveNumberOfThreads() )
+#endif
+  {
+    std::vector<double> betaChunk ( this->ui_n * m );
+    std::vector<double> partialSums;
+    std::vector<double> transformedBuffer;
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp for schedule( dynamic ) ordered
+#endif
+    for (int chunk = 0; chunk < numChunks; chunk++)
+    {
+      std::fill ( betaChunk.begin(), betaChunk.end(), 0.0 );
+      uint dimEnd = std::min<uint> ( ( chunk + 1 ) * dimsPerChunk, this->ui_d );
+      for (uint dim = chunk * dimsPerChunk; dim < dimEnd; dim++)
+      {
+        this->hik_kernel_multiply_block_dimension ( dim, m, &(alphaRows[0]), &(betaChunk[0]), partialSums, _transformView, transformedBuffer );
+      }
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp ordered
+#endif
+      for ( uint i = 0; i < betaChunk.size(); i++ )
+        betaRows[i] += betaChunk[i];
+    }
+  }
+
+  // comment about the following noise integration, see hik_kernel_multiply
+  for ( uint i = 0; i < this->ui_n; i++ )
+    for ( uint c = 0; c < m; c++ )
+      _beta(i,c) = betaRows[i*m + c] + this->d_noise * alphaRows[i*m + c];
+}
+
+bool FastMinKernel::hikBilinearFormGradient ( const NICE::Matrix & _U,
+                                              const NICE::Matrix & _V,
+                                              const NICE::Vector & _weights,
+                                              const ParameterizedFunction *_pf,
+                                              NICE::Vector & _gradient
+                                            ) const
+{
+  uint m = _U.cols();
+
+  if ( ( _U.rows() != this->ui_n ) || ( _V.rows() != this->ui_n ) || ( _V.cols() != m ) || ( _weights.size() != m ) )
+    fthrow(Exception, "FastMinKernel::hikBilinearFormGradient: sizes of U (" << _U.rows() << " x " << m << "), V (" << _V.rows() << " x " << _V.cols() << ") and weights (" << _weights.size() << ") do not fit to the number of examples (" << this->ui_n << ")" );
+
+  if ( _pf == NULL )
+    fthrow(Exception, "FastMinKernel::hikBilinearFormGradient: no parameterized function given");
+
+  uint numParameters = _pf->parameters().size();
+  _gradient.resize ( numParameters );
+  _gradient.set ( 0.0 );
+
+  if ( ( m == 0 ) || ( numParameters == 0 ) )
+    return true;
+
+  // store U and V example-wise, see hik_kernel_multiply_block
+  std::vector<double> URows ( this->ui_n * m );
+  std::vector<double> VRows ( this->ui_n * m );
+  for ( uint i = 0; i < this->ui_n; i++ )
+    for ( uint c = 0; c < m; c++ )
+    {
+      URows[i*m + c] = _U(i,c);
+      VRows[i*m + c] = _V(i,c);
+    }
+
+  bool supported ( true );
+
+  // see hik_kernel_multiply for the parallelization scheme
+  uint dimsPerChunk = this->getNumberOfDimensionsPerChunk();
+  int numChunks = ( this->ui_d + dimsPerChunk - 1 ) / dimsPerChunk;
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel num_threads( this->getEffectiveNumberOfThreads() )
+#endif
+  {
+    std::vector<double> gradientChunk ( numParameters );
+    std::vector<double> weightedSums;
+    std::vector<double> suffixSums;
+    std::vector<uint> parameterIndices;
+    std::vector<double> derivatives;
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp for schedule( dynamic ) ordered
+#endif
+    for (int chunk = 0; chunk < numChunks; chunk++)
+    {
+      std::fill ( gradientChunk.begin(), gradientChunk.end(), 0.0 );
+      bool supportedChunk ( true );
+      uint dimEnd = std::min<uint> ( ( chunk + 1 ) * dimsPerChunk, this->ui_d );
+      for (uint dim = chunk * dimsPerChunk; supportedChunk && ( dim < dimEnd ); dim++)
+      {
+        supportedChunk = addBilinearFormGradientDimension ( this->X_sorted.getFeatureValues(dim).nonzeroElements(), dim, m,
+                                                            &(URows[0]), &(VRows[0]), _weights.getDataPointer(), _pf,
+                                                            weightedSums, suffixSums, parameterIndices, derivatives, &(gradientChunk[0]) );
+      }
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp ordered
+#endif
+      {
+        supported = supported && supportedChunk;
+        for ( uint k = 0; k < numParameters; k++ )
+          _gradient[k] += gradientChunk[k];
+      }
+    }
+  }
+
+  return supported;
+}
+
 void FastMinKernel::hik_kernel_sum(const NICE::VVector & _A,
                                    const NICE::VVector & _B,
                                    const NICE::SparseVector & _xstar,
@@ -683,7 +1431,13 @@ void FastMinKernel::hik_kernel_sum(const NICE::VVector & _A,
   // sparse version of hik_kernel_sum, no really significant changes,
   // we are just skipping zero elements
   _beta = 0.0;
-  for (SparseVector::const_iterator i = _xstar.begin(); i != _xstar.end(); i++)
+  // transform all non-zero elements of the example at once
+  std::vector<double> transformedXstar;
+  if ( _pf != NULL )
+    transformExample ( _pf, _xstar, transformedXstar );
+
+  uint cnt ( 0 );
+  for (SparseVector::const_iterator i = _xstar.begin(); i != _xstar.end(); i++, cnt++)
   {
 
     uint dim = i->first;
@@ -737,7 +1491,7 @@ void FastMinKernel::hik_kernel_sum(const NICE::VVector & _A,
 
     if ( _pf != NULL )
     {
-      fval = _pf->f ( dim, fval );
+      fval = transformedXstar[cnt];
     }
 
     // but apply using the transformed one
@@ -754,6 +1508,11 @@ void FastMinKernel::hik_kernel_sum(const NICE::VVector & _A,
 {
   _beta = 0.0;
   uint dim ( 0 );
+  // transform all values of the example at once
+  std::vector<double> transformedXstar;
+  if ( _pf != NULL )
+    transformExample ( _pf, _xstar, transformedXstar );
+
   for (NICE::Vector::const_iterator i = _xstar.begin(); i != _xstar.end(); i++, dim++)
   {
 
@@ -802,7 +1561,7 @@ void FastMinKernel::hik_kernel_sum(const NICE::VVector & _A,
 
     if ( _pf != NULL )
     {
-      fval = _pf->f ( dim, fval );
+      fval = transformedXstar[dim];
     }
 
     // but apply using the transformed one
@@ -823,14 +1582,20 @@ void FastMinKernel::hik_kernel_sum_fast(const double *_Tlookup,
     return;
   }
 
+  if ( this->ui_d == 0 )
+    return;
+
   // runtime is O(d) if the quantizer is O(1)
+  // all dimensions are quantized with a single call of the quantizer
+  std::vector<uint> dims ( this->ui_d );
+  std::vector<uint> bins ( this->ui_d );
   for ( uint dim = 0; dim < this->ui_d; dim++)
-  {
-    double v = _xstar[dim];
-    uint qBin = _q->quantize( v, dim );
+    dims[dim] = dim;
+  _q->quantize( _xstar.getDataPointer(), &(dims[0]), &(bins[0]), this->ui_d );
 
-    _beta += _Tlookup[dim*_q->getNumberOfBins() + qBin];
-  }
+  uint hmax = _q->getNumberOfBins();
+  for ( uint dim = 0; dim < this->ui_d; dim++)
+    _beta += _Tlookup[dim*hmax + bins[dim]];
 }
 
 void FastMinKernel::hik_kernel_sum_fast(const double *_Tlookup,
@@ -844,14 +1609,30 @@ void FastMinKernel::hik_kernel_sum_fast(const double *_Tlookup,
   // we are just skipping zero elements
   // for additional comments see the non-sparse version of hik_kernel_sum_fast
   // runtime is O(d) if the quantizer is O(1)
-  for (SparseVector::const_iterator i = _xstar.begin(); i != _xstar.end(); i++ )
-  {
-    uint dim = i->first;
-    double v = i->second;
-    uint qBin = _q->quantize( v, dim );
+  std::vector<uint> dims;
+  std::vector<uint> bins;
+  _q->quantize( _xstar, dims, bins, this->ui_d );
 
-    _beta += _Tlookup[dim*_q->getNumberOfBins() + qBin];
-  }
+  uint hmax = _q->getNumberOfBins();
+  for ( uint k = 0; k < dims.size(); k++ )
+    _beta += _Tlookup[dims[k]*hmax + bins[k]];
+}
+
+// sum of the LUT entries of a single training example, see the LUT offsets prepared in solveLin
+static inline double sumLookupTableOfExample ( const double * _Tlookup,
+                                               const uint & _example,
+                                               const std::vector<uint> & _zeroOffsets,
+                                               const std::vector<uint> & _exampleStart,
+                                               const std::vector<uint> & _nonzeroOffsets,
+                                               const std::vector<uint> & _nonzeroZeroOffsets
+                                             )
+{
+  double sum ( 0.0 );
+  for ( uint j = 0; j < _zeroOffsets.size(); j++ )
+    sum += _Tlookup[ _zeroOffsets[j] ];
+  for ( uint k = _exampleStart[_example]; k < _exampleStart[_example+1]; k++ )
+    sum += _Tlookup[ _nonzeroOffsets[k] ] - _Tlookup[ _nonzeroZeroOffsets[k] ];
+  return sum;
 }
 
 double *FastMinKernel::solveLin(const NICE::Vector & _y,
@@ -885,7 +1666,6 @@ double *FastMinKernel::solveLin(const NICE::Vector & _y,
   NICE::Vector delta_alpha (_y.size(),0.0);
   double alpha_old;
   double alpha_new;
-  double x_i;
 
   // initialization of the alpha vector
   if (_alpha.size() != _y.size())
@@ -901,6 +1681,43 @@ double *FastMinKernel::solveLin(const NICE::Vector & _y,
 
   memset(Tlookup, 0, sizeof(Tlookup[0])*hmax*this->ui_d);
 
+  // LUT offsets (dim*hmax + bin) of the non-zero values of every example, computed once,
+  // such that the pseudo residuals below only require integer gathers from the LUT:
+  // sum_j T[j][bin(x_ij)] = sum_j T[j][bin(0)] + sum_{j: x_ij != 0} ( T[j][bin(x_ij)] - T[j][bin(0)] )
+  std::vector<uint> zeroOffsets ( this->ui_d );
+  for ( uint j = 0; j < this->ui_d; j++ )
+    zeroOffsets[j] = j*hmax + _q->quantize( 0.0, j );
+
+  // sparse row view of every example: non-zero dimensions and transformed values,
+  // such that neither the pseudo residuals nor the LUT updates need to search X_sorted
+  std::vector<uint> exampleStart;
+  std::vector<uint> nonzeroDims;
+  std::vector<double> nonzeroValues;
+  std::vector<double> nonzeroTransformedValues;
+  this->X_sorted.getExampleMirror ( exampleStart, nonzeroDims, nonzeroValues, nonzeroTransformedValues );
+
+  if ( _y.size() > this->ui_n )
+    fthrow(Exception, "FastMinKernel::solveLin: size of y (" << _y.size() << ") is larger than the number of training examples (" << this->ui_n << ")");
+
+  // the coordinate descent works on the (transformed) values X_sorted(j,i), i.e., the pseudo residuals
+  // and the LUT updates quantize the transformed values, the cached bin indices refer to the original ones
+  uint nnzTotal = nonzeroDims.size();
+  std::vector<uint> nonzeroUpdateBins ( nnzTotal );
+  std::vector<uint> nonzeroOffsets ( nnzTotal );
+  std::vector<uint> nonzeroZeroOffsets ( nnzTotal );
+  if ( nnzTotal > 0 )
+    _q->quantize( &(nonzeroTransformedValues[0]), &(nonzeroDims[0]), &(nonzeroUpdateBins[0]), nnzTotal );
+
+  for ( uint pos = 0; pos < nnzTotal; pos++ )
+  {
+    nonzeroOffsets[pos]     = nonzeroDims[pos]*hmax + nonzeroUpdateBins[pos];
+    nonzeroZeroOffsets[pos] = zeroOffsets[ nonzeroDims[pos] ];
+  }
+
+  // prototypes are computed only once and not for every update of the LUT
+  std::vector<double> prototypes;
+  this->computePrototypes ( _q, _pf, prototypes );
+
   uint iter;
   Timer t;
   if ( _timeAnalysis )
@@ -943,11 +1760,7 @@ double *FastMinKernel::solveLin(const NICE::Vector & _y,
       for ( uint i = 0; i < sizeOfRandomSubset; i++)
       {
         pseudoResidual(perm[i]) = -_y(perm[i]) + (this->d_noise * _alpha(perm[i]));
-        for (uint j = 0; j < this->ui_d; j++)
-        {
-          x_i = this->X_sorted(j,perm[i]);
-          pseudoResidual(perm[i]) += Tlookup[j*hmax + _q->quantize( x_i, j )];
-        }
+        pseudoResidual(perm[i]) += sumLookupTableOfExample ( Tlookup, perm[i], zeroOffsets, exampleStart, nonzeroOffsets, nonzeroZeroOffsets );
 
         //NOTE: this threshhold could also be a parameter of the function call
         if ( fabs(pseudoResidual(perm[i])) > 1e-7 )
@@ -959,7 +1772,11 @@ double *FastMinKernel::solveLin(const NICE::Vector & _y,
 
           delta_alpha(perm[i]) = alpha_old-alpha_new;
 
-          this->hikUpdateLookupTable(Tlookup, alpha_new, alpha_old, perm[i], _q, _pf ); // works correctly
+          uint rowStart = exampleStart[ perm[i] ];
+          uint rowSize  = exampleStart[ perm[i] + 1 ] - rowStart;
+          if ( rowSize > 0 )
+            this->hikUpdateLookupTableOfExample ( Tlookup, alpha_new - alpha_old, &(prototypes[0]), hmax,
+                                                  &(nonzeroDims[rowStart]), &(nonzeroTransformedValues[rowStart]), &(nonzeroUpdateBins[rowStart]), rowSize );
 
         } else
         {
@@ -996,11 +1813,7 @@ double *FastMinKernel::solveLin(const NICE::Vector & _y,
       {
 
         pseudoResidual(i) = -_y(i) + (this->d_noise* _alpha(i));
-        for (uint j = 0; j < this->ui_d; j++)
-        {
-          x_i = this->X_sorted(j,i);
-          pseudoResidual(i) += Tlookup[j*hmax + _q->quantize( x_i, j )];
-        }
+        pseudoResidual(i) += sumLookupTableOfExample ( Tlookup, i, zeroOffsets, exampleStart, nonzeroOffsets, nonzeroZeroOffsets );
 
         //NOTE: this threshhold could also be a parameter of the function call
         if ( fabs(pseudoResidual(i)) > 1e-7 )
@@ -1010,7 +1823,11 @@ double *FastMinKernel::solveLin(const NICE::Vector & _y,
           _alpha(i) = alpha_new;
           delta_alpha(i) = alpha_old-alpha_new;
 
-          this->hikUpdateLookupTable(Tlookup, alpha_new, alpha_old, i, _q, _pf ); // works correctly
+          uint rowStart = exampleStart[ i ];
+          uint rowSize  = exampleStart[ i + 1 ] - rowStart;
+          if ( rowSize > 0 )
+            this->hikUpdateLookupTableOfExample ( Tlookup, alpha_new - alpha_old, &(prototypes[0]), hmax,
+                                                  &(nonzeroDims[rowStart]), &(nonzeroTransformedValues[rowStart]), &(nonzeroUpdateBins[rowStart]), rowSize );
 
         } else
         {
@@ -1185,7 +2002,7 @@ void FastMinKernel::hikPrepareKVNApproximation(NICE::VVector & _A) const
 
     uint cntNonzeroFeat(0);
 
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
     // loop through all elements in sorted order
     for ( SortedVectorSparse<double>::const_elementpointer i = nonzeroElements.begin(); i != nonzeroElements.end(); i++ )
     {
@@ -1219,16 +2036,16 @@ double * FastMinKernel::hikPrepareKVNApproximationFast(NICE::VVector & _A,
   {
     for ( uint i = 0 ; i < hmax ; i++ )
     {
-      if ( _pf != NULL )
-      {
-        *p_prototypes = _pf->f ( dim, _q->getPrototype( i, dim ) );
-      } else
-      {
-        *p_prototypes = _q->getPrototype( i, dim );
-      }
+      p_prototypes[i] = _q->getPrototype( i, dim );
+    }
 
-      p_prototypes++;
+    // all prototypes of this dimension are transformed at once
+    if ( _pf != NULL )
+    {
+      _pf->f ( dim, &(*p_prototypes), &(*p_prototypes), hmax );
     }
+
+    p_prototypes += hmax;
   }
 
 
@@ -1243,7 +2060,7 @@ double * FastMinKernel::hikPrepareKVNApproximationFast(NICE::VVector & _A,
     if ( nrZeroIndices == this->ui_n )
       continue;
 
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
 
     SortedVectorSparse<double>::const_elementpointer i = nonzeroElements.begin();
     SortedVectorSparse<double>::const_elementpointer iPredecessor = nonzeroElements.begin();
@@ -1317,16 +2134,16 @@ double* FastMinKernel::hikPrepareLookupTableForKVNApproximation(const Quantizati
   {
     for ( uint i = 0 ; i < hmax ; i++ )
     {
-      if ( _pf != NULL )
-      {
-        *p_prototypes = _pf->f ( dim, _q->getPrototype( i, dim ) );
-      } else
-      {
-        *p_prototypes = _q->getPrototype( i, dim );
-      }
+      p_prototypes[i] = _q->getPrototype( i, dim );
+    }
 
-      p_prototypes++;
+    // all prototypes of this dimension are transformed at once
+    if ( _pf != NULL )
+    {
+      _pf->f ( dim, &(*p_prototypes), &(*p_prototypes), hmax );
     }
+
+    p_prototypes += hmax;
   }
 
   // creating the lookup table as pure C, which might be beneficial
@@ -1340,7 +2157,7 @@ double* FastMinKernel::hikPrepareLookupTableForKVNApproximation(const Quantizati
     if ( nrZeroIndices == this->ui_n )
       continue;
 
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
 
     SortedVectorSparse<double>::const_elementpointer i = nonzeroElements.begin();
     SortedVectorSparse<double>::const_elementpointer iPredecessor = nonzeroElements.begin();
@@ -1408,7 +2225,13 @@ void FastMinKernel::hikComputeKVNApproximation(const NICE::VVector & _A,
                                                const ParameterizedFunction *_pf )
 {
   _norm = 0.0;
-  for (SparseVector::const_iterator i = _xstar.begin(); i != _xstar.end(); i++)
+  // transform all non-zero elements of the example at once
+  std::vector<double> transformedXstar;
+  if ( _pf != NULL )
+    transformExample ( _pf, _xstar, transformedXstar );
+
+  uint cnt ( 0 );
+  for (SparseVector::const_iterator i = _xstar.begin(); i != _xstar.end(); i++, cnt++)
   {
 
     uint dim    = i->first;
@@ -1451,7 +2274,7 @@ void FastMinKernel::hikComputeKVNApproximation(const NICE::VVector & _A,
     }
 
     if ( _pf != NULL )
-      fval = _pf->f ( dim, fval );
+      fval = transformedXstar[cnt];
 
     // but apply using the transformed one
     _norm += firstPart + secondPart* pow( fval, 2 );
@@ -1521,7 +2344,7 @@ void FastMinKernel::hikComputeKernelVector ( const NICE::SparseVector& _xstar,
       std::cerr << " position: " << position << std::endl;
 
     //get the non-zero elements for this dimension
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
 
     //run over the non-zero elements and add the corresponding entries to our kernel vector
 
@@ -1541,6 +2364,44 @@ void FastMinKernel::hikComputeKernelVector ( const NICE::SparseVector& _xstar,
   }
 }
 
+void FastMinKernel::hikComputeKernelVectors ( const std::vector< const NICE::SparseVector * > & _xstars,
+                                              NICE::Matrix & _kstars
+                                            ) const
+{
+  _kstars.resize ( this->ui_n, _xstars.size() );
+  _kstars.set ( 0.0 );
+
+  for ( uint j = 0; j < _xstars.size(); j++ )
+  {
+    for ( SparseVector::const_iterator i = _xstars[j]->begin(); i != _xstars[j]->end(); i++ )
+    {
+      uint dim = i->first;
+      double fval = i->second;
+
+      if ( dim >= this->X_sorted.get_d() )
+        continue;
+
+      const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+      uint nnz ( nonzeroElements.size() );
+      if ( nnz == 0 )
+        continue;
+
+      // same rule as in hikComputeKernelVector: training values in front of position are smaller than fval
+      uint position;
+      this->X_sorted.findFirstLargerInDimension(dim, fval, position);
+      uint nrZeroIndices ( this->ui_n - nnz );
+      uint numSmaller = ( position > nrZeroIndices ) ? std::min ( position - nrZeroIndices, nnz ) : 0;
+
+      const double * values = nonzeroElements.getValues();
+      const uint * indices = nonzeroElements.getIndices();
+      for ( uint pos = 0; pos < numSmaller; pos++ )
+        _kstars ( indices[pos], j ) += values[pos];
+      for ( uint pos = numSmaller; pos < nnz; pos++ )
+        _kstars ( indices[pos], j ) += fval;
+    }
+  }
+}
+
     //////////////////////////////////////////
     // variance computation: non-sparse inputs
     //////////////////////////////////////////
@@ -1552,6 +2413,11 @@ void FastMinKernel::hikComputeKVNApproximation(const NICE::VVector & _A,
 {
   _norm = 0.0;
   uint dim ( 0 );
+  // transform all values of the example at once
+  std::vector<double> transformedXstar;
+  if ( _pf != NULL )
+    transformExample ( _pf, _xstar, transformedXstar );
+
   for (Vector::const_iterator i = _xstar.begin(); i != _xstar.end(); i++, dim++)
   {
 
@@ -1587,7 +2453,7 @@ void FastMinKernel::hikComputeKVNApproximation(const NICE::VVector & _A,
     double secondPart( 0.0);
 
     if ( _pf != NULL )
-      fval = _pf->f ( dim, fval );
+      fval = transformedXstar[dim];
 
     fval = fval * fval;
 
@@ -1654,7 +2520,7 @@ void FastMinKernel::hikComputeKernelVector( const NICE::Vector & _xstar,
 
 
     //get the non-zero elements for this dimension
-    const multimap< double, SortedVectorSparse<double>::dataelement> & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = this->X_sorted.getFeatureValues(dim).nonzeroElements();
 
     //run over the non-zero elements and add the corresponding entries to our kernel vector
 
@@ -1692,6 +2558,9 @@ void FastMinKernel::restore ( std::istream & _is,
         throw;
     }
 
+    // cached bin indices refer to the previous training data
+    this->clearBinIndices();
+
     _is.precision (numeric_limits<double>::digits10 + 1);
 
     bool b_endOfBlock ( false ) ;
@@ -1802,6 +2671,36 @@ void FastMinKernel::store ( std::ostream & _os,
   }
 }
 
+void FastMinKernel::storeBinary ( BinaryModelWriter & _writer,
+                                  const std::string & _prefix
+                                ) const
+{
+  // the few scalar settings are written as text
+  std::ostringstream settings;
+  settings.precision ( numeric_limits<double>::digits10 + 1 );
+  settings << this->ui_n << " " << this->ui_d << " " << this->d_noise << " " << this->approxScheme;
+  _writer.addString ( _prefix + "settings", settings.str() );
+
+  this->X_sorted.storeBinary ( _writer, _prefix + "X_sorted." );
+}
+
+void FastMinKernel::restoreBinary ( const BinaryModelReader & _reader,
+                                    const std::string & _prefix
+                                  )
+{
+  // cached bin indices refer to the previous training data
+  this->clearBinIndices();
+
+  std::istringstream settings ( _reader.getString ( _prefix + "settings" ) );
+  int approxSchemeInt;
+  settings >> this->ui_n >> this->ui_d >> this->d_noise >> approxSchemeInt;
+  if ( settings.fail() )
+    fthrow ( Exception, "FastMinKernel::restoreBinary: invalid section " << _prefix << "settings" );
+  this->setApproximationScheme ( approxSchemeInt );
+
+  this->X_sorted.restoreBinary ( _reader, _prefix + "X_sorted." );
+}
+
 void FastMinKernel::clear ()
 {
   std::cerr << "FastMinKernel clear-function called" << std::endl;
@@ -1830,24 +2729,45 @@ void FastMinKernel::addMultipleExamples( const std::vector< const NICE::SparseVe
   this->addMultipleExamples ( _newExamples );
 }
 
+void FastMinKernel::removeExample( const uint & _exampleIndex,
+                                   const bool & _performOptimizationAfterDecrement
+                                 )
+{
+  this->removeMultipleExamples ( std::vector< uint > ( 1, _exampleIndex ), _performOptimizationAfterDecrement );
+}
+
+void FastMinKernel::removeMultipleExamples( const std::vector< uint > & _exampleIndices,
+                                            const bool & _performOptimizationAfterDecrement
+                                          )
+{
+  // the remaining examples are renumbered consecutively
+  this->X_sorted.remove_features( _exampleIndices );
+  this->ui_n = this->X_sorted.get_n();
+
+  // positions of the non-zero values changed
+  this->clearBinIndices();
+}
+
 void FastMinKernel::addExample( const NICE::SparseVector * _example,
                                 const NICE::ParameterizedFunction *_pf
                               )
 {
   this->X_sorted.add_feature( *_example, _pf );
   this->ui_n++;
+
+  // positions of the non-zero values changed
+  this->clearBinIndices();
 }
 
 void FastMinKernel::addMultipleExamples( const std::vector< const NICE::SparseVector * > & _newExamples,
                                          const NICE::ParameterizedFunction *_pf
                                          )
 {
-  for ( std::vector< const NICE::SparseVector * >::const_iterator exIt = _newExamples.begin();
-        exIt != _newExamples.end();
-        exIt++ )
-  {
-    this->X_sorted.add_feature( **exIt, _pf );
-    this->ui_n++;
-  }
+  // sort the new values per dimension and merge them in a single pass, instead of inserting them one by one
+  this->X_sorted.add_features( _newExamples, _pf );
+  this->ui_n += _newExamples.size();
+
+  // positions of the non-zero values changed
+  this->clearBinIndices();
 }
 
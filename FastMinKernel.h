@@ -9,6 +9,7 @@
 
 // STL includes
 #include <iostream>
+#include <vector>
 
 // NICE-core includes
 #include <core/basics/Config.h>
@@ -59,6 +60,27 @@ namespace NICE {
       //! debug flag for output during debugging
       bool b_debug;
 
+      //! number of threads used for loops over dimensions (0 = all available cores, 1 = sequential)
+      uint ui_numThreads;
+
+      //! quantization the cached bin indices belong to (NULL if no bin indices are cached)
+      const Quantization * binIndicesQuantization;
+      //! bin indices of the non-zero training values of every dimension (in sorted order), used for up to 256 bins
+      std::vector< std::vector<unsigned char> > binIndices8;
+      //! bin indices of the non-zero training values of every dimension (in sorted order), used for up to 65536 bins
+      std::vector< std::vector<unsigned short> > binIndices16;
+
+      //! (transformed) prototypes used by hikUpdateLookupTable, see getCachedPrototypes
+      mutable std::vector<double> prototypeCache;
+      //! quantization the cached prototypes were computed with
+      mutable const Quantization * prototypeCacheQuantization;
+      //! upper bounds of this quantization at the time of the computation
+      mutable NICE::Vector prototypeCacheUpperBounds;
+      //! transformation the cached prototypes were computed with
+      mutable const ParameterizedFunction * prototypeCacheFunction;
+      //! parameters of this transformation at the time of the computation
+      mutable NICE::Vector prototypeCacheParameters;
+
       /**
       * @brief Set number of examples
       * @author Alexander Freytag
@@ -81,6 +103,104 @@ namespace NICE {
       enum ApproximationScheme{ MEDIAN = 0, EXPECTATION=1};
       ApproximationScheme approxScheme;
 
+      /**
+      * @brief Number of threads to be used for a loop over the dimensions, resolves 0 to all available cores (always 1 inside of a parallel region)
+      */
+      int getEffectiveNumberOfThreads ( ) const;
+
+      /**
+      * @brief Number of consecutive dimensions accumulated into a common partial result by the loops over the dimensions.
+      * Depends on the data only, such that the order of the summation does not depend on the number of threads.
+      */
+      uint getNumberOfDimensionsPerChunk ( ) const;
+
+      /**
+      * @brief Add the contribution of a single dimension to K*alpha (without noise), see hik_kernel_multiply
+      *
+      * @param _transformedBuffer storage for the feature values transformed on the fly (only used with _transformView)
+      */
+      void hik_kernel_multiply_dimension ( const uint & _dim,
+                                           const NICE::VVector & _A,
+                                           const NICE::VVector & _B,
+                                           NICE::Vector & _beta,
+                                           const ParameterizedFunction *_transformView,
+                                           std::vector<double> & _transformedBuffer
+                                         ) const;
+
+      /**
+      * @brief Add the contribution of a single dimension to K*alpha (without noise) using a LUT, see hik_kernel_multiply_fast
+      */
+      void hik_kernel_multiply_fast_dimension ( const uint & _dim,
+                                                const double *_Tlookup,
+                                                const Quantization * _q,
+                                                NICE::Vector & _beta
+                                              ) const;
+
+      /**
+      * @brief Add the contribution of a single dimension to K*alpha for m vectors at once, see hik_kernel_multiply_block
+      *
+      * @param _alphaRows alpha values stored example-wise (n x m, row-major)
+      * @param _betaRows resulting values stored example-wise (n x m, row-major)
+      * @param _partialSums buffer for the partial sums A and B of this dimension (at least 2 x nnz x m)
+      * @param _transformedBuffer storage for the feature values transformed on the fly (only used with _transformView)
+      */
+      void hik_kernel_multiply_block_dimension ( const uint & _dim,
+                                                 const uint & _m,
+                                                 const double * _alphaRows,
+                                                 double * _betaRows,
+                                                 std::vector<double> & _partialSums,
+                                                 const ParameterizedFunction *_transformView,
+                                                 std::vector<double> & _transformedBuffer
+                                               ) const;
+
+      /**
+      * @brief Compute the (transformed) prototypes of all dimensions, stored as hmax x d values (see hikPrepareLookupTable)
+      */
+      void computePrototypes ( const Quantization * _q,
+                               const ParameterizedFunction * _pf,
+                               std::vector<double> & _prototypes
+                             ) const;
+
+      /**
+      * @brief Prototypes of computePrototypes, which are only computed again if the quantization (bins, upper bounds)
+      * or the transformation (parameters) changed since the last call. Not safe for concurrent calls.
+      */
+      const std::vector<double> & getCachedPrototypes ( const Quantization * _q,
+                                                        const ParameterizedFunction * _pf
+                                                      ) const;
+
+      /**
+      * @brief Non-zero dimensions, original values, and transformed values of a single example (from the example mirror if kept)
+      */
+      void getNonZeroElementsOfExample ( const uint & _idx,
+                                         std::vector<uint> & _dims,
+                                         std::vector<double> & _values,
+                                         std::vector<double> & _transformedValues
+                                       ) const;
+
+      /**
+      * @brief Update a LUT after the alpha value of a single example changed, see hikUpdateLookupTable
+      *
+      * Only the non-zero dimensions of the example are touched. Each of them requires two contiguous
+      * range updates: the prototypes below the bin of the example and the example value from this bin on.
+      *
+      * @param _diffOfAlpha alphaNew - alphaOld
+      * @param _prototypes (transformed) prototypes, see computePrototypes
+      * @param _dims non-zero dimensions of the example
+      * @param _values transformed values of the example in these dimensions
+      * @param _bins bins of the original values
+      * @param _nnz number of non-zero dimensions
+      */
+      void hikUpdateLookupTableOfExample ( double * _T,
+                                           const double & _diffOfAlpha,
+                                           const double * _prototypes,
+                                           const uint & _hmax,
+                                           const uint * _dims,
+                                           const double * _values,
+                                           const uint * _bins,
+                                           const uint & _nnz
+                                         ) const;
+
     public:
 
       //------------------------------------------------------
@@ -180,6 +300,13 @@ namespace NICE {
       void setDebug( const bool & _debug);
       bool getDebug( ) const;
 
+      /**
+      * @brief Set the number of threads used for loops over dimensions (0 = all available cores, 1 = sequential). Only effective if compiled with OpenMP support.
+      * Dimensions are split statically and partial results are summed up in a fixed order, so results are reproducible for a fixed number of threads.
+      */
+      void setNumberOfThreads( const uint & _numThreads );
+      uint getNumberOfThreads( ) const;
+
       //------------------------------------------------------
       // high level methods
       //------------------------------------------------------
@@ -193,6 +320,14 @@ namespace NICE {
       */
       void applyFunctionToFeatureMatrix ( const NICE::ParameterizedFunction *_pf = NULL );
 
+      /*
+      * Transform views: the multiplication routines below optionally take an order preserving
+      * ParameterizedFunction _transformView. If given, the function is applied on the fly to the
+      * original values of every dimension (see FeatureMatrixT::getTransformedValues) and the stored
+      * transformed values are neither read nor modified. Hence, several parameter values can be
+      * evaluated without rewriting the feature matrix, also concurrently on the same object.
+      */
+
       /**
       * @brief  Prepare the efficient HIK-computations part 2: calculate the partial sum for each dimension. Explicitely exploiting sparsity!!! Pay attention: X_sorted is of dimensionality d x n!
       * @author Alexander Freytag
@@ -200,7 +335,30 @@ namespace NICE {
       */
       void hik_prepare_alpha_multiplications(const NICE::Vector & _alpha,
                                              NICE::VVector & _A,
-                                             NICE::VVector & _B
+                                             NICE::VVector & _B,
+                                             const ParameterizedFunction *_transformView = NULL
+                                            ) const;
+
+      /**
+      * @brief Update the partial sums A and B (see hik_prepare_alpha_multiplications) after examples were added
+      * and some alpha values changed, instead of computing them from scratch.
+      *
+      * Examples with an index of at least _numOldExamples are new ones, their alpha values were zero so far.
+      * The changes of all examples are added in a single sweep per dimension, starting at the smallest
+      * position of a changed or new example (range update). Dimensions in which no example changed are
+      * not touched.
+      *
+      * @param _diffOfAlpha alphaNew - alphaOld of all n examples (zero for unchanged examples)
+      * @param _changedExamples indices of the examples with a non-zero change
+      * @param _numOldExamples number of examples A and B were computed for
+      * @param _A partial sums a_{k,j}, updated
+      * @param _B partial sums b_{k,j}, updated
+      */
+      void hik_update_alpha_multiplications ( const NICE::Vector & _diffOfAlpha,
+                                              const std::vector<uint> & _changedExamples,
+                                              const uint & _numOldExamples,
+                                              NICE::VVector & _A,
+                                              NICE::VVector & _B
                                             ) const;
 
       /**
@@ -211,7 +369,8 @@ namespace NICE {
       void hik_kernel_multiply(const NICE::VVector & _A,
                                const NICE::VVector & _B,
                                const NICE::Vector & _alpha,
-                               NICE::Vector & _beta
+                               NICE::Vector & _beta,
+                               const ParameterizedFunction *_transformView = NULL
                               ) const;
       void hik_kernel_multiply_fast(const double *_Tlookup, 
                                     const Quantization * _q, 
@@ -219,6 +378,62 @@ namespace NICE {
                                     NICE::Vector & _beta
                                    ) const;
 
+      /**
+      * @brief Quantize all non-zero training values once and keep their bin indices, such that hik_kernel_multiply_fast
+      * and solveLin do not need to call _q->quantize for the training data anymore. The bin indices are only used if
+      * the same quantization object is given to these methods. They are discarded if examples are added.
+      * Call this method again (or clearBinIndices) after the parameters of _q have been re-computed.
+      */
+      void prepareBinIndices ( const Quantization * _q );
+
+      /**
+      * @brief Discard the cached bin indices, see prepareBinIndices
+      */
+      void clearBinIndices ( );
+
+      /**
+      * @brief Check whether bin indices for the given quantization are cached
+      */
+      bool hasBinIndices ( const Quantization * _q ) const;
+
+      /**
+      * @brief Computing K*alpha for several vectors alpha (columns of an n x m matrix) at once.
+      * Partial sums for all columns are computed in a single pass over the sorted data of every dimension,
+      * which avoids streaming the feature matrix m times.
+      *
+      * @param _alpha n x m matrix, every column is multiplied with the kernel matrix (plus noise)
+      * @param _beta resulting n x m matrix
+      * @param _transformView optional transformation applied on the fly
+      */
+      void hik_kernel_multiply_block ( const NICE::Matrix & _alpha,
+                                       NICE::Matrix & _beta,
+                                       const ParameterizedFunction *_transformView = NULL
+                                     ) const;
+
+      /**
+      * @brief Gradient of sum_c _weights[c] * _U(:,c)^T K _V(:,c) with respect to the parameters of _pf,
+      * where K is the kernel matrix of the features transformed with _pf (without noise).
+      *
+      * Since _pf is order preserving, K_ab = sum_k f_k(min(x^a_k, x^b_k)) and the derivative of K
+      * is again a minimum kernel, in which the derivative of f_k is applied to the smaller original value.
+      * The sum over all columns is computed with suffix sums in a single pass over the sorted data,
+      * and the derivatives of _pf are evaluated only once per non-zero element.
+      *
+      * @param _U n x m matrix
+      * @param _V n x m matrix
+      * @param _weights weight of every column (size m)
+      * @param _pf order preserving transformation providing ParameterizedFunction::parameterDerivatives
+      * @param _gradient resulting gradient (one entry per parameter of _pf)
+      *
+      * @return false if _pf does not provide analytic derivatives (_gradient is undefined then)
+      */
+      bool hikBilinearFormGradient ( const NICE::Matrix & _U,
+                                     const NICE::Matrix & _V,
+                                     const NICE::Vector & _weights,
+                                     const ParameterizedFunction *_pf,
+                                     NICE::Vector & _gradient
+                                   ) const;
+
       /**
       * @brief Computing k_{*}*alpha using the minimum kernel trick and exploiting sparsity of the feature vector given
       *
@@ -315,13 +530,15 @@ namespace NICE {
       * @param alpha coefficient vector
       * @param q Quantization
       * @param pf ParameterizedFunction to change the original feature values
+      * @param _transformView optional transformation of the training features applied on the fly
       *
       * @return C standard vector representing a q.size()*n double matrix and the lookup table T. Elements can be accessed with
       * T[dim*q.size() + j], where j is a bin entry corresponding to quantization q.
       */
       double* hikPrepareLookupTable(const NICE::Vector & _alpha, 
                                     const Quantization * _q, 
-                                    const ParameterizedFunction *_pf = NULL
+                                    const ParameterizedFunction *_pf = NULL,
+                                    const ParameterizedFunction *_transformView = NULL
                                    ) const;
 
       /**
@@ -334,6 +551,8 @@ namespace NICE {
       * @param idx index in which alpha changed
       * @param q Quantization
       * @param pf ParameterizedFunction to change the original feature values
+      *
+      * The (transformed) prototypes are kept between calls and only computed again if q or pf changed (see getCachedPrototypes).
       */
       void hikUpdateLookupTable(double * _T, 
                                 const double & _alphaNew, 
@@ -343,6 +562,22 @@ namespace NICE {
                                 const ParameterizedFunction *pf 
                                ) const;
 
+      /**
+      * @brief update the lookup table after the alpha values of several examples changed, see hikUpdateLookupTable
+      *
+      * @param _T previously computed LUT, that will be changed
+      * @param _diffOfAlpha alphaNew - alphaOld of all n examples
+      * @param _examples indices of the examples whose change is applied
+      * @param _q Quantization
+      * @param _pf ParameterizedFunction to change the original feature values
+      */
+      void hikUpdateLookupTable ( double * _T,
+                                  const NICE::Vector & _diffOfAlpha,
+                                  const std::vector<uint> & _examples,
+                                  const Quantization * _q,
+                                  const ParameterizedFunction *_pf
+                                ) const;
+
       /**
       * @brief return a reference to the sorted feature matrix
       */
@@ -459,6 +694,15 @@ namespace NICE {
       */
       void hikComputeKernelVector( const NICE::SparseVector & _xstar, NICE::Vector & _kstar) const;
 
+      /**
+      * @brief Compute the kernel vectors k_* of several test examples at once, i.e., the kernel matrix between training and test examples.
+      * Every test value is located with a single binary search, and the non-zero training values are read directly from the sorted arrays.
+      *
+      * @param _xstars test examples
+      * @param _kstars resulting kernel vectors (n x number of test examples), column j is the kernel vector of _xstars[j]
+      */
+      void hikComputeKernelVectors( const std::vector< const NICE::SparseVector * > & _xstars, NICE::Matrix & _kstars ) const;
+
     //////////////////////////////////////////
     // variance computation: non-sparse inputs
     //////////////////////////////////////////
@@ -500,6 +744,20 @@ namespace NICE {
       /** Persistent interface */
       virtual void restore ( std::istream & _is, int _format = 0 );
       virtual void store ( std::ostream & _os, int _format = 0 ) const;
+
+      /**
+      * @brief add the kernel settings and the sorted training data to a binary model (see FeatureMatrixT::storeBinary)
+      * @param _writer binary model
+      * @param _prefix prefix of the section names
+      */
+      void storeBinary ( BinaryModelWriter & _writer, const std::string & _prefix ) const;
+
+      /**
+      * @brief restore from a binary model written by storeBinary
+      * @param _reader binary model
+      * @param _prefix prefix of the section names
+      */
+      void restoreBinary ( const BinaryModelReader & _reader, const std::string & _prefix );
       virtual void clear ();
 
     ///////////////////// INTERFACE ONLINE LEARNABLE /////////////////////
@@ -516,6 +774,14 @@ namespace NICE {
                                       const bool & _performOptimizationAfterIncrement = true
                                     );
 
+    virtual void removeExample( const uint & _exampleIndex,
+                                const bool & _performOptimizationAfterDecrement = true
+                              );
+
+    virtual void removeMultipleExamples( const std::vector< uint > & _exampleIndices,
+                                         const bool & _performOptimizationAfterDecrement = true
+                                       );
+
 
       /**
       * @brief Add a new example to the feature-storage. You have to update the corresponding variables explicitely after that.
@@ -528,6 +794,7 @@ namespace NICE {
 
       /**
       * @brief Add multiple new example to the feature-storage. You have to update the corresponding variables explicitely after that.
+      * The batch is sorted per dimension and merged into the sorted features at once, see FeatureMatrixT::add_features.
       * @author Alexander Freytag
       * @date 02-01-2014 (dd-mm-yyyy)
       *
@@ -27,6 +27,7 @@
   
 // gp-hik-core includes
 #include "SortedVectorSparse.h"
+#include "gp-hik-core/BinaryModelFile.h"
 #include "gp-hik-core/parameterizedFunctions/ParameterizedFunction.h"
 
 
@@ -51,6 +52,47 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
     //! debug flag for output during debugging
     bool b_debug;
 
+    //! keep a row-major mirror (examples x dimensions) of the non-zero elements, see setKeepExampleMirror
+    bool b_keepExampleMirror;
+    //! non-zero elements of example i are stored at positions exampleStart[i] to exampleStart[i+1]-1 of the following arrays (CSR layout)
+    std::vector<uint> exampleStart;
+    std::vector<uint> exampleDims;
+    std::vector<T> exampleValues;
+    std::vector<T> exampleTransformedValues;
+
+    /**
+    * @brief insert sparse examples (examples x dimensions) by collecting all values per dimension first,
+    * such that every dimension is sorted and merged only once
+    *
+    * @param _features new examples
+    * @param _indexOffset original index of the first new example
+    * @param _pf optional parameterized function for computing the transformed values
+    */
+    void insertSparseExamples ( const std::vector< const NICE::SparseVector * > & _features,
+                                const uint & _indexOffset,
+                                const NICE::ParameterizedFunction * _pf = NULL
+                              );
+
+    /**
+    * @brief compute the row-major (CSR) layout of all non-zero elements from the sorted dimensions, O(nnz), see getExampleMirror
+    */
+    void computeExampleMirror ( std::vector<uint> & _exampleStart,
+                                std::vector<uint> & _dims,
+                                std::vector<T> & _values,
+                                std::vector<T> & _transformedValues
+                              ) const;
+
+    /**
+    * @brief update the mirror after a single element changed, the value is taken from the sorted dimension.
+    * An existing entry is overwritten in place, a new or removed non-zero element shifts the subsequent entries.
+    *
+    * @param _dim dimension of the element
+    * @param _example index of the example
+    */
+    void updateExampleMirrorElement ( const uint & _dim,
+                                      const uint & _example
+                                    );
+
 
   public:
     
@@ -255,7 +297,7 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
                            ) const;
     
     /** 
-    * @brief Finds the first element in a given dimension, which equals elem (orig feature value, not the transformed one)
+    * @brief Finds the first element in a given dimension, which equals elem (orig feature value, not the transformed one), runtime O(log n)
     * @author Alexander Freytag
     * @date 08-12-2011 (dd-mm-yyyy)
     */
@@ -265,7 +307,7 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
                              ) const;
     
     /** 
-    * @brief Finds the last element in a given dimension, which equals elem (orig feature value, not the transformed one)
+    * @brief Finds the last element in a given dimension, which equals elem (orig feature value, not the transformed one), runtime O(log n)
     * @author Alexander Freytag
     * @date 08-12-2011 (dd-mm-yyyy)1
     */
@@ -275,7 +317,7 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
                             ) const;
     
     /** 
-    * @brief Finds the first element in a given dimension, which is larger as elem (orig feature value, not the transformed one)
+    * @brief Finds the first element in a given dimension, which is larger as elem (orig feature value, not the transformed one), runtime O(log n)
     * @author Alexander Freytag
     * @date 08-12-2011 (dd-mm-yyyy)
     */
@@ -285,7 +327,7 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
                                    ) const;
     
     /** 
-    * @brief Finds the last element in a given dimension, which is smaller as elem (orig feature value, not the transformed one)
+    * @brief Finds the last element in a given dimension, which is smaller as elem (orig feature value, not the transformed one), runtime O(log n)
     * @author Alexander Freytag
     * @date 08-12-2011 (dd-mm-yyyy)
     */
@@ -313,6 +355,21 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
     * @param pf the parameterized function (optional), if not given, nothing will be done
     */    
     void applyFunctionToFeatureMatrix ( const NICE::ParameterizedFunction *_pf = NULL );
+
+    /**
+    * @brief transformed values of the non-zero elements of a dimension (in sorted order)
+    *
+    * @param _dim dimension
+    * @param _transformView if given, the values are computed on the fly from the original values
+    * (order preserving functions only) instead of reading the stored transformed values
+    * @param _buffer storage for the values computed on the fly
+    *
+    * @return pointer to the stored values or to the buffer
+    */
+    const T * getTransformedValues ( const uint & _dim,
+                                     const NICE::ParameterizedFunction *_transformView,
+                                     std::vector<T> & _buffer
+                                   ) const;
     
     /** 
     * @brief Computes the ratio of sparsity across the matrix
@@ -344,6 +401,27 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
     * @date 07-12-2011 (dd-mm-yyyy)
     */
     void add_features(const std::vector<std::vector<T> > & _features );
+
+    /**
+    * @brief append a batch of sparse examples (examples x dimensions). The new values are sorted per dimension
+    * and merged into the already sorted values with a single linear pass, and the example mirror is extended once,
+    * i.e., the costs are O(nnz_batch log nnz_batch + nnz_total) instead of O(nnz_batch * n) for adding them one by one.
+    *
+    * @param _features new examples, appended in the given order
+    * @param _pf optional parameterized function for computing the transformed values
+    */
+    void add_features(const std::vector< const NICE::SparseVector * > & _features,
+                      const NICE::ParameterizedFunction *_pf = NULL
+                     );
+
+    /**
+    * @brief remove examples from all dimensions, O(nnz_total). The remaining examples keep their order
+    * and are numbered consecutively afterwards, i.e., their original indices are decreased by the number of
+    * removed examples in front of them.
+    *
+    * @param _indices original indices of the examples to remove (in arbitrary order, duplicates are ignored)
+    */
+    void remove_features(const std::vector< uint > & _indices );
     
     /** 
     * @brief set the stored features to new values - which means deleting the old things and inserting the new ones. Return resulting permutation according to each dimension
@@ -444,8 +522,11 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
     * @brief compute the diagonal elements of the HIK kernel matrix induced by the features
     *
     * @param diagonalElements resulting vector
+    * @param _transformView if given, the features are transformed on the fly (see getTransformedValues)
     */
-    void hikDiagonalElements( Vector & _diagonalElements ) const;
+    void hikDiagonalElements( Vector & _diagonalElements,
+                              const NICE::ParameterizedFunction *_transformView = NULL
+                            ) const;
 
     /**
     * @brief Compute the trace of the HIK kernel matrix induced by the features
@@ -467,12 +548,81 @@ template<class T> class FeatureMatrixT : public NICE::Persistent
     * @return number of nonzero elements on the specified dimension
     */ 
     uint getNumberOfZeroElementsPerDimension(const uint & _dim) const;
+
+    /**
+    * @brief Keep a compact row-major (CSR) mirror of the non-zero elements, such that all non-zero elements
+    * of a single example can be accessed in O(nnz_i) instead of O(d log n) with operator().
+    * The mirror needs additional memory of about the size of the sorted data.
+    * It is kept consistent by all methods of this class. Changes via the non-const getFeatureValues
+    * require a call of updateExampleMirror.
+    *
+    * @param _keepExampleMirror enable (the mirror is computed immediately) or disable (the mirror is released)
+    */
+    void setKeepExampleMirror ( const bool & _keepExampleMirror );
+
+    bool getKeepExampleMirror ( ) const;
+
+    /**
+    * @brief re-compute the row-major mirror from the sorted dimensions, O(nnz)
+    */
+    void updateExampleMirror ( );
+
+    /**
+    * @brief non-zero elements of a single example, requires setKeepExampleMirror(true), O(1)
+    *
+    * @param _example index of the example
+    * @param _dims resulting pointer to the (increasing) dimensions of the non-zero elements
+    * @param _values resulting pointer to the original values
+    * @param _transformedValues resulting pointer to the transformed values
+    *
+    * @return number of non-zero elements of the example
+    */
+    uint getExample ( const uint & _example,
+                      const uint * & _dims,
+                      const T * & _values,
+                      const T * & _transformedValues
+                    ) const;
+
+    /**
+    * @brief row-major (CSR) layout of all non-zero elements, copied from the mirror if kept and computed otherwise
+    *
+    * @param _exampleStart resulting start positions, n+1 elements
+    * @param _dims resulting dimensions of the non-zero elements
+    * @param _values resulting original values
+    * @param _transformedValues resulting transformed values
+    */
+    void getExampleMirror ( std::vector<uint> & _exampleStart,
+                            std::vector<uint> & _dims,
+                            std::vector<T> & _values,
+                            std::vector<T> & _transformedValues
+                          ) const;
     
     /** Persistent interface */
     virtual void restore ( std::istream & _is, int _format = 0 );
     virtual void store ( std::ostream & _os, int _format = 0 ) const;
     virtual void clear ( );
 
+    /**
+    * @brief add the features to a binary model, the sorted arrays of all dimensions are stored contiguously
+    * (the arrays are referenced, i.e., the feature matrix must not change until the model is written)
+    *
+    * @param _writer binary model
+    * @param _prefix prefix of the section names
+    */
+    void storeBinary ( BinaryModelWriter & _writer,
+                       const std::string & _prefix
+                     ) const;
+
+    /**
+    * @brief restore the features from a binary model written by storeBinary (bulk copy, no element-wise inserts)
+    *
+    * @param _reader binary model
+    * @param _prefix prefix of the section names
+    */
+    void restoreBinary ( const BinaryModelReader & _reader,
+                         const std::string & _prefix
+                       );
+
 };
 
   //! default definition for a FeatureMatrix
@@ -12,6 +12,51 @@
 
 namespace NICE {
 
+    // transformation of several values of a single dimension, batched for double values
+    template <typename T>
+    inline void transformFeatureValues ( const NICE::ParameterizedFunction *_pf,
+                                         const uint & _dim,
+                                         const T * _values,
+                                         T * _transformedValues,
+                                         const uint & _n
+                                       )
+    {
+      for ( uint i = 0; i < _n; i++ )
+        _transformedValues[i] = _pf->f ( _dim, _values[i] );
+    }
+
+    inline void transformFeatureValues ( const NICE::ParameterizedFunction *_pf,
+                                         const uint & _dim,
+                                         const double * _values,
+                                         double * _transformedValues,
+                                         const uint & _n
+                                       )
+    {
+      _pf->f ( _dim, _values, _transformedValues, _n );
+    }
+
+    // transformation of values of different dimensions, batched for double values
+    template <typename T>
+    inline void transformFeatureValuesPerDimension ( const NICE::ParameterizedFunction *_pf,
+                                                     const uint * _dims,
+                                                     const T * _values,
+                                                     T * _transformedValues,
+                                                     const uint & _n
+                                                   )
+    {
+      for ( uint i = 0; i < _n; i++ )
+        _transformedValues[i] = _pf->f ( _dims[i], _values[i] );
+    }
+
+    inline void transformFeatureValuesPerDimension ( const NICE::ParameterizedFunction *_pf,
+                                                     const uint * _dims,
+                                                     const double * _values,
+                                                     double * _transformedValues,
+                                                     const uint & _n
+                                                   )
+    {
+      _pf->fPerDimension ( _dims, _values, _transformedValues, _n );
+    }
 
 
     //------------------------------------------------------
@@ -22,6 +67,7 @@ namespace NICE {
     template <typename T>
     FeatureMatrixT<T>::FeatureMatrixT()
     {
+      this->b_keepExampleMirror = false;
       this->ui_n = 0;
       this->ui_d = 0;
       this->features.clear();
@@ -36,6 +82,9 @@ namespace NICE {
                                       const uint & _dim
                                      )
     {
+      this->b_keepExampleMirror = false;
+      this->ui_n = 0;
+
         // resize our data structure
         if (_dim == 0)
             this->set_d( (*_features.begin()).size() );
@@ -59,6 +108,7 @@ namespace NICE {
                    const uint & _dim
                   )
     {
+      this->b_keepExampleMirror = false;
       this->features.clear();
 
         // resize our data structure
@@ -88,16 +138,7 @@ namespace NICE {
       }
       else //we have examples x dimes (as usually done)
       {
-        //loop over every example to add its content
-        for (uint nr = 0; nr < this->ui_n; nr++)
-        {
-          //loop over every dimension to add the specific value to the corresponding SortedVectorSparse
-          for (NICE::SparseVector::const_iterator elemIt = _features[nr]->begin(); elemIt != _features[nr]->end(); elemIt++)
-          {
-            //elemIt->first: dim, elemIt->second: value
-            this->features[elemIt->first].insert( (T) elemIt->second, nr);
-          }//for non-zero-values of the feature
-        }//for every new feature
+        this->insertSparseExamples( _features, 0 /* index of first example */ );
       }//if dimOverEx
 
       //set n for the internal data structure SortedVectorSparse
@@ -113,6 +154,7 @@ namespace NICE {
                    const uint & _dim
                   )
     {
+      this->b_keepExampleMirror = false;
       if (_dim < 0)
         set_d( _features.njc -1 );
       else
@@ -122,12 +164,14 @@ namespace NICE {
 
       for ( uint i = 0; i < _features.njc-1; i++ ) //walk over dimensions
       {
+        std::vector< std::pair< T, typename SortedVectorSparse<T>::dataelement > > newElements;
         for ( uint j = _features.jc[i]; j < _features.jc[i+1] && j < _features.ndata; j++ ) //walk over single features, which are sparsely represented
         {
-          this->features[i].insert(((T*)_features.data)[j], true /* specify feature number */, _features.ir[ j]);
+          newElements.push_back( std::pair< T, typename SortedVectorSparse<T>::dataelement > ( ((T*)_features.data)[j], typename SortedVectorSparse<T>::dataelement ( _features.ir[ j], ((T*)_features.data)[j] ) ) );
           if ((_features.ir[ j])>nMax)
             nMax = _features.ir[ j];
         }
+        this->features[i].insertMultiple( newElements );
       }
       for (typename std::vector<NICE::SortedVectorSparse<T> >::iterator it = this->features.begin(); it != this->features.end(); it++)
       {
@@ -144,6 +188,7 @@ namespace NICE {
                    const std::map<uint, uint> & _examples,
                    const uint & _dim)
     {
+      this->b_keepExampleMirror = false;
       if (_dim < 0)
         set_d(_features.njc -1);
       else
@@ -153,16 +198,18 @@ namespace NICE {
 
       for ( uint i = 0; i < _features.njc-1; i++ ) //walk over dimensions
       {
+        std::vector< std::pair< T, typename SortedVectorSparse<T>::dataelement > > newElements;
         for ( uint j = _features.jc[i]; j < _features.jc[i+1] && j < _features.ndata; j++ ) //walk over single features, which are sparsely represented
         {
           uint example_index = _features.ir[ j];
           std::map<uint, uint>::const_iterator it = _examples.find(example_index);
           if ( it != _examples.end() ) {
-            this->features[i].insert(((T*)_features.data)[j], true /* specify feature number */, it->second /* new index */);
+            newElements.push_back( std::pair< T, typename SortedVectorSparse<T>::dataelement > ( ((T*)_features.data)[j], typename SortedVectorSparse<T>::dataelement ( it->second /* new index */, ((T*)_features.data)[j] ) ) );
             if (it->second > nMax)
               nMax = it->second;
           }
         }
+        this->features[i].insertMultiple( newElements );
       }
       for (typename std::vector<NICE::SortedVectorSparse<T> >::iterator it = this->features.begin(); it != this->features.end(); it++)
         (*it).setN(nMax+1);
@@ -342,6 +389,9 @@ namespace NICE {
       }
       else
         (this->features[_row]).set ( _col, _newElement, _setTransformedValue );
+
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirrorElement ( _row, _col );
     }
 
     //  Sets a specified element to the given value, without validity check
@@ -353,6 +403,9 @@ namespace NICE {
                                              )
     {
       (this->features[_row]).set ( _col, _newElement, _setTransformedValue );
+
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirrorElement ( _row, _col );
     }
 
     //  Acceess to all element entries of a specified dimension, including validity check
@@ -386,13 +439,10 @@ namespace NICE {
                                                 ) const
     {
       _position = 0;
-      if ( _dim > this->ui_d )
+      if ( _dim >= this->ui_d )
         return;
 
-      std::pair< typename SortedVectorSparse<T>::elementpointer, typename SortedVectorSparse<T>::elementpointer > eit;
-      eit =  this->features[_dim].nonzeroElements().equal_range ( _elem );
-
-      _position = distance( this->features[_dim].nonzeroElements().begin(), eit.first );
+      _position = this->features[_dim].nonzeroElements().lowerBoundPosition ( _elem );
 
       if ( _elem > this->features[_dim].getTolerance() )
         _position += this->features[_dim].getZeros();
@@ -407,12 +457,10 @@ namespace NICE {
                                                ) const
     {
       _position = 0;
-      if ( _dim > this->ui_d )
+      if ( _dim >= this->ui_d )
         return;
 
-      std::pair< typename SortedVectorSparse<T>::const_elementpointer, typename SortedVectorSparse<T>::const_elementpointer > eit =  this->features[_dim].nonzeroElements().equal_range ( _elem );
-
-      _position = distance( this->features[_dim].nonzeroElements().begin(), eit.second );
+      _position = this->features[_dim].nonzeroElements().upperBoundPosition ( _elem );
 
       if ( _elem > this->features[_dim].getTolerance() )
         _position += this->features[_dim].getZeros();
@@ -425,23 +473,19 @@ namespace NICE {
                                                        uint & _position
                                                       ) const
     {
+      _position = 0;
+      if ( _dim >= this->ui_d )
+        return;
 
-        // number of zero elements
-        uint nz = this->ui_n - this->features[_dim].getNonZeros();
-        // number of non-zero elements
-        uint nnz = this->features[_dim].getNonZeros();
-
-        _position = 0; // this is the index of the first non-zero element.
+      // number of zero elements
+      uint nz = this->ui_n - this->features[_dim].getNonZeros();
 
       // standard case
 
-      // find pointer to last non-zero element
-      typename SortedVectorSparse<T>::const_elementpointer it =  this->features[_dim].nonzeroElements().end();
-      // find pointer to first element largern than the given value
-      it = this->features[_dim].nonzeroElements().upper_bound ( _elem );
-
-      _position = distance( this->features[_dim].nonzeroElements().begin(), it );
-
+      // find position of first element larger than the given value
+      // binary search on the flat value array, the position is directly
+      // available as array offset -> O(log n)
+      _position = this->features[_dim].nonzeroElements().upperBoundPosition ( _elem );
 
       // special case 1: element is (almost) zero -> every other value is considered to be larger
       if ( _elem >= this->features[_dim].getTolerance() )
@@ -458,13 +502,13 @@ namespace NICE {
                                                       ) const
     {
       _position = 0;
-      if ( (_dim < 0) || (_dim > this->ui_d))
+      if ( _dim >= this->ui_d )
         return;
 
-      typename SortedVectorSparse<T>::const_elementpointer it =  this->features[_dim].nonzeroElements().lower_bound ( _elem );
-      _position = distance( this->features[_dim].nonzeroElements().begin(), it );
+      _position = this->features[_dim].nonzeroElements().lowerBoundPosition ( _elem );
 
-      if ( it->first > this->features[_dim].getTolerance() )
+      // the zero elements are smaller than every non-zero value, also if elem exceeds all non-zero values
+      if ( _elem > this->features[_dim].getTolerance() )
         _position += this->features[_dim].getZeros();
     }
 
@@ -524,14 +568,15 @@ namespace NICE {
         uint d = this->get_d();
         for (uint dim = 0; dim < d; dim++)
         {
-          std::multimap< double, typename SortedVectorSparse<double>::dataelement> & nonzeroElements = this->getFeatureValues(dim).nonzeroElements();
-          for ( SortedVectorSparse<double>::elementpointer i = nonzeroElements.begin(); i != nonzeroElements.end(); i++ )
-          {
-            SortedVectorSparse<double>::dataelement & de = i->second;
+          SortedNonzeroElements<T> & nonzeroElements = this->getFeatureValues(dim).nonzeroElements();
+          //TODO check, wether the element is "sparse" afterwards
+          transformFeatureValues ( _pf, dim, nonzeroElements.getValues(), nonzeroElements.getTransformedValues(), nonzeroElements.size() );
+        }
 
-            //TODO check, wether the element is "sparse" afterwards
-            de.second = _pf->f( dim, i->first );
-          }
+        // the mirror only needs the new transformed values
+        if ( this->b_keepExampleMirror && !this->exampleValues.empty() )
+        {
+          transformFeatureValuesPerDimension ( _pf, &(this->exampleDims[0]), &(this->exampleValues[0]), &(this->exampleTransformedValues[0]), this->exampleValues.size() );
         }
 
         /*for ( int i = 0 ; i < featureMatrix.get_n(); i++ )
@@ -545,6 +590,26 @@ namespace NICE {
     }
 
 
+    template <typename T>
+    const T * FeatureMatrixT<T>::getTransformedValues ( const uint & _dim,
+                                                        const NICE::ParameterizedFunction *_transformView,
+                                                        std::vector<T> & _buffer
+                                                      ) const
+    {
+      const SortedNonzeroElements<T> & nonzeroElements = this->features[_dim].nonzeroElements();
+      if ( _transformView == NULL )
+        return nonzeroElements.getTransformedValues();
+
+      uint nnz = nonzeroElements.size();
+      if ( nnz == 0 )
+        return NULL;
+
+      if ( _buffer.size() < nnz )
+        _buffer.resize ( nnz );
+      transformFeatureValues ( _transformView, _dim, nonzeroElements.getValues(), &(_buffer[0]), nnz );
+      return &(_buffer[0]);
+    }
+
     //Computes the ratio of sparsity across the matrix
     template <typename T>
     double FeatureMatrixT<T>:: computeSparsityRatio() const
@@ -583,6 +648,25 @@ namespace NICE {
         else
           this->features[dimension].insert( _feature[dimension] );
       }
+
+      // append the new example to the mirror, O(d)
+      if ( this->b_keepExampleMirror )
+      {
+        for (uint dimension = 0; dimension <  this->features.size(); dimension++)
+        {
+          if ( this->features[dimension].checkSparsity( _feature[dimension] ) )
+            continue;
+
+          this->exampleDims.push_back ( dimension );
+          this->exampleValues.push_back ( _feature[dimension] );
+          if (_pf != NULL)
+            this->exampleTransformedValues.push_back ( _pf->f( dimension, _feature[dimension]) );
+          else
+            this->exampleTransformedValues.push_back ( _feature[dimension] );
+        }
+        this->exampleStart.push_back ( this->exampleDims.size() );
+      }
+
       this->ui_n++;
     }
     //  add a new feature and insert its elements at the end of each dimension vector
@@ -609,6 +693,25 @@ namespace NICE {
         else
           this->features[it->first].insert( (T) it->second, true /* _specifyFeatureNumber */, this->ui_n );
       }
+
+      // append the new example to the mirror, O(nnz_i)
+      if ( this->b_keepExampleMirror )
+      {
+        for (NICE::SparseVector::const_iterator it = _feature.begin(); it != _feature.end(); it++)
+        {
+          if ( this->features[it->first].checkSparsity( (T) it->second ) )
+            continue;
+
+          this->exampleDims.push_back ( it->first );
+          this->exampleValues.push_back ( (T) it->second );
+          if (_pf != NULL)
+            this->exampleTransformedValues.push_back ( _pf->f( it->first, (T) it->second) );
+          else
+            this->exampleTransformedValues.push_back ( (T) it->second );
+        }
+        this->exampleStart.push_back ( this->exampleDims.size() );
+      }
+
       this->ui_n++;
     }
 
@@ -628,13 +731,131 @@ namespace NICE {
       //pay attention: we assume now, that we have a vector (over dimensions) containing vectors over features (examples per dimension) - to be more efficient
       for (uint dim = 0; dim < this->ui_d; dim++)
       {
+          // add_feature with a sparse example only counts the examples in its non-zero dimensions
+          this->features[dim].setN( this->ui_n );
           this->features[dim].insert( _features[dim] );
       }
 
+      // append the new examples to the mirror, O(d) per example
+      if ( this->b_keepExampleMirror )
+      {
+        for (uint nr = 0; nr < _features[0].size(); nr++)
+        {
+          for (uint dim = 0; dim < this->ui_d; dim++)
+          {
+            if ( this->features[dim].checkSparsity( _features[dim][nr] ) )
+              continue;
+
+            this->exampleDims.push_back ( dim );
+            this->exampleValues.push_back ( _features[dim][nr] );
+            this->exampleTransformedValues.push_back ( _features[dim][nr] );
+          }
+          this->exampleStart.push_back ( this->exampleDims.size() );
+        }
+      }
+
       //update the number of our features
       this->ui_n += _features[0].size();
     }
 
+    //  append several sparse examples, every dimension is sorted and merged only once
+    template <typename T>
+    void FeatureMatrixT<T>::add_features(const std::vector< const NICE::SparseVector * > & _features,
+                                         const NICE::ParameterizedFunction *_pf
+                                        )
+    {
+      if ( _features.empty() )
+        return;
+
+      // the dimension of a sparse vector might not be set, its largest non-zero dimension has to fit in any case
+      uint dimMax ( 0 );
+      for (uint nr = 0; nr < _features.size(); nr++)
+      {
+        dimMax = std::max ( dimMax, (uint) _features[nr]->getDim() );
+        if ( !_features[nr]->empty() )
+          dimMax = std::max ( dimMax, (uint) _features[nr]->rbegin()->first + 1 );
+      }
+
+      if (this->ui_n == 0)
+      {
+        this->set_d( std::max ( dimMax, this->ui_d ) );
+      }
+
+      if ( dimMax > this->ui_d)
+      {
+        fthrow(Exception, "FeatureMatrixT<T>::add_features - number of dimensions does not fit");
+        return;
+      }
+
+      this->insertSparseExamples( _features, this->ui_n /* index of first new example */, _pf );
+
+      // append the new examples to the mirror, O(nnz_batch)
+      if ( this->b_keepExampleMirror )
+      {
+        for (uint nr = 0; nr < _features.size(); nr++)
+        {
+          for (NICE::SparseVector::const_iterator it = _features[nr]->begin(); it != _features[nr]->end(); it++)
+          {
+            if ( this->features[it->first].checkSparsity( (T) it->second ) )
+              continue;
+
+            this->exampleDims.push_back ( it->first );
+            this->exampleValues.push_back ( (T) it->second );
+            if (_pf != NULL)
+              this->exampleTransformedValues.push_back ( _pf->f( it->first, (T) it->second) );
+            else
+              this->exampleTransformedValues.push_back ( (T) it->second );
+          }
+          this->exampleStart.push_back ( this->exampleDims.size() );
+        }
+      }
+
+      this->ui_n += _features.size();
+
+      //set n for the internal data structure SortedVectorSparse
+      for (typename std::vector<NICE::SortedVectorSparse<T> >::iterator it = this->features.begin(); it != this->features.end(); it++)
+        (*it).setN( this->ui_n );
+    }
+
+    //  remove several examples, every dimension is compacted with a single pass
+    template <typename T>
+    void FeatureMatrixT<T>::remove_features(const std::vector< uint > & _indices )
+    {
+      if ( _indices.empty() )
+        return;
+
+      // new index for every example, negative for the removed ones
+      std::vector< int > newIndices ( this->ui_n, 0 );
+      for (uint i = 0; i < _indices.size(); i++)
+      {
+        if ( _indices[i] >= this->ui_n )
+        {
+          fthrow(Exception, "FeatureMatrixT<T>::remove_features - index " << _indices[i] << " exceeds the number of examples " << this->ui_n);
+          return;
+        }
+        newIndices[ _indices[i] ] = -1;
+      }
+
+      uint nNew ( 0 );
+      for (uint i = 0; i < this->ui_n; i++)
+      {
+        if ( newIndices[i] < 0 )
+          continue;
+        newIndices[i] = nNew;
+        nNew++;
+      }
+
+      for (uint dim = 0; dim < this->ui_d; dim++)
+      {
+        this->features[dim].removeMultiple( newIndices, nNew );
+      }
+
+      this->ui_n = nNew;
+
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirror();
+    }
+
     template <typename T>
     void FeatureMatrixT<T>::set_features(const std::vector<std::vector<T> > & _features,
                                          std::vector<std::vector<uint> > & _permutations,
@@ -653,6 +874,9 @@ namespace NICE {
         this->features[dim].insert( _features[dim] );
       }
 
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirror();
+
       this->getPermutations( _permutations );
     }
 
@@ -674,6 +898,9 @@ namespace NICE {
         this->features[dim].insert( _features[dim] );
       }
 
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirror();
+
       this->getPermutations( _permutations );
     }
 
@@ -698,6 +925,9 @@ namespace NICE {
 
         this->features[dim].insert( _features[dim] );
       }
+
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirror();
     }
 
     template <typename T>
@@ -763,22 +993,9 @@ namespace NICE {
       {
         if ( this->b_debug )
           std::cerr << "FeatureMatrixT<T>::set_features " << this->ui_n << " new examples" << std::endl;
-        //loop over every example to add its content
-        for (uint nr = 0; nr < this->ui_n; nr++)
-        {
-          if ( this->b_debug )
-            std::cerr << "add feature nr. " << nr << " / " << _features.size() << " ";
-          //loop over every dimension to add the specific value to the corresponding SortedVectorSparse
-          for (NICE::SparseVector::const_iterator elemIt = _features[nr]->begin(); elemIt != _features[nr]->end(); elemIt++)
-          {
-            if ( this->b_debug )
-              std::cerr << elemIt->first << "-" << elemIt->second << " ";
-            //elemIt->first: dim, elemIt->second: value
-            this->features[elemIt->first].insert( (T) elemIt->second, true /* _specifyFeatureNumber */, nr);
-          }//for non-zero-values of the feature
-          if ( this->b_debug )
-            std::cerr << std::endl;
-        }//for every new feature
+
+        this->insertSparseExamples( _features, 0 /* index of first example */ );
+
         if ( this->b_debug )
           std::cerr << "FeatureMatrixT<T>::set_features done" << std::endl;
       }//if dimOverEx
@@ -786,6 +1003,45 @@ namespace NICE {
       //set n for the internal data structure SortedVectorSparse
       for (typename std::vector<NICE::SortedVectorSparse<T> >::iterator it = this->features.begin(); it != this->features.end(); it++)
         (*it).setN( this->ui_n );
+
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirror();
+    }
+
+    template <typename T>
+    void FeatureMatrixT<T>::insertSparseExamples( const std::vector< const NICE::SparseVector * > & _features,
+                                                  const uint & _indexOffset,
+                                                  const NICE::ParameterizedFunction * _pf
+                                                )
+    {
+      // collect all non-zero values per dimension first, such that every dimension
+      // has to be sorted and merged only once
+      std::vector< std::vector< std::pair< T, typename SortedVectorSparse<T>::dataelement > > > newElementsPerDim ( this->ui_d );
+
+      //loop over every example to add its content
+      for (uint nr = 0; nr < _features.size(); nr++)
+      {
+        if ( this->b_debug )
+          std::cerr << "add feature nr. " << nr << " / " << _features.size() << " ";
+        //loop over every dimension to add the specific value to the corresponding SortedVectorSparse
+        for (NICE::SparseVector::const_iterator elemIt = _features[nr]->begin(); elemIt != _features[nr]->end(); elemIt++)
+        {
+          if ( this->b_debug )
+            std::cerr << elemIt->first << "-" << elemIt->second << " ";
+          //elemIt->first: dim, elemIt->second: value
+          T transformedValue ( (T) elemIt->second );
+          if ( _pf != NULL )
+            transformedValue = _pf->f( elemIt->first, (T) elemIt->second );
+          newElementsPerDim[elemIt->first].push_back( std::pair< T, typename SortedVectorSparse<T>::dataelement > ( (T) elemIt->second, typename SortedVectorSparse<T>::dataelement ( _indexOffset + nr, transformedValue ) ) );
+        }//for non-zero-values of the feature
+        if ( this->b_debug )
+          std::cerr << std::endl;
+      }//for every new feature
+
+      for (uint dim = 0; dim < this->ui_d; dim++)
+      {
+        this->features[dim].insertMultiple( newElementsPerDim[dim] );
+      }
     }
 
     template <typename T>
@@ -837,14 +1093,16 @@ namespace NICE {
       uint dimIdx(0);
       for (typename std::vector<NICE::SortedVectorSparse<T> >::const_iterator it = this->features.begin(); it != this->features.end(); it++, dimIdx++)
       {
-        std::map< uint, typename NICE::SortedVectorSparse<T>::elementpointer>  nonzeroIndices= (*it).nonzeroIndices();
-        for (typename std::map< uint, typename NICE::SortedVectorSparse<T>::elementpointer>::const_iterator inIt = nonzeroIndices.begin(); inIt != nonzeroIndices.end(); inIt++)
+        const SortedNonzeroElements<T> & nonzeroElements = (*it).nonzeroElements();
+        const uint * indices = nonzeroElements.getIndices();
+        const T * transformedValues = nonzeroElements.getTransformedValues();
+        for ( uint i = 0; i < nonzeroElements.size(); i++ )
         {
-          uint featIndex = ((*inIt).second)->second.first;
+          uint featIndex = indices[i];
           if ( _transpose )
-            _matrix(featIndex,dimIdx) =((*inIt).second)->second.second;
+            _matrix(featIndex,dimIdx) = transformedValues[i];
           else
-            _matrix(dimIdx,featIndex) =((*inIt).second)->second.second;
+            _matrix(dimIdx,featIndex) = transformedValues[i];
         }
       }
     }
@@ -870,14 +1128,16 @@ namespace NICE {
       uint dimIdx(0);
       for (typename std::vector<NICE::SortedVectorSparse<T> >::const_iterator it = this->features.begin(); it != this->features.end(); it++, dimIdx++)
       {
-        std::map< uint, typename NICE::SortedVectorSparse<T>::elementpointer>  nonzeroIndices= (*it).nonzeroIndices();
-        for (typename std::map< uint, typename NICE::SortedVectorSparse<T>::elementpointer>::const_iterator inIt = nonzeroIndices.begin(); inIt != nonzeroIndices.end(); inIt++)
+        const SortedNonzeroElements<T> & nonzeroElements = (*it).nonzeroElements();
+        const uint * indices = nonzeroElements.getIndices();
+        const T * transformedValues = nonzeroElements.getTransformedValues();
+        for ( uint i = 0; i < nonzeroElements.size(); i++ )
         {
-          uint featIndex = ((*inIt).second)->second.first;
+          uint featIndex = indices[i];
           if ( _transpose )
-            _matrix[featIndex][dimIdx] =((*inIt).second)->second.second;
+            _matrix[featIndex][dimIdx] = transformedValues[i];
           else
-            _matrix[dimIdx][featIndex] =((*inIt).second)->second.second;
+            _matrix[dimIdx][featIndex] = transformedValues[i];
         }
       }
     }
@@ -920,24 +1180,25 @@ namespace NICE {
     }
 
     template <typename T>
-    void FeatureMatrixT<T>::hikDiagonalElements( Vector & _diagonalElements ) const
+    void FeatureMatrixT<T>::hikDiagonalElements( Vector & _diagonalElements,
+                                                 const NICE::ParameterizedFunction *_transformView
+                                               ) const
     {
       uint dimIdx = 0;
       // the function calculates the diagonal elements of a HIK kernel matrix
       _diagonalElements.resize(this->ui_n);
       _diagonalElements.set(0.0);
+      std::vector<T> transformedBuffer;
       // loop through all dimensions
       for (typename std::vector<NICE::SortedVectorSparse<T> >::const_iterator it = this->features.begin(); it != this->features.end(); it++, dimIdx++)
       {
-        std::map< uint, typename NICE::SortedVectorSparse<T>::elementpointer>  nonzeroIndices= (*it).nonzeroIndices();
+        const SortedNonzeroElements<T> & nonzeroElements = (*it).nonzeroElements();
+        const uint * indices = nonzeroElements.getIndices();
+        const T * transformedValues = this->getTransformedValues ( dimIdx, _transformView, transformedBuffer );
         // loop through all features
-        for (typename std::map< uint, typename NICE::SortedVectorSparse<T>::elementpointer>::const_iterator inIt = nonzeroIndices.begin(); inIt != nonzeroIndices.end(); inIt++)
+        for ( uint i = 0; i < nonzeroElements.size(); i++ )
         {
-          uint index = inIt->first;
-          typename NICE::SortedVectorSparse<T>::elementpointer p = inIt->second;
-          typename NICE::SortedVectorSparse<T>::dataelement de = p->second;
-
-          _diagonalElements[index] += de.second;
+          _diagonalElements[ indices[i] ] += transformedValues[i];
         }
       }
     }
@@ -969,6 +1230,166 @@ namespace NICE {
     }
 
 
+    template <typename T>
+    void FeatureMatrixT<T>::setKeepExampleMirror ( const bool & _keepExampleMirror )
+    {
+      this->b_keepExampleMirror = _keepExampleMirror;
+
+      if ( this->b_keepExampleMirror )
+      {
+        this->updateExampleMirror();
+      }
+      else
+      {
+        // release the memory
+        std::vector<uint>().swap ( this->exampleStart );
+        std::vector<uint>().swap ( this->exampleDims );
+        std::vector<T>().swap ( this->exampleValues );
+        std::vector<T>().swap ( this->exampleTransformedValues );
+      }
+    }
+
+    template <typename T>
+    bool FeatureMatrixT<T>::getKeepExampleMirror ( ) const
+    {
+      return this->b_keepExampleMirror;
+    }
+
+    template <typename T>
+    void FeatureMatrixT<T>::updateExampleMirror ( )
+    {
+      this->computeExampleMirror ( this->exampleStart, this->exampleDims, this->exampleValues, this->exampleTransformedValues );
+    }
+
+    template <typename T>
+    void FeatureMatrixT<T>::updateExampleMirrorElement ( const uint & _dim,
+                                                         const uint & _example
+                                                       )
+    {
+      // the dimensions of an example are increasing, such that the entry is found by a binary search within its row
+      std::vector<uint>::iterator rowBegin = this->exampleDims.begin() + this->exampleStart[_example];
+      std::vector<uint>::iterator rowEnd   = this->exampleDims.begin() + this->exampleStart[_example+1];
+      std::vector<uint>::iterator entry    = std::lower_bound ( rowBegin, rowEnd, _dim );
+      uint pos ( entry - this->exampleDims.begin() );
+      bool inMirror ( ( entry != rowEnd ) && ( *entry == _dim ) );
+
+      uint nzPos;
+      if ( this->features[_dim].getNonZeroPosition ( _example, nzPos ) )
+      {
+        const SortedNonzeroElements<T> & nonzeroElements = this->features[_dim].nonzeroElements();
+        T value            = nonzeroElements.getValues()[nzPos];
+        T transformedValue = nonzeroElements.getTransformedValues()[nzPos];
+
+        if ( inMirror )
+        {
+          this->exampleValues[pos]            = value;
+          this->exampleTransformedValues[pos] = transformedValue;
+          return;
+        }
+
+        // zero became non-zero
+        this->exampleDims.insert ( entry, _dim );
+        this->exampleValues.insert ( this->exampleValues.begin() + pos, value );
+        this->exampleTransformedValues.insert ( this->exampleTransformedValues.begin() + pos, transformedValue );
+        for ( uint i = _example + 1; i < this->exampleStart.size(); i++ )
+          this->exampleStart[i]++;
+      }
+      else if ( inMirror )
+      {
+        // non-zero became zero
+        this->exampleDims.erase ( entry );
+        this->exampleValues.erase ( this->exampleValues.begin() + pos );
+        this->exampleTransformedValues.erase ( this->exampleTransformedValues.begin() + pos );
+        for ( uint i = _example + 1; i < this->exampleStart.size(); i++ )
+          this->exampleStart[i]--;
+      }
+    }
+
+    template <typename T>
+    uint FeatureMatrixT<T>::getExample ( const uint & _example,
+                                         const uint * & _dims,
+                                         const T * & _values,
+                                         const T * & _transformedValues
+                                       ) const
+    {
+      if ( !this->b_keepExampleMirror )
+        fthrow(Exception, "FeatureMatrixT<T>::getExample -- no example mirror available, call setKeepExampleMirror(true) first");
+
+      if ( _example >= this->ui_n )
+        fthrow(Exception, "FeatureMatrixT<T>::getExample -- example index out of bounds");
+
+      uint start = this->exampleStart[_example];
+      uint nnz   = this->exampleStart[_example+1] - start;
+
+      _dims              = ( nnz > 0 ) ? &(this->exampleDims[start]) : NULL;
+      _values            = ( nnz > 0 ) ? &(this->exampleValues[start]) : NULL;
+      _transformedValues = ( nnz > 0 ) ? &(this->exampleTransformedValues[start]) : NULL;
+
+      return nnz;
+    }
+
+    template <typename T>
+    void FeatureMatrixT<T>::getExampleMirror ( std::vector<uint> & _exampleStart,
+                                               std::vector<uint> & _dims,
+                                               std::vector<T> & _values,
+                                               std::vector<T> & _transformedValues
+                                             ) const
+    {
+      if ( this->b_keepExampleMirror )
+      {
+        _exampleStart      = this->exampleStart;
+        _dims              = this->exampleDims;
+        _values            = this->exampleValues;
+        _transformedValues = this->exampleTransformedValues;
+      }
+      else
+      {
+        this->computeExampleMirror ( _exampleStart, _dims, _values, _transformedValues );
+      }
+    }
+
+    template <typename T>
+    void FeatureMatrixT<T>::computeExampleMirror ( std::vector<uint> & _exampleStart,
+                                                   std::vector<uint> & _dims,
+                                                   std::vector<T> & _values,
+                                                   std::vector<T> & _transformedValues
+                                                 ) const
+    {
+      // count the non-zero elements of every example
+      _exampleStart.assign ( this->ui_n + 1, 0 );
+      for ( uint dim = 0; dim < this->ui_d; dim++ )
+      {
+        const SortedNonzeroElements<T> & nonzeroElements = this->features[dim].nonzeroElements();
+        const uint * indices = nonzeroElements.getIndices();
+        for ( uint cnt = 0; cnt < nonzeroElements.size(); cnt++ )
+          _exampleStart[ indices[cnt] + 1 ]++;
+      }
+      for ( uint i = 0; i < this->ui_n; i++ )
+        _exampleStart[i+1] += _exampleStart[i];
+
+      // scatter the elements, looping over the dimensions in increasing order keeps every example sorted by dimension
+      uint nnz = _exampleStart[ this->ui_n ];
+      _dims.resize ( nnz );
+      _values.resize ( nnz );
+      _transformedValues.resize ( nnz );
+
+      std::vector<uint> fillPosition ( _exampleStart.begin(), _exampleStart.end() - 1 );
+      for ( uint dim = 0; dim < this->ui_d; dim++ )
+      {
+        const SortedNonzeroElements<T> & nonzeroElements = this->features[dim].nonzeroElements();
+        const uint * indices          = nonzeroElements.getIndices();
+        const T * values              = nonzeroElements.getValues();
+        const T * transformedValues   = nonzeroElements.getTransformedValues();
+        for ( uint cnt = 0; cnt < nonzeroElements.size(); cnt++ )
+        {
+          uint pos = fillPosition[ indices[cnt] ]++;
+          _dims[pos]              = dim;
+          _values[pos]            = values[cnt];
+          _transformedValues[pos] = transformedValues[cnt];
+        }
+      }
+    }
+
     template <typename T>
     void FeatureMatrixT<T>::restore ( std::istream & _is,
                                       int _format
@@ -1042,6 +1463,9 @@ namespace NICE {
           }
         }
 
+        // the mirror is not stored, but re-computed from the restored data
+        if ( this->b_keepExampleMirror )
+          this->updateExampleMirror();
       }
       else
       {
@@ -1092,6 +1516,81 @@ namespace NICE {
     void FeatureMatrixT<T>::clear ()
     {}
 
+    template <typename T>
+    void FeatureMatrixT<T>::storeBinary ( BinaryModelWriter & _writer,
+                                          const std::string & _prefix
+                                        ) const
+    {
+      std::vector<uint> size ( 2 );
+      size[0] = this->ui_n;
+      size[1] = this->ui_d;
+      _writer.addArrayCopy ( _prefix + "size", size );
+
+      std::vector<uint> nonZeros ( this->ui_d );
+      std::vector<T> tolerances ( this->ui_d );
+      for (uint dim = 0; dim < this->ui_d; dim++)
+      {
+        const SortedNonzeroElements<T> & nz = this->features[dim].nonzeroElements();
+        nonZeros[dim] = nz.size();
+        tolerances[dim] = this->features[dim].getTolerance();
+
+        // sections are created even if all dimensions are empty
+        _writer.addArray ( _prefix + "values", nz.getValues(), nz.size() );
+        _writer.addArray ( _prefix + "indices", nz.getIndices(), nz.size() );
+        _writer.addArray ( _prefix + "transformedValues", nz.getTransformedValues(), nz.size() );
+      }
+      _writer.addArrayCopy ( _prefix + "nonZeros", nonZeros );
+      _writer.addArrayCopy ( _prefix + "tolerances", tolerances );
+    }
+
+    template <typename T>
+    void FeatureMatrixT<T>::restoreBinary ( const BinaryModelReader & _reader,
+                                            const std::string & _prefix
+                                          )
+    {
+      size_t count;
+      const uint * size = _reader.getArray<uint> ( _prefix + "size", count );
+      if ( count != 2 )
+        fthrow ( Exception, "FeatureMatrixT::restoreBinary: invalid section " << _prefix << "size" );
+      this->ui_n = size[0];
+      this->ui_d = size[1];
+
+      const uint * nonZeros = _reader.getArray<uint> ( _prefix + "nonZeros", count );
+      if ( count != this->ui_d )
+        fthrow ( Exception, "FeatureMatrixT::restoreBinary: number of dimensions (" << count << ") does not match " << this->ui_d );
+      const T * tolerances = _reader.getArray<T> ( _prefix + "tolerances", count );
+      if ( count != this->ui_d )
+        fthrow ( Exception, "FeatureMatrixT::restoreBinary: number of tolerances (" << count << ") does not match " << this->ui_d );
+
+      size_t totalNonZeros ( 0 );
+      for (uint dim = 0; dim < this->ui_d; dim++)
+        totalNonZeros += nonZeros[dim];
+
+      size_t countValues, countIndices, countTransformed;
+      const T * values = _reader.getArray<T> ( _prefix + "values", countValues );
+      const uint * indices = _reader.getArray<uint> ( _prefix + "indices", countIndices );
+      const T * transformedValues = _reader.getArray<T> ( _prefix + "transformedValues", countTransformed );
+      if ( ( countValues != totalNonZeros ) || ( countIndices != totalNonZeros ) || ( countTransformed != totalNonZeros ) )
+        fthrow ( Exception, "FeatureMatrixT::restoreBinary: sizes of the sorted arrays do not match the number of non-zero elements (" << totalNonZeros << ")" );
+
+      this->features.clear();
+      this->features.resize ( this->ui_d );
+      for (uint dim = 0; dim < this->ui_d; dim++)
+      {
+        this->features[dim].setN ( this->ui_n );
+        this->features[dim].setTolerance ( tolerances[dim] );
+        this->features[dim].assignSorted ( values, indices, transformedValues, nonZeros[dim] );
+
+        values += nonZeros[dim];
+        indices += nonZeros[dim];
+        transformedValues += nonZeros[dim];
+      }
+
+      // the mirror is not stored, but re-computed from the restored data
+      if ( this->b_keepExampleMirror )
+        this->updateExampleMirror();
+    }
+
 } // namespace
 
 // #endif
@@ -23,6 +23,7 @@ GMHIKernel::GMHIKernel( FastMinKernel *_fmk, ParameterizedFunction *_pf, const Q
   this->pf = _pf;
   verbose = false;
   useOldPreparation = false;
+  this->b_lazyTransform = false;
 
 }
 
@@ -42,12 +43,12 @@ void GMHIKernel::multiply (NICE::Vector & y, const NICE::Vector & x) const
       NICE::VVector A; 
       NICE::VVector B; 
       // prepare to calculate sum_i x_i K(x,x_i)
-      fmk->hik_prepare_alpha_multiplications(x, A, B);
+      fmk->hik_prepare_alpha_multiplications(x, A, B, this->transformView() );
       T = fmk->hik_prepare_alpha_multiplications_fast(A, B, this->q, pf);
     }
     else
     {
-      T = fmk->hikPrepareLookupTable(x, this->q, pf );
+      T = fmk->hikPrepareLookupTable(x, this->q, pf, this->transformView() );
     }
     fmk->hik_kernel_multiply_fast ( T, this->q, x, y ); 
     delete [] T;
@@ -57,7 +58,7 @@ void GMHIKernel::multiply (NICE::Vector & y, const NICE::Vector & x) const
     NICE::VVector A; 
     NICE::VVector B; 
     // prepare to calculate sum_i x_i K(x,x_i)
-    fmk->hik_prepare_alpha_multiplications(x, A, B);
+    fmk->hik_prepare_alpha_multiplications(x, A, B, this->transformView() );
     
     if (verbose)
     {
@@ -80,7 +81,21 @@ void GMHIKernel::multiply (NICE::Vector & y, const NICE::Vector & x) const
     // y = K * x
     //we only need x as input argument to add x*noise to beta
     //all necessary information for the "real" multiplication is already stored in y
-    fmk->hik_kernel_multiply(A, B, x, y);
+    fmk->hik_kernel_multiply(A, B, x, y, this->transformView() );
+  }
+}
+
+/** multiply with several vectors at once: A*X = Y */
+void GMHIKernel::multiplyBlock (NICE::Matrix & _Y, const NICE::Matrix & _X) const
+{
+  // with quantization, we would need a separate LUT for each column anyway
+  if ( this->q != NULL )
+  {
+    ImplicitKernelMatrix::multiplyBlock ( _Y, _X );
+  }
+  else
+  {
+    this->fmk->hik_kernel_multiply_block ( _X, _Y, this->transformView() );
   }
 }
 
@@ -109,6 +124,18 @@ void GMHIKernel::setUseOldPreparation( const bool & _useOldPreparation)
   useOldPreparation = _useOldPreparation;
 }
 
+void GMHIKernel::setLazyTransform( const bool & _lazyTransform )
+{
+  if ( _lazyTransform && ( this->pf != NULL ) && !this->pf->isOrderPreserving() )
+    fthrow(Exception, "GMHIKernel::setLazyTransform: the lazy mode needs an order preserving transformation");
+
+  // bring the stored features up to date
+  if ( this->b_lazyTransform && !_lazyTransform && ( this->pf != NULL ) )
+    fmk->applyFunctionToFeatureMatrix( pf );
+
+  this->b_lazyTransform = _lazyTransform;
+}
+
 uint GMHIKernel::getNumParameters() const 
 {
   if ( this->pf == NULL )
@@ -134,12 +161,14 @@ void GMHIKernel::setParameters( const NICE::Vector & parameters )
 
   pf->parameters() = parameters;
   
-  fmk->applyFunctionToFeatureMatrix( pf );
+  // in the lazy mode, the new parameters are used on the fly
+  if ( !this->b_lazyTransform )
+    fmk->applyFunctionToFeatureMatrix( pf );
 }
 
 void GMHIKernel::getDiagonalElements ( Vector & diagonalElements ) const
 {
-  fmk->featureMatrix().hikDiagonalElements(diagonalElements);
+  fmk->featureMatrix().hikDiagonalElements(diagonalElements, this->transformView() );
   // add sigma^2 I
   diagonalElements += fmk->getNoise();
 }
@@ -147,7 +176,7 @@ void GMHIKernel::getDiagonalElements ( Vector & diagonalElements ) const
 void GMHIKernel::getFirstDiagonalElement ( double & diagonalElement ) const
 {
   Vector diagonalElements;
-  fmk->featureMatrix().hikDiagonalElements(diagonalElements);
+  fmk->featureMatrix().hikDiagonalElements(diagonalElements, this->transformView() );
   diagonalElement = diagonalElements[0];
   // add sigma^2 I
   diagonalElement += fmk->getNoise();
@@ -187,6 +216,19 @@ Vector GMHIKernel::getParameterUpperBounds() const
   return pf->getParameterUpperBounds();
 }
 
+bool GMHIKernel::getBilinearFormGradient ( const NICE::Matrix & _U,
+                                           const NICE::Matrix & _V,
+                                           const NICE::Vector & _weights,
+                                           NICE::Vector & _gradient
+                                         ) const
+{
+  // the noise of the FastMinKernel does not depend on any parameter
+  if ( pf == NULL )
+    return ImplicitKernelMatrix::getBilinearFormGradient ( _U, _V, _weights, _gradient );
+
+  return fmk->hikBilinearFormGradient ( _U, _V, _weights, pf, _gradient );
+}
+
 double GMHIKernel::approxFrobNorm() const
 {
   return this->fmk->getFrobNormApprox();
@@ -216,3 +258,17 @@ void GMHIKernel::addMultipleExamples( const std::vector< const NICE::SparseVecto
 {
   //nothing has to be done here, the fmk-object got new examples already in outer struct (FMKGPHyperparameterOptimization)
 }
+
+void GMHIKernel::removeExample( const uint & exampleIndex,
+			       const bool & performOptimizationAfterDecrement
+			     )
+{
+  //nothing has to be done here, the examples were removed from the fmk-object already in outer struct (FMKGPHyperparameterOptimization)
+}
+
+void GMHIKernel::removeMultipleExamples( const std::vector< uint > & exampleIndices,
+					const bool & performOptimizationAfterDecrement
+				      )
+{
+  //nothing has to be done here, the examples were removed from the fmk-object already in outer struct (FMKGPHyperparameterOptimization)
+}
@@ -38,6 +38,12 @@ class GMHIKernel : public ImplicitKernelMatrix
     bool use_sparse_implementation;
     bool useOldPreparation;
 
+    /** if true, setParameters does not rewrite the feature matrix, pf is applied on the fly instead */
+    bool b_lazyTransform;
+
+    /** transformation which has to be applied on the fly by the FastMinKernel methods, or NULL */
+    const ParameterizedFunction * transformView() const { return this->b_lazyTransform ? this->pf : NULL; };
+
   public:
 
     /** simple constructor */
@@ -46,6 +52,9 @@ class GMHIKernel : public ImplicitKernelMatrix
     /** multiply with a vector: A*x = y */
     virtual void multiply (NICE::Vector & y, const NICE::Vector & x) const;
 
+    /** multiply with several vectors at once: A*X = Y (single pass over the data if no quantization is used) */
+    virtual void multiplyBlock (NICE::Matrix & _Y, const NICE::Matrix & _X) const;
+
     /** get the number of rows in A */
     virtual uint rows () const;
 
@@ -67,14 +76,39 @@ class GMHIKernel : public ImplicitKernelMatrix
     Vector getParameterLowerBounds() const;
     Vector getParameterUpperBounds() const;
 
+    /**
+    * @brief gradient with respect to the parameters of pf, see ImplicitKernelMatrix::getBilinearFormGradient.
+    * The derivatives are computed from the original feature values, i.e., independently of the lazy mode.
+    * With quantization, this is the gradient of the exact kernel matrix, whose multiplications are approximated.
+    */
+    virtual bool getBilinearFormGradient ( const NICE::Matrix & _U,
+                                           const NICE::Matrix & _V,
+                                           const NICE::Vector & _weights,
+                                           NICE::Vector & _gradient
+                                         ) const;
+
     void setVerbose( const bool & _verbose);
     void setUseOldPreparation( const bool & _useOldPreparation);
+
+    /**
+    * @brief Switch between rewriting the transformed features in setParameters (default) and
+    * transforming them on the fly in every multiplication (lazy). The lazy mode leaves the stored
+    * transformed values of the FastMinKernel untouched, such that several kernel objects with their own
+    * parameterized functions can share a single FastMinKernel. Each multiplication has to evaluate pf
+    * for all non-zero elements then, which only pays off if few multiplications are needed per parameter.
+    * When the lazy mode is switched off, the features are transformed with the current parameters.
+    * @pre pf is order preserving
+    */
+    void setLazyTransform( const bool & _lazyTransform );
+    bool getLazyTransform( ) const { return this->b_lazyTransform; };
     
     virtual double approxFrobNorm() const;
     virtual void setApproximationScheme(const int & _approxScheme);
     
     void setFastMinKernel(NICE::FastMinKernel * _fmk){fmk = _fmk;};
     
+    const Quantization * getQuantization() const { return q; };
+    
     ///////////////////// INTERFACE PERSISTENT /////////////////////
     // interface specific methods for store and restore
     ///////////////////// INTERFACE PERSISTENT /////////////////////
@@ -97,6 +131,14 @@ class GMHIKernel : public ImplicitKernelMatrix
 				      const NICE::Vector & newLabels,
 				      const bool & performOptimizationAfterIncrement = true
 				    );     
+
+    virtual void removeExample( const uint & exampleIndex,
+				const bool & performOptimizationAfterDecrement = true
+			      );
+
+    virtual void removeMultipleExamples( const std::vector< uint > & exampleIndices,
+					 const bool & performOptimizationAfterDecrement = true
+				       );
      
 };
 
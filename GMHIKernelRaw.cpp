@@ -5,8 +5,14 @@
 * @date 01/02/2012
 
 */
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
+#ifdef NICE_USELIB_OPENMP
+#include <omp.h>
+#endif
+
 #include <core/vector/VVector.h>
 #include <core/basics/Timer.h>
 
@@ -28,10 +34,27 @@ GMHIKernelRaw::GMHIKernelRaw( const std::vector< const NICE::SparseVector *> &_e
     this->table_T = NULL;
     this->d_noise = _d_noise;
     this->q       = _q;
+    this->ui_numThreads = 1;
 
     this->initData(_examples);
 }
 
+GMHIKernelRaw::GMHIKernelRaw( const double _d_noise,
+                              NICE::Quantization * _q
+                            )
+{
+    this->examples_raw = NULL;
+    this->nnz_per_dimension = NULL;
+    this->table_A = NULL;
+    this->table_B = NULL;
+    this->table_T = NULL;
+    this->num_dimension = 0;
+    this->num_examples = 0;
+    this->d_noise = _d_noise;
+    this->q       = _q;
+    this->ui_numThreads = 1;
+}
+
 GMHIKernelRaw::~GMHIKernelRaw()
 {
     this->cleanupData();
@@ -223,10 +246,44 @@ void GMHIKernelRaw::copyTableT(double *_src, double *_dst) const
   }
 }
 
-void GMHIKernelRaw::updateTablesAandB ( const NICE::Vector _x ) const
+int GMHIKernelRaw::getEffectiveNumberOfThreads () const
+{
+#ifdef NICE_USELIB_OPENMP
+    // called from within a parallel region (e.g., one thread per class), stay sequential
+    if ( omp_in_parallel() )
+        return 1;
+    if ( this->ui_numThreads == 0 )
+        return omp_get_max_threads();
+#endif
+    return std::max<int> ( 1, this->ui_numThreads );
+}
+
+uint GMHIKernelRaw::getNumberOfDimensionsPerChunk () const
+{
+    // every chunk covers about 4*n non-zero elements, such that adding its partial result (O(n))
+    // is cheap compared to its computation
+    double nnz ( 0.0 );
+    for ( uint dim = 0; dim < this->num_dimension; dim++ )
+      nnz += this->nnz_per_dimension[dim];
+
+    double dimsPerChunk ( this->num_dimension );
+    if ( nnz > 0.0 )
+      dimsPerChunk = ceil ( 4.0 * this->num_examples * this->num_dimension / nnz );
+
+    return (uint) std::max<double> ( 1.0, std::min<double> ( dimsPerChunk, this->num_dimension ) );
+}
+
+void GMHIKernelRaw::computeTablesAandB ( const NICE::Vector & _x,
+                                         double ** _tableA,
+                                         double ** _tableB
+                                       ) const
 {
     // start the actual computations of A, B, and optionally T
-    for (uint dim = 0; dim < this->num_dimension; dim++)
+    // every dimension only touches its own rows of A and B
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel for num_threads( this->getEffectiveNumberOfThreads() ) schedule( dynamic )
+#endif
+    for (int dim = 0; dim < (int) this->num_dimension; dim++)
     {
       double alpha_sum         = 0.0;
       double alpha_times_x_sum = 0.0;
@@ -249,13 +306,21 @@ void GMHIKernelRaw::updateTablesAandB ( const NICE::Vector _x ) const
         alpha_times_x_sum += _x[index] * elem;
         alpha_sum         += _x[index];
         
-        this->table_A[dim][cntNonzeroFeat] = alpha_times_x_sum;        
-        this->table_B[dim][cntNonzeroFeat] = alpha_sum;
+        _tableA[dim][cntNonzeroFeat] = alpha_times_x_sum;        
+        _tableB[dim][cntNonzeroFeat] = alpha_sum;
       }      
     }
 }
 
-void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
+void GMHIKernelRaw::updateTablesAandB ( const NICE::Vector _x ) const
+{
+    this->computeTablesAandB ( _x, this->table_A, this->table_B );
+}
+
+void GMHIKernelRaw::computeTableT ( double ** _tableA,
+                                    double ** _tableB,
+                                    double * _tableT
+                                  ) const
 {
     // sanity check
     if ( this->q == NULL)
@@ -285,6 +350,10 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
       }
     }
 
+    // sorted values of the current dimension and their bins
+    std::vector<double> valuesOfDim;
+    std::vector<uint> binsOfDim;
+
     // start the actual computation of  T
     for (uint dim = 0; dim < this->num_dimension; dim++)
     {
@@ -292,7 +361,7 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
 
       if ( nnz == 0 )
       {
-          double * itT = this->table_T + dim*hmax;
+          double * itT = _tableT + dim*hmax;
           for ( uint idxProto = 0; idxProto < hmax; idxProto++, itT++ )
           {
               *itT = 0;
@@ -300,21 +369,21 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
           continue;
       }
 
-        uint idxProtoElem; // denotes the bin number in dim i of a quantized example, previously termed qBin
-
-        sparseVectorElement * i            = examples_raw[dim];
-        sparseVectorElement * iPredecessor = examples_raw[dim];
+        // all non-zero elements of this dimension are quantized at once
+        valuesOfDim.resize ( nnz );
+        binsOfDim.resize ( nnz );
+        for ( uint k = 0; k < nnz; k++ )
+          valuesOfDim[k] = examples_raw[dim][k].value;
+        this->q->quantize ( &(valuesOfDim[0]), dim, &(binsOfDim[0]), nnz );
 
         // index of the element, which is always bigger than the current value fval
         int indexElem = 0;
-        // element of the feature
-        double elem = i->value;
-        
-        idxProtoElem = this->q->quantize ( elem, dim );
+
+        uint idxProtoElem = binsOfDim[0]; // denotes the bin number in dim i of a quantized example, previously termed qBin
 
         uint idxProto;
         double * itProtoVal = prototypes + dim*hmax;
-        double * itT = this->table_T + dim*hmax;
+        double * itT = _tableT + dim*hmax;
         
         // special case 1:
         // loop over all prototypes smaller then the smallest quantized example in this dimension
@@ -322,7 +391,7 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
         {
           // current prototype is smaller than all known examples
           // -> resulting value = fval * sum_l=1^n alpha_l          
-          (*itT) = (*itProtoVal) * ( this->table_B[ dim ][ nnz-1 ] );          
+          (*itT) = (*itProtoVal) * ( _tableB[ dim ][ nnz-1 ] );          
         }//for-loop over prototypes -- special case 1
 
         // standard case: prototypes larger then the smallest element, but smaller then the largest one in the corrent dimension        
@@ -333,14 +402,7 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
             while ( (idxProto >= idxProtoElem) && ( indexElem < ( nnz - 1 ) ) ) //(this->ui_n-1-nrZeroIndices)) )
             {
               indexElem++;
-              iPredecessor = i;
-              i++;
-
-              // only quantize if value changed
-              if ( i->value !=  iPredecessor->value )
-              {
-                idxProtoElem = this->q->quantize ( i->value, dim );
-              }
+              idxProtoElem = binsOfDim[indexElem];
             }
             
             // did we looped over the largest element in this dimension?
@@ -349,7 +411,7 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
               break;
             }
 
-            (*itT) = table_A[ dim ][ indexElem-1 ] + (*itProtoVal)*( table_B[ dim ][ nnz-1 ] - table_B[ dim ][ indexElem-1 ] );
+            (*itT) = _tableA[ dim ][ indexElem-1 ] + (*itProtoVal)*( _tableB[ dim ][ nnz-1 ] - _tableB[ dim ][ indexElem-1 ] );
         }//for-loop over prototypes -- standard case 
             
         // special case 2:
@@ -358,7 +420,7 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
 
         for ( ; idxProto < hmax; idxProto++, itProtoVal++, itT++)
         {
-          (*itT) = table_A[ dim ][ indexElem ];
+          (*itT) = _tableA[ dim ][ indexElem ];
         }//for-loop over prototypes -- special case 2
         
     }//for-loop over dimensions
@@ -379,36 +441,69 @@ void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
 //    std::cerr << std::endl;
 }
 
+void GMHIKernelRaw::updateTableT ( const NICE::Vector _x ) const
+{
+    this->computeTableT ( this->table_A, this->table_B, this->table_T );
+}
+
+void GMHIKernelRaw::computeLookupTables ( const NICE::Vector & _x,
+                                          double ** & _tableA,
+                                          double ** & _tableB,
+                                          double * & _tableT
+                                        ) const
+{
+    _tableA = this->allocateTableAorB();
+    _tableB = this->allocateTableAorB();
+    this->computeTablesAandB ( _x, _tableA, _tableB );
+
+    _tableT = NULL;
+    if ( this->q != NULL )
+    {
+      _tableT = this->allocateTableT();
+      this->computeTableT ( _tableA, _tableB, _tableT );
+    }
+}
+
 /** multiply with a vector: A*x = y */
 void GMHIKernelRaw::multiply (NICE::Vector & _y, const NICE::Vector & _x) const
 {
-  // STEP 1: initialize tables A and B
-  this->updateTablesAandB(_x);
+  if ( _x.size() != this->num_examples )
+    fthrow(Exception, "GMHIKernelRaw::multiply: size of the vector (" << _x.size() << ") does not fit to the number of examples (" << this->num_examples << ")" );
 
   _y.resize( this->num_examples );
   _y.set(0.0);
 
-  for (uint dim = 0; dim < this->num_dimension; dim++)
+  // tables A and B are computed on the fly for every dimension in a local buffer
+  // (see multiplyBlockDimension with a single column), such that concurrent calls
+  // for different vectors do not interfere with each other
+  // The dimensions are split into chunks which only depend on the data, every chunk is accumulated
+  // into its own partial result, and the partial results are added up in the order of the chunks.
+  // Therefore, the result does neither depend on the number of threads nor on the scheduling.
+  uint dimsPerChunk = this->getNumberOfDimensionsPerChunk();
+  int numChunks = ( this->num_dimension + dimsPerChunk - 1 ) / dimsPerChunk;
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel num_threads( this->getEffectiveNumberOfThreads() )
+#endif
   {
-    uint nnz = this->nnz_per_dimension[dim];
-    uint nz  = this->num_examples - nnz;
+    NICE::Vector yChunk ( this->num_examples );
+    std::vector<double> partialSums;
 
-    if ( nnz == 0 ) {
-      // all values are zero in this dimension :) and we can simply ignore the feature
-      continue;
-    }
-
-    sparseVectorElement *training_values_in_dim = examples_raw[dim];
-    for ( uint cntNonzeroFeat = 0; cntNonzeroFeat < nnz; cntNonzeroFeat++, training_values_in_dim++ )
+#ifdef NICE_USELIB_OPENMP
+#pragma omp for schedule( dynamic ) ordered
+#endif
+    for (int chunk = 0; chunk < numChunks; chunk++)
     {
-      uint feat = training_values_in_dim->example_index;
-      uint inversePosition = cntNonzeroFeat;
-      double fval = training_values_in_dim->value;
-
-      double firstPart = this->table_A[dim][inversePosition];
-      double secondPart = this->table_B[dim][nnz-1] - this->table_B[dim][inversePosition];
+      yChunk.set ( 0.0 );
+      uint dimEnd = std::min<uint> ( ( chunk + 1 ) * dimsPerChunk, this->num_dimension );
+      for (uint dim = chunk * dimsPerChunk; dim < dimEnd; dim++)
+      {
+        this->multiplyBlockDimension ( dim, 1, _x.getDataPointer(), yChunk.getDataPointer(), partialSums );
+      }
 
-      _y[feat] += firstPart + fval * secondPart;
+#ifdef NICE_USELIB_OPENMP
+#pragma omp ordered
+#endif
+      _y += yChunk;
     }
   }
 
@@ -418,6 +513,124 @@ void GMHIKernelRaw::multiply (NICE::Vector & _y, const NICE::Vector & _x) const
 
 }
 
+void GMHIKernelRaw::multiplyBlockDimension ( const uint & _dim,
+                                             const uint & _m,
+                                             const double * _xRows,
+                                             double * _yRows,
+                                             std::vector<double> & _partialSums
+                                           ) const
+{
+    uint nnz = this->nnz_per_dimension[_dim];
+
+    if ( nnz == 0 )
+      return;
+
+    // layout of the buffer: A (nnz x m) followed by B (nnz x m)
+    if ( _partialSums.size() < 2*nnz*_m )
+      _partialSums.resize ( 2*nnz*_m );
+    double * A = &(_partialSums[0]);
+    double * B = A + nnz*_m;
+
+    // first pass: tables A and B for all m columns, see computeTablesAandB
+    sparseVectorElement *training_values_in_dim = examples_raw[_dim];
+    double * itA = A;
+    double * itB = B;
+    for ( uint cntNonzeroFeat = 0; cntNonzeroFeat < nnz; cntNonzeroFeat++, training_values_in_dim++, itA += _m, itB += _m )
+    {
+      const double * x = _xRows + training_values_in_dim->example_index * _m;
+      double elem      = training_values_in_dim->value;
+      if ( cntNonzeroFeat == 0 )
+      {
+        for ( uint c = 0; c < _m; c++ )
+        {
+          itA[c] = x[c] * elem;
+          itB[c] = x[c];
+        }
+      }
+      else
+      {
+        const double * prevA = itA - _m;
+        const double * prevB = itB - _m;
+        for ( uint c = 0; c < _m; c++ )
+        {
+          itA[c] = prevA[c] + x[c] * elem;
+          itB[c] = prevB[c] + x[c];
+        }
+      }
+    }
+
+    // second pass: scatter the results
+    const double * alpha_sum = B + (nnz-1)*_m;
+    training_values_in_dim = examples_raw[_dim];
+    itA = A;
+    itB = B;
+    for ( uint cntNonzeroFeat = 0; cntNonzeroFeat < nnz; cntNonzeroFeat++, training_values_in_dim++, itA += _m, itB += _m )
+    {
+      double * y  = _yRows + training_values_in_dim->example_index * _m;
+      double fval = training_values_in_dim->value;
+      for ( uint c = 0; c < _m; c++ )
+      {
+        y[c] += itA[c] + fval * ( alpha_sum[c] - itB[c] );
+      }
+    }
+}
+
+void GMHIKernelRaw::multiplyBlock ( NICE::Matrix & _Y, const NICE::Matrix & _X ) const
+{
+  uint m = _X.cols();
+
+  if ( _X.rows() != this->num_examples )
+    fthrow(Exception, "GMHIKernelRaw::multiplyBlock: number of rows (" << _X.rows() << ") does not fit to the number of examples (" << this->num_examples << ")" );
+
+  _Y.resize ( this->num_examples, m );
+
+  if ( m == 0 )
+    return;
+
+  // store X example-wise, such that all columns belonging to a single example are
+  // located next to each other during the loop over the sorted features
+  std::vector<double> xRows ( this->num_examples * m );
+  for ( uint i = 0; i < this->num_examples; i++ )
+    for ( uint c = 0; c < m; c++ )
+      xRows[i*m + c] = _X(i,c);
+
+  std::vector<double> yRows ( this->num_examples * m, 0.0 );
+
+  // see multiply for the parallelization scheme
+  uint dimsPerChunk = this->getNumberOfDimensionsPerChunk();
+  int numChunks = ( this->num_dimension + dimsPerChunk - 1 ) / dimsPerChunk;
+#ifdef NICE_USELIB_OPENMP
+#pragma omp parallel num_threads( this->getEffectiveNumberOfThreads() )
+#endif
+  {
+    std::vector<double> yChunk ( this->num_examples * m );
+    std::vector<double> partialSums;
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp for schedule( dynamic ) ordered
+#endif
+    for (int chunk = 0; chunk < numChunks; chunk++)
+    {
+      std::fill ( yChunk.begin(), yChunk.end(), 0.0 );
+      uint dimEnd = std::min<uint> ( ( chunk + 1 ) * dimsPerChunk, this->num_dimension );
+      for (uint dim = chunk * dimsPerChunk; dim < dimEnd; dim++)
+      {
+        this->multiplyBlockDimension ( dim, m, &(xRows[0]), &(yChunk[0]), partialSums );
+      }
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp ordered
+#endif
+      for ( uint i = 0; i < yChunk.size(); i++ )
+        yRows[i] += yChunk[i];
+    }
+  }
+
+  for ( uint i = 0; i < this->num_examples; i++ )
+    for ( uint c = 0; c < m; c++ )
+      _Y(i,c) = yRows[i*m + c] + this->d_noise * xRows[i*m + c];
+}
+
 /** get the number of rows in A */
 uint GMHIKernelRaw::rows () const
 {
@@ -467,6 +680,16 @@ uint NICE::GMHIKernelRaw::getNumberOfDimensions() const
     return this->num_dimension;
 }
 
+void NICE::GMHIKernelRaw::setNumberOfThreads ( const uint & _numThreads )
+{
+    this->ui_numThreads = _numThreads;
+}
+
+uint NICE::GMHIKernelRaw::getNumberOfThreads () const
+{
+    return this->ui_numThreads;
+}
+
 void NICE::GMHIKernelRaw::getDiagonalElements( NICE::Vector & _diagonalElements) const
 {
     _diagonalElements = this->diagonalElements;
@@ -495,3 +718,105 @@ NICE::Vector NICE::GMHIKernelRaw::getLargestValuePerDimension ( ) const
 
   return vmax;
 }
+
+void NICE::GMHIKernelRaw::storeBinary ( BinaryModelWriter & _writer,
+                                        const std::string & _prefix,
+                                        const bool & _withExampleIndices
+                                      ) const
+{
+  std::vector<uint> size ( 2 );
+  size[0] = this->num_examples;
+  size[1] = this->num_dimension;
+  _writer.addArrayCopy ( _prefix + "size", size );
+  _writer.addArray ( _prefix + "nnz", this->nnz_per_dimension, this->num_dimension );
+
+  // values and example indices are interleaved in sparseVectorElement, write them as separate arrays
+  std::vector<double> values;
+  std::vector<uint> indices;
+  for ( uint d = 0; d < this->num_dimension; d++ )
+  {
+    for ( uint k = 0; k < this->nnz_per_dimension[d]; k++ )
+    {
+      values.push_back ( this->examples_raw[d][k].value );
+      if ( _withExampleIndices )
+        indices.push_back ( this->examples_raw[d][k].example_index );
+    }
+  }
+  _writer.addArrayCopy ( _prefix + "values", values );
+
+  if ( _withExampleIndices )
+  {
+    _writer.addArrayCopy ( _prefix + "indices", indices );
+    _writer.addArray ( _prefix + "diagonal", this->diagonalElements.getDataPointer(), this->diagonalElements.size() );
+  }
+}
+
+void NICE::GMHIKernelRaw::restoreBinary ( const BinaryModelReader & _reader,
+                                          const std::string & _prefix
+                                        )
+{
+  this->cleanupData();
+
+  size_t count;
+  const uint * size = _reader.getArray<uint> ( _prefix + "size", count );
+  if ( count != 2 )
+    fthrow ( Exception, "GMHIKernelRaw::restoreBinary: invalid size of " << _prefix );
+  this->num_examples  = size[0];
+  this->num_dimension = size[1];
+
+  const uint * nnz = _reader.getArray<uint> ( _prefix + "nnz", count );
+  if ( count != this->num_dimension )
+    fthrow ( Exception, "GMHIKernelRaw::restoreBinary: " << count << " non-zero counts given for " << this->num_dimension << " dimensions" );
+
+  size_t numValues;
+  const double * values = _reader.getArray<double> ( _prefix + "values", numValues );
+
+  // example indices are optional, see storeBinary
+  bool withExampleIndices = _reader.hasSection ( _prefix + "indices" );
+  const uint * indices = NULL;
+  if ( withExampleIndices )
+  {
+    indices = _reader.getArray<uint> ( _prefix + "indices", count );
+    if ( count != numValues )
+      fthrow ( Exception, "GMHIKernelRaw::restoreBinary: " << count << " example indices given for " << numValues << " values" );
+  }
+
+  size_t totalNNZ ( 0 );
+  for ( uint d = 0; d < this->num_dimension; d++ )
+    totalNNZ += nnz[d];
+  if ( totalNNZ != numValues )
+    fthrow ( Exception, "GMHIKernelRaw::restoreBinary: " << numValues << " values given, but " << totalNNZ << " expected" );
+
+  this->nnz_per_dimension = new uint [ this->num_dimension ];
+  this->examples_raw      = new sparseVectorElement * [ this->num_dimension ];
+  size_t offset ( 0 );
+  for ( uint d = 0; d < this->num_dimension; d++ )
+  {
+    this->nnz_per_dimension[d] = nnz[d];
+    this->examples_raw[d] = new sparseVectorElement [ nnz[d] ];
+
+    for ( uint k = 0; k < nnz[d]; k++, offset++ )
+    {
+      this->examples_raw[d][k].value = values[offset];
+      this->examples_raw[d][k].example_index = withExampleIndices ? indices[offset] : 0;
+    }
+  }
+
+  if ( withExampleIndices )
+  {
+    const double * diagonal = _reader.getArray<double> ( _prefix + "diagonal", count );
+    this->diagonalElements.resize ( count );
+    for ( uint i = 0; i < count; i++ )
+      this->diagonalElements[i] = diagonal[i];
+
+    // tables used by updateTablesAandB and updateTableT, see initData
+    this->table_A = allocateTableAorB();
+    this->table_B = allocateTableAorB();
+    if ( this->q != NULL )
+      this->table_T = this->allocateTableT();
+  }
+  else
+  {
+    this->diagonalElements.resize ( 0 );
+  }
+}
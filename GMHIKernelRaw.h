@@ -11,7 +11,9 @@
 
 #include <core/algebra/GenericMatrix.h>
 
+#include "BinaryModelFile.h"
 #include "quantization/Quantization.h"
+#include "algebra/GenericBlockMatrix.h"
 
 namespace NICE {
 
@@ -21,7 +23,7 @@ namespace NICE {
  * @author Erik Rodner, Alexander Freytag
  */
 
-class GMHIKernelRaw : public GenericMatrix
+class GMHIKernelRaw : public GenericBlockMatrix
 {
   public:
     typedef struct sparseVectorElement {
@@ -49,6 +51,9 @@ class GMHIKernelRaw : public GenericMatrix
     uint num_examples;
     double d_noise;
 
+    /** number of threads used for loops over dimensions (0 = all available cores, 1 = sequential) */
+    uint ui_numThreads;
+
     /** object performing feature quantization */
     NICE::Quantization *q;
 
@@ -72,9 +77,32 @@ class GMHIKernelRaw : public GenericMatrix
     void clearTablesAandB();
     void clearTablesT();
 
-
-    double * computeTableT ( const NICE::Vector & _alpha
-                           );
+    /** number of threads to be used for a loop over the dimensions, resolves 0 to all available cores (always 1 inside of a parallel region) */
+    int getEffectiveNumberOfThreads () const;
+
+    /** number of consecutive dimensions accumulated into a common partial result by multiply and multiplyBlock,
+      * depends on the data only, such that the order of the summation does not depend on the number of threads */
+    uint getNumberOfDimensionsPerChunk () const;
+
+    /** add the contribution of dimension _dim to A*X for m vectors at once (X and Y stored example-wise, row-major) */
+    void multiplyBlockDimension ( const uint & _dim,
+                                  const uint & _m,
+                                  const double * _xRows,
+                                  double * _yRows,
+                                  std::vector<double> & _partialSums
+                                ) const;
+
+    /** compute the tables A and B for the vector _x and store them in the given (pre-allocated) tables */
+    void computeTablesAandB ( const NICE::Vector & _x,
+                              double ** _tableA,
+                              double ** _tableB
+                            ) const;
+
+    /** compute the lookup table T from the tables A and B and store it in the given (pre-allocated) table */
+    void computeTableT ( double ** _tableA,
+                         double ** _tableB,
+                         double * _tableT
+                       ) const;
 
     /////////////////////////
     /////////////////////////
@@ -90,11 +118,21 @@ class GMHIKernelRaw : public GenericMatrix
                    NICE::Quantization * _q = NULL
                  );
 
-    /** multiply with a vector: A*x = y; this is not really const anymore!! */
+    /** constructor of an empty matrix, which is set up by restoreBinary */
+    GMHIKernelRaw( const double _d_noise,
+                   NICE::Quantization * _q
+                 );
+
+    /** multiply with a vector: A*x = y; does not touch the stored tables and can be called concurrently */
     virtual void multiply ( NICE::Vector & y,
                             const NICE::Vector & x
                           ) const;
 
+    /** multiply with several vectors at once: A*X = Y, tables A and B are computed for all columns in a single pass over the data */
+    virtual void multiplyBlock ( NICE::Matrix & _Y,
+                                 const NICE::Matrix & _X
+                               ) const;
+
     /** get the number of rows in A */
     virtual uint rows () const;
 
@@ -108,6 +146,10 @@ class GMHIKernelRaw : public GenericMatrix
     uint *getNNZPerDimension() const;
     uint getNumberOfDimensions() const;
 
+    /** set the number of threads used for loops over dimensions (0 = all available cores, 1 = sequential), only effective with OpenMP support */
+    void setNumberOfThreads ( const uint & _numThreads );
+    uint getNumberOfThreads () const;
+
     /** simple destructor */
     virtual ~GMHIKernelRaw();
 
@@ -115,11 +157,39 @@ class GMHIKernelRaw : public GenericMatrix
     void updateTablesAandB ( const NICE::Vector _x ) const;
     void updateTableT ( const NICE::Vector _x ) const;
 
+    /**
+    * @brief compute new tables A, B, and (only with quantization, NULL otherwise) T for the vector _x
+    * without touching the stored tables, i.e., this can be called concurrently. The caller takes ownership of the tables.
+    */
+    void computeLookupTables ( const NICE::Vector & _x,
+                               double ** & _tableA,
+                               double ** & _tableB,
+                               double * & _tableT
+                             ) const;
+
     /** get the diagonal elements of the current matrix */
     void getDiagonalElements ( NICE::Vector & _diagonalElements ) const;
 
     NICE::Vector getLargestValuePerDimension ( ) const;
 
+    /**
+    * @brief add the sorted training data to a binary model (sections _prefix + "size", "nnz", "values", "indices", and "diagonal")
+    * @param _withExampleIndices if false, only the sorted values per dimension are written, which is sufficient for
+    * classification with the arrays A and B, but not for multiplications with the kernel matrix
+    */
+    void storeBinary ( BinaryModelWriter & _writer,
+                       const std::string & _prefix,
+                       const bool & _withExampleIndices = true
+                     ) const;
+
+    /**
+    * @brief restore the sorted training data written by storeBinary, previous data is discarded.
+    * The parameters of the quantization are not computed again, they have to be restored separately.
+    */
+    void restoreBinary ( const BinaryModelReader & _reader,
+                         const std::string & _prefix
+                       );
+
 };
 
 }
@@ -7,6 +7,7 @@
 */
 
 // STL includes
+#include <fstream>
 #include <iostream>
 
 // NICE-core includes
@@ -589,6 +590,26 @@ void GPHIKClassifier::predictUncertainty( const NICE::Vector * _example,
   }
 }
 
+void GPHIKClassifier::predictUncertainty( const std::vector< const NICE::SparseVector * > & _examples, 
+                                          NICE::Vector & _uncertainties 
+                                        ) const
+{  
+  if ( this->gphyper == NULL )
+     fthrow(Exception, "Classifier not trained yet -- aborting!" );  
+
+  if ( this->varianceApproximation == APPROXIMATE_FINE )
+  {
+    this->gphyper->computePredictiveVarianceApproximateFine( _examples, _uncertainties );
+    return;
+  }
+
+  _uncertainties.resize( _examples.size() );
+  for ( uint i = 0; i < _examples.size(); i++ )
+  {
+    this->predictUncertainty( _examples[i], _uncertainties[i] );
+  }
+}
+
 ///////////////////// INTERFACE PERSISTENT /////////////////////
 // interface specific methods for store and restore
 ///////////////////// INTERFACE PERSISTENT ///////////////////// 
@@ -596,6 +617,23 @@ void GPHIKClassifier::predictUncertainty( const NICE::Vector * _example,
 void GPHIKClassifier::restore ( std::istream & _is, 
                                 int _format 
                               )
+{
+  this->restoreFromStream ( _is, _format, "" );
+}
+
+void GPHIKClassifier::restoreMapped ( const std::string & _filename )
+{
+  std::ifstream ifs ( _filename.c_str(), std::ios::in | std::ios::binary );
+  if ( ! ifs.good() )
+    fthrow ( Exception, "GPHIKClassifier::restoreMapped: unable to open " << _filename );
+
+  this->restoreFromStream ( ifs, BinaryModelFile::FORMAT_BINARY, _filename );
+}
+
+void GPHIKClassifier::restoreFromStream ( std::istream & _is, 
+                                          int _format,
+                                          const std::string & _mappedFilename
+                                        )
 {
   //delete everything we knew so far...
   this->clear();
@@ -657,7 +695,10 @@ void GPHIKClassifier::restore ( std::istream & _is,
         
         //then, load everything that we stored explicitely,
         // including precomputed matrices, LUTs, eigenvalues, ... and all that stuff
-        this->gphyper->restore( _is, _format );  
+        if ( _mappedFilename.empty() )
+          this->gphyper->restore( _is, _format );  
+        else
+          this->gphyper->restoreMapped( _is, _mappedFilename );
           
         _is >> tmp; // end of block 
         tmp = this->removeEndTag ( tmp );
@@ -834,3 +875,24 @@ void GPHIKClassifier::addMultipleExamples( const std::vector< const NICE::Sparse
     this->gphyper->addMultipleExamples( _newExamples, _newLabels, _performOptimizationAfterIncrement );     
   }
 }
+
+void GPHIKClassifier::removeExample( const uint & _exampleIndex,
+                                  const bool & _performOptimizationAfterDecrement
+                                )
+{
+  this->removeMultipleExamples ( std::vector< uint > ( 1, _exampleIndex ), _performOptimizationAfterDecrement );
+}
+
+void GPHIKClassifier::removeMultipleExamples( const std::vector< uint > & _exampleIndices,
+                                           const bool & _performOptimizationAfterDecrement
+                                         )
+{
+  //are examples to remove given? If not, nothing has to be done
+  if ( _exampleIndices.size() < 1 )
+    return;
+
+  if ( ! this->b_isTrained )
+    fthrow ( Exception, "Classifier not initially trained yet -- examples can not be removed!" );
+
+  this->gphyper->removeMultipleExamples( _exampleIndices, _performOptimizationAfterDecrement );
+}
@@ -89,6 +89,15 @@ class GPHIKClassifier : public NICE::Persistent, public NICE::OnlineLearnable
     //  PROTECTED METHODS  //
     /////////////////////////
     /////////////////////////
+
+    /**
+    * @brief restore from a stream, see restore and restoreMapped
+    * @param _mappedFilename if not empty, the binary model of gphyper is mapped from this file (see FMKGPHyperparameterOptimization::restoreMapped)
+    */
+    void restoreFromStream ( std::istream & _is,
+                             int _format,
+                             const std::string & _mappedFilename
+                           );
           
 
   public:
@@ -278,6 +287,17 @@ class GPHIKClassifier : public NICE::Persistent, public NICE::OnlineLearnable
     void predictUncertainty( const NICE::Vector * _example, 
                              double & _uncertainty 
                            ) const;    
+
+    /** 
+     * @brief prediction of classification uncertainty for several examples at once, e.g., for ranking candidates in active learning.
+     * The fine approximation processes the examples in blocks (see FMKGPHyperparameterOptimization::computePredictiveVarianceApproximateFine),
+     * the other methods are applied to one example after another.
+     * @param _examples examples for which the classification uncertainty shall be predicted, given in a sparse representation
+     * @param _uncertainties contains the resulting classification uncertainty for every example
+     */       
+    void predictUncertainty( const std::vector< const NICE::SparseVector * > & _examples, 
+                             NICE::Vector & _uncertainties 
+                           ) const;
     
 
 
@@ -296,10 +316,18 @@ class GPHIKClassifier : public NICE::Persistent, public NICE::OnlineLearnable
     /** 
      * @brief Save classifier to external file (stream)
      * @author Alexander Freytag
+     * @param _format BinaryModelFile::FORMAT_TEXT (tagged text) or BinaryModelFile::FORMAT_BINARY (binary model for fast restoring)
      */     
     void store ( std::ostream & _os, 
                  int _format = 0 
                ) const;
+
+    /**
+    * @brief Load a classifier stored with BinaryModelFile::FORMAT_BINARY by mapping the file into memory.
+    * The LUTs are used in place (read-only), such that loading does not depend on their size.
+    * @param _filename file written by store
+    */
+    void restoreMapped ( const std::string & _filename );
     
     /** 
      * @brief Clear classifier object
@@ -329,6 +357,20 @@ class GPHIKClassifier : public NICE::Persistent, public NICE::OnlineLearnable
                                       const NICE::Vector & _newLabels,
                                       const bool & _performOptimizationAfterIncrement = true
                                     );       
+
+    /** 
+     * @brief remove a single example (index in the order of insertion)
+     */    
+    virtual void removeExample( const uint & _exampleIndex,
+                                const bool & _performOptimizationAfterDecrement = true
+                              );
+
+    /** 
+     * @brief remove several examples (indices in the order of insertion), the remaining examples are numbered consecutively afterwards
+     */    
+    virtual void removeMultipleExamples( const std::vector< uint > & _exampleIndices,
+                                         const bool & _performOptimizationAfterDecrement = true
+                                       );
 };
 
 }
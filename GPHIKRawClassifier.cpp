@@ -8,9 +8,15 @@
 
 // STL includes
 #include <iostream>
+#include <limits>
+#include <sstream>
 
 #include <unistd.h>
 
+#ifdef NICE_USELIB_OPENMP
+#include <omp.h>
+#endif
+
 // NICE-core includes
 #include <core/basics/numerictools.h>
 #include <core/basics/Timer.h>
@@ -85,6 +91,242 @@ void GPHIKRawClassifier::clearSetsOfTablesT( )
     this->precomputedT.clear();
 }
 
+void GPHIKRawClassifier::clearSetsOfCompactTables( )
+{
+    // delete all LUTs with reduced precision
+    std::map< uint, CompactLookupTable * > * tables[3] = { &(this->compactA), &(this->compactB), &(this->compactT) };
+    for ( uint t = 0; t < 3; t++ )
+    {
+        for ( std::map< uint, CompactLookupTable * >::iterator it = tables[t]->begin();
+              it != tables[t]->end();
+              it++
+            )
+        {
+            delete it->second;
+        }
+        tables[t]->clear();
+    }
+}
+
+void GPHIKRawClassifier::computeScoresForBlock ( const std::vector< const NICE::SparseVector *> & _examples,
+                                                 const uint & _begin,
+                                                 const uint & _end,
+                                                 NICE::Matrix & _scores
+                                               ) const
+{
+  // (1) look up all test values of the block once, independent of the class:
+  //     with quantization, we only need the offset of the corresponding bin in T,
+  //     otherwise, we need the position of the value within the sorted training data
+  std::vector<uint> offsets;
+  std::vector<double> values;
+  std::vector<uint> positions;
+  std::vector<uint> exampleStart ( _end - _begin + 1, 0 );
+
+  // without the training data (see store_classification_only), only the quantized LUTs are available
+  GMHIKernelRaw::sparseVectorElement **dataMatrix = ( this->gm != NULL ) ? this->gm->getDataMatrix() : NULL;
+  uint hmax = ( this->q != NULL ) ? this->q->getNumberOfBins() : 0;
+
+  std::vector<uint> dims;
+  std::vector<uint> bins;
+
+  for ( uint exCnt = _begin; exCnt < _end; exCnt++ )
+  {
+    const NICE::SparseVector * xstar = _examples[exCnt];
+
+    if ( this->q != NULL )
+    {
+      // all non-zero elements of known dimensions are quantized at once
+      this->q->quantize ( *xstar, dims, bins, this->num_dimension );
+
+      for ( uint k = 0; k < dims.size(); k++ )
+      {
+        if ( !this->compactT.empty() )
+        {
+          // tables with reduced precision are accessed per dimension
+          offsets.push_back ( dims[k] );
+          positions.push_back ( bins[k] );
+        }
+        else
+        {
+          offsets.push_back ( dims[k] * hmax + bins[k] );
+        }
+      }
+    }
+    else
+    {
+      for ( SparseVector::const_iterator i = xstar->begin(); i != xstar->end(); i++ )
+      {
+        uint dim    = i->first;
+        double fval = i->second;
+
+        if ( dim >= this->num_dimension )
+          continue;
+
+        uint nnz = this->nnz_per_dimension[dim];
+        if ( nnz == 0 ) continue;
+
+        GMHIKernelRaw::sparseVectorElement fval_element;
+        fval_element.value = fval;
+        GMHIKernelRaw::sparseVectorElement *it = upper_bound ( dataMatrix[dim], dataMatrix[dim] + nnz, fval_element );
+
+        offsets.push_back ( dim );
+        values.push_back ( fval );
+        positions.push_back ( distance ( dataMatrix[dim], it ) );
+      }
+    }
+    exampleStart[exCnt - _begin + 1] = offsets.size();
+  }
+
+  // (2) evaluate the tables of one class for the whole block before switching to the next class
+  if ( ( this->q != NULL ) && !this->packedT.empty() )
+  {
+    // packed LUT: a single row per test value contains the contributions of all classes
+    const std::vector<uint> & classNumbers = this->packedT.getClassNumbers();
+    std::vector<double> rowSums ( this->packedT.getStride() );
+
+    for ( uint exCnt = _begin; exCnt < _end; exCnt++ )
+    {
+      std::fill ( rowSums.begin(), rowSums.end(), 0.0 );
+      for ( uint k = exampleStart[exCnt - _begin]; k < exampleStart[exCnt - _begin + 1]; k++ )
+        this->packedT.addRow ( offsets[k], &(rowSums[0]) );
+
+      for ( uint c = 0; c < classNumbers.size(); c++ )
+        _scores( exCnt, classNumbers[c] ) = rowSums[c];
+    }
+  }
+  else if ( ( this->q != NULL ) && !this->compactT.empty() )
+  {
+    for ( std::map< uint, CompactLookupTable * >::const_iterator itT = this->compactT.begin() ;
+          itT != this->compactT.end();
+          itT++
+        )
+    {
+      uint classno = itT->first;
+      const CompactLookupTable & T = *(itT->second);
+
+      for ( uint exCnt = _begin; exCnt < _end; exCnt++ )
+      {
+        double beta = 0;
+        for ( uint k = exampleStart[exCnt - _begin]; k < exampleStart[exCnt - _begin + 1]; k++ )
+          beta += T.get ( offsets[k], positions[k] );
+
+        _scores( exCnt, classno ) = beta;
+      }
+    }
+  }
+  else if ( this->q != NULL )
+  {
+    for ( std::map< uint, double * >::const_iterator itT = this->precomputedT.begin() ;
+          itT != this->precomputedT.end();
+          itT++
+        )
+    {
+      uint classno = itT->first;
+      const double *T = itT->second;
+
+      for ( uint exCnt = _begin; exCnt < _end; exCnt++ )
+      {
+        double beta = 0;
+        for ( uint k = exampleStart[exCnt - _begin]; k < exampleStart[exCnt - _begin + 1]; k++ )
+          beta += T[ offsets[k] ];
+
+        _scores( exCnt, classno ) = beta;
+      }
+    }
+  }
+  else if ( !this->compactA.empty() )
+  {
+    for ( std::map<uint, CompactLookupTable *>::const_iterator itA = this->compactA.begin() ; itA != this->compactA.end(); itA++ )
+    {
+      uint classno = itA->first;
+      const CompactLookupTable & A = *(itA->second);
+      const CompactLookupTable & B = *(this->compactB.find ( classno )->second);
+
+      for ( uint exCnt = _begin; exCnt < _end; exCnt++ )
+      {
+        double beta = 0;
+        for ( uint k = exampleStart[exCnt - _begin]; k < exampleStart[exCnt - _begin + 1]; k++ )
+        {
+          uint dim      = offsets[k];
+          double fval   = values[k];
+          uint position = positions[k];
+          uint nnz      = this->nnz_per_dimension[dim];
+
+          if ( position == 0 )
+            beta += fval * B.get ( dim, nnz - 1 );
+          else if ( position == nnz )
+            beta += A.get ( dim, nnz - 1 );
+          else
+            beta += A.get ( dim, position - 1 ) + fval * ( B.get ( dim, nnz - 1 ) - B.get ( dim, position - 1 ) );
+        }
+
+        _scores( exCnt, classno ) = beta;
+      }
+    }
+  }
+  else
+  {
+    for ( std::map<uint, PrecomputedType>::const_iterator itA = this->precomputedA.begin() ; itA != this->precomputedA.end(); itA++ )
+    {
+      uint classno = itA->first;
+      const PrecomputedType & A = itA->second;
+      const PrecomputedType & B = this->precomputedB.find ( classno )->second;
+
+      for ( uint exCnt = _begin; exCnt < _end; exCnt++ )
+      {
+        double beta = 0;
+        for ( uint k = exampleStart[exCnt - _begin]; k < exampleStart[exCnt - _begin + 1]; k++ )
+        {
+          uint dim      = offsets[k];
+          double fval   = values[k];
+          uint position = positions[k];
+          uint nnz      = this->nnz_per_dimension[dim];
+
+          // position == 0: the test value is smaller than all training values, i.e., the sum of all alphas times fval
+          // position == nnz: the test value is at least as large as all training values, i.e., the sum of all alphas times the training values
+          // otherwise: the training values in front of position contribute their own value, the remaining ones fval
+          if ( position == 0 )
+            beta += fval * B[ dim ][ nnz - 1 ];
+          else if ( position == nnz )
+            beta += A[ dim ][ nnz - 1 ];
+          else
+            beta += A[ dim ][ position - 1 ] + fval * ( B[ dim ][ nnz - 1 ] - B[ dim ][ position - 1 ] );
+        }
+
+        _scores( exCnt, classno ) = beta;
+      }
+    }
+  }
+}
+
+uint GPHIKRawClassifier::computeResult ( NICE::Matrix & _scores,
+                                        const uint & _row
+                                      ) const
+{
+  uint result ( 0 );
+  if ( this->knownClasses.size() > 2 )
+  { // multi-class classification
+    result = *(this->knownClasses.begin());
+    for ( std::set<uint>::const_iterator it = this->knownClasses.begin(); it != this->knownClasses.end(); it++ )
+    {
+      if ( _scores( _row, *it ) > _scores( _row, result ) )
+        result = *it;
+    }
+  }
+  else if ( this->knownClasses.size() == 2 ) // binary setting
+  {
+    // since we erased the binary label vector corresponding to the smaller class number,
+    // we only have scores for the larger class number
+    uint class_for_which_we_have_a_score          = *(this->knownClasses.rbegin());
+    uint class_for_which_we_dont_have_a_score     = *(this->knownClasses.begin());
+
+    _scores( _row, class_for_which_we_dont_have_a_score ) = - _scores( _row, class_for_which_we_have_a_score );
+
+    result = _scores( _row, class_for_which_we_have_a_score ) > 0.0 ? class_for_which_we_have_a_score : class_for_which_we_dont_have_a_score;
+  }
+  return result;
+}
+
 /////////////////////////////////////////////////////
 /////////////////////////////////////////////////////
 //                 PUBLIC METHODS
@@ -100,6 +342,7 @@ GPHIKRawClassifier::GPHIKRawClassifier( )
   this->num_dimension     = 0;
 
   this->solver            = NULL;    
+  this->blockSolver       = NULL;
   this->q                 = NULL;
   this->gm                = NULL;
 
@@ -128,6 +371,7 @@ GPHIKRawClassifier::GPHIKRawClassifier( const Config *_conf,
   this->num_dimension     = 0;
 
   this->solver            = NULL;    
+  this->blockSolver       = NULL;
   this->q                 = NULL;
   this->gm                = NULL;
 
@@ -160,6 +404,12 @@ GPHIKRawClassifier::~GPHIKRawClassifier()
     this->solver = NULL;
   }
 
+  if ( this->blockSolver != NULL )
+  {
+    delete this->blockSolver;
+    this->blockSolver = NULL;
+  }
+
   if ( this->gm != NULL)
   {
     delete this->gm;
@@ -168,6 +418,13 @@ GPHIKRawClassifier::~GPHIKRawClassifier()
 
   this->clearSetsOfTablesAandB();
   this->clearSetsOfTablesT();
+  this->clearSetsOfCompactTables();
+
+  if ( this->nnz_per_dimension != NULL )
+  {
+      delete [] this->nnz_per_dimension;
+      this->nnz_per_dimension = NULL;
+  }
 
   if ( this->q != NULL )
   {
@@ -187,6 +444,19 @@ void GPHIKRawClassifier::initFromConfig(const Config *_conf,
   this->b_debug     = _conf->gB( _confSection, "debug", false);
   this->f_tolerance = _conf->gD( _confSection, "f_tolerance", 1e-10);
 
+  // parallelization of loops over dimensions (only effective with OpenMP support)
+  this->ui_numThreads = std::max ( 0, _conf->gI( _confSection, "num_threads", 1 ) );
+
+  // batch classification: number of test examples sharing the lookups of the class tables
+  this->ui_classifyBlockSize = std::max ( 1, _conf->gI( _confSection, "classify_block_size", 256 ) );
+
+  // quantized classification: one contiguous LUT for all classes, see PackedLookupTables
+  this->b_usePackedLUT = _conf->gB( _confSection, "use_packed_lut", false );
+  this->lutPrecision = CompactLookupTable::precisionFromString ( _conf->gS( _confSection, "lut_precision", "double" ) );
+
+  // persistence: skip the training data which is not needed by classify
+  this->b_storeClassificationOnly = _conf->gB( _confSection, "store_classification_only", false );
+
   //FIXME this is not used in that way for the standard GPHIKClassifier
   //string ilssection = "FMKGPHyperparameterOptimization";
   string ilssection       = _confSection;
@@ -200,6 +470,23 @@ void GPHIKRawClassifier::initFromConfig(const Config *_conf,
                                                        ils_min_residual
                                                      );
 
+  // solve the linear systems of all classes simultaneously, such that
+  // every iteration only needs a single pass over the training data
+  bool ils_block_solver   = _conf->gB( ilssection, "ils_block_solver", false );
+  if ( this->blockSolver != NULL )
+  {
+    delete this->blockSolver;
+    this->blockSolver = NULL;
+  }
+  if ( ils_block_solver )
+  {
+    this->blockSolver     = new ILSBlockConjugateGradients( ils_verbose,
+                                                            ils_max_iterations,
+                                                            ils_min_delta,
+                                                            ils_min_residual
+                                                          );
+  }
+
   // variables for the eigen value decomposition technique
   this->b_eig_verbose              = _conf->gB ( _confSection, "eig_verbose", false );
   this->i_eig_value_max_iterations = _conf->gI ( _confSection, "eig_value_max_iterations", 10 );
@@ -211,10 +498,16 @@ void GPHIKRawClassifier::initFromConfig(const Config *_conf,
       std::cerr << "   confSection " << confSection << std::endl;
       std::cerr << "   d_noise " << d_noise << std::endl;
       std::cerr << "   f_tolerance " << f_tolerance << std::endl;
+      std::cerr << "   ui_numThreads " << ui_numThreads << std::endl;
+      std::cerr << "   ui_classifyBlockSize " << ui_classifyBlockSize << std::endl;
+      std::cerr << "   b_usePackedLUT " << b_usePackedLUT << std::endl;
+      std::cerr << "   b_storeClassificationOnly " << b_storeClassificationOnly << std::endl;
+      std::cerr << "   lutPrecision " << CompactLookupTable::precisionToString ( this->lutPrecision ) << std::endl;
       std::cerr << "   ils_max_iterations " << ils_max_iterations << std::endl;
       std::cerr << "   ils_min_delta " << ils_min_delta << std::endl;
       std::cerr << "   ils_min_residual " << ils_min_residual << std::endl;
       std::cerr << "   ils_verbose " << ils_verbose << std::endl;
+      std::cerr << "   ils_block_solver " << ils_block_solver << std::endl;
       std::cerr << "   b_eig_verbose " << b_eig_verbose << std::endl;
       std::cerr << "   i_eig_value_max_iterations " << i_eig_value_max_iterations << std::endl;
   }
@@ -284,150 +577,14 @@ void GPHIKRawClassifier::classify ( const NICE::SparseVector * _xstar,
                                  SparseVector & _scores
                                ) const
 {
-  if ( ! this->b_isTrained )
-     fthrow(Exception, "Classifier not trained yet -- aborting!" );
-  _scores.clear();
-
-
-    // classification with quantization of test inputs
-    if ( this->q != NULL )
-    {
-        uint maxClassNo = 0;
-        for ( std::map< uint, double * >::const_iterator itT = this->precomputedT.begin() ;
-              itT != this->precomputedT.end();
-              itT++
-            )
-        {
-          uint classno = itT->first;
-          maxClassNo   = std::max ( maxClassNo, classno );
-          double beta  = 0;
-          double *T    = itT->second;
-
-          for (SparseVector::const_iterator i = _xstar->begin(); i != _xstar->end(); i++ )
-          {
-            uint dim  = i->first;
-            double v  = i->second;
-            uint qBin = this->q->quantize( v, dim );
+  NICE::Vector scores;
+  this->classify ( _xstar, _result, scores );
 
-            beta += T[dim * this->q->getNumberOfBins() + qBin];
-          }//for-loop over dimensions of test input
-
-          _scores[ classno ] = beta;
-
-        }//for-loop over 1-vs-all models
-    }
-    // classification with exact test inputs, i.e., no quantization involved
-    else
-    {
-        uint maxClassNo = 0;
-        for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
-        {
-          uint classno = i->first;
-          maxClassNo   = std::max ( maxClassNo, classno );
-          double beta  = 0;
-          GMHIKernelRaw::sparseVectorElement **dataMatrix = this->gm->getDataMatrix();
-
-          const PrecomputedType & A = i->second;
-          std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
-          const PrecomputedType & B = j->second;
-
-          for (SparseVector::const_iterator i = _xstar->begin(); i != _xstar->end(); i++)
-          {
-            uint dim    = i->first;
-            double fval = i->second;
-
-            uint nnz = this->nnz_per_dimension[dim];
-            uint nz  = this->num_examples - nnz;
-
-            if ( nnz == 0 ) continue;
-            // useful
-            //if ( fval < this->f_tolerance ) continue;
-
-            uint position = 0;
-
-            //this->X_sorted.findFirstLargerInDimension(dim, fval, position);
-            GMHIKernelRaw::sparseVectorElement fval_element;
-            fval_element.value = fval;
-
-            //std::cerr << "value to search for " << fval << endl;
-            //std::cerr << "data matrix in dimension " << dim << endl;
-            //for (int j = 0; j < nnz; j++)
-            //    std::cerr << dataMatrix[dim][j].value << std::endl;
-
-            GMHIKernelRaw::sparseVectorElement *it = upper_bound ( dataMatrix[dim], dataMatrix[dim] + nnz, fval_element );
-            position = distance ( dataMatrix[dim], it );
-            
-//             /*// add zero elements
-//             if ( fval_element.value > 0.0 )
-//                 position += nz;*/
-
-
-            bool posIsZero ( position == 0 );
-            
-            // special case 1:
-            // new example is smaller than all known examples
-            // -> resulting value = fval * sum_l=1^n alpha_l               
-            if ( position == 0 )
-            {
-              beta += fval * B[ dim ][ nnz - 1 ];  
-            }
-            // special case 2:
-            // new example is equal to or larger than the largest training example in this dimension
-            // -> the term B[ dim ][ nnz-1 ] - B[ dim ][ indexElem ] is equal to zero and vanishes, which is logical, since all elements are smaller than the remaining prototypes!            
-            else if ( position == nnz )
-            {
-              beta += A[ dim ][ nnz - 1 ];
-            }
-            // standard case: new example is larger then the smallest element, but smaller then the largest one in the corrent dimension        
-            else
-            {
-                beta += A[ dim ][ position - 1 ] + fval * ( B[ dim ][ nnz - 1 ] - B[ dim ][ position - 1 ] );
-            }
-            
-//             // correct upper bound to correct position, only possible if new example is not the smallest value in this dimension
-//             if ( !posIsZero )
-//                 position--;
-// 
-// 
-//             double firstPart = 0.0;
-//             if ( !posIsZero  )
-//               firstPart = ( A[ dim ][ position ] );
-// 
-//             double secondPart( B[ dim ][ this->num_examples-1-nz ]);
-//             if ( !posIsZero && (position >= nz) )
-//                 secondPart -= B[dim][ position ];
-// 
-//             // but apply using the transformed one
-//             beta += firstPart + secondPart* fval;
-          }//for-loop over dimensions of test input
-
-          _scores[ classno ] = beta;
-
-        }//for-loop over 1-vs-all models
-
-    } // if-condition wrt quantization
+  // only the known classes get a score
+  _scores.clear();
+  for ( std::set<uint>::const_iterator it = this->knownClasses.begin(); it != this->knownClasses.end(); it++ )
+    _scores[ *it ] = scores[ *it ];
   _scores.setDim ( *this->knownClasses.rbegin() + 1 );
-
-
-  if ( this->knownClasses.size() > 2 )
-  { // multi-class classification
-    _result = _scores.maxElement();
-  }
-  else if ( this->knownClasses.size() == 2 ) // binary setting
-  {
-    uint class1 = *(this->knownClasses.begin());
-    uint class2 = *(this->knownClasses.rbegin());
-
-    // since we erased the binary label vector corresponding to the smaller class number,
-    // we only have scores for the larger class number
-    uint class_for_which_we_have_a_score          = class2;
-    uint class_for_which_we_dont_have_a_score     = class1;
-
-    _scores[class_for_which_we_dont_have_a_score] = - _scores[class_for_which_we_have_a_score];
-
-    _result = _scores[class_for_which_we_have_a_score] > 0.0 ? class_for_which_we_have_a_score : class_for_which_we_dont_have_a_score;
-  }
-
 }
 
 
@@ -439,123 +596,15 @@ void GPHIKRawClassifier::classify ( const NICE::SparseVector * _xstar,
   if ( ! this->b_isTrained )
      fthrow(Exception, "Classifier not trained yet -- aborting!" );
 
-    // classification with quantization of test inputs
-    if ( this->q != NULL )
-    {
-        uint maxClassNo = 0;
-        for ( std::map< uint, double * >::const_iterator itT = this->precomputedT.begin() ;
-              itT != this->precomputedT.end();
-              itT++
-            )
-        {
-          uint classno = itT->first;
-          maxClassNo   = std::max ( maxClassNo, classno );
-          double beta  = 0;
-          double *T    = itT->second;
-
-          for (SparseVector::const_iterator i = _xstar->begin(); i != _xstar->end(); i++ )
-          {
-            uint dim  = i->first;
-            double v  = i->second;
-            uint qBin = this->q->quantize( v, dim );
-
-            beta += T[dim * this->q->getNumberOfBins() + qBin];
-          }//for-loop over dimensions of test input
-
-          _scores[ classno ] = beta;
-
-        }//for-loop over 1-vs-all models
-    }
-    // classification with exact test inputs, i.e., no quantization involved
-    else
-    {
-        uint maxClassNo = 0;
-        for ( std::map<uint, PrecomputedType>::const_iterator i = this->precomputedA.begin() ; i != this->precomputedA.end(); i++ )
-        {
-          uint classno = i->first;
-          maxClassNo   = std::max ( maxClassNo, classno );
-          double beta  = 0;
-          GMHIKernelRaw::sparseVectorElement **dataMatrix = this->gm->getDataMatrix();
-
-          const PrecomputedType & A = i->second;
-          std::map<uint, PrecomputedType>::const_iterator j = this->precomputedB.find ( classno );
-          const PrecomputedType & B = j->second;
-
-          for (SparseVector::const_iterator i = _xstar->begin(); i != _xstar->end(); i++)
-          {
-            uint dim    = i->first;
-            double fval = i->second;
-
-            uint nnz = this->nnz_per_dimension[dim];
-            uint nz  = this->num_examples - nnz;
-
-            if ( nnz == 0 ) continue;
-            // useful
-            //if ( fval < this->f_tolerance ) continue;
-
-            uint position = 0;
-
-            //this->X_sorted.findFirstLargerInDimension(dim, fval, position);
-            GMHIKernelRaw::sparseVectorElement fval_element;
-            fval_element.value = fval;
-
-            //std::cerr << "value to search for " << fval << endl;
-            //std::cerr << "data matrix in dimension " << dim << endl;
-            //for (int j = 0; j < nnz; j++)
-            //    std::cerr << dataMatrix[dim][j].value << std::endl;
-
-            GMHIKernelRaw::sparseVectorElement *it = upper_bound ( dataMatrix[dim], dataMatrix[dim] + nnz, fval_element );
-            position = distance ( dataMatrix[dim], it );
-
-            bool posIsZero ( position == 0 );
-
-            // special case 1:
-            // new example is smaller than all known examples
-            // -> resulting value = fval * sum_l=1^n alpha_l
-            if ( position == 0 )
-            {
-              beta += fval * B[ dim ][ nnz - 1 ];
-            }
-            // special case 2:
-            // new example is equal to or larger than the largest training example in this dimension
-            // -> the term B[ dim ][ nnz-1 ] - B[ dim ][ indexElem ] is equal to zero and vanishes, which is logical, since all elements are smaller than the remaining prototypes!
-            else if ( position == nnz )
-            {
-              beta += A[ dim ][ nnz - 1 ];
-            }
-            // standard case: new example is larger then the smallest element, but smaller then the largest one in the corrent dimension
-            else
-            {
-                beta += A[ dim ][ position - 1 ] + fval * ( B[ dim ][ nnz - 1 ] - B[ dim ][ position - 1 ] );
-            }
-
-          }//for-loop over dimensions of test input
-
-          _scores[ classno ] = beta;
-
-        }//for-loop over 1-vs-all models
-
-    } // if-condition wrt quantization
-
-  if ( this->knownClasses.size() > 2 )
-  { // multi-class classification
-    _result = _scores.MaxIndex();
-  }
-  else if ( this->knownClasses.size() == 2 ) // binary setting
-  {
-    uint class1 = *(this->knownClasses.begin());
-    uint class2 = *(this->knownClasses.rbegin());
-
-    // since we erased the binary label vector corresponding to the smaller class number,
-    // we only have scores for the larger class number
-    uint class_for_which_we_have_a_score          = class2;
-    uint class_for_which_we_dont_have_a_score     = class1;
-    
-    _scores[class_for_which_we_dont_have_a_score] = - _scores[class_for_which_we_have_a_score];
-
-    _result = _scores[class_for_which_we_have_a_score] > 0.0 ? class_for_which_we_have_a_score : class_for_which_we_dont_have_a_score;
-  }
+  // a block consisting of the single example, such that single and batch classification
+  // share the same lookups and yield exactly the same scores
+  std::vector< const NICE::SparseVector * > examples ( 1, _xstar );
+  NICE::Matrix scores ( 1, *(this->knownClasses.rbegin()) + 1 );
+  scores.set ( -std::numeric_limits<double>::max() );
+  this->computeScoresForBlock ( examples, 0, 1, scores );
 
+  _result = this->computeResult ( scores, 0 );
+  _scores = scores.getRow ( 0 );
 }
 
 void GPHIKRawClassifier::classify ( const std::vector< const NICE::SparseVector *> _examples,
@@ -563,33 +612,35 @@ void GPHIKRawClassifier::classify ( const std::vector< const NICE::SparseVector
                                     NICE::Matrix & _scores
                                   ) const
 {
+    if ( ! this->b_isTrained )
+       fthrow(Exception, "Classifier not trained yet -- aborting!" );
+
+    // scores of unknown class numbers remain at the smallest possible value
     _scores.resize( _examples.size(), * (this->knownClasses.rbegin()) +1 );
-    _scores.set( 0.0 );
+    _scores.set( -std::numeric_limits<double>::max() );
 
     _results.resize( _examples.size() );
     _results.set( 0.0 );
 
-
-    NICE::Vector::iterator resultsIt = _results.begin();
-
-
-    uint exCnt ( 0 );
-    uint resUI ( 0 );    
-    NICE::Vector scoresSingle( *(this->knownClasses.rbegin())+1, -std::numeric_limits<double>::max() );
-        
-    for ( std::vector< const NICE::SparseVector *>::const_iterator exIt = _examples.begin();
-          exIt != _examples.end();
-          exIt++, resultsIt++, exCnt++
-        )
+    if ( _examples.empty() )
+      return;
+
+    // every block writes to its own rows of _scores only
+    int numBlocks = ( _examples.size() + this->ui_classifyBlockSize - 1 ) / this->ui_classifyBlockSize;
+#ifdef NICE_USELIB_OPENMP
+    int numThreads = ( this->ui_numThreads == 0 ) ? omp_get_max_threads() : (int) this->ui_numThreads;
+    numThreads = std::max ( 1, std::min ( numThreads, numBlocks ) );
+#pragma omp parallel for num_threads( numThreads ) schedule( dynamic ) if ( numThreads > 1 )
+#endif
+    for ( int blockCnt = 0; blockCnt < numBlocks; blockCnt++ )
     {
-        this->classify ( *exIt,
-                         resUI,
-                         scoresSingle
-                       );
-        *resultsIt = resUI;
-        _scores.setRow( exCnt, scoresSingle );
-       scoresSingle.set( -std::numeric_limits<double>::max() );
+        uint begin = blockCnt * this->ui_classifyBlockSize;
+        uint end   = std::min<uint> ( begin + this->ui_classifyBlockSize, _examples.size() );
+        this->computeScoresForBlock ( _examples, begin, end, _scores );
     }
+
+    for ( uint exCnt = 0; exCnt < _examples.size(); exCnt++ )
+      _results[exCnt] = this->computeResult ( _scores, exCnt );
 }
 
 
@@ -667,6 +718,8 @@ void GPHIKRawClassifier::train ( const std::vector< const NICE::SparseVector *>
 
   this->clearSetsOfTablesAandB();
   this->clearSetsOfTablesT();
+  this->packedT.clear();
+  this->clearSetsOfCompactTables();
 
 
   // sort examples in each dimension and "transpose" the feature matrix
@@ -675,6 +728,9 @@ void GPHIKRawClassifier::train ( const std::vector< const NICE::SparseVector *>
     delete this->gm;
 
   this->gm = new GMHIKernelRaw ( _examples, this->d_noise, this->q );
+  this->gm->setNumberOfThreads ( this->ui_numThreads );
+  if ( this->nnz_per_dimension != NULL )
+    delete [] this->nnz_per_dimension;
   this->nnz_per_dimension = this->gm->getNNZPerDimension();
   this->num_dimension     = this->gm->getNumberOfDimensions();
 
@@ -701,53 +757,117 @@ void GPHIKRawClassifier::train ( const std::vector< const NICE::SparseVector *>
   this->gm->getDiagonalElements ( diagonalElements );
   this->solver->setJacobiPreconditioner ( diagonalElements );
 
+  // optionally solve the linear equations of all classes at once
+  NICE::Matrix alphaBlock;
+  if ( this->blockSolver != NULL )
+  {
+    if (b_verbose)
+        std::cerr << "Training for all " << _binLabels.size() << " classes simultaneously" << endl;
+
+    NICE::Matrix yBlock ( this->num_examples, _binLabels.size() );
+    alphaBlock.resize ( this->num_examples, _binLabels.size() );
+    uint column = 0;
+    for ( std::map<uint, NICE::Vector>::const_iterator i = _binLabels.begin();
+          i != _binLabels.end();
+          i++, column++
+        )
+    {
+      for ( uint j = 0; j < this->num_examples; j++ )
+      {
+        yBlock(j,column) = i->second[j];
+        // initial solution, see below
+        alphaBlock(j,column) = i->second[j] / eigenMax[0];
+      }
+    }
+
+    this->blockSolver->setJacobiPreconditioner ( diagonalElements );
+    this->blockSolver->solveLin ( *gm, yBlock, alphaBlock );
+  }
+
   // solve linear equations for each class
-  // be careful when parallising this!
+  // the classes are independent of each other: every thread uses its own copy of the solver
+  // and the kernel multiplications as well as the computation of the lookup tables do not
+  // modify gm, such that the results do not depend on the number of threads
+  int numClasses = _binLabels.size();
+  std::vector<uint> classNumbers;
+  std::vector<const NICE::Vector *> binaryLabels;
   for ( std::map<uint, NICE::Vector>::const_iterator i = _binLabels.begin();
         i != _binLabels.end();
         i++
       )
   {
-    uint classno = i->first;
-    if (b_verbose)
-        std::cerr << "Training for class " << classno << endl;
-    const NICE::Vector & y = i->second;
-    NICE::Vector alpha;
-
-
-  /** About finding a good initial solution (see also GPLikelihoodApproximation)
-    * K~ = K + sigma^2 I
-    *
-    * K~ \approx lambda_max v v^T
-    * \lambda_max v v^T * alpha = k_*     | multiply with v^T from left
-    * => \lambda_max v^T alpha = v^T k_*
-    * => alpha = k_* / lambda_max could be a good initial start
-    * If we put everything in the first equation this gives us
-    * v = k_*
-    *  This reduces the number of iterations by 5 or 8
-    */
-    alpha = (y * (1.0 / eigenMax[0]) );
-
-    this->solver->solveLin( *gm, y, alpha );
+    classNumbers.push_back ( i->first );
+    binaryLabels.push_back ( &(i->second) );
+  }
+
+  std::vector<double **> tablesA ( numClasses, (double **) NULL );
+  std::vector<double **> tablesB ( numClasses, (double **) NULL );
+  std::vector<double *>  tablesT ( numClasses, (double *) NULL );
+
+#ifdef NICE_USELIB_OPENMP
+  int numThreads = ( this->ui_numThreads == 0 ) ? omp_get_max_threads() : (int) this->ui_numThreads;
+  numThreads = std::max ( 1, std::min ( numThreads, numClasses ) );
+  // with a single thread, gm is still allowed to parallelize over the dimensions
+#pragma omp parallel num_threads( numThreads ) if ( numThreads > 1 )
+#endif
+  {
+    ILSConjugateGradients threadSolver ( *(this->solver) );
+
+#ifdef NICE_USELIB_OPENMP
+#pragma omp for schedule( dynamic )
+#endif
+    for ( int cnt = 0; cnt < numClasses; cnt++ )
+    {
+      const NICE::Vector & y = *(binaryLabels[cnt]);
+      NICE::Vector alpha;
+
+      if ( this->blockSolver != NULL )
+      {
+        alpha.resize ( this->num_examples );
+        for ( uint j = 0; j < this->num_examples; j++ )
+          alpha[j] = alphaBlock(j,cnt);
+      }
+      else
+      {
+        if (b_verbose)
+            std::cerr << "Training for class " << classNumbers[cnt] << endl;
+
+
+      /** About finding a good initial solution (see also GPLikelihoodApproximation)
+        * K~ = K + sigma^2 I
+        *
+        * K~ \approx lambda_max v v^T
+        * \lambda_max v v^T * alpha = k_*     | multiply with v^T from left
+        * => \lambda_max v^T alpha = v^T k_*
+        * => alpha = k_* / lambda_max could be a good initial start
+        * If we put everything in the first equation this gives us
+        * v = k_*
+        *  This reduces the number of iterations by 5 or 8
+        */
+        alpha = (y * (1.0 / eigenMax[0]) );
+
+        threadSolver.solveLin( *gm, y, alpha );
+      }
 
 //    //debug
 //      std::cerr << "alpha: " << alpha << std::endl;
 
-    // get lookup tables, A, B, etc. and store them
-    this->gm->updateTablesAandB( alpha );
-    double **A = this->gm->getTableA();
-    double **B = this->gm->getTableB();
+      // get lookup tables, A, B, etc. (T only for quantization)
+      this->gm->computeLookupTables ( alpha, tablesA[cnt], tablesB[cnt], tablesT[cnt] );
+    }
+  }
 
-    this->precomputedA.insert ( std::pair<uint, PrecomputedType> ( classno, A ) );
-    this->precomputedB.insert ( std::pair<uint, PrecomputedType> ( classno, B ) );
+  // store the lookup tables in the order of the classes
+  for ( int cnt = 0; cnt < numClasses; cnt++ )
+  {
+    uint classno = classNumbers[cnt];
+    this->precomputedA.insert ( std::pair<uint, PrecomputedType> ( classno, tablesA[cnt] ) );
+    this->precomputedB.insert ( std::pair<uint, PrecomputedType> ( classno, tablesB[cnt] ) );
 
     // Quantization for classification?
     if ( this->q != NULL )
     {
-      this->gm->updateTableT( alpha );
-      double *T = this->gm->getTableT ( );
-      this->precomputedT.insert( std::pair<uint, double * > ( classno, T ) );
-
+      this->precomputedT.insert( std::pair<uint, double * > ( classno, tablesT[cnt] ) );
     }
   }
 
@@ -757,6 +877,37 @@ void GPHIKRawClassifier::train ( const std::vector< const NICE::SparseVector *>
     this->clearSetsOfTablesAandB();
   }
 
+  // optionally replace the LUTs of all classes by a single packed one
+  if ( ( this->q != NULL ) && this->b_usePackedLUT )
+  {
+    this->packedT.pack ( this->precomputedT, this->num_dimension, this->q->getNumberOfBins() );
+    this->clearSetsOfTablesT();
+  }
+  // optionally replace the LUTs of every class by tables with reduced precision
+  // (the packed LUT is kept in double precision)
+  else if ( this->lutPrecision != CompactLookupTable::PRECISION_DOUBLE )
+  {
+    if ( this->q != NULL )
+    {
+      for ( std::map< uint, double * >::const_iterator itT = this->precomputedT.begin(); itT != this->precomputedT.end(); itT++ )
+        this->compactT.insert ( std::pair<uint, CompactLookupTable *> ( itT->first,
+                                  new CompactLookupTable ( itT->second, this->num_dimension, this->q->getNumberOfBins(), this->lutPrecision ) ) );
+      this->clearSetsOfTablesT();
+    }
+    else
+    {
+      for ( std::map< uint, PrecomputedType >::const_iterator itA = this->precomputedA.begin(); itA != this->precomputedA.end(); itA++ )
+      {
+        const PrecomputedType & B = this->precomputedB.find ( itA->first )->second;
+        this->compactA.insert ( std::pair<uint, CompactLookupTable *> ( itA->first,
+                                  new CompactLookupTable ( itA->second, this->num_dimension, this->nnz_per_dimension, this->lutPrecision ) ) );
+        this->compactB.insert ( std::pair<uint, CompactLookupTable *> ( itA->first,
+                                  new CompactLookupTable ( B, this->num_dimension, this->nnz_per_dimension, this->lutPrecision ) ) );
+      }
+      this->clearSetsOfTablesAandB();
+    }
+  }
+
 
   t.stop();
   if ( this->b_verbose )
@@ -771,3 +922,341 @@ void GPHIKRawClassifier::train ( const std::vector< const NICE::SparseVector *>
 
 
 }
+
+///////////////////// INTERFACE PERSISTENT /////////////////////
+// interface specific methods for store and restore
+///////////////////// INTERFACE PERSISTENT /////////////////////
+
+namespace
+{
+  /** name of the section of a single class, e.g., "A.3" */
+  std::string classSectionName ( const std::string & _prefix,
+                                 const uint & _classno
+                               )
+  {
+    std::ostringstream name;
+    name << _prefix << "." << _classno;
+    return name.str();
+  }
+
+  /** class numbers of a map of tables */
+  template<class S> std::vector<uint> classNumbersOf ( const std::map<uint, S> & _tables )
+  {
+    std::vector<uint> classNumbers;
+    for ( typename std::map<uint, S>::const_iterator it = _tables.begin(); it != _tables.end(); it++ )
+      classNumbers.push_back ( it->first );
+    return classNumbers;
+  }
+
+  /** copy the section _name into the per-dimension arrays of a table A or B */
+  double ** restoreTableAorB ( const NICE::BinaryModelReader & _reader,
+                               const std::string & _name,
+                               const uint * _nnzPerDimension,
+                               const uint & _numDimension
+                             )
+  {
+    size_t count;
+    const double * values = _reader.getArray<double> ( _name, count );
+
+    size_t totalNNZ ( 0 );
+    for ( uint dim = 0; dim < _numDimension; dim++ )
+      totalNNZ += _nnzPerDimension[dim];
+    if ( count != totalNNZ )
+      fthrow ( Exception, "GPHIKRawClassifier::restore: section " << _name << " has " << count << " entries, but " << totalNNZ << " expected" );
+
+    double ** table = new double * [ _numDimension ];
+    for ( uint dim = 0; dim < _numDimension; dim++ )
+    {
+      uint nnz = _nnzPerDimension[dim];
+      table[dim] = ( nnz > 0 ) ? new double [ nnz ] : NULL;
+      std::copy ( values, values + nnz, table[dim] );
+      values += nnz;
+    }
+    return table;
+  }
+}
+
+void GPHIKRawClassifier::restore ( std::istream & _is,
+                                   int _format
+                                 )
+{
+  if ( ! _is.good() )
+  {
+    std::cerr << "GPHIKRawClassifier::restore -- InStream not initialized - restoring not possible!" << std::endl;
+    throw;
+  }
+
+  std::string tmp;
+  _is >> tmp; //class name
+
+  if ( ! this->isStartTag( tmp, "GPHIKRawClassifier" ) )
+  {
+    std::cerr << " WARNING - attempt to restore GPHIKRawClassifier, but start flag " << tmp << " does not match! Aborting... " << std::endl;
+    throw;
+  }
+
+  //delete everything we knew so far...
+  this->clear();
+
+  BinaryModelReader reader;
+  reader.read ( _is );
+
+  // settings
+  std::istringstream settings ( reader.getString ( "settings" ) );
+  std::string s_lutPrecision;
+  settings >> this->b_isTrained
+           >> this->d_noise
+           >> this->f_tolerance
+           >> this->ui_numThreads
+           >> this->ui_classifyBlockSize
+           >> this->b_usePackedLUT
+           >> s_lutPrecision
+           >> this->b_storeClassificationOnly
+           >> this->num_examples
+           >> this->num_dimension
+           >> this->b_verbose
+           >> this->b_debug;
+  if ( settings.fail() )
+    fthrow ( Exception, "GPHIKRawClassifier::restore: invalid settings" );
+  this->lutPrecision = CompactLookupTable::precisionFromString ( s_lutPrecision );
+  this->confSection = reader.getString ( "confSection" );
+
+  // quantization (stored as text, see store)
+  if ( this->q != NULL )
+  {
+    delete this->q;
+    this->q = NULL;
+  }
+  if ( reader.hasSection ( "quantization" ) )
+  {
+    std::istringstream quantization ( reader.getString ( "quantization" ) );
+    std::string s_quantType;
+    quantization >> s_quantType;
+    s_quantType = this->removeStartTag ( s_quantType );
+
+    if ( s_quantType == "Quantization1DAequiDist0To1" )
+    {
+      this->q = new NICE::Quantization1DAequiDist0To1();
+    }
+    else if ( s_quantType == "Quantization1DAequiDist0ToMax" )
+    {
+      this->q = new NICE::Quantization1DAequiDist0ToMax ( );
+    }
+    else if ( s_quantType == "QuantizationNDAequiDist0ToMax" )
+    {
+      this->q = new NICE::QuantizationNDAequiDist0ToMax ( );
+    }
+    else
+    {
+      fthrow(Exception, "Quantization type is unknown " << s_quantType);
+    }
+
+    this->q->restore ( quantization, _format );
+  }
+
+  std::vector<uint> classNumbers;
+  reader.getArrayCopy ( "knownClasses", classNumbers );
+  this->knownClasses.insert ( classNumbers.begin(), classNumbers.end() );
+
+  if ( this->b_isTrained )
+  {
+    size_t count;
+    const uint * nnz = reader.getArray<uint> ( "nnz", count );
+    if ( count != this->num_dimension )
+      fthrow ( Exception, "GPHIKRawClassifier::restore: " << count << " non-zero counts given for " << this->num_dimension << " dimensions" );
+    this->nnz_per_dimension = new uint [ this->num_dimension ];
+    std::copy ( nnz, nnz + count, this->nnz_per_dimension );
+
+    // sorted training data (missing for classification-only models with quantization)
+    if ( reader.hasSection ( "data.size" ) )
+    {
+      this->gm = new GMHIKernelRaw ( this->d_noise, this->q );
+      this->gm->restoreBinary ( reader, "data." );
+      this->gm->setNumberOfThreads ( this->ui_numThreads );
+    }
+
+    // arrays A and B, classification without quantization
+    reader.getArrayCopy ( "A.classes", classNumbers );
+    for ( std::vector<uint>::const_iterator it = classNumbers.begin(); it != classNumbers.end(); it++ )
+    {
+      this->precomputedA.insert ( std::pair<uint, PrecomputedType> ( *it,
+                                    restoreTableAorB ( reader, classSectionName ( "A", *it ), this->nnz_per_dimension, this->num_dimension ) ) );
+      this->precomputedB.insert ( std::pair<uint, PrecomputedType> ( *it,
+                                    restoreTableAorB ( reader, classSectionName ( "B", *it ), this->nnz_per_dimension, this->num_dimension ) ) );
+    }
+
+    // LUTs T, classification with quantization
+    reader.getArrayCopy ( "T.classes", classNumbers );
+    for ( std::vector<uint>::const_iterator it = classNumbers.begin(); it != classNumbers.end(); it++ )
+    {
+      const double * T = reader.getArray<double> ( classSectionName ( "T", *it ), count );
+      if ( ( this->q == NULL ) || ( count != (size_t) this->num_dimension * this->q->getNumberOfBins() ) )
+        fthrow ( Exception, "GPHIKRawClassifier::restore: LUT of class " << *it << " does not match the quantization" );
+
+      double * table = new double [ count ];
+      std::copy ( T, T + count, table );
+      this->precomputedT.insert ( std::pair<uint, double *> ( *it, table ) );
+    }
+
+    // packed LUTs
+    if ( reader.hasSection ( "packedT" ) )
+    {
+      std::vector<uint> layout;
+      reader.getArrayCopy ( "packedT.layout", layout );
+      reader.getArrayCopy ( "packedT.classes", classNumbers );
+      const double * packed = reader.getArray<double> ( "packedT", count );
+      if ( ( layout.size() != 3 ) || ( count != (size_t) layout[0] * layout[1] * layout[2] ) )
+        fthrow ( Exception, "GPHIKRawClassifier::restore: invalid layout of the packed LUTs" );
+
+      this->packedT.assign ( packed, layout[0], layout[1], layout[2], classNumbers );
+    }
+
+    // tables with reduced precision
+    std::map< uint, CompactLookupTable * > * compactTables[3] = { &(this->compactA), &(this->compactB), &(this->compactT) };
+    const char * compactNames[3] = { "compactA", "compactB", "compactT" };
+    for ( uint t = 0; t < 3; t++ )
+    {
+      reader.getArrayCopy ( std::string ( compactNames[t] ) + ".classes", classNumbers );
+      for ( std::vector<uint>::const_iterator it = classNumbers.begin(); it != classNumbers.end(); it++ )
+      {
+        CompactLookupTable * table = new CompactLookupTable();
+        compactTables[t]->insert ( std::pair<uint, CompactLookupTable *> ( *it, table ) );
+        table->restoreBinary ( reader, classSectionName ( compactNames[t], *it ) + "." );
+      }
+    }
+  }
+
+  _is >> tmp; // end of block
+  if ( ! this->isEndTag( tmp, "GPHIKRawClassifier" ) )
+  {
+    std::cerr << " WARNING - attempt to restore GPHIKRawClassifier, but end flag " << tmp << " does not match! Aborting... " << std::endl;
+    throw;
+  }
+}
+
+void GPHIKRawClassifier::store ( std::ostream & _os,
+                                 int _format
+                               ) const
+{
+  if ( ! _os.good() )
+  {
+    std::cerr << "OutStream not initialized - storing not possible!" << std::endl;
+    return;
+  }
+
+  // show starting point
+  _os << this->createStartTag( "GPHIKRawClassifier" ) << std::endl;
+
+  BinaryModelWriter writer;
+
+  // settings
+  std::ostringstream settings;
+  settings.precision ( numeric_limits<double>::digits10 + 1 );
+  settings << this->b_isTrained << " "
+           << this->d_noise << " "
+           << this->f_tolerance << " "
+           << this->ui_numThreads << " "
+           << this->ui_classifyBlockSize << " "
+           << this->b_usePackedLUT << " "
+           << CompactLookupTable::precisionToString ( this->lutPrecision ) << " "
+           << this->b_storeClassificationOnly << " "
+           << this->num_examples << " "
+           << this->num_dimension << " "
+           << this->b_verbose << " "
+           << this->b_debug;
+  writer.addString ( "settings", settings.str() );
+  writer.addString ( "confSection", this->confSection );
+
+  // the quantization is small, we keep its text representation
+  if ( this->q != NULL )
+  {
+    std::ostringstream quantization;
+    quantization.precision ( numeric_limits<double>::digits10 + 1 );
+    this->q->store ( quantization, _format );
+    writer.addString ( "quantization", quantization.str() );
+  }
+
+  std::vector<uint> classNumbers ( this->knownClasses.begin(), this->knownClasses.end() );
+  writer.addArrayCopy ( "knownClasses", classNumbers );
+
+  if ( this->b_isTrained )
+  {
+    writer.addArray ( "nnz", this->nnz_per_dimension, this->num_dimension );
+
+    // the sorted training data is only needed by classify if there is no quantization
+    if ( ( this->gm != NULL ) && ( ! this->b_storeClassificationOnly || ( this->q == NULL ) ) )
+      this->gm->storeBinary ( writer, "data.", ! this->b_storeClassificationOnly );
+
+    // arrays A and B, the arrays of all dimensions are written one after another
+    writer.addArrayCopy ( "A.classes", classNumbersOf ( this->precomputedA ) );
+    for ( std::map< uint, PrecomputedType >::const_iterator itA = this->precomputedA.begin(); itA != this->precomputedA.end(); itA++ )
+    {
+      const PrecomputedType & B = this->precomputedB.find ( itA->first )->second;
+      std::string nameA = classSectionName ( "A", itA->first );
+      std::string nameB = classSectionName ( "B", itA->first );
+      for ( uint dim = 0; dim < this->num_dimension; dim++ )
+      {
+        writer.addArray ( nameA, itA->second[dim], this->nnz_per_dimension[dim] );
+        writer.addArray ( nameB, B[dim], this->nnz_per_dimension[dim] );
+      }
+    }
+
+    // LUTs T
+    writer.addArrayCopy ( "T.classes", classNumbersOf ( this->precomputedT ) );
+    for ( std::map< uint, double * >::const_iterator itT = this->precomputedT.begin(); itT != this->precomputedT.end(); itT++ )
+      writer.addArray ( classSectionName ( "T", itT->first ), itT->second, (size_t) this->num_dimension * this->q->getNumberOfBins() );
+
+    // packed LUTs
+    if ( ! this->packedT.empty() )
+    {
+      std::vector<uint> layout ( 3 );
+      layout[0] = this->packedT.getNumberOfDimensions();
+      layout[1] = this->packedT.getNumberOfBins();
+      layout[2] = this->packedT.getStride();
+      writer.addArrayCopy ( "packedT.layout", layout );
+      writer.addArrayCopy ( "packedT.classes", this->packedT.getClassNumbers() );
+      writer.addArray ( "packedT", this->packedT.getTable(), this->packedT.getTableSize() );
+    }
+
+    // tables with reduced precision
+    const std::map< uint, CompactLookupTable * > * compactTables[3] = { &(this->compactA), &(this->compactB), &(this->compactT) };
+    const char * compactNames[3] = { "compactA", "compactB", "compactT" };
+    for ( uint t = 0; t < 3; t++ )
+    {
+      writer.addArrayCopy ( std::string ( compactNames[t] ) + ".classes", classNumbersOf ( *(compactTables[t]) ) );
+      for ( std::map< uint, CompactLookupTable * >::const_iterator it = compactTables[t]->begin(); it != compactTables[t]->end(); it++ )
+        it->second->storeBinary ( writer, classSectionName ( compactNames[t], it->first ) + "." );
+    }
+  }
+
+  writer.write ( _os );
+  _os << std::endl;
+
+  // done
+  _os << this->createEndTag( "GPHIKRawClassifier" ) << std::endl;
+}
+
+void GPHIKRawClassifier::clear ()
+{
+  if ( this->gm != NULL )
+  {
+    delete this->gm;
+    this->gm = NULL;
+  }
+
+  this->clearSetsOfTablesAandB();
+  this->clearSetsOfTablesT();
+  this->packedT.clear();
+  this->clearSetsOfCompactTables();
+
+  if ( this->nnz_per_dimension != NULL )
+  {
+    delete [] this->nnz_per_dimension;
+    this->nnz_per_dimension = NULL;
+  }
+
+  this->num_examples  = 0;
+  this->num_dimension = 0;
+  this->knownClasses.clear();
+  this->b_isTrained = false;
+}
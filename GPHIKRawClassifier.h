@@ -20,6 +20,10 @@
 
 //
 #include "quantization/Quantization.h"
+#include "quantization/PackedLookupTables.h"
+#include "quantization/CompactLookupTable.h"
+#include "algebra/ILSBlockConjugateGradients.h"
+#include "BinaryModelFile.h"
 #include "GMHIKernelRaw.h"
 
 namespace NICE {
@@ -30,7 +34,7 @@ namespace NICE {
  * @author Erik Rodner, Alexander Freytag
  */
 
-class GPHIKRawClassifier
+class GPHIKRawClassifier : public NICE::Persistent
 {
 
   protected:
@@ -57,6 +61,12 @@ class GPHIKRawClassifier
     /** Header in configfile where variable settings are stored */
     std::string confSection;
 
+    /** number of threads used for kernel multiplications (0 = all available cores, 1 = sequential) */
+    uint ui_numThreads;
+
+    /** number of test examples processed together during batch classification */
+    uint ui_classifyBlockSize;
+
     //////////////////////////////////////
     //     EigenValue Decomposition     //
     //////////////////////////////////////
@@ -75,6 +85,8 @@ class GPHIKRawClassifier
     double d_noise;
 
     ILSConjugateGradients *solver;
+    /** solver for all classes at once sharing the kernel multiplications (NULL if classes are solved one after another) */
+    ILSBlockConjugateGradients *blockSolver;
     /** object performing feature quantization */
     NICE::Quantization *q;
 
@@ -88,6 +100,20 @@ class GPHIKRawClassifier
     /** precomputed LUTs (1 per class) needed for classification with quantization  */
     std::map< uint, double * > precomputedT;
 
+    /** use a single LUT with layout [dim][bin][class] instead of one LUT per class for classification with quantization */
+    bool b_usePackedLUT;
+    /** packed LUTs of all classes (only used if b_usePackedLUT is set, precomputedT is empty then) */
+    PackedLookupTables packedT;
+
+    /** storage precision of the LUTs used for classification */
+    CompactLookupTable::Precision lutPrecision;
+    /** arrays A (1 per class) with reduced precision, replace precomputedA if lutPrecision is not double */
+    std::map< uint, CompactLookupTable * > compactA;
+    /** arrays B (1 per class) with reduced precision, replace precomputedB if lutPrecision is not double */
+    std::map< uint, CompactLookupTable * > compactB;
+    /** LUTs (1 per class) with reduced precision, replace precomputedT if lutPrecision is not double */
+    std::map< uint, CompactLookupTable * > compactT;
+
     uint *nnz_per_dimension;
     uint num_examples;
     uint num_dimension;
@@ -97,6 +123,9 @@ class GPHIKRawClassifier
     GMHIKernelRaw *gm;
     std::set<uint> knownClasses;
 
+    /** store only what classify needs, i.e., the LUTs and (without quantization) the sorted values per dimension */
+    bool b_storeClassificationOnly;
+
     /////////////////////////
     /////////////////////////
     //  PROTECTED METHODS  //
@@ -105,6 +134,26 @@ class GPHIKRawClassifier
 
     void clearSetsOfTablesAandB();
     void clearSetsOfTablesT();
+    void clearSetsOfCompactTables();
+
+    /**
+    * @brief compute the scores of all classes for the examples _begin, ..., _end-1 and store them in the corresponding rows of _scores.
+    * Every test value is looked up (position in the sorted training data or quantization bin) only once and
+    * the tables of each class are used for the whole block, before switching to the next class.
+    */
+    void computeScoresForBlock ( const std::vector< const NICE::SparseVector *> & _examples,
+                                 const uint & _begin,
+                                 const uint & _end,
+                                 NICE::Matrix & _scores
+                               ) const;
+
+    /**
+    * @brief determine the class of the example in row _row of _scores (computed by computeScoresForBlock),
+    * in the binary setting the score of the smaller class number is set to the negative score of the larger one
+    */
+    uint computeResult ( NICE::Matrix & _scores,
+                         const uint & _row
+                       ) const;
 
 
     /////////////////////////
@@ -186,7 +235,9 @@ class GPHIKRawClassifier
      * @author Alexander Freytag, Erik Rodner
      * @param examples ((std::vector< NICE::SparseVector *>)) to be classified given in a sparse representation
      * @param results (Vector) class number of most likely class per example
-     * @param scores (NICE::Matrix) classification scores for known classes and test examples
+     * @param scores (NICE::Matrix) classification scores for known classes and test examples (one row per example, one column per class number)
+     *
+     * The examples are processed in blocks of classify_block_size examples, which are distributed among num_threads threads.
      */
     void classify ( const std::vector< const NICE::SparseVector *> _examples,
                     NICE::Vector & _results,
@@ -214,6 +265,34 @@ class GPHIKRawClassifier
                  std::map<uint, NICE::Vector> & _binLabels
                );
 
+    ///////////////////// INTERFACE PERSISTENT /////////////////////
+    // interface specific methods for store and restore
+    ///////////////////// INTERFACE PERSISTENT /////////////////////
+
+    /**
+     * @brief Load classifier from external file (stream) written by store
+     */
+    void restore ( std::istream & _is,
+                   int _format = 0
+                 );
+
+    /**
+     * @brief Save classifier to external file (stream)
+     *
+     * The model is always written as binary container (see BinaryModelFile) enclosed in a start and an end tag,
+     * _format is passed to the quantization only. If store_classification_only is set, the example indices of the
+     * training data are skipped and, with quantization, the training data altogether. The restored
+     * classifier can only be used for classification then.
+     */
+    void store ( std::ostream & _os,
+                 int _format = 0
+               ) const;
+
+    /**
+     * @brief Clear classifier object
+     */
+    void clear ();
+
 };
 
 }
@@ -604,4 +604,25 @@ void GPHIKRegression::addMultipleExamples( const std::vector< const NICE::Sparse
   {
     this->gphyper->addMultipleExamples( newExamples, newLabels, performOptimizationAfterIncrement );     
   }
-}
\ No newline at end of file
+}
+
+void GPHIKRegression::removeExample( const uint & exampleIndex,
+                                  const bool & performOptimizationAfterDecrement
+                                )
+{
+  this->removeMultipleExamples ( std::vector< uint > ( 1, exampleIndex ), performOptimizationAfterDecrement );
+}
+
+void GPHIKRegression::removeMultipleExamples( const std::vector< uint > & exampleIndices,
+                                           const bool & performOptimizationAfterDecrement
+                                         )
+{
+  //are examples to remove given? If not, nothing has to be done
+  if ( exampleIndices.size() < 1 )
+    return;
+
+  if ( ! this->b_isTrained )
+    fthrow ( Exception, "Regression object not initially trained yet -- examples can not be removed!" );
+
+  this->gphyper->removeMultipleExamples( exampleIndices, performOptimizationAfterDecrement );
+}
@@ -252,6 +252,20 @@ class GPHIKRegression : public NICE::Persistent, public NICE::OnlineLearnable
                                       const bool & performOptimizationAfterIncrement = true
                                     );       
 
+    /** 
+     * @brief remove a single example (index in the order of insertion)
+     */    
+    virtual void removeExample( const uint & exampleIndex,
+                                const bool & performOptimizationAfterDecrement = true
+                              );
+
+    /** 
+     * @brief remove several examples (indices in the order of insertion), the remaining examples are numbered consecutively afterwards
+     */    
+    virtual void removeMultipleExamples( const std::vector< uint > & exampleIndices,
+                                         const bool & performOptimizationAfterDecrement = true
+                                       );
+
 
 
 };
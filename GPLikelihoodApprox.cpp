@@ -9,6 +9,10 @@
 // STL includes
 #include <iostream>
 
+#ifdef NICE_USELIB_OPENMP
+#include <omp.h>
+#endif
+
 // NICE-core includes
 #include <core/algebra/CholeskyRobust.h>
 #include <core/algebra/ILSConjugateGradients.h>
@@ -63,6 +67,45 @@ GPLikelihoodApprox::GPLikelihoodApprox( const std::map<uint, NICE::Vector> & _bi
   this->debug = false;
   
   this->initialAlphaGuess = NULL;
+  this->blockLinsolver = NULL;
+  this->logDetApprox = NULL;
+  this->subspaceIteration = NULL;
+  this->ui_numThreads = 1;
+  this->ui_gradientNumProbes = 10;
+  this->ui_gradientSeed = 0;
+}
+
+GPLikelihoodApprox::GPLikelihoodApprox( const GPLikelihoodApprox & _other,
+                                        ImplicitKernelMatrix *_ikm,
+                                        IterativeLinearSolver *_linsolver,
+                                        EigValues *_eig
+                                      )
+
+      : CostFunction( _ikm->getNumParameters() )
+{
+  this->binaryLabels = _other.binaryLabels;
+  this->ikm = _ikm;
+  this->linsolver = _linsolver;
+  this->eig = _eig;
+
+  this->nrOfClasses = _other.nrOfClasses;
+
+  this->min_nlikelihood = std::numeric_limits<double>::max();
+  this->verifyApproximation = _other.verifyApproximation;
+  
+  this->nrOfEigenvaluesToConsider = _other.nrOfEigenvaluesToConsider;
+
+  this->verbose = _other.verbose;
+  this->debug = _other.debug;
+  
+  // the initial guess is only read
+  this->initialAlphaGuess = _other.initialAlphaGuess;
+  this->blockLinsolver = NULL;
+  this->logDetApprox = NULL;
+  this->subspaceIteration = NULL;
+  this->ui_numThreads = 1;
+  this->ui_gradientNumProbes = _other.ui_gradientNumProbes;
+  this->ui_gradientSeed = _other.ui_gradientSeed;
 }
 
 GPLikelihoodApprox::~GPLikelihoodApprox()
@@ -91,6 +134,16 @@ const std::map<uint, Vector> & GPLikelihoodApprox::getBestAlphas () const
   return this->min_alphas;
 }
 
+void GPLikelihoodApprox::mergeBestSolution ( const GPLikelihoodApprox & _other )
+{
+  if ( _other.min_nlikelihood < this->min_nlikelihood )
+  {
+    this->min_nlikelihood = _other.min_nlikelihood;
+    this->min_parameter = _other.min_parameter;
+    this->min_alphas = _other.min_alphas;
+  }
+}
+
 void GPLikelihoodApprox::calculateLikelihood ( double _mypara, 
                                                const FeatureMatrix & _f, 
                                                const std::map< uint, NICE::Vector > & _yset, 
@@ -145,12 +198,83 @@ void GPLikelihoodApprox::calculateLikelihood ( double _mypara,
   cerr << "OPTGT: " << _mypara << " " << gt_nlikelihood << " " << gt_logdet << " " << gt_dataterm << endl;
 }
 
+void GPLikelihoodApprox::solveLinBlock ( std::map<uint, NICE::Vector> & _alphas )
+{
+  uint n = ikm->rows();
+  NICE::Matrix Y ( n, this->binaryLabels.size() );
+  NICE::Matrix X ( n, this->binaryLabels.size() );
+
+  uint column = 0;
+  for ( std::map<uint, NICE::Vector>::const_iterator j = binaryLabels.begin(); j != binaryLabels.end() ; j++, column++ )
+  {
+    const NICE::Vector & alphaInit = _alphas[ j->first ];
+    for ( uint i = 0; i < n; i++ )
+    {
+      Y(i,column) = j->second[i];
+      X(i,column) = alphaInit[i];
+    }
+  }
+
+  this->blockLinsolver->solveLin ( *ikm, Y, X );
+
+  column = 0;
+  for ( std::map<uint, NICE::Vector>::const_iterator j = binaryLabels.begin(); j != binaryLabels.end() ; j++, column++ )
+  {
+    NICE::Vector & alpha = _alphas[ j->first ];
+    for ( uint i = 0; i < n; i++ )
+      alpha[i] = X(i,column);
+  }
+}
+
+void GPLikelihoodApprox::solveLinPerClass ( std::map<uint, NICE::Vector> & _alphas )
+{
+  std::vector<const NICE::Vector *> labels;
+  std::vector<NICE::Vector *> alphas;
+  for ( std::map<uint, NICE::Vector>::const_iterator j = binaryLabels.begin(); j != binaryLabels.end() ; j++ )
+  {
+    labels.push_back ( &(j->second) );
+    alphas.push_back ( &(_alphas[ j->first ]) );
+  }
+  int numClasses = labels.size();
+
+  int numThreads = 1;
+#ifdef NICE_USELIB_OPENMP
+  // only the conjugate gradient solver can be copied for each thread
+  ILSConjugateGradients *linsolver_cg = dynamic_cast<ILSConjugateGradients *> ( linsolver );
+  if ( linsolver_cg != NULL )
+  {
+    numThreads = ( this->ui_numThreads == 0 ) ? omp_get_max_threads() : (int) this->ui_numThreads;
+    numThreads = std::max ( 1, std::min ( numThreads, numClasses ) );
+  }
+#endif
+
+  if ( numThreads <= 1 )
+  {
+    for ( int cnt = 0; cnt < numClasses; cnt++ )
+      linsolver->solveLin ( *ikm, *(labels[cnt]), *(alphas[cnt]) );
+    return;
+  }
+
+#ifdef NICE_USELIB_OPENMP
+  // every class is solved by exactly the same sequence of operations as in the sequential case,
+  // the kernel multiplications within run sequentially here, but sum up the dimensions in the same
+  // chunks as in the parallel case (see FastMinKernel::hik_kernel_multiply), therefore, the solutions
+  // do not depend on the number of threads
+#pragma omp parallel num_threads( numThreads )
+  {
+    ILSConjugateGradients threadSolver ( *linsolver_cg );
+
+#pragma omp for schedule( dynamic )
+    for ( int cnt = 0; cnt < numClasses; cnt++ )
+      threadSolver.solveLin ( *ikm, *(labels[cnt]), *(alphas[cnt]) );
+  }
+#endif
+}
+
 void GPLikelihoodApprox::computeAlphaDirect(const OPTIMIZATION::matrix_type & _x, 
                                             const NICE::Vector & _eigenValues 
                                            )
 {
-  Timer t;
-  
   NICE::Vector diagonalElements; 
   ikm->getDiagonalElements ( diagonalElements );
 
@@ -159,6 +283,8 @@ void GPLikelihoodApprox::computeAlphaDirect(const OPTIMIZATION::matrix_type & _x
 
   if ( linsolver_cg != NULL )
     linsolver_cg->setJacobiPreconditioner ( diagonalElements );
+  if ( this->blockLinsolver != NULL )
+    this->blockLinsolver->setJacobiPreconditioner ( diagonalElements );
   
 
   // all alpha vectors will be stored!
@@ -191,17 +317,35 @@ void GPLikelihoodApprox::computeAlphaDirect(const OPTIMIZATION::matrix_type & _x
      *  This reduces the number of iterations by 5 or 8
      */
     NICE::Vector alpha;
-    alpha = (binaryLabels[classCnt] * (1.0 / _eigenValues[0]) );
-
-    if ( verbose )
-      std::cerr << "Using the standard solver ..." << std::endl;
-
-    t.start();
-    linsolver->solveLin ( *ikm, binaryLabels[classCnt], alpha );
-    t.stop();
+    std::map<uint, NICE::Vector>::const_iterator guessIt;
+    if ( ( this->initialAlphaGuess != NULL ) &&
+         ( ( guessIt = this->initialAlphaGuess->find ( classCnt ) ) != this->initialAlphaGuess->end() ) &&
+         ( guessIt->second.size() == j->second.size() )
+       )
+    {
+      // see (0), e.g., the solution before new examples were added
+      alpha = guessIt->second;
+    }
+    else
+      alpha = (binaryLabels[classCnt] * (1.0 / _eigenValues[0]) );
 
     alphas.insert( std::pair<uint, NICE::Vector> ( classCnt, alpha) );
   }  
+
+  // solve the linear equation systems, starting from the initial solutions computed above
+  if ( this->blockLinsolver != NULL )
+  {
+    // all classes at once
+    if ( verbose )
+      std::cerr << "Using the block solver ..." << std::endl;
+    this->solveLinBlock ( alphas );
+  }
+  else
+  {
+    if ( verbose )
+      std::cerr << "Using the standard solver ..." << std::endl;
+    this->solveLinPerClass ( alphas );
+  }
   
   // save the parameter value and alpha vectors
   ikm->getParameters ( min_parameter );
@@ -261,7 +405,24 @@ double GPLikelihoodApprox::evaluate(const OPTIMIZATION::matrix_type & _x)
   //old version: just use the first eigenvalue
   
   // we have to re-compute EV and EW in all cases, since we change the hyper parameter and thereby the kernel matrix 
-  eig->getEigenvalues( *ikm, eigenmax, eigenmaxvectors, rank ); 
+  if ( ( this->subspaceIteration != NULL ) && this->subspaceIteration->hasSubspace ( ikm->rows(), rank ) )
+  {
+    // the eigenvectors of the previous evaluation are a good starting subspace for the current kernel matrix
+    uint iterations = this->subspaceIteration->getEigenvalues ( *ikm, eigenmax, eigenmaxvectors );
+    if ( this->verbose )
+      std::cerr << "warm-started subspace iteration needed " << iterations << " iterations" << std::endl;
+  }
+  else
+  {
+    eig->getEigenvalues( *ikm, eigenmax, eigenmaxvectors, rank ); 
+
+    // refine once, such that A*W is available for the deflation of the linear solver
+    if ( this->subspaceIteration != NULL )
+    {
+      this->subspaceIteration->setSubspace ( eigenmaxvectors );
+      this->subspaceIteration->getEigenvalues ( *ikm, eigenmax, eigenmaxvectors );
+    }
+  }
   if ( this->verbose )
     std::cerr << "eigenmax: " << eigenmax << std::endl;
       
@@ -278,6 +439,8 @@ double GPLikelihoodApprox::evaluate(const OPTIMIZATION::matrix_type & _x)
   //TODO why do we need this?  
   if ( linsolver_cg != NULL )
     linsolver_cg->setJacobiPreconditioner ( diagonalElements );
+  if ( this->blockLinsolver != NULL )
+    this->blockLinsolver->setJacobiPreconditioner ( diagonalElements );
   
 
   // all alpha vectors will be stored!
@@ -330,51 +493,77 @@ double GPLikelihoodApprox::evaluate(const OPTIMIZATION::matrix_type & _x)
     
 
     
+    alphas[classCnt] = alpha;
+  }
+
+  // solve the linear equation systems, starting from the initial solutions computed above
+  t.start();
+  if ( this->blockLinsolver != NULL )
+  {
+    // all classes at once
+    if ( verbose )
+      cerr << "Using the block solver ..." << endl;
+    // the dominant eigenvectors of K + sigma^2 I are deflated, since they slow down CG the most
+    if ( this->subspaceIteration != NULL )
+      this->blockLinsolver->setDeflationSubspace ( this->subspaceIteration->getEigenvectors(), this->subspaceIteration->getProducts() );
+    this->solveLinBlock ( alphas );
+    this->blockLinsolver->clearDeflationSubspace();
+  }
+  else
+  {
     if ( verbose )
       cerr << "Using the standard solver ..." << endl;
+    this->solveLinPerClass ( alphas );
+  }
+  t.stop();
 
-    t.start();
-    linsolver->solveLin ( *ikm, binaryLabels[classCnt], alpha );
-    t.stop();
-   
+  if ( verbose )
+    std::cerr << "Time used for solving (K + sigma^2 I)^{-1} Y: " << t.getLast() << std::endl;
 
-    if ( verbose )
-      std::cerr << "Time used for solving (K + sigma^2 I)^{-1} y: " << t.getLast() << std::endl;
+  for ( std::map<uint, NICE::Vector>::const_iterator j = binaryLabels.begin(); j != binaryLabels.end() ; j++)
+  {
     // this term is no approximation at all
-    double dataterm = binaryLabels[classCnt].scalarProduct(alpha);
-    binaryDataterms[classCnt] = (dataterm);
-
-    alphas[classCnt] = alpha;
+    double dataterm = j->second.scalarProduct( alphas[j->first] );
+    binaryDataterms[j->first] = (dataterm);
   }
   
   // approximation stuff
   if ( this->verbose )  
     cerr << "Approximating logdet(K) ..." << endl;
   t.start();
-  LogDetApproxBaiAndGolub la;
-  la.setVerbose(this->verbose);
-
-  //NOTE: this is already the squared frobenius norm, that we are looking for.
-  double frobNormSquared(0.0);
-  
-  // ------------- LOWER BOUND, THAT IS USED --------------------
-  // frobNormSquared ~ \sum \lambda_i^2 <-- LOWER BOUND
-  for (int idx = 0; idx < rank; idx++)
+  double logdet ( 0.0 );
+  if ( this->logDetApprox != NULL )
   {
-    frobNormSquared += (eigenmax[idx] * eigenmax[idx]);
+    // stochastic Lanczos quadrature, only needs multiplications with K + sigma^2 I
+    this->logDetApprox->setVerbose ( this->verbose );
+    logdet = this->logDetApprox->getLogDetApproximation ( *ikm );
   }
+  else
+  {
+    LogDetApproxBaiAndGolub la;
+    la.setVerbose(this->verbose);
 
-                
-  if ( this->verbose )
-    cerr << " frob norm squared: est:" << frobNormSquared << endl;
-  if ( this->verbose )  
-    std::cerr << "trace: " << diagonalElements.Sum() << std::endl;
-  double logdet = la.getLogDetApproximationUpperBound( diagonalElements.Sum(), /* trace = n only for non-transformed features*/
-                             frobNormSquared, /* use a rough approximation of the frobenius norm */
-                             eigenmax[0], /* upper bound for eigen values */
-                             ikm->rows() /* = n */ 
-                          );
+    //NOTE: this is already the squared frobenius norm, that we are looking for.
+    double frobNormSquared(0.0);
   
+    // ------------- LOWER BOUND, THAT IS USED --------------------
+    // frobNormSquared ~ \sum \lambda_i^2 <-- LOWER BOUND
+    for (int idx = 0; idx < rank; idx++)
+    {
+      frobNormSquared += (eigenmax[idx] * eigenmax[idx]);
+    }
+
+                
+    if ( this->verbose )
+      cerr << " frob norm squared: est:" << frobNormSquared << endl;
+    if ( this->verbose )  
+      std::cerr << "trace: " << diagonalElements.Sum() << std::endl;
+    logdet = la.getLogDetApproximationUpperBound( diagonalElements.Sum(), /* trace = n only for non-transformed features*/
+                               frobNormSquared, /* use a rough approximation of the frobenius norm */
+                               eigenmax[0], /* upper bound for eigen values */
+                               ikm->rows() /* = n */ 
+                            );
+  }
   t.stop();
   
   if ( this->verbose )
@@ -388,6 +577,8 @@ double GPLikelihoodApprox::evaluate(const OPTIMIZATION::matrix_type & _x)
   if ( this->verbose )
     cerr << "OPT: " << xv << " " << nlikelihood << " " << logdet << " " << dataterm << endl;
 
+  this->current_alphas = alphas;
+
   if ( nlikelihood < min_nlikelihood )
   {
     min_nlikelihood = nlikelihood;
@@ -399,6 +590,108 @@ double GPLikelihoodApprox::evaluate(const OPTIMIZATION::matrix_type & _x)
   return nlikelihood;
 }
 
+double GPLikelihoodApprox::evaluateWithGradient ( const NICE::Vector & _x,
+                                                  NICE::Vector & _gradient
+                                                )
+{
+  OPTIMIZATION::matrix_type x ( _x.size(), 1 );
+  for ( uint i = 0 ; i < _x.size(); i++ )
+    x(i,0) = _x[i];
+
+  // the gradient needs the alpha vectors of exactly these parameters, which are not cached
+  this->alreadyVisited.erase ( _x.getHashValue() );
+  this->current_alphas.clear();
+  double nlikelihood = this->evaluate ( x );
+
+  _gradient.resize ( _x.size() );
+  _gradient.set ( 0.0 );
+  if ( this->current_alphas.empty() )
+    return nlikelihood;
+
+  uint n = ikm->rows();
+  uint numClasses = this->binaryLabels.size();
+  uint numProbes = this->ui_gradientNumProbes;
+
+  // draw the probes only once (own linear congruential generator, see LogDetApproxStochasticLanczos),
+  // such that the estimated gradients of all evaluations share the same random error
+  if ( ( this->gradientProbes.rows() != n ) || ( this->gradientProbes.cols() != numProbes ) )
+  {
+    unsigned int state = this->ui_gradientSeed;
+    this->gradientProbes.resize ( n, numProbes );
+    for ( uint c = 0; c < numProbes; c++ )
+      for ( uint i = 0; i < n; i++ )
+      {
+        state = 1664525u * state + 1013904223u;
+        this->gradientProbes(i,c) = ( state & 0x80000000u ) ? 1.0 : -1.0;
+      }
+    this->gradientProbeSolutions.resize ( n, numProbes );
+    this->gradientProbeSolutions.set ( 0.0 );
+  }
+
+  // (K + sigma^2 I)^{-1} Z, starting from the solutions of the previous call
+  // (the Jacobi preconditioner of the current parameters has been set by evaluate)
+  Timer t;
+  t.start();
+  if ( this->blockLinsolver != NULL )
+  {
+    if ( this->subspaceIteration != NULL )
+      this->blockLinsolver->setDeflationSubspace ( this->subspaceIteration->getEigenvectors(), this->subspaceIteration->getProducts() );
+    this->blockLinsolver->solveLin ( *ikm, this->gradientProbes, this->gradientProbeSolutions );
+    this->blockLinsolver->clearDeflationSubspace();
+  }
+  else
+  {
+    NICE::Vector z ( n );
+    NICE::Vector u ( n );
+    for ( uint c = 0; c < numProbes; c++ )
+    {
+      for ( uint i = 0; i < n; i++ )
+      {
+        z[i] = this->gradientProbes(i,c);
+        u[i] = this->gradientProbeSolutions(i,c);
+      }
+      linsolver->solveLin ( *ikm, z, u );
+      for ( uint i = 0; i < n; i++ )
+        this->gradientProbeSolutions(i,c) = u[i];
+    }
+  }
+  t.stop();
+  if ( this->verbose )
+    std::cerr << "Time used for solving (K + sigma^2 I)^{-1} Z for " << numProbes << " probes: " << t.getLast() << std::endl;
+
+  // data terms: -alpha_c^T dK alpha_c, trace estimate: nrOfClasses/m * u_i^T dK z_i
+  NICE::Matrix U ( n, numClasses + numProbes );
+  NICE::Matrix V ( n, numClasses + numProbes );
+  NICE::Vector weights ( numClasses + numProbes );
+  uint column = 0;
+  for ( std::map<uint, NICE::Vector>::const_iterator j = this->current_alphas.begin(); j != this->current_alphas.end(); j++, column++ )
+  {
+    for ( uint i = 0; i < n; i++ )
+    {
+      U(i,column) = j->second[i];
+      V(i,column) = j->second[i];
+    }
+    weights[column] = -1.0;
+  }
+  for ( uint c = 0; c < numProbes; c++, column++ )
+  {
+    for ( uint i = 0; i < n; i++ )
+    {
+      U(i,column) = this->gradientProbeSolutions(i,c);
+      V(i,column) = this->gradientProbes(i,c);
+    }
+    weights[column] = this->nrOfClasses / (double) numProbes;
+  }
+
+  if ( !ikm->getBilinearFormGradient ( U, V, weights, _gradient ) )
+    fthrow ( Exception, "GPLikelihoodApprox::evaluateWithGradient: the kernel matrix does not provide analytic derivatives of its parameters" );
+
+  if ( this->verbose )
+    std::cerr << "OPTGRAD: " << _x << " " << _gradient << std::endl;
+
+  return nlikelihood;
+}
+
 void GPLikelihoodApprox::setParameterLowerBound(const double & _parameterLowerBound)
 {
   this->parameterLowerBound = _parameterLowerBound;
@@ -415,6 +708,33 @@ void GPLikelihoodApprox::setInitialAlphaGuess(std::map< uint, NICE::Vector >* _i
 }
 
 
+void GPLikelihoodApprox::setBlockLinsolver ( ILSBlockConjugateGradients * _blockLinsolver )
+{
+  this->blockLinsolver = _blockLinsolver;
+}
+
+void GPLikelihoodApprox::setLogDetApprox ( LogDetApproxStochasticLanczos * _logDetApprox )
+{
+  this->logDetApprox = _logDetApprox;
+}
+
+void GPLikelihoodApprox::setGradientProbes ( const uint & _numProbes, const uint & _seed )
+{
+  this->ui_gradientNumProbes = std::max ( (uint) 1, _numProbes );
+  this->ui_gradientSeed = _seed;
+  this->gradientProbes.resize ( 0, 0 );
+}
+
+void GPLikelihoodApprox::setSubspaceIteration ( EVSubspaceIteration * _subspaceIteration )
+{
+  this->subspaceIteration = _subspaceIteration;
+}
+
+void GPLikelihoodApprox::setNumberOfThreads ( const uint & _numThreads )
+{
+  this->ui_numThreads = _numThreads;
+}
+
 void GPLikelihoodApprox::setBinaryLabels(const std::map<uint, Vector> & _binaryLabels)
 {
   this->binaryLabels = _binaryLabels;
@@ -23,6 +23,9 @@
 // gp-hik-core includes
 #include "gp-hik-core/FastMinKernel.h"
 #include "gp-hik-core/ImplicitKernelMatrix.h"
+#include "gp-hik-core/algebra/EVSubspaceIteration.h"
+#include "gp-hik-core/algebra/ILSBlockConjugateGradients.h"
+#include "gp-hik-core/algebra/LogDetApproxStochasticLanczos.h"
 #include "gp-hik-core/parameterizedFunctions/ParameterizedFunction.h"
 
 namespace NICE {
@@ -44,6 +47,13 @@ class GPLikelihoodApprox : public OPTIMIZATION::CostFunction
     /** method for solving linear equation systems */
     IterativeLinearSolver *linsolver;
 
+    /** optional method for solving the linear equation systems of all classes at once (used instead of linsolver if given) */
+    ILSBlockConjugateGradients *blockLinsolver;
+
+    /** optional warm-started eigenvalue method reusing the eigenvectors of the previous evaluation (used instead of eig if given).
+    * Its Ritz vectors are also used as deflation subspace of blockLinsolver. */
+    EVSubspaceIteration *subspaceIteration;
+
     /** object providing fast calculations */
     ImplicitKernelMatrix *ikm;
 
@@ -55,7 +65,38 @@ class GPLikelihoodApprox : public OPTIMIZATION::CostFunction
     
     /** To define how fine the approximation of the squared frobenius norm will be*/
     int nrOfEigenvaluesToConsider;
+
+    /** optional stochastic Lanczos estimate of logdet(K + sigma^2 I) (used instead of the Bai and Golub upper bound if given) */
+    LogDetApproxStochasticLanczos *logDetApprox;
+
+    /** number of probe vectors of the trace estimate in evaluateWithGradient */
+    uint ui_gradientNumProbes;
+
+    /** seed of the random number generator used for the probe vectors of the trace estimate */
+    uint ui_gradientSeed;
+
+    /** Rademacher probe vectors of the trace estimate (one per column), drawn once per number of examples */
+    NICE::Matrix gradientProbes;
+
+    /** (K + sigma^2 I)^{-1} times the probe vectors of the previous call, used as initial solutions */
+    NICE::Matrix gradientProbeSolutions;
     
+    /**
+    * @brief Solve (K + sigma^2 I) alpha = y for all binary label vectors at once using blockLinsolver
+    *
+    * @param _alphas initial solutions (one per class, same keys as binaryLabels), overwritten with the solutions
+    */
+    void solveLinBlock ( std::map<uint, NICE::Vector> & _alphas );
+
+    /**
+    * @brief Solve (K + sigma^2 I) alpha = y for every binary label vector separately using linsolver.
+    * If linsolver is a conjugate gradient solver, the classes are distributed among ui_numThreads threads,
+    * each of them using its own copy of the solver.
+    *
+    * @param _alphas initial solutions (one per class, same keys as binaryLabels), overwritten with the solutions
+    */
+    void solveLinPerClass ( std::map<uint, NICE::Vector> & _alphas );
+
     //! only for debugging purposes, printing some statistics
     void calculateLikelihood ( double _mypara, 
                                const FeatureMatrix & _f, 
@@ -69,6 +110,9 @@ class GPLikelihoodApprox : public OPTIMIZATION::CostFunction
     //! alpha vectors of the best solution
     std::map<uint, Vector> min_alphas;
 
+    //! alpha vectors of the last evaluation which was not taken from the cache
+    std::map<uint, Vector> current_alphas;
+
     //! minimal value of the likelihood
     double min_nlikelihood;
 
@@ -90,6 +134,9 @@ class GPLikelihoodApprox : public OPTIMIZATION::CostFunction
     bool verbose;    
     /** debug flag for several outputs useful for debugging*/
     bool debug;  
+
+    /** number of threads used for solving the linear equation systems of different classes (0 = all available cores, 1 = sequential) */
+    uint ui_numThreads;
     
 
   public:
@@ -104,6 +151,17 @@ class GPLikelihoodApprox : public OPTIMIZATION::CostFunction
                         int _nrOfEigenvaluesToConsider = 1
                       );
       
+    /**
+    * @brief constructor for evaluating other parameters of the same problem concurrently:
+    * copies the labels and settings of _other, but works on its own kernel matrix and solvers.
+    * The optional methods (block solver, logdet approximation, subspace iteration) are not copied.
+    */
+    GPLikelihoodApprox( const GPLikelihoodApprox & _other,
+                        ImplicitKernelMatrix *_ikm,
+                        IterativeLinearSolver *_linsolver,
+                        EigValues *_eig
+                      );
+
     /** simple destructor */
     virtual ~GPLikelihoodApprox();
      
@@ -128,16 +186,48 @@ class GPLikelihoodApprox : public OPTIMIZATION::CostFunction
     * @return likelihood 
     */
     virtual double evaluate(const OPTIMIZATION::matrix_type & x);
+
+    /**
+    * @brief Evaluate the likelihood and its gradient for given hyperparameters
+    *
+    * With K~ = K + sigma^2 I and alpha_c = K~^{-1} y_c, the gradient of the negative log-likelihood is
+    * nrOfClasses * tr(K~^{-1} dK~/dtheta) - sum_c alpha_c^T dK~/dtheta alpha_c.
+    * The trace is estimated with Rademacher probe vectors z_i, i.e., tr(K~^{-1} dK~/dtheta) \approx 1/m sum_i (K~^{-1} z_i)^T dK~/dtheta z_i,
+    * which needs a single solve with m right hand sides. All quadratic forms are then computed with
+    * ImplicitKernelMatrix::getBilinearFormGradient at once. The trace estimate refers to the exact logdet, hence,
+    * the gradient matches the likelihood best if the stochastic Lanczos logdet approximation is used.
+    *
+    * @param _x hyperparameters
+    * @param _gradient resulting gradient (zero if _x is out of bounds)
+    *
+    * @return likelihood (see evaluate)
+    */
+    double evaluateWithGradient ( const NICE::Vector & _x,
+                                  NICE::Vector & _gradient
+                                );
      
     
     // ------ get and set methods ------
     const NICE::Vector & getBestParameters () const { return min_parameter; };
     const std::map<uint, Vector> & getBestAlphas () const;
+    double getBestLikelihood () const { return min_nlikelihood; };
+
+    /**
+    * @brief take over the best solution of _other if its likelihood is smaller (ties keep the current solution)
+    */
+    void mergeBestSolution ( const GPLikelihoodApprox & _other );
     
     void setParameterLowerBound(const double & _parameterLowerBound);
     void setParameterUpperBound(const double & _parameterUpperBound);
     
     void setInitialAlphaGuess(std::map<uint, NICE::Vector> * _initialAlphaGuess);
+    
+    void setBlockLinsolver ( ILSBlockConjugateGradients * _blockLinsolver );
+    void setLogDetApprox ( LogDetApproxStochasticLanczos * _logDetApprox );
+    /** set the number of probe vectors and the seed of the trace estimate in evaluateWithGradient */
+    void setGradientProbes ( const uint & _numProbes, const uint & _seed = 0 );
+    void setSubspaceIteration ( EVSubspaceIteration * _subspaceIteration );
+    void setNumberOfThreads ( const uint & _numThreads );
     void setBinaryLabels(const std::map<uint, Vector> & _binaryLabels);
     
     void setVerbose( const bool & _verbose );
@@ -135,6 +135,27 @@ Vector IKMLinearCombination::getParameterUpperBounds() const
   return uB;
 }
 
+bool IKMLinearCombination::getBilinearFormGradient ( const NICE::Matrix & _U,
+                                                     const NICE::Matrix & _V,
+                                                     const NICE::Vector & _weights,
+                                                     NICE::Vector & _gradient
+                                                   ) const
+{
+  uint ind = 0;
+  _gradient.resize ( getNumParameters() );
+  for ( vector<ImplicitKernelMatrix *>::const_iterator i = matrices.begin(); i != matrices.end(); i++, ind++ )
+  {
+    ImplicitKernelMatrix *ikm = *i;
+    if ( ikm->getNumParameters() == 0 ) continue;
+    Vector singleGradient;
+    if ( !ikm->getBilinearFormGradient ( _U, _V, _weights, singleGradient ) )
+      return false;
+    for ( uint k = 0; k < singleGradient.size(); k++ )
+      _gradient[ parameterRanges[ ind ] + k ] = singleGradient[k];
+  }
+  return true;
+}
+
 void IKMLinearCombination::updateParameterRanges()
 {
   if ( matrices.size() == 0 ) {
@@ -178,6 +199,19 @@ void IKMLinearCombination::multiply (NICE::Vector & y, const NICE::Vector & x) c
   }
 }
 
+void IKMLinearCombination::multiplyBlock (NICE::Matrix & _Y, const NICE::Matrix & _X) const
+{
+  _Y.resize( rows(), _X.cols() );
+  _Y.set(0.0);
+  for ( vector<ImplicitKernelMatrix *>::const_iterator i = matrices.begin(); i != matrices.end(); i++ )
+  {
+    ImplicitKernelMatrix *ikm = *i;
+    Matrix YSingle;
+    ikm->multiplyBlock ( YSingle, _X );
+    _Y += YSingle;
+  }
+}
+
 uint IKMLinearCombination::rows () const
 {
   return cols();
@@ -294,4 +328,24 @@ void IKMLinearCombination::addMultipleExamples( const std::vector< const NICE::S
   {
     (*i)->addMultipleExamples( newExamples, newLabels);
   }  
-}
\ No newline at end of file
+}
+
+void IKMLinearCombination::removeExample( const uint & exampleIndex,
+			       const bool & performOptimizationAfterDecrement
+			     )
+{
+  for ( std::vector<NICE::ImplicitKernelMatrix *>::iterator i = matrices.begin(); i != matrices.end(); i++ )
+  {
+    (*i)->removeExample( exampleIndex, performOptimizationAfterDecrement );
+  }  
+}
+
+void IKMLinearCombination::removeMultipleExamples( const std::vector< uint > & exampleIndices,
+					const bool & performOptimizationAfterDecrement
+				      )
+{
+  for ( std::vector<NICE::ImplicitKernelMatrix *>::iterator i = matrices.begin(); i != matrices.end(); i++ )
+  {
+    (*i)->removeMultipleExamples( exampleIndices, performOptimizationAfterDecrement );
+  }  
+}
@@ -53,11 +53,21 @@ class IKMLinearCombination : public ImplicitKernelMatrix
     virtual Vector getParameterLowerBounds() const;
     virtual Vector getParameterUpperBounds() const;
 
+    /** gradients of all models, concatenated like the parameters, see ImplicitKernelMatrix::getBilinearFormGradient */
+    virtual bool getBilinearFormGradient ( const NICE::Matrix & _U,
+                                           const NICE::Matrix & _V,
+                                           const NICE::Vector & _weights,
+                                           NICE::Vector & _gradient
+                                         ) const;
+
     void addModel ( ImplicitKernelMatrix *ikm );
     
     /** multiply with a vector: A*x = y */
     virtual void multiply (NICE::Vector & y, const NICE::Vector & x) const;
 
+    /** multiply with several vectors at once: A*X = Y */
+    virtual void multiplyBlock (NICE::Matrix & _Y, const NICE::Matrix & _X) const;
+
     /** get the number of rows in A */
     virtual uint rows () const;
 
@@ -92,6 +102,14 @@ class IKMLinearCombination : public ImplicitKernelMatrix
 				      const bool & performOptimizationAfterIncrement = true
 				    );      
 
+    virtual void removeExample( const uint & exampleIndex,
+				const bool & performOptimizationAfterDecrement = true
+			      );
+
+    virtual void removeMultipleExamples( const std::vector< uint > & exampleIndices,
+					 const bool & performOptimizationAfterDecrement = true
+				       );
+
 };
 
 }
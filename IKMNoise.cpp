@@ -8,6 +8,7 @@
 // STL includes
 #include <iostream>
 #include <limits>
+#include <set>
 
 // NICE-core includes
 #include "IKMNoise.h"
@@ -96,11 +97,34 @@ Vector IKMNoise::getParameterUpperBounds() const
   Vector uB;
   if ( optimizeNoise ) {
     uB.resize(1);
-    uB[0] = -std::numeric_limits<double>::max();
+    uB[0] = std::numeric_limits<double>::max();
   }
   return uB;
 }
 
+bool IKMNoise::getBilinearFormGradient ( const NICE::Matrix & _U,
+                                         const NICE::Matrix & _V,
+                                         const NICE::Vector & _weights,
+                                         NICE::Vector & _gradient
+                                       ) const
+{
+  _gradient.resize ( getNumParameters() );
+  if ( !optimizeNoise )
+    return true;
+
+  // the parameter is log(noise), hence, d(noise I)/d(parameter) = noise I
+  double sum ( 0.0 );
+  for ( uint c = 0; c < _U.cols(); c++ )
+  {
+    double dot ( 0.0 );
+    for ( uint i = 0; i < _U.rows(); i++ )
+      dot += _U(i,c) * _V(i,c);
+    sum += _weights[c] * dot;
+  }
+  _gradient[0] = noise * sum;
+  return true;
+}
+
 void IKMNoise::multiply (NICE::Vector & y, const NICE::Vector & x) const
 {
   y.resize( rows() );
@@ -108,6 +132,14 @@ void IKMNoise::multiply (NICE::Vector & y, const NICE::Vector & x) const
   y = noise * x;
 }
 
+void IKMNoise::multiplyBlock (NICE::Matrix & _Y, const NICE::Matrix & _X) const
+{
+  _Y.resize( rows(), _X.cols() );
+  
+  _Y = _X;
+  _Y *= noise;
+}
+
 uint IKMNoise::rows () const
 {
   return cols();
@@ -219,4 +251,20 @@ void IKMNoise::addMultipleExamples( const std::vector< const NICE::SparseVector
 				    )
 {
   this->size += newExamples.size();
-}
\ No newline at end of file
+}
+
+void IKMNoise::removeExample( const uint & exampleIndex,
+			       const bool & performOptimizationAfterDecrement
+			     )
+{
+  this->removeMultipleExamples ( std::vector< uint > ( 1, exampleIndex ), performOptimizationAfterDecrement );
+}
+
+void IKMNoise::removeMultipleExamples( const std::vector< uint > & exampleIndices,
+					const bool & performOptimizationAfterDecrement
+				      )
+{
+  // duplicates are removed only once
+  std::set< uint > uniqueIndices ( exampleIndices.begin(), exampleIndices.end() );
+  this->size -= uniqueIndices.size();
+}
@@ -54,9 +54,19 @@ class IKMNoise : public ImplicitKernelMatrix
     virtual NICE::Vector getParameterLowerBounds() const;
     virtual NICE::Vector getParameterUpperBounds() const;
 
+    /** gradient with respect to log(noise), see ImplicitKernelMatrix::getBilinearFormGradient */
+    virtual bool getBilinearFormGradient ( const NICE::Matrix & _U,
+                                           const NICE::Matrix & _V,
+                                           const NICE::Vector & _weights,
+                                           NICE::Vector & _gradient
+                                         ) const;
+
     /** multiply with a vector: A*x = y */
     virtual void multiply (NICE::Vector & y, const NICE::Vector & x) const;
 
+    /** multiply with several vectors at once: A*X = Y */
+    virtual void multiplyBlock (NICE::Matrix & _Y, const NICE::Matrix & _X) const;
+
     /** get the number of rows in A */
     virtual uint rows () const;
 
@@ -86,6 +96,14 @@ class IKMNoise : public ImplicitKernelMatrix
 				      const NICE::Vector & newLabels,
 				      const bool & performOptimizationAfterIncrement = true
 				    );        
+
+    virtual void removeExample( const uint & exampleIndex,
+				const bool & performOptimizationAfterDecrement = true
+			      );
+
+    virtual void removeMultipleExamples( const std::vector< uint > & exampleIndices,
+					 const bool & performOptimizationAfterDecrement = true
+				       );
     
 
 };
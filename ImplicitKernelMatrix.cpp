@@ -19,3 +19,15 @@ ImplicitKernelMatrix::~ImplicitKernelMatrix()
 {
 }
 
+bool ImplicitKernelMatrix::getBilinearFormGradient ( const NICE::Matrix & _U,
+                                                     const NICE::Matrix & _V,
+                                                     const NICE::Vector & _weights,
+                                                     NICE::Vector & _gradient
+                                                   ) const
+{
+  // nothing to differentiate
+  _gradient.resize ( this->getNumParameters() );
+  _gradient.set ( 0.0 );
+  return ( this->getNumParameters() == 0 );
+}
+
@@ -18,6 +18,7 @@
 
 // gp-hik-core includes
 #include "gp-hik-core/OnlineLearnable.h"
+#include "gp-hik-core/algebra/GenericBlockMatrix.h"
 
 namespace NICE {
   
@@ -27,7 +28,7 @@ namespace NICE {
  * @date 02/14/2012
  */
 
-class ImplicitKernelMatrix : public GenericMatrix, public NICE::Persistent, public NICE::OnlineLearnable
+class ImplicitKernelMatrix : public GenericBlockMatrix, public NICE::Persistent, public NICE::OnlineLearnable
 {
 
   protected:
@@ -52,6 +53,23 @@ class ImplicitKernelMatrix : public GenericMatrix, public NICE::Persistent, publ
 
     virtual Vector getParameterLowerBounds() const = 0;
     virtual Vector getParameterUpperBounds() const = 0;
+
+    /**
+    * @brief Gradient of sum_c _weights[c] * _U(:,c)^T A _V(:,c) with respect to the parameters of A,
+    * needed for gradient-based hyperparameter optimization
+    *
+    * @param _U rows() x m matrix
+    * @param _V rows() x m matrix
+    * @param _weights weight of every column (size m)
+    * @param _gradient resulting gradient (size getNumParameters())
+    *
+    * @return false if analytic derivatives are not available (default if there are parameters at all)
+    */
+    virtual bool getBilinearFormGradient ( const NICE::Matrix & _U,
+                                           const NICE::Matrix & _V,
+                                           const NICE::Vector & _weights,
+                                           NICE::Vector & _gradient
+                                         ) const;
     
     virtual double approxFrobNorm() const = 0;
     virtual void setApproximationScheme(const int & _approxScheme) = 0;
@@ -76,6 +94,14 @@ class ImplicitKernelMatrix : public GenericMatrix, public NICE::Persistent, publ
 				      const NICE::Vector & newLabels,
 				      const bool & performOptimizationAfterIncrement = true
 				    ) = 0;      
+
+    virtual void removeExample( const uint & exampleIndex,
+				const bool & performOptimizationAfterDecrement = true
+			      ) = 0;
+
+    virtual void removeMultipleExamples( const std::vector< uint > & exampleIndices,
+					 const bool & performOptimizationAfterDecrement = true
+				       ) = 0;
     
     //high order methods
     virtual void  multiply (NICE::Vector &y, const NICE::Vector &x) const = 0;
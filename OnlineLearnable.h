@@ -2,7 +2,11 @@
 #define _NICE_ONLINELEARNABLEINCLUDE
 
 
+// STL includes
+#include <vector>
+
 // NICE-core includes
+#include <core/basics/types.h>
 #include <core/vector/SparseVectorT.h>
 #include <core/vector/VectorT.h>
 
@@ -47,6 +51,24 @@ class OnlineLearnable {
                                       const bool & performOptimizationAfterIncrement = true
                                     ) = 0;    
 
+    /** 
+     * @brief Interface method to remove a single example from the current object
+     * @param exampleIndex index of the example in the order of insertion, the indices of all later examples are decreased by one
+     * @param performOptimizationAfterDecrement (optional) whether or not to run a hyper parameter optimization after removing the example
+     */    
+    virtual void removeExample( const uint & exampleIndex,
+                                const bool & performOptimizationAfterDecrement = true
+                              ) = 0;
+
+    /** 
+     * @brief Interface method to remove multiple examples from the current object
+     * @param exampleIndices indices of the examples in the order of insertion, the remaining examples keep their order and are numbered consecutively afterwards
+     * @param performOptimizationAfterDecrement (optional) whether or not to run a hyper parameter optimization after removing the examples
+     */    
+    virtual void removeMultipleExamples( const std::vector< uint > & exampleIndices,
+                                         const bool & performOptimizationAfterDecrement = true
+                                       ) = 0;
+
 
     /** 
      * @brief simple destructor
@@ -10,8 +10,10 @@
 // STL includes
 #include <vector>
 #include <cmath>
+#include <cstddef>
 #include <map>
 #include <algorithm>
+#include <iterator>
 #include <iostream>
 #include <limits>
 
@@ -25,9 +27,323 @@
 
 namespace NICE {
 
+ /**
+ * @brief Reference to the (original index, transformed value) part of a single non-zero element.
+ * Behaves like the dataelement of the former multimap storage, i.e., offers members first and second.
+ */
+template<class T, class IndexType, class ValueType> struct SortedDataElementReference
+{
+  IndexType & first;
+  ValueType & second;
+
+  SortedDataElementReference ( IndexType & _first, ValueType & _second ) : first ( _first ), second ( _second ) {}
+
+  operator std::pair< uint, T > () const { return std::pair< uint, T > ( this->first, this->second ); }
+};
+
+ /**
+ * @brief Reference to a single non-zero element, i.e., original value (first) and
+ * (original index, transformed value) (second), as known from std::multimap< T, dataelement >
+ */
+template<class T, class IndexType, class ValueType> struct SortedElementReference
+{
+  const T & first;
+  SortedDataElementReference< T, IndexType, ValueType > second;
+
+  SortedElementReference ( const T & _first, IndexType & _index, ValueType & _transformed ) : first ( _first ), second ( _index, _transformed ) {}
+};
+
+ /**
+ * @class SortedElementIterator
+ * @brief Random access iterator over the non-zero elements of a SortedVectorSparse, with the same
+ * dereferencing semantics as the former multimap iterators (it->first, it->second.first, it->second.second)
+ */
+template<class T, class IndexType, class ValueType> class SortedElementIterator
+{
+  public:
+    typedef SortedElementReference< T, IndexType, ValueType > reference;
+
+    //! helper to support operator-> for proxy references
+    struct pointer
+    {
+      reference r;
+      pointer ( const reference & _r ) : r ( _r ) {}
+      reference * operator-> () { return &(this->r); }
+    };
+
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef std::pair< T, std::pair< uint, T > > value_type;
+    typedef std::ptrdiff_t difference_type;
+
+  protected:
+    const T * p_value;
+    IndexType * p_index;
+    ValueType * p_transformed;
+
+  public:
+    SortedElementIterator() : p_value ( NULL ), p_index ( NULL ), p_transformed ( NULL ) {}
+
+    SortedElementIterator ( const T * _value, IndexType * _index, ValueType * _transformed )
+      : p_value ( _value ), p_index ( _index ), p_transformed ( _transformed ) {}
+
+    //! allows conversion from non-const to const iterators
+    template<class I2, class V2>
+    SortedElementIterator ( const SortedElementIterator< T, I2, V2 > & _it )
+      : p_value ( _it.valuePointer() ), p_index ( _it.indexPointer() ), p_transformed ( _it.transformedPointer() ) {}
+
+    const T * valuePointer() const { return this->p_value; }
+    IndexType * indexPointer() const { return this->p_index; }
+    ValueType * transformedPointer() const { return this->p_transformed; }
+
+    reference operator* () const { return reference ( *(this->p_value), *(this->p_index), *(this->p_transformed) ); }
+    pointer operator-> () const { return pointer ( **this ); }
+    reference operator[] ( const difference_type & _n ) const { return *( *this + _n ); }
+
+    SortedElementIterator & operator++ () { ++(this->p_value); ++(this->p_index); ++(this->p_transformed); return *this; }
+    SortedElementIterator & operator-- () { --(this->p_value); --(this->p_index); --(this->p_transformed); return *this; }
+    SortedElementIterator operator++ ( int ) { SortedElementIterator tmp ( *this ); ++(*this); return tmp; }
+    SortedElementIterator operator-- ( int ) { SortedElementIterator tmp ( *this ); --(*this); return tmp; }
+
+    SortedElementIterator & operator+= ( const difference_type & _n ) { this->p_value += _n; this->p_index += _n; this->p_transformed += _n; return *this; }
+    SortedElementIterator & operator-= ( const difference_type & _n ) { return ( *this += -_n ); }
+    SortedElementIterator operator+ ( const difference_type & _n ) const { SortedElementIterator tmp ( *this ); return ( tmp += _n ); }
+    SortedElementIterator operator- ( const difference_type & _n ) const { SortedElementIterator tmp ( *this ); return ( tmp -= _n ); }
+
+    template<class I2, class V2>
+    difference_type operator- ( const SortedElementIterator< T, I2, V2 > & _it ) const { return this->p_value - _it.valuePointer(); }
+
+    template<class I2, class V2>
+    bool operator== ( const SortedElementIterator< T, I2, V2 > & _it ) const { return this->p_value == _it.valuePointer(); }
+    template<class I2, class V2>
+    bool operator!= ( const SortedElementIterator< T, I2, V2 > & _it ) const { return this->p_value != _it.valuePointer(); }
+    template<class I2, class V2>
+    bool operator< ( const SortedElementIterator< T, I2, V2 > & _it ) const { return this->p_value < _it.valuePointer(); }
+    template<class I2, class V2>
+    bool operator> ( const SortedElementIterator< T, I2, V2 > & _it ) const { return this->p_value > _it.valuePointer(); }
+    template<class I2, class V2>
+    bool operator<= ( const SortedElementIterator< T, I2, V2 > & _it ) const { return this->p_value <= _it.valuePointer(); }
+    template<class I2, class V2>
+    bool operator>= ( const SortedElementIterator< T, I2, V2 > & _it ) const { return this->p_value >= _it.valuePointer(); }
+};
+
+ /**
+ * @class SortedNonzeroElements
+ * @brief Flat storage of the non-zero elements of a SortedVectorSparse as structure of arrays, i.e.,
+ * contiguous arrays of original values (sorted in ascending order), original indices, and transformed values.
+ * Offers the parts of the std::multimap interface which are needed to traverse the elements in sorted order.
+ */
+template<class T> class SortedNonzeroElements
+{
+  public:
+    typedef std::pair< uint, T > dataelement;
+    typedef SortedElementIterator< T, uint, T > iterator;
+    typedef SortedElementIterator< T, const uint, const T > const_iterator;
+    typedef std::reverse_iterator< const_iterator > const_reverse_iterator;
+
+  protected:
+    //! original feature values, sorted in ascending order
+    std::vector< T > values;
+    //! original index of every element
+    std::vector< uint > indices;
+    //! transformed feature value of every element
+    std::vector< T > transformedValues;
+
+    template<class S> static S * dataPointer ( std::vector< S > & _v ) { return _v.empty() ? NULL : &(_v[0]); }
+    template<class S> static const S * dataPointer ( const std::vector< S > & _v ) { return _v.empty() ? NULL : &(_v[0]); }
+
+  public:
+    uint size() const { return this->values.size(); }
+    bool empty() const { return this->values.empty(); }
+
+    void clear()
+    {
+      this->values.clear();
+      this->indices.clear();
+      this->transformedValues.clear();
+    }
+
+    void reserve ( const uint & _n )
+    {
+      this->values.reserve ( _n );
+      this->indices.reserve ( _n );
+      this->transformedValues.reserve ( _n );
+    }
+
+    iterator begin() { return iterator ( dataPointer ( this->values ), dataPointer ( this->indices ), dataPointer ( this->transformedValues ) ); }
+    iterator end() { return this->begin() + this->size(); }
+    const_iterator begin() const { return const_iterator ( dataPointer ( this->values ), dataPointer ( this->indices ), dataPointer ( this->transformedValues ) ); }
+    const_iterator end() const { return this->begin() + this->size(); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator ( this->end() ); }
+    const_reverse_iterator rend() const { return const_reverse_iterator ( this->begin() ); }
+
+    //! position of the first element which is not smaller than _value, O(log n)
+    uint lowerBoundPosition ( const T & _value ) const
+    {
+      return std::lower_bound ( this->values.begin(), this->values.end(), _value ) - this->values.begin();
+    }
+
+    //! position of the first element which is larger than _value, O(log n)
+    uint upperBoundPosition ( const T & _value ) const
+    {
+      return std::upper_bound ( this->values.begin(), this->values.end(), _value ) - this->values.begin();
+    }
+
+    iterator lower_bound ( const T & _value ) { return this->begin() + this->lowerBoundPosition ( _value ); }
+    iterator upper_bound ( const T & _value ) { return this->begin() + this->upperBoundPosition ( _value ); }
+    const_iterator lower_bound ( const T & _value ) const { return this->begin() + this->lowerBoundPosition ( _value ); }
+    const_iterator upper_bound ( const T & _value ) const { return this->begin() + this->upperBoundPosition ( _value ); }
+
+    std::pair< iterator, iterator > equal_range ( const T & _value )
+    {
+      return std::pair< iterator, iterator > ( this->lower_bound ( _value ), this->upper_bound ( _value ) );
+    }
+
+    std::pair< const_iterator, const_iterator > equal_range ( const T & _value ) const
+    {
+      return std::pair< const_iterator, const_iterator > ( this->lower_bound ( _value ), this->upper_bound ( _value ) );
+    }
+
+    /** @brief direct read access to the sorted original values */
+    const T * getValues() const { return dataPointer ( this->values ); }
+    /** @brief direct read access to the original indices (in sorted order) */
+    const uint * getIndices() const { return dataPointer ( this->indices ); }
+    /** @brief direct read access to the transformed values (in sorted order) */
+    const T * getTransformedValues() const { return dataPointer ( this->transformedValues ); }
+    /** @brief direct write access to the transformed values, needed for order preserving transformations */
+    T * getTransformedValues() { return dataPointer ( this->transformedValues ); }
+
+    /**
+    * @brief insert an element behind all elements with equal value (as done by std::multimap)
+    * @return position of the new element
+    */
+    uint insert ( const T & _value, const uint & _index, const T & _transformedValue )
+    {
+      uint pos = this->upperBoundPosition ( _value );
+      this->values.insert ( this->values.begin() + pos, _value );
+      this->indices.insert ( this->indices.begin() + pos, _index );
+      this->transformedValues.insert ( this->transformedValues.begin() + pos, _transformedValue );
+      return pos;
+    }
+
+    /** @brief replace all elements by the given arrays, which have to be sorted by their original value */
+    void assign ( const T * _values, const uint * _indices, const T * _transformedValues, const uint & _n )
+    {
+      this->values.assign ( _values, _values + _n );
+      this->indices.assign ( _indices, _indices + _n );
+      this->transformedValues.assign ( _transformedValues, _transformedValues + _n );
+    }
+
+    /** @brief append an element, which has to be not smaller than the last element */
+    void push_back ( const T & _value, const uint & _index, const T & _transformedValue )
+    {
+      this->values.push_back ( _value );
+      this->indices.push_back ( _index );
+      this->transformedValues.push_back ( _transformedValue );
+    }
+
+    /** @brief remove the element at the given position */
+    void erase ( const uint & _pos )
+    {
+      this->values.erase ( this->values.begin() + _pos );
+      this->indices.erase ( this->indices.begin() + _pos );
+      this->transformedValues.erase ( this->transformedValues.begin() + _pos );
+    }
+
+    /**
+    * @brief merge a batch of elements (sorted by their original value) into the stored elements with a single linear pass.
+    * Elements with equal values keep their order, and stored elements precede new ones.
+    *
+    * @param _sortedElements new elements as (original value, (original index, transformed value)), sorted by original value
+    * @param _oldToNewPositions resulting new position for every previously stored element
+    * @param _newPositions resulting position for every new element
+    */
+    void mergeSorted ( const std::vector< std::pair< T, dataelement > > & _sortedElements,
+                       std::vector< uint > & _oldToNewPositions,
+                       std::vector< uint > & _newPositions
+                     )
+    {
+      uint nOld ( this->size() );
+      uint nNew ( _sortedElements.size() );
+
+      std::vector< T > mergedValues;
+      std::vector< uint > mergedIndices;
+      std::vector< T > mergedTransformedValues;
+      mergedValues.reserve ( nOld + nNew );
+      mergedIndices.reserve ( nOld + nNew );
+      mergedTransformedValues.reserve ( nOld + nNew );
+
+      _oldToNewPositions.resize ( nOld );
+      _newPositions.resize ( nNew );
+
+      uint iOld ( 0 );
+      uint iNew ( 0 );
+      for ( uint pos = 0; pos < nOld + nNew; pos++ )
+      {
+        if ( ( iNew == nNew ) || ( ( iOld < nOld ) && !( _sortedElements[iNew].first < this->values[iOld] ) ) )
+        {
+          mergedValues.push_back ( this->values[iOld] );
+          mergedIndices.push_back ( this->indices[iOld] );
+          mergedTransformedValues.push_back ( this->transformedValues[iOld] );
+          _oldToNewPositions[iOld] = pos;
+          iOld++;
+        }
+        else
+        {
+          mergedValues.push_back ( _sortedElements[iNew].first );
+          mergedIndices.push_back ( _sortedElements[iNew].second.first );
+          mergedTransformedValues.push_back ( _sortedElements[iNew].second.second );
+          _newPositions[iNew] = pos;
+          iNew++;
+        }
+      }
+
+      this->values.swap ( mergedValues );
+      this->indices.swap ( mergedIndices );
+      this->transformedValues.swap ( mergedTransformedValues );
+    }
+
+    /**
+    * @brief remove elements and renumber the original indices of the remaining ones with a single linear pass.
+    * The order of the remaining elements is kept.
+    *
+    * @param _newIndices new original index for every old original index, negative if the element has to be removed
+    * @param _oldToNewPositions resulting new position for every previously stored element (size() for removed ones)
+    */
+    void removeAndRenumber ( const std::vector< int > & _newIndices,
+                             std::vector< uint > & _oldToNewPositions
+                           )
+    {
+      uint nOld ( this->size() );
+      _oldToNewPositions.resize ( nOld );
+
+      uint nNew ( 0 );
+      for ( uint pos = 0; pos < nOld; pos++ )
+      {
+        int newIndex ( _newIndices[ this->indices[pos] ] );
+        if ( newIndex < 0 )
+        {
+          _oldToNewPositions[pos] = nOld;
+          continue;
+        }
+
+        this->values[nNew] = this->values[pos];
+        this->indices[nNew] = (uint) newIndex;
+        this->transformedValues[nNew] = this->transformedValues[pos];
+        _oldToNewPositions[pos] = nNew;
+        nNew++;
+      }
+
+      this->values.resize ( nNew );
+      this->indices.resize ( nNew );
+      this->transformedValues.resize ( nNew );
+    }
+};
+
  /**
  * @class SortedVectorSparse
  * @brief A sparse vector that is always sorted and keeps index mapping!
+ * Non-zero elements are stored in contiguous arrays sorted by their original value (see SortedNonzeroElements),
+ * the mapping original index -> position is kept as compact array sorted by original index.
  * @author Alexander Freytag
  */
 
@@ -36,9 +352,12 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
   public:
     //! original index, transformed feature value
     typedef typename std::pair< uint, T > dataelement;
-    typedef typename std::multimap< T, dataelement >::iterator elementpointer;
-    typedef typename std::multimap< T, dataelement >::const_iterator const_elementpointer;
-    typedef typename std::multimap< T, dataelement >::const_reverse_iterator const_reverse_elementpointer;
+    typedef SortedNonzeroElements< T > elementcontainer;
+    typedef typename SortedNonzeroElements< T >::iterator elementpointer;
+    typedef typename SortedNonzeroElements< T >::const_iterator const_elementpointer;
+    typedef typename SortedNonzeroElements< T >::const_reverse_iterator const_reverse_elementpointer;
+    //! original index, position of the element in the sorted arrays
+    typedef typename std::pair< uint, uint > indexelement;
 
   protected:
     T tolerance;
@@ -47,11 +366,83 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     //! b_verbose flag for output after calling the restore-function
     bool b_verbose;
 
-    //! mapping of the original feature value to the index and the transformed feature value
-    std::multimap< T, dataelement > nzData;
+    //! original feature values (sorted), original indices, and transformed feature values of all non-zero elements
+    SortedNonzeroElements< T > nzData;
+
+    //! non zero index mapping, (original index, position in nzData), sorted by original index,
+    //! only valid if b_indexMappingValid (see validateIndexMapping)
+    mutable std::vector< indexelement > nonzero_indices;
+
+    //! false after single insertions or deletions, which shift the positions of the subsequent elements
+    mutable bool b_indexMappingValid;
+
+    //! compares (value, dataelement) pairs by their original value only
+    static bool compareByValue ( const std::pair< T, dataelement > & _a, const std::pair< T, dataelement > & _b )
+    {
+      return _a.first < _b.first;
+    }
+
+    //! compares index elements by their original index only
+    static bool compareByIndex ( const indexelement & _a, const indexelement & _b )
+    {
+      return _a.first < _b.first;
+    }
+
+    /**
+    * @brief find the position of a given original index within the sorted arrays, O(log nnz)
+    * @return false if the element is zero
+    */
+    inline bool findPosition ( const uint & _a, uint & _position ) const
+    {
+      this->validateIndexMapping();
+      typename std::vector< indexelement >::const_iterator i = std::lower_bound ( this->nonzero_indices.begin(), this->nonzero_indices.end(), indexelement ( _a, 0 ), compareByIndex );
+      if ( ( i == this->nonzero_indices.end() ) || ( i->first != _a ) )
+        return false;
+      _position = i->second;
+      return true;
+    }
+
+    /**
+    * @brief insert a single non-zero element. The positions of all subsequent elements change,
+    * the index mapping is only computed again on the next lookup (see validateIndexMapping),
+    * such that a sequence of insertions does not renumber the mapping every time.
+    */
+    void insertNonZero ( const T & _value, const uint & _index, const T & _transformedValue )
+    {
+      this->nzData.insert ( _value, _index, _transformedValue );
+      this->b_indexMappingValid = false;
+    }
 
-    //! non zero index mapping, original index -> pointer to the element
-    std::map<uint, elementpointer > nonzero_indices;
+    /** @brief remove a single non-zero element, the index mapping is computed again on the next lookup */
+    void eraseNonZero ( const uint & _position )
+    {
+      this->nzData.erase ( _position );
+      this->b_indexMappingValid = false;
+    }
+
+    /** @brief re-compute the index mapping from scratch, O(nnz log nnz) */
+    void rebuildIndexMapping () const
+    {
+      uint nnz ( this->nzData.size() );
+      const uint * indices = this->nzData.getIndices();
+
+      this->nonzero_indices.resize ( nnz );
+      for ( uint pos = 0; pos < nnz; pos++ )
+        this->nonzero_indices[pos] = indexelement ( indices[pos], pos );
+
+      std::sort ( this->nonzero_indices.begin(), this->nonzero_indices.end(), compareByIndex );
+      this->b_indexMappingValid = true;
+    }
+
+    /**
+    * @brief re-compute the index mapping if single elements were inserted or removed since the last lookup.
+    * Lookups are therefore not safe for concurrent calls on the same vector directly after such modifications.
+    */
+    void validateIndexMapping () const
+    {
+      if ( !this->b_indexMappingValid )
+        this->rebuildIndexMapping();
+    }
 
   public:
     /**
@@ -63,6 +454,7 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
       this->ui_n = 0;
       this->tolerance = ( T ) 0.0;
       this->b_verbose = false;
+      this->b_indexMappingValid = true;
     }
 
     /**
@@ -75,6 +467,7 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
       this->tolerance = _v.getTolerance();
       this->ui_n = _v.getN();
       this->nonzero_indices = _v.nonzero_indices;
+      this->b_indexMappingValid = _v.b_indexMappingValid;
       this->b_verbose = _v.getVerbose();
     }
 
@@ -82,6 +475,7 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     {
       this->tolerance = _tolerance;
       this->ui_n = 0;
+      this->b_indexMappingValid = true;
       this->insert ( _v );
       this->b_verbose = false;
     }
@@ -138,9 +532,7 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
       if ( !checkSparsity ( _newElement ) )
       {
         // element is not sparse
-        std::pair<T, dataelement > p ( _newElement, dataelement ( newIndex, _newElement ) );
-        elementpointer it = this->nzData.insert ( p );
-        this->nonzero_indices.insert ( std::pair<uint, elementpointer> ( newIndex, it ) );
+        this->insertNonZero ( _newElement, newIndex, _newElement );
       }
       this->ui_n++;
     }
@@ -166,14 +558,98 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
       if ( !checkSparsity ( _newElement ) )
       {
         // element is not sparse
-
-        std::pair<T, dataelement > p ( _newElement, dataelement ( newIndex,_newElementTransformed ) );
-        elementpointer it = this->nzData.insert ( p );
-        this->nonzero_indices.insert ( std::pair<uint, elementpointer> ( newIndex, it ) );
+        this->insertNonZero ( _newElement, newIndex, _newElementTransformed );
       }
       this->ui_n++;
     }
 
+    /**
+    * @brief add several elements at once. The new elements are sorted and merged into the
+    * already sorted elements in a single linear pass, which is much more efficient than inserting them one by one.
+    * Sparse elements are skipped. The number of elements (ui_n) is not modified, use setN afterwards!
+    * We do not check, wether the given indices were already available or not!
+    *
+    * @param _newElements new elements as (original value, (original index, transformed value)), will be sorted in place
+    */
+    void insertMultiple ( std::vector< std::pair< T, dataelement > > & _newElements )
+    {
+      // remove sparse elements
+      uint nnzNew ( 0 );
+      for ( uint i = 0; i < _newElements.size(); i++ )
+      {
+        if ( !checkSparsity ( _newElements[i].first ) )
+        {
+          _newElements[nnzNew] = _newElements[i];
+          nnzNew++;
+        }
+      }
+      _newElements.resize ( nnzNew );
+
+      if ( nnzNew == 0 )
+        return;
+
+      // stable sorting keeps the insertion order of equal values, just as std::multimap would do
+      std::stable_sort ( _newElements.begin(), _newElements.end(), compareByValue );
+
+      std::vector< uint > oldToNewPositions;
+      std::vector< uint > newPositions;
+      this->nzData.mergeSorted ( _newElements, oldToNewPositions, newPositions );
+
+      // an outdated mapping is computed again on the next lookup anyway
+      if ( !this->b_indexMappingValid )
+        return;
+
+      // update positions of previously stored elements
+      for ( typename std::vector< indexelement >::iterator i = this->nonzero_indices.begin(); i != this->nonzero_indices.end(); i++ )
+      {
+        i->second = oldToNewPositions[ i->second ];
+      }
+
+      // add new elements to the index mapping
+      std::vector< indexelement > newIndices ( nnzNew );
+      for ( uint i = 0; i < nnzNew; i++ )
+        newIndices[i] = indexelement ( _newElements[i].second.first, newPositions[i] );
+      std::sort ( newIndices.begin(), newIndices.end(), compareByIndex );
+
+      std::vector< indexelement > mergedIndices ( this->nonzero_indices.size() + nnzNew );
+      std::merge ( this->nonzero_indices.begin(), this->nonzero_indices.end(),
+                   newIndices.begin(), newIndices.end(),
+                   mergedIndices.begin(), compareByIndex );
+      this->nonzero_indices.swap ( mergedIndices );
+    }
+
+    /**
+    * @brief remove several elements at once and renumber the remaining ones, O(nnz).
+    * The order of equal values is kept, i.e., the result equals inserting the remaining elements only.
+    *
+    * @param _newIndices new original index for every old original index, negative if the element has to be removed
+    * @param _n number of remaining elements (including zeros)
+    */
+    void removeMultiple ( const std::vector< int > & _newIndices,
+                          const uint & _n
+                        )
+    {
+      std::vector< uint > oldToNewPositions;
+      this->nzData.removeAndRenumber ( _newIndices, oldToNewPositions );
+      this->ui_n = _n;
+
+      // an outdated mapping is computed again on the next lookup anyway
+      if ( !this->b_indexMappingValid )
+        return;
+
+      // renumbering keeps the order of the original indices, such that the mapping stays sorted
+      uint nnzNew ( 0 );
+      for ( uint i = 0; i < this->nonzero_indices.size(); i++ )
+      {
+        int newIndex ( _newIndices[ this->nonzero_indices[i].first ] );
+        if ( newIndex < 0 )
+          continue;
+        this->nonzero_indices[nnzNew] = indexelement ( (uint) newIndex, oldToNewPositions[ this->nonzero_indices[i].second ] );
+        nnzNew++;
+      }
+      this->nonzero_indices.resize ( nnzNew );
+    }
+
     /**
     * @brief add a vector of new elements to the vector
     *
@@ -181,8 +657,13 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     */
     void insert ( const std::vector<T> &_v )
     {
+      std::vector< std::pair< T, dataelement > > newElements;
+      newElements.reserve ( _v.size() );
       for ( uint i = 0; i < _v.size(); i++ )
-        this->insert ( _v[i] );
+        newElements.push_back ( std::pair< T, dataelement > ( _v[i], dataelement ( this->ui_n + i, _v[i] ) ) );
+
+      this->insertMultiple ( newElements );
+      this->ui_n += _v.size();
     }
     /**
     * @brief add a vector of new elements to the vector. It doesn't make much sense to have such a function, but who knows...
@@ -191,14 +672,20 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     */
     void insert ( const NICE::SparseVector* _v )
     {
-      for (NICE::SparseVector::const_iterator vIt = _v->begin(); vIt != _v->end(); vIt++)
+      std::vector< std::pair< T, dataelement > > newElements;
+      newElements.reserve ( _v->size() );
+      uint i ( 0 );
+      for (NICE::SparseVector::const_iterator vIt = _v->begin(); vIt != _v->end(); vIt++, i++)
       {
-        this->insert((T)vIt->second);
+        newElements.push_back ( std::pair< T, dataelement > ( (T)vIt->second, dataelement ( this->ui_n + i, (T)vIt->second ) ) );
       }
+
+      this->insertMultiple ( newElements );
+      this->ui_n += _v->size();
     }
 
     /**
-    * @brief non-efficient access to a specific non-zero element
+    * @brief access to a specific non-zero element, O(1)
     *
     * @param an index of a non-zero element (not the original index!)
     *
@@ -206,11 +693,7 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     */
     T accessNonZero ( uint _a ) const
     {
-      const_elementpointer it = this->nzData.begin();
-      advance ( it, _a );
-      dataelement de = it->second;
-
-      return de.second;
+      return this->nzData.getTransformedValues()[_a];
     };
 
     /**
@@ -222,14 +705,12 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     */
     inline T access ( uint _a ) const
     {
-      typename std::map<uint, elementpointer>::const_iterator i = this->nonzero_indices.find ( _a );
-      if ( i != this->nonzero_indices.end() ) {
+      uint pos;
+      if ( this->findPosition ( _a, pos ) ) {
         // accessing a nonzero element
-        const elementpointer & it = i->second;
-        const dataelement & de = it->second;
         // we access the transformed value here and not the
         // original one
-        return de.second;
+        return this->nzData.getTransformedValues()[pos];
       } else {
         // the element is zero
         return ( T ) 0;
@@ -245,17 +726,29 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     */
     inline T accessOriginal ( uint _a ) const
     {
-      typename std::map<uint, elementpointer>::const_iterator i = this->nonzero_indices.find ( _a );
-      if ( i != this->nonzero_indices.end() ) {
+      uint pos;
+      if ( this->findPosition ( _a, pos ) ) {
         // accessing a nonzero element
-        elementpointer it = i->second;
-        return it->first;
+        return this->nzData.getValues()[pos];
       } else {
         // the element is zero
         return ( T ) 0;
       }
     }
 
+    /**
+    * @brief position of an element within the sorted non-zero elements, O(log nnz)
+    *
+    * @param _a original index of the element
+    * @param _position resulting position (see nonzeroElements)
+    *
+    * @return false if the element is zero
+    */
+    inline bool getNonZeroPosition ( const uint & _a, uint & _position ) const
+    {
+      return this->findPosition ( _a, _position );
+    }
+
     inline T getLargestValueUnsafe ( const double & _quantile = 1.0,
                                      const bool & _getTransformedValue = false
                                    ) const
@@ -265,92 +758,34 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
         return  0.0;
       }
 
-        uint idxDest ( round ( (this->getNonZeros() - 1) * _quantile)  );
-
-        if ( _quantile > 0.5 )
-        {
-          typename std::multimap< T, dataelement >::const_reverse_iterator it = this->nzData.rend();
-
-          //
-          // take as many backward steps as indicated by _quantile
-          for ( uint idx = this->getNonZeros(); idx > idxDest; idx-- )
-          {
-            it++;
-          }
-          // alternative usage for random access iterators:
-          // it = it + (uint) this->getNonZeros() * ( 1.0 -  _quantile );
-
-            if ( _getTransformedValue )
-              return it->second.second;
-            else
-              return it->first;
-        }
-        else
-        {
-          typename std::multimap< T, dataelement >::const_iterator it = this->nzData.begin();
+      uint idxDest ( round ( (this->getNonZeros() - 1) * _quantile)  );
 
-          // take as many steps forward as indicated by _quantile
-          for ( uint idx = 0; idx < idxDest; idx++ )
-          {
-            it++;
-          }
-          // alternative usage for random access iterators:
-          // it = it + (uint) this->getNonZeros() * _quantile;
-
-          if ( _getTransformedValue )
-            return it->second.second;
-          else
-            return it->first;
-        }
+      if ( _getTransformedValue )
+        return this->nzData.getTransformedValues()[idxDest];
+      else
+        return this->nzData.getValues()[idxDest];
     }
 
     inline T getLargestTransformedValueUnsafe ( const double & _quantile = 1.0 ) const
     {
-        uint idxDest ( round ( (this->getNonZeros() - 1) * _quantile )  );
+      uint idxDest ( round ( (this->getNonZeros() - 1) * _quantile )  );
 
-        if ( _quantile > 0.5 )
-        {
-          typename std::multimap< T, dataelement >::const_reverse_iterator it = this->nzData.rend();
-
-          //
-          // take as many backward steps as indicated by _quantile
-          for ( uint idx = this->getNonZeros(); idx > idxDest; idx-- )
-          {
-            it++;
-          }
-          // alternative usage for random access iterators:
-          // it = it + (uint) this->getNonZeros() * ( 1.0 -  _quantile );
-
-          return it->second.second;
-        }
-        else
-        {
-          typename std::multimap< T, dataelement >::const_iterator it = this->nzData.begin();
-
-          // take as many steps forward as indicated by _quantile
-          for ( uint idx = 0; idx < idxDest; idx++ )
-          {
-            it++;
-          }
-          // alternative usage for random access iterators:
-          // it = it + (uint) this->getNonZeros() * _quantile;
-
-          return it->second.second;
-        }
+      return this->nzData.getTransformedValues()[idxDest];
     }
 
-    std::multimap< T, dataelement > & nonzeroElements()
+    SortedNonzeroElements< T > & nonzeroElements()
     {
       return this->nzData;
     }
 
-    const std::multimap< T, dataelement > & nonzeroElements() const
+    const SortedNonzeroElements< T > & nonzeroElements() const
     {
       return this->nzData;
     }
 
-    const std::map< uint, elementpointer> & nonzeroIndices() const
+    const std::vector< indexelement > & nonzeroIndices() const
     {
+      this->validateIndexMapping();
       return this->nonzero_indices;
     }
 
@@ -387,25 +822,22 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
       if ( _a >= this->ui_n || _a < 0 )
         fthrow ( Exception, "SortedVectorSparse::set(): out of bounds" );
 
-      typename std::map<uint, elementpointer>::iterator i = this->nonzero_indices.find ( _a );
+      uint pos;
 
       // check whether the element was previously non-sparse
-      if ( i != this->nonzero_indices.end() ) {
-        elementpointer it = i->second;
+      if ( this->findPosition ( _a, pos ) ) {
 
         if ( checkSparsity ( _newElement ) ) {
           // old: non-sparse, new:sparse
           // delete the element
-          this->nzData.erase ( it );
-          this->nonzero_indices.erase ( i );
+          this->eraseNonZero ( pos );
         } else {
           // old: non-sparse, new: non-sparse
-          // The following statement would be nice, but it is not allowed.
+          // The original value determines the position, therefore it can not be modified in place.
           // This is also the reason why we implemented the transformed feature value ability.
-          // it->first = newElement;
           if ( _setTransformedValue ) {
             // set the transformed value
-            it->second.second = _newElement;
+            this->nzData.getTransformedValues()[pos] = _newElement;
           } else {
             // the following is a weird tricky and expensive
             this->set ( _a, 0.0 );
@@ -420,19 +852,35 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
         {
           //std::cerr << "changing a zero value to a non-zero value " << newElement << std::endl;
           // old element is not sparse
-          dataelement de ( _a, _newElement );
-          std::pair<T, dataelement> p ( _newElement, de );
-          elementpointer it = this->nzData.insert ( p );
-          this->nonzero_indices.insert ( std::pair<uint, elementpointer> ( _a, it ) );
+          this->insertNonZero ( _newElement, _a, _newElement );
         }
       }
     }
 
+    /**
+    * @brief replace all non-zero elements by the given arrays (bulk restore, e.g., from a binary model)
+    *
+    * @param _values original values, sorted in ascending order
+    * @param _indices original index of every element
+    * @param _transformedValues transformed value of every element
+    * @param _nnz number of non-zero elements
+    */
+    void assignSorted ( const T * _values,
+                        const uint * _indices,
+                        const T * _transformedValues,
+                        const uint & _nnz
+                      )
+    {
+      this->nzData.assign ( _values, _indices, _transformedValues, _nnz );
+      this->rebuildIndexMapping();
+    }
+
     SortedVectorSparse<T> operator= ( const SortedVectorSparse<T> & _F )
     {
       this->tolerance = _F.getTolerance();
       this->ui_n = _F.getN();
       this->nonzero_indices = _F.nonzero_indices;
+      this->b_indexMappingValid = _F.b_indexMappingValid;
       this->nzData = _F.nzData;
 
       return *this;
@@ -445,13 +893,8 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     */
     std::vector<uint> getPermutationNonZero() const
     {
-      std::vector<uint> rv ( this->nzData.size() );
-      uint idx = 0;
-      for ( typename std::multimap<T, dataelement>::const_iterator it = this->nzData.begin(); it != this->nzData.end(); it++, idx++ )
-      {
-        rv[idx] = it->second.first;
-      }
-      return rv;
+      const uint * indices = this->nzData.getIndices();
+      return std::vector<uint> ( indices, indices + this->nzData.size() );
     };
 
     /**
@@ -463,24 +906,14 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     std::map<uint, uint> getPermutationNonZeroReal() const
     {
       std::map<uint, uint> rv;
-//         int idx = 0;
-//         for (typename std::multimap<T, dataelement>::const_iterator it = nzData.begin(); it != nzData.end(); it++, idx++)
-//         {
-//           //inserts the real feature number as key
-//           //TODO DO not insert the feature, but its original index, which is stored somewhere else!
-//           rv.insert(std::pair<int,int>(it->second.first,it->second.second));
-//           std::cerr << "inserting: " << it->second.first << " - " << it->second.second << std::endl;
-//           //if we want to use the relative feature number (realtive to non-zero elements), use the following
-//           //rv.insert(std::pair<int,int>(idx,it->second.first));
-//         }
 
       uint nrZeros ( this->getZeros() );
 
-      uint idx = 0;
-      for ( typename std::multimap<T, dataelement>::const_iterator it = this->nzData.begin(); it != this->nzData.end(); it++, idx++ )
+      const uint * indices = this->nzData.getIndices();
+      for ( uint idx = 0; idx < this->nzData.size(); idx++ )
       {
         //inserts the real feature number as key
-        rv.insert ( std::pair<uint, uint> ( nrZeros + idx, it->second.first ) );
+        rv.insert ( std::pair<uint, uint> ( nrZeros + idx, indices[idx] ) );
       }
       return rv;
     };
@@ -494,13 +927,11 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     std::map<uint, uint> getPermutationNonZeroRelative() const
     {
       std::map<uint, uint> rv;
-      uint idx = 0;
-      for ( typename std::multimap<T, dataelement>::const_iterator it = this->nzData.begin(); it != this->nzData.end(); it++, idx++ )
+      const uint * indices = this->nzData.getIndices();
+      for ( uint idx = 0; idx < this->nzData.size(); idx++ )
       {
-        //inserts the real feature number as key
-        //rv.insert(std::pair<int,int>(it->second.first,it->second.first));
         //if we want to use the relative feature number (realtive to non-zero elements), use the following
-        rv.insert ( std::pair<uint, uint> ( idx, it->second.first ) );
+        rv.insert ( std::pair<uint, uint> ( idx, indices[idx] ) );
       }
       return rv;
     };
@@ -514,24 +945,35 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     {
       std::vector<uint> rv ( this->ui_n );
 
-      uint idx = std::max( this->ui_n - 1, (uint) 0 );
-      typename std::multimap<T, dataelement>::const_reverse_iterator it ;
-      for ( it = this->nzData.rbegin(); it != this->nzData.rend() && ( it->first > tolerance ); it++, idx-- )
+      const T * values = this->nzData.getValues();
+      const uint * indices = this->nzData.getIndices();
+
+      // positive non-zero elements are located at the end
+      int idx = this->ui_n - 1;
+      int pos = this->nzData.size() - 1;
+      for ( ; ( pos >= 0 ) && ( values[pos] > tolerance ); pos--, idx-- )
       {
-        rv[ idx ] = it->second.first;
+        rv[ idx ] = indices[pos];
       }
 
-      uint i = std::max( this->ui_n - 1, (uint) 0 );
-      for ( int iCnt = this->ui_n - 1 ; iCnt >= 0 ; i--, iCnt-- )
-        if ( nonzero_indices.find ( i ) == nonzero_indices.end() )
+      // followed by all zero elements
+      this->validateIndexMapping();
+      typename std::vector< indexelement >::const_reverse_iterator nzIt = this->nonzero_indices.rbegin();
+      for ( int i = this->ui_n - 1 ; i >= 0 ; i-- )
+      {
+        while ( ( nzIt != this->nonzero_indices.rend() ) && ( (int) nzIt->first > i ) )
+          nzIt++;
+        if ( ( nzIt == this->nonzero_indices.rend() ) || ( (int) nzIt->first != i ) )
         {
           rv[ idx ] = i;
           idx--;
         }
+      }
 
-      for ( ; it != this->nzData.rend(); it++, idx-- )
+      // and negative elements are located at the beginning
+      for ( ; pos >= 0; pos--, idx-- )
       {
-        rv[ idx ] = it->second.first;
+        rv[ idx ] = indices[pos];
       }
 
       return rv;
@@ -546,11 +988,12 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     {
       std::vector<std::pair<uint, T> > rv;
       rv.resize ( this->nzData.size() );
-      uint idx = 0;
-      for ( typename std::multimap<T, dataelement>::const_iterator it = this->nzData.begin(); it != this->nzData.end(); it++, idx++ )
+      const uint * indices = this->nzData.getIndices();
+      const T * transformedValues = this->nzData.getTransformedValues();
+      for ( uint idx = 0; idx < this->nzData.size(); idx++ )
       {
-        rv[idx].first = it->second.first;
-        rv[idx].second = it->second.second;
+        rv[idx].first = indices[idx];
+        rv[idx].second = transformedValues[idx];
       }
       return rv;
     };
@@ -631,13 +1074,13 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
       for ( uint i = 0 ; i < c.size(); i++ )
         c[i] /= 2;
       // now we have in c the position of the current median
-      typename std::multimap<T, dataelement>::const_reverse_iterator it;
+      const uint * indices = this->nzData.getIndices();
+      const T * transformedValues = this->nzData.getTransformedValues();
 
-      for ( it = this->nzData.rbegin(); it != this->nzData.rend(); it++ )
+      for ( int pos = this->nzData.size() - 1; pos >= 0; pos-- )
       {
-        const dataelement & de = it->second;
-        uint origIndex = de.first;
-        double value = de.second;
+        uint origIndex = indices[pos];
+        double value = transformedValues[pos];
         int classno = _labels[origIndex];
         c[ classno ]--;
         if ( c[classno] == 0 )
@@ -657,14 +1100,16 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
     */
     void print(std::ostream & _os) const
     {
-      typename std::multimap<T, dataelement>::const_iterator it = nzData.begin();
+      const T * values = this->nzData.getValues();
+      const T * transformedValues = this->nzData.getTransformedValues();
+      uint pos ( 0 );
 
       if (_os.good())
       {
-        for ( ; it != nzData.end() ; it++ )
+        for ( ; pos < this->nzData.size() ; pos++ )
         {
-          if ( it->first < ( T ) 0.0 )
-            _os << it->first << " ";
+          if ( values[pos] < ( T ) 0.0 )
+            _os << values[pos] << " ";
           else
             break;
         }
@@ -674,9 +1119,9 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
           _os << ( T ) 0.0 << " " ;
         }
 
-        for ( ; ( it != this->nzData.end() ); it++ )
+        for ( ; pos < this->nzData.size(); pos++ )
         {
-          _os << it->second.second << " ";
+          _os << transformedValues[pos] << " ";
         }
         _os << std::endl;
       }
@@ -768,17 +1213,18 @@ template<class T> class SortedVectorSparse : NICE::Persistent{
               uint origIndex;
               T transformedValue;
 
+              // data is stored in sorted order, so we can simply append everything
               this->nzData.clear();
+              this->nzData.reserve ( nonZeros );
               for ( uint i = 0; i < nonZeros; i++)
               {
                 _is >> origValue;
                 _is >> origIndex;
                 _is >> transformedValue;
 
-                std::pair<T, dataelement > p ( origValue, dataelement ( origIndex, transformedValue ) );
-                elementpointer it = this->nzData.insert ( p);
-                this->nonzero_indices.insert ( std::pair<uint, elementpointer> ( origIndex, it ) );
+                this->nzData.push_back ( origValue, origIndex, transformedValue );
               }
+              this->rebuildIndexMapping();
 
               _is >> tmp; // end of block
               tmp = this->removeEndTag ( tmp );
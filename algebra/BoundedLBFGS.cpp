@@ -0,0 +1,246 @@
+/**
+* @file BoundedLBFGS.cpp
+* @brief Limited-memory BFGS for box-constrained minimization of differentiable functions (Implementation)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+// NICE-core includes
+#include <core/basics/Exception.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/algebra/BoundedLBFGS.h"
+
+using namespace NICE;
+
+// sufficient decrease constant of the Armijo condition
+static const double ARMIJO_CONSTANT = 1e-4;
+
+// correction pairs with s^T y <= CURVATURE_TOLERANCE * y^T y are skipped (no positive curvature)
+static const double CURVATURE_TOLERANCE = 1e-10;
+
+/**
+* @brief scalar product restricted to the free variables
+*/
+static double freeScalarProduct ( const NICE::Vector & _a,
+                                  const NICE::Vector & _b,
+                                  const std::vector<bool> & _free
+                                )
+{
+  double sum ( 0.0 );
+  for ( uint i = 0; i < _a.size(); i++ )
+    if ( _free[i] )
+      sum += _a[i] * _b[i];
+  return sum;
+}
+
+BoundedLBFGS::BoundedLBFGS ( const uint & _maxIterations,
+                             const uint & _memorySize,
+                             const double & _gradientTolerance,
+                             const double & _functionTolerance,
+                             const bool & _verbose
+                           )
+{
+  this->ui_maxIterations = _maxIterations;
+  this->ui_memorySize = std::max ( (uint) 1, _memorySize );
+  this->d_gradientTolerance = _gradientTolerance;
+  this->d_functionTolerance = _functionTolerance;
+  this->b_verbose = _verbose;
+  this->ui_maxLineSearchSteps = 20;
+  this->ui_numEvaluations = 0;
+}
+
+BoundedLBFGS::~BoundedLBFGS()
+{
+}
+
+void BoundedLBFGS::setVerbose ( const bool & _verbose )
+{
+  this->b_verbose = _verbose;
+}
+
+void BoundedLBFGS::setMaxLineSearchSteps ( const uint & _maxLineSearchSteps )
+{
+  this->ui_maxLineSearchSteps = std::max ( (uint) 1, _maxLineSearchSteps );
+}
+
+uint BoundedLBFGS::minimize ( DifferentiableFunction & _f,
+                              NICE::Vector & _x,
+                              const NICE::Vector & _lowerBounds,
+                              const NICE::Vector & _upperBounds,
+                              double & _value
+                            )
+{
+  uint n = _x.size();
+  if ( ( _lowerBounds.size() != n ) || ( _upperBounds.size() != n ) )
+    fthrow ( Exception, "BoundedLBFGS: sizes of the bounds (" << _lowerBounds.size() << ", " << _upperBounds.size() << ") do not match the number of variables (" << n << ")" );
+
+  for ( uint i = 0; i < n; i++ )
+    _x[i] = std::min ( std::max ( _x[i], _lowerBounds[i] ), _upperBounds[i] );
+
+  NICE::Vector gradient;
+  _value = _f.evaluate ( _x, gradient );
+  this->ui_numEvaluations = 1;
+  if ( gradient.size() != n )
+    fthrow ( Exception, "BoundedLBFGS: size of the gradient (" << gradient.size() << ") does not match the number of variables (" << n << ")" );
+
+  // correction pairs, the oldest one first
+  std::vector<NICE::Vector> S;
+  std::vector<NICE::Vector> Y;
+
+  std::vector<bool> isFree ( n );
+  NICE::Vector direction ( n );
+  NICE::Vector xNew ( n );
+  NICE::Vector gradientNew;
+  NICE::Vector step ( n );
+
+  uint iteration;
+  for ( iteration = 0; iteration < this->ui_maxIterations; iteration++ )
+  {
+    // variables at a bound whose gradient points outwards are fixed in this iteration
+    double projectedGradientNorm ( 0.0 );
+    for ( uint i = 0; i < n; i++ )
+    {
+      isFree[i] = ! ( ( ( _x[i] <= _lowerBounds[i] ) && ( gradient[i] > 0.0 ) ) ||
+                    ( ( _x[i] >= _upperBounds[i] ) && ( gradient[i] < 0.0 ) ) );
+      if ( isFree[i] )
+        projectedGradientNorm = std::max ( projectedGradientNorm, fabs ( gradient[i] ) );
+    }
+
+    if ( this->b_verbose )
+      std::cerr << "BoundedLBFGS: iteration " << iteration << " value " << _value << " projected gradient " << projectedGradientNorm << std::endl;
+
+    if ( projectedGradientNorm <= this->d_gradientTolerance )
+      break;
+
+    // two-loop recursion restricted to the free variables
+    for ( uint i = 0; i < n; i++ )
+      direction[i] = isFree[i] ? gradient[i] : 0.0;
+
+    std::vector<double> a ( S.size() );
+    std::vector<double> rho ( S.size() );
+    for ( int k = (int) S.size() - 1; k >= 0; k-- )
+    {
+      double sy = freeScalarProduct ( S[k], Y[k], isFree );
+      rho[k] = ( sy > 0.0 ) ? 1.0 / sy : 0.0;
+      a[k] = rho[k] * freeScalarProduct ( S[k], direction, isFree );
+      for ( uint i = 0; i < n; i++ )
+        if ( isFree[i] )
+          direction[i] -= a[k] * Y[k][i];
+    }
+    if ( ! S.empty() )
+    {
+      double yy = freeScalarProduct ( Y.back(), Y.back(), isFree );
+      double gamma = ( yy > 0.0 ) ? freeScalarProduct ( S.back(), Y.back(), isFree ) / yy : 1.0;
+      if ( gamma > 0.0 )
+        direction *= gamma;
+    }
+    for ( uint k = 0; k < S.size(); k++ )
+    {
+      double b = rho[k] * freeScalarProduct ( Y[k], direction, isFree );
+      for ( uint i = 0; i < n; i++ )
+        if ( isFree[i] )
+          direction[i] += ( a[k] - b ) * S[k][i];
+    }
+    direction *= -1.0;
+
+    double directionalDerivative = freeScalarProduct ( gradient, direction, isFree );
+    if ( ( directionalDerivative >= 0.0 ) && ! S.empty() )
+    {
+      // no descent direction, start again with the projected gradient
+      S.clear();
+      Y.clear();
+      for ( uint i = 0; i < n; i++ )
+        direction[i] = isFree[i] ? -gradient[i] : 0.0;
+    }
+
+    // the projected gradient is not scaled yet, start with a step changing no variable by more than one
+    double stepLength = S.empty() ? std::min ( 1.0, 1.0 / projectedGradientNorm ) : 1.0;
+
+    bool accepted ( false );
+    bool stationary ( false );
+    double valueNew ( 0.0 );
+    for ( uint lineSearchStep = 0; lineSearchStep < this->ui_maxLineSearchSteps; lineSearchStep++, stepLength *= 0.5 )
+    {
+      double decrease ( 0.0 );
+      double stepNorm ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+      {
+        xNew[i] = std::min ( std::max ( _x[i] + stepLength * direction[i], _lowerBounds[i] ), _upperBounds[i] );
+        step[i] = xNew[i] - _x[i];
+        decrease += gradient[i] * step[i];
+        stepNorm = std::max ( stepNorm, fabs ( step[i] ) );
+      }
+
+      if ( stepNorm == 0.0 )
+      {
+        stationary = true;
+        break;
+      }
+
+      valueNew = _f.evaluate ( xNew, gradientNew );
+      this->ui_numEvaluations++;
+
+      if ( ( valueNew < std::numeric_limits<double>::max() ) && ( valueNew <= _value + ARMIJO_CONSTANT * decrease ) )
+      {
+        accepted = true;
+        break;
+      }
+    }
+
+    if ( stationary )
+      break;
+
+    if ( ! accepted )
+    {
+      if ( S.empty() )
+      {
+        if ( this->b_verbose )
+          std::cerr << "BoundedLBFGS: line search failed" << std::endl;
+        break;
+      }
+
+      // retry with the projected gradient
+      S.clear();
+      Y.clear();
+      continue;
+    }
+
+    // new correction pair
+    NICE::Vector y ( gradientNew );
+    y -= gradient;
+    double sy ( step.scalarProduct ( y ) );
+    if ( sy > CURVATURE_TOLERANCE * y.scalarProduct ( y ) )
+    {
+      if ( S.size() == this->ui_memorySize )
+      {
+        S.erase ( S.begin() );
+        Y.erase ( Y.begin() );
+      }
+      S.push_back ( step );
+      Y.push_back ( y );
+    }
+
+    double relativeDecrease = ( _value - valueNew ) / std::max ( 1.0, std::max ( fabs ( _value ), fabs ( valueNew ) ) );
+
+    _x = xNew;
+    _value = valueNew;
+    gradient = gradientNew;
+
+    if ( relativeDecrease <= this->d_functionTolerance )
+    {
+      iteration++;
+      break;
+    }
+  }
+
+  if ( this->b_verbose )
+    std::cerr << "BoundedLBFGS: finished after " << iteration << " iterations and " << this->ui_numEvaluations << " evaluations, value " << _value << std::endl;
+
+  return iteration;
+}
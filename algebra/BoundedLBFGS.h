@@ -0,0 +1,127 @@
+/**
+* @file BoundedLBFGS.h
+* @brief Limited-memory BFGS for box-constrained minimization of differentiable functions (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_BOUNDEDLBFGSINCLUDE
+#define _NICE_BOUNDEDLBFGSINCLUDE
+
+// STL includes
+#include <vector>
+
+// NICE-core includes
+#include <core/vector/VectorT.h>
+
+namespace NICE {
+
+ /**
+ * @class DifferentiableFunction
+ * @brief Function which returns its gradient along with its value
+ */
+
+class DifferentiableFunction
+{
+
+  public:
+
+    virtual ~DifferentiableFunction() {};
+
+    /**
+    * @brief evaluate the function and its gradient
+    *
+    * @param _x argument
+    * @param _gradient resulting gradient (same size as _x)
+    *
+    * @return function value
+    */
+    virtual double evaluate ( const NICE::Vector & _x,
+                              NICE::Vector & _gradient
+                            ) = 0;
+};
+
+ /**
+ * @class BoundedLBFGS
+ * @brief Limited-memory BFGS for minimizing a differentiable function subject to lower and upper bounds
+ * of every variable (projected L-BFGS).
+ *
+ * In every iteration, the variables which are at a bound and whose gradient points outwards are fixed.
+ * The search direction of the remaining variables is computed with the usual two-loop recursion, and a
+ * backtracking line search (Armijo condition) is performed along the projection of the search path onto
+ * the box. If the quasi-Newton direction fails, the memory is cleared and a projected gradient step is tried.
+ */
+
+class BoundedLBFGS
+{
+
+  protected:
+    /** verbose flag */
+    bool b_verbose;
+
+    /** maximum number of iterations */
+    uint ui_maxIterations;
+
+    /** number of correction pairs kept for the approximation of the inverse Hessian */
+    uint ui_memorySize;
+
+    /** stop if the maximum absolute value of the projected gradient is not larger than this value */
+    double d_gradientTolerance;
+
+    /** stop if the relative decrease of the function value is not larger than this value */
+    double d_functionTolerance;
+
+    /** maximum number of function evaluations per line search */
+    uint ui_maxLineSearchSteps;
+
+    /** number of function evaluations of the last call of minimize */
+    uint ui_numEvaluations;
+
+  public:
+
+    /**
+    * @brief simple constructor
+    * @param _maxIterations maximum number of iterations
+    * @param _memorySize number of correction pairs
+    * @param _gradientTolerance tolerance of the projected gradient (maximum norm)
+    * @param _functionTolerance tolerance of the relative decrease of the function value
+    * @param _verbose print the progress
+    */
+    BoundedLBFGS ( const uint & _maxIterations = 50,
+                   const uint & _memorySize = 5,
+                   const double & _gradientTolerance = 1e-5,
+                   const double & _functionTolerance = 1e-8,
+                   const bool & _verbose = false
+                 );
+
+    /** simple destructor */
+    virtual ~BoundedLBFGS();
+
+    void setVerbose ( const bool & _verbose );
+
+    /** set the maximum number of function evaluations per line search */
+    void setMaxLineSearchSteps ( const uint & _maxLineSearchSteps );
+
+    /**
+    * @brief minimize _f within the box [_lowerBounds, _upperBounds]
+    *
+    * @param _f function to minimize
+    * @param _x initial solution (projected onto the box), overwritten with the solution found
+    * @param _lowerBounds lower bound of every variable
+    * @param _upperBounds upper bound of every variable
+    * @param _value resulting function value at _x
+    *
+    * @return number of iterations performed
+    */
+    uint minimize ( DifferentiableFunction & _f,
+                    NICE::Vector & _x,
+                    const NICE::Vector & _lowerBounds,
+                    const NICE::Vector & _upperBounds,
+                    double & _value
+                  );
+
+    /** number of function evaluations of the last call of minimize */
+    uint getNumberOfEvaluations () const { return this->ui_numEvaluations; };
+};
+
+} // namespace
+
+#endif
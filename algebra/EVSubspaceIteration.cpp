@@ -0,0 +1,269 @@
+/**
+* @file EVSubspaceIteration.cpp
+* @brief Warm-started subspace iteration for the largest eigenvalues of a symmetric matrix (Implementation)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// NICE-core includes
+#include <core/basics/Exception.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/algebra/EVSubspaceIteration.h"
+
+using namespace NICE;
+
+// maximum number of sweeps of the Jacobi method for the projected matrix
+static const uint JACOBI_MAX_SWEEPS = 50;
+
+/**
+* @brief orthonormalize the columns of _V (modified Gram-Schmidt, applied twice for stability)
+* columns which become linearly dependent are replaced by unit vectors
+*/
+static void orthonormalizeColumns ( NICE::Matrix & _V )
+{
+  uint n = _V.rows();
+  uint k = _V.cols();
+
+  for ( uint c = 0; c < k; c++ )
+  {
+    uint unitVector = c;
+    for ( int pass = 0; pass < 2; pass++ )
+    {
+      for ( uint prev = 0; prev < c; prev++ )
+      {
+        double dot ( 0.0 );
+        for ( uint i = 0; i < n; i++ )
+          dot += _V(i,prev) * _V(i,c);
+        for ( uint i = 0; i < n; i++ )
+          _V(i,c) -= dot * _V(i,prev);
+      }
+
+      double norm ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+        norm += _V(i,c) * _V(i,c);
+      norm = sqrt ( norm );
+
+      if ( norm < 1e-12 )
+      {
+        // restart this column with a unit vector and orthogonalize again
+        for ( uint i = 0; i < n; i++ )
+          _V(i,c) = 0.0;
+        _V(unitVector % n,c) = 1.0;
+        unitVector++;
+        pass = -1;
+        continue;
+      }
+
+      for ( uint i = 0; i < n; i++ )
+        _V(i,c) /= norm;
+    }
+  }
+}
+
+/**
+* @brief eigendecomposition of a small symmetric matrix with the cyclic Jacobi method
+*
+* @param _H symmetric matrix, destroyed
+* @param _eigenvalues resulting eigenvalues in decreasing order
+* @param _eigenvectors resulting eigenvectors (one per column)
+*/
+static void jacobiEigen ( NICE::Matrix & _H,
+                          NICE::Vector & _eigenvalues,
+                          NICE::Matrix & _eigenvectors
+                        )
+{
+  uint k = _H.rows();
+  NICE::Matrix S ( k, k, 0.0 );
+  for ( uint i = 0; i < k; i++ )
+    S(i,i) = 1.0;
+
+  for ( uint sweep = 0; sweep < JACOBI_MAX_SWEEPS; sweep++ )
+  {
+    double offDiagonal ( 0.0 );
+    double diagonal ( 0.0 );
+    for ( uint i = 0; i < k; i++ )
+    {
+      diagonal += _H(i,i) * _H(i,i);
+      for ( uint j = i + 1; j < k; j++ )
+        offDiagonal += _H(i,j) * _H(i,j);
+    }
+    if ( offDiagonal <= 1e-30 * diagonal )
+      break;
+
+    for ( uint p = 0; p < k; p++ )
+      for ( uint q = p + 1; q < k; q++ )
+      {
+        if ( _H(p,q) == 0.0 )
+          continue;
+
+        // rotation annihilating H(p,q)
+        double theta = ( _H(q,q) - _H(p,p) ) / ( 2.0 * _H(p,q) );
+        double t = ( theta >= 0.0 ? 1.0 : -1.0 ) / ( fabs ( theta ) + sqrt ( theta * theta + 1.0 ) );
+        double c = 1.0 / sqrt ( t * t + 1.0 );
+        double s = t * c;
+
+        for ( uint r = 0; r < k; r++ )
+        {
+          double hrp = _H(r,p);
+          double hrq = _H(r,q);
+          _H(r,p) = c * hrp - s * hrq;
+          _H(r,q) = s * hrp + c * hrq;
+        }
+        for ( uint r = 0; r < k; r++ )
+        {
+          double hpr = _H(p,r);
+          double hqr = _H(q,r);
+          _H(p,r) = c * hpr - s * hqr;
+          _H(q,r) = s * hpr + c * hqr;
+        }
+        for ( uint r = 0; r < k; r++ )
+        {
+          double srp = S(r,p);
+          double srq = S(r,q);
+          S(r,p) = c * srp - s * srq;
+          S(r,q) = s * srp + c * srq;
+        }
+      }
+  }
+
+  // sort by decreasing eigenvalues
+  std::vector< std::pair<double, uint> > order;
+  for ( uint i = 0; i < k; i++ )
+    order.push_back ( std::pair<double, uint> ( -_H(i,i), i ) );
+  std::sort ( order.begin(), order.end() );
+
+  _eigenvalues.resize ( k );
+  _eigenvectors.resize ( k, k );
+  for ( uint c = 0; c < k; c++ )
+  {
+    _eigenvalues[c] = -order[c].first;
+    for ( uint r = 0; r < k; r++ )
+      _eigenvectors(r,c) = S(r,order[c].second);
+  }
+}
+
+EVSubspaceIteration::EVSubspaceIteration ( const uint & _maxIterations,
+                                           const double & _tolerance,
+                                           const bool & _verbose
+                                         )
+{
+  this->ui_maxIterations = std::max ( (uint) 1, _maxIterations );
+  this->d_tolerance = _tolerance;
+  this->b_verbose = _verbose;
+}
+
+EVSubspaceIteration::~EVSubspaceIteration()
+{
+}
+
+void EVSubspaceIteration::setVerbose ( const bool & _verbose )
+{
+  this->b_verbose = _verbose;
+}
+
+void EVSubspaceIteration::setSubspace ( const NICE::Matrix & _subspace )
+{
+  this->ritzVectors = _subspace;
+  this->ritzProducts.resize ( 0, 0 );
+}
+
+bool EVSubspaceIteration::hasSubspace ( const uint & _n,
+                                        const uint & _k
+                                      ) const
+{
+  return ( ( this->ritzVectors.rows() == _n ) && ( this->ritzVectors.cols() == _k ) && ( _k > 0 ) );
+}
+
+void EVSubspaceIteration::clear ()
+{
+  this->ritzVectors.resize ( 0, 0 );
+  this->ritzProducts.resize ( 0, 0 );
+}
+
+uint EVSubspaceIteration::getEigenvalues ( const GenericBlockMatrix & _A,
+                                           NICE::Vector & _eigenvalues,
+                                           NICE::Matrix & _eigenvectors
+                                         )
+{
+  uint n = this->ritzVectors.rows();
+  uint k = this->ritzVectors.cols();
+
+  if ( ( k == 0 ) || ( k > n ) || ( _A.rows() != n ) || ( _A.cols() != n ) )
+    fthrow ( Exception, "EVSubspaceIteration: no starting subspace of suitable size (" << n << " x " << k << ") for a " << _A.rows() << " x " << _A.cols() << " matrix" );
+
+  NICE::Matrix V ( this->ritzVectors );
+  orthonormalizeColumns ( V );
+
+  NICE::Matrix AV;
+  NICE::Matrix H ( k, k );
+  NICE::Matrix S;
+  NICE::Vector theta;
+
+  uint iteration;
+  for ( iteration = 1; ; iteration++ )
+  {
+    _A.multiplyBlock ( AV, V );
+
+    // Rayleigh-Ritz projection H = V^T A V
+    for ( uint a = 0; a < k; a++ )
+      for ( uint b = a; b < k; b++ )
+      {
+        double sum ( 0.0 );
+        for ( uint i = 0; i < n; i++ )
+          sum += 0.5 * ( V(i,a) * AV(i,b) + V(i,b) * AV(i,a) );
+        H(a,b) = sum;
+        H(b,a) = sum;
+      }
+    jacobiEigen ( H, theta, S );
+
+    // Ritz vectors W = V S and, exactly, A W = (A V) S
+    this->ritzVectors.resize ( n, k );
+    this->ritzProducts.resize ( n, k );
+    for ( uint i = 0; i < n; i++ )
+      for ( uint c = 0; c < k; c++ )
+      {
+        double w ( 0.0 );
+        double aw ( 0.0 );
+        for ( uint b = 0; b < k; b++ )
+        {
+          w  += V(i,b) * S(b,c);
+          aw += AV(i,b) * S(b,c);
+        }
+        this->ritzVectors(i,c) = w;
+        this->ritzProducts(i,c) = aw;
+      }
+
+    double maxResidual ( 0.0 );
+    for ( uint c = 0; c < k; c++ )
+    {
+      double residual ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+      {
+        double diff = this->ritzProducts(i,c) - theta[c] * this->ritzVectors(i,c);
+        residual += diff * diff;
+      }
+      maxResidual = std::max ( maxResidual, sqrt ( residual ) );
+    }
+
+    if ( this->b_verbose )
+      std::cerr << "EVSubspaceIteration: iteration " << iteration << " largest Ritz value " << theta[0] << " max. residual " << maxResidual << std::endl;
+
+    if ( ( maxResidual <= this->d_tolerance * fabs ( theta[0] ) ) || ( iteration >= this->ui_maxIterations ) )
+      break;
+
+    // next subspace: orthonormalized A W
+    V = this->ritzProducts;
+    orthonormalizeColumns ( V );
+  }
+
+  _eigenvalues = theta;
+  _eigenvectors = this->ritzVectors;
+
+  return iteration;
+}
@@ -0,0 +1,105 @@
+/**
+* @file EVSubspaceIteration.h
+* @brief Warm-started subspace iteration for the largest eigenvalues of a symmetric matrix (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_EVSUBSPACEITERATIONINCLUDE
+#define _NICE_EVSUBSPACEITERATIONINCLUDE
+
+// NICE-core includes
+#include <core/vector/MatrixT.h>
+#include <core/vector/VectorT.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/algebra/GenericBlockMatrix.h"
+
+namespace NICE {
+
+ /**
+ * @class EVSubspaceIteration
+ * @brief Computes the k largest eigenvalues and eigenvectors of a symmetric matrix by subspace
+ * iteration with Rayleigh-Ritz projections, starting from the Ritz vectors of the previous call.
+ *
+ * During hyperparameter optimization, the kernel matrices of successive evaluations are similar.
+ * Their dominant eigenvectors are therefore a very good starting subspace, and only a few
+ * multiplications (one GenericBlockMatrix::multiplyBlock per iteration) are needed instead of a
+ * cold Arnoldi run. Besides the Ritz vectors W, the products A*W of the last call are kept, such
+ * that W can be used as deflation subspace of ILSBlockConjugateGradients without further multiplications.
+ */
+
+class EVSubspaceIteration
+{
+
+  protected:
+    /** verbose flag */
+    bool b_verbose;
+
+    /** maximum number of iterations (i.e., block multiplications) per call */
+    uint ui_maxIterations;
+
+    /** iterations stop if ||A w - theta w|| <= d_tolerance * theta_max holds for all Ritz pairs */
+    double d_tolerance;
+
+    /** current Ritz vectors (one per column, sorted by decreasing Ritz values) */
+    NICE::Matrix ritzVectors;
+
+    /** A times the current Ritz vectors */
+    NICE::Matrix ritzProducts;
+
+  public:
+
+    /**
+    * @brief simple constructor
+    * @param _maxIterations maximum number of iterations per call
+    * @param _tolerance relative residual tolerance of the Ritz pairs
+    * @param _verbose output of the residuals
+    */
+    EVSubspaceIteration ( const uint & _maxIterations = 10,
+                          const double & _tolerance = 1e-4,
+                          const bool & _verbose = false
+                        );
+
+    /** simple destructor */
+    virtual ~EVSubspaceIteration();
+
+    void setVerbose ( const bool & _verbose );
+
+    /**
+    * @brief set the starting subspace, e.g., eigenvectors computed by a cold solver
+    * @param _subspace matrix with one starting vector per column
+    */
+    void setSubspace ( const NICE::Matrix & _subspace );
+
+    /** check whether a starting subspace of _k vectors with _n rows is available */
+    bool hasSubspace ( const uint & _n,
+                       const uint & _k
+                     ) const;
+
+    /** forget the current subspace */
+    void clear ();
+
+    /**
+    * @brief refine the current subspace for the matrix _A
+    * @pre a subspace of suitable size has been set (see hasSubspace)
+    *
+    * @param _A symmetric matrix
+    * @param _eigenvalues resulting Ritz values in decreasing order
+    * @param _eigenvectors resulting Ritz vectors (one per column)
+    *
+    * @return number of iterations needed
+    */
+    uint getEigenvalues ( const GenericBlockMatrix & _A,
+                          NICE::Vector & _eigenvalues,
+                          NICE::Matrix & _eigenvectors
+                        );
+
+    /** Ritz vectors of the last call */
+    const NICE::Matrix & getEigenvectors () const { return this->ritzVectors; };
+
+    /** A times the Ritz vectors of the last call */
+    const NICE::Matrix & getProducts () const { return this->ritzProducts; };
+};
+
+} // namespace
+
+#endif
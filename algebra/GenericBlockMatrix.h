@@ -0,0 +1,61 @@
+/**
+* @file GenericBlockMatrix.h
+* @brief Generic matrix which can be multiplied with several vectors at once (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_GENERICBLOCKMATRIXINCLUDE
+#define _NICE_GENERICBLOCKMATRIXINCLUDE
+
+// NICE-core includes
+#include <core/algebra/GenericMatrix.h>
+#include <core/vector/MatrixT.h>
+#include <core/vector/VectorT.h>
+
+namespace NICE {
+
+ /**
+ * @class GenericBlockMatrix
+ * @brief Generic matrix which can be multiplied with a block of vectors (multiple right hand sides) at once.
+ *
+ * The default implementation simply multiplies column by column. Derived classes
+ * should overwrite multiplyBlock if they can share work between the columns, e.g., by
+ * running only once over their data.
+ */
+
+class GenericBlockMatrix : public GenericMatrix
+{
+
+  public:
+
+    virtual ~GenericBlockMatrix() {};
+
+    /**
+    * @brief multiply with several vectors at once: A*X = Y
+    *
+    * @param _Y resulting matrix (rows() x m)
+    * @param _X matrix whose m columns are multiplied with A (cols() x m)
+    */
+    virtual void multiplyBlock ( NICE::Matrix & _Y,
+                                 const NICE::Matrix & _X
+                               ) const
+    {
+      _Y.resize ( this->rows(), _X.cols() );
+
+      NICE::Vector x ( _X.rows() );
+      NICE::Vector y;
+      for ( uint c = 0; c < _X.cols(); c++ )
+      {
+        for ( uint i = 0; i < _X.rows(); i++ )
+          x[i] = _X(i,c);
+
+        this->multiply ( y, x );
+
+        for ( uint i = 0; i < y.size(); i++ )
+          _Y(i,c) = y[i];
+      }
+    };
+};
+
+} // namespace
+
+#endif
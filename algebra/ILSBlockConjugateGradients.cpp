@@ -0,0 +1,278 @@
+/**
+* @file ILSBlockConjugateGradients.cpp
+* @brief Conjugate gradients for several right hand sides sharing the matrix multiplications (Implementation)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+
+// STL includes
+#include <iostream>
+#include <cmath>
+
+// NICE-core includes
+#include <core/basics/Exception.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/algebra/ILSBlockConjugateGradients.h"
+
+using namespace NICE;
+using namespace std;
+
+ILSBlockConjugateGradients::ILSBlockConjugateGradients ( const bool _verbose,
+                                                         const uint _maxIterations,
+                                                         const double _minDelta,
+                                                         const double _minResidual
+                                                       )
+{
+  this->b_verbose        = _verbose;
+  this->ui_maxIterations = _maxIterations;
+  this->d_minDelta       = _minDelta;
+  this->d_minResidual    = _minResidual;
+}
+
+ILSBlockConjugateGradients::~ILSBlockConjugateGradients()
+{
+}
+
+void ILSBlockConjugateGradients::setJacobiPreconditioner ( const NICE::Vector & _jacobiPreconditioner )
+{
+  this->jacobiPreconditioner = _jacobiPreconditioner;
+}
+
+void ILSBlockConjugateGradients::setDeflationSubspace ( const NICE::Matrix & _subspace,
+                                                        const NICE::Matrix & _products
+                                                      )
+{
+  if ( ( _subspace.rows() != _products.rows() ) || ( _subspace.cols() != _products.cols() ) )
+    fthrow(Exception, "ILSBlockConjugateGradients: size of the deflation subspace (" << _subspace.rows() << " x " << _subspace.cols() << ") does not fit to its products (" << _products.rows() << " x " << _products.cols() << ")" );
+
+  uint n = _subspace.rows();
+  uint k = _subspace.cols();
+
+  // Cholesky decomposition of the small matrix W^T A W
+  NICE::Matrix L ( k, k, 0.0 );
+  for ( uint j = 0; j < k; j++ )
+  {
+    for ( uint i = j; i < k; i++ )
+    {
+      // symmetrized entry of W^T A W
+      double sum ( 0.0 );
+      for ( uint l = 0; l < n; l++ )
+        sum += 0.5 * ( _subspace(l,i) * _products(l,j) + _subspace(l,j) * _products(l,i) );
+      for ( uint l = 0; l < j; l++ )
+        sum -= L(i,l) * L(j,l);
+
+      if ( i == j )
+      {
+        if ( sum <= 0.0 )
+        {
+          std::cerr << "ILSBlockConjugateGradients: W^T A W is not positive definite, deflation is disabled" << std::endl;
+          this->clearDeflationSubspace();
+          return;
+        }
+        L(j,j) = sqrt ( sum );
+      }
+      else
+        L(i,j) = sum / L(j,j);
+    }
+  }
+
+  this->deflationSubspace = _subspace;
+  this->deflationProducts = _products;
+  this->deflationCholesky = L;
+}
+
+void ILSBlockConjugateGradients::clearDeflationSubspace ()
+{
+  this->deflationSubspace.resize ( 0, 0 );
+  this->deflationProducts.resize ( 0, 0 );
+  this->deflationCholesky.resize ( 0, 0 );
+}
+
+void ILSBlockConjugateGradients::solveDeflationSystem ( NICE::Vector & _rhs ) const
+{
+  const NICE::Matrix & L = this->deflationCholesky;
+  int k = L.rows();
+
+  // forward substitution with L, then backward substitution with L^T
+  for ( int i = 0; i < k; i++ )
+  {
+    for ( int j = 0; j < i; j++ )
+      _rhs[i] -= L(i,j) * _rhs[j];
+    _rhs[i] /= L(i,i);
+  }
+  for ( int i = k - 1; i >= 0; i-- )
+  {
+    for ( int j = i + 1; j < k; j++ )
+      _rhs[i] -= L(j,i) * _rhs[j];
+    _rhs[i] /= L(i,i);
+  }
+}
+
+void ILSBlockConjugateGradients::deflateDirection ( NICE::Matrix & _p,
+                                                    const NICE::Matrix & _z,
+                                                    const uint & _c
+                                                  ) const
+{
+  uint n = this->deflationSubspace.rows();
+  uint k = this->deflationSubspace.cols();
+
+  NICE::Vector mu ( k );
+  for ( uint j = 0; j < k; j++ )
+  {
+    mu[j] = 0.0;
+    for ( uint i = 0; i < n; i++ )
+      mu[j] += this->deflationProducts(i,j) * _z(i,_c);
+  }
+  this->solveDeflationSystem ( mu );
+
+  for ( uint i = 0; i < n; i++ )
+    for ( uint j = 0; j < k; j++ )
+      _p(i,_c) -= this->deflationSubspace(i,j) * mu[j];
+}
+
+int ILSBlockConjugateGradients::solveLin ( const GenericBlockMatrix & _gm,
+                                           const NICE::Matrix & _b,
+                                           NICE::Matrix & _x
+                                         )
+{
+  uint n = _b.rows();
+  uint m = _b.cols();
+
+  if ( _gm.rows() != n )
+    fthrow(Exception, "ILSBlockConjugateGradients: size of the matrix (" << _gm.rows() << ") does not fit to the right hand sides (" << n << ")" );
+
+  bool usePreconditioner = ( this->jacobiPreconditioner.size() == n );
+  bool useDeflation = ( ( this->deflationSubspace.rows() == n ) && ( this->deflationSubspace.cols() > 0 ) );
+
+  if ( ( _x.rows() != n ) || ( _x.cols() != m ) )
+  {
+    _x.resize ( n, m );
+    _x.set ( 0.0 );
+  }
+
+  if ( m == 0 )
+    return 0;
+
+  // r = b - A x
+  NICE::Matrix r;
+  _gm.multiplyBlock ( r, _x );
+  for ( uint c = 0; c < m; c++ )
+    for ( uint i = 0; i < n; i++ )
+      r(i,c) = _b(i,c) - r(i,c);
+
+  // deflation: x += W mu and r -= A W mu with (W^T A W) mu = W^T r, such that W^T r = 0
+  if ( useDeflation )
+  {
+    uint k = this->deflationSubspace.cols();
+    NICE::Vector mu ( k );
+    for ( uint c = 0; c < m; c++ )
+    {
+      for ( uint j = 0; j < k; j++ )
+      {
+        mu[j] = 0.0;
+        for ( uint i = 0; i < n; i++ )
+          mu[j] += this->deflationSubspace(i,j) * r(i,c);
+      }
+      this->solveDeflationSystem ( mu );
+
+      for ( uint i = 0; i < n; i++ )
+        for ( uint j = 0; j < k; j++ )
+        {
+          _x(i,c) += this->deflationSubspace(i,j) * mu[j];
+          r(i,c)  -= this->deflationProducts(i,j) * mu[j];
+        }
+    }
+  }
+
+  // z = M^{-1} r and p = z (minus its component in span(W) for deflation)
+  NICE::Matrix z ( n, m );
+  NICE::Matrix p ( n, m );
+  NICE::Vector rz ( m );
+  for ( uint c = 0; c < m; c++ )
+  {
+    rz[c] = 0.0;
+    for ( uint i = 0; i < n; i++ )
+    {
+      z(i,c) = usePreconditioner ? r(i,c) / this->jacobiPreconditioner[i] : r(i,c);
+      p(i,c) = z(i,c);
+      rz[c] += r(i,c) * z(i,c);
+    }
+    if ( useDeflation )
+      this->deflateDirection ( p, z, c );
+  }
+
+  // columns which are not yet converged
+  std::vector<uint> active;
+  for ( uint c = 0; c < m; c++ )
+    active.push_back ( c );
+
+  NICE::Matrix pActive;
+  NICE::Matrix qActive;
+
+  uint iteration;
+  for ( iteration = 0; ( iteration < this->ui_maxIterations ) && ( !active.empty() ); iteration++ )
+  {
+    // q = A p for all active columns at once
+    pActive.resize ( n, active.size() );
+    for ( uint k = 0; k < active.size(); k++ )
+      for ( uint i = 0; i < n; i++ )
+        pActive(i,k) = p(i,active[k]);
+
+    _gm.multiplyBlock ( qActive, pActive );
+
+    std::vector<uint> stillActive;
+    for ( uint k = 0; k < active.size(); k++ )
+    {
+      uint c = active[k];
+
+      double pq ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+        pq += p(i,c) * qActive(i,k);
+
+      if ( pq == 0.0 )
+        continue;
+
+      double stepSize = rz[c] / pq;
+
+      double residualNorm ( 0.0 );
+      double pNorm ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+      {
+        _x(i,c) += stepSize * p(i,c);
+        r(i,c)  -= stepSize * qActive(i,k);
+        residualNorm += r(i,c) * r(i,c);
+        pNorm += p(i,c) * p(i,c);
+      }
+      residualNorm = sqrt ( residualNorm );
+      double delta = fabs ( stepSize ) * sqrt ( pNorm );
+
+      if ( this->b_verbose )
+        std::cerr << "ILSBlockConjugateGradients: iteration " << iteration << " column " << c << " residual " << residualNorm << " delta " << delta << std::endl;
+
+      if ( ( residualNorm < this->d_minResidual ) || ( delta < this->d_minDelta ) )
+        continue;
+
+      // new search direction
+      double rzNew ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+      {
+        z(i,c) = usePreconditioner ? r(i,c) / this->jacobiPreconditioner[i] : r(i,c);
+        rzNew += r(i,c) * z(i,c);
+      }
+      double beta = rzNew / rz[c];
+      for ( uint i = 0; i < n; i++ )
+        p(i,c) = z(i,c) + beta * p(i,c);
+      if ( useDeflation )
+        this->deflateDirection ( p, z, c );
+      rz[c] = rzNew;
+
+      stillActive.push_back ( c );
+    }
+    active = stillActive;
+  }
+
+  if ( this->b_verbose )
+    std::cerr << "ILSBlockConjugateGradients: " << iteration << " iterations, " << active.size() << " of " << m << " columns not converged" << std::endl;
+
+  return iteration;
+}
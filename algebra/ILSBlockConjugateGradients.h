@@ -0,0 +1,123 @@
+/**
+* @file ILSBlockConjugateGradients.h
+* @brief Conjugate gradients for several right hand sides sharing the matrix multiplications (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_ILSBLOCKCONJUGATEGRADIENTSINCLUDE
+#define _NICE_ILSBLOCKCONJUGATEGRADIENTSINCLUDE
+
+// NICE-core includes
+#include <core/vector/MatrixT.h>
+#include <core/vector/VectorT.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/algebra/GenericBlockMatrix.h"
+
+namespace NICE {
+
+ /**
+ * @class ILSBlockConjugateGradients
+ * @brief Iteratively solves A X = B for a symmetric positive definite A and several right hand sides (columns of B).
+ *
+ * Every column runs its own (Jacobi preconditioned) conjugate gradient recursion, but the
+ * multiplications with A of all not yet converged columns are done with a single call of
+ * GenericBlockMatrix::multiplyBlock. For implicit kernel matrices, this means
+ * running only once over the training data per iteration instead of once per right hand side.
+ *
+ * Optionally, a deflation subspace W (e.g., the dominant eigenvectors of A, see EVSubspaceIteration)
+ * together with A*W can be given. The solver then runs the deflated conjugate gradient method of
+ * Saad et al. ("A deflated version of the conjugate gradient algorithm", SIAM J. Sci. Comput., 2000),
+ * i.e., the search directions are kept A-orthogonal to W and the convergence only depends on the
+ * remaining part of the spectrum.
+ */
+
+class ILSBlockConjugateGradients
+{
+
+  protected:
+    /** verbose flag */
+    bool b_verbose;
+
+    /** maximum number of iterations */
+    uint ui_maxIterations;
+
+    /** a column is converged if the change of its solution becomes smaller than this value */
+    double d_minDelta;
+
+    /** a column is converged if the L2 norm of its residual becomes smaller than this value */
+    double d_minResidual;
+
+    /** diagonal of the Jacobi preconditioner (empty if not used) */
+    NICE::Vector jacobiPreconditioner;
+
+    /** deflation subspace W (one vector per column, empty if not used) */
+    NICE::Matrix deflationSubspace;
+
+    /** A*W for the deflation subspace W */
+    NICE::Matrix deflationProducts;
+
+    /** Cholesky factor L of W^T A W = L L^T */
+    NICE::Matrix deflationCholesky;
+
+    /** solve (W^T A W) mu = _rhs in place using deflationCholesky */
+    void solveDeflationSystem ( NICE::Vector & _rhs ) const;
+
+    /** _p(:,_c) -= W mu with (W^T A W) mu = (A W)^T _z(:,_c) */
+    void deflateDirection ( NICE::Matrix & _p,
+                            const NICE::Matrix & _z,
+                            const uint & _c
+                          ) const;
+
+  public:
+
+    /**
+    * @brief simple constructor
+    * @param _verbose output of the residuals
+    * @param _maxIterations maximum number of iterations
+    * @param _minDelta minimum change of the solution of a column
+    * @param _minResidual minimum residual of a column
+    */
+    ILSBlockConjugateGradients ( const bool _verbose = false,
+                                 const uint _maxIterations = 10000,
+                                 const double _minDelta = 1e-7,
+                                 const double _minResidual = 1e-20
+                               );
+
+    /** simple destructor */
+    virtual ~ILSBlockConjugateGradients();
+
+    /**
+    * @brief set the diagonal elements of A used for Jacobi preconditioning
+    */
+    void setJacobiPreconditioner ( const NICE::Vector & _jacobiPreconditioner );
+
+    /**
+    * @brief set the deflation subspace
+    * @param _subspace matrix W with linearly independent columns
+    * @param _products A*W (has to be exact, since it replaces the multiplications with W)
+    */
+    void setDeflationSubspace ( const NICE::Matrix & _subspace,
+                                const NICE::Matrix & _products
+                              );
+
+    /** do not use a deflation subspace anymore */
+    void clearDeflationSubspace ();
+
+    /**
+    * @brief Solve A X = B. If X already has the size of B, it is used as initial solution.
+    *
+    * @param _gm symmetric positive definite matrix A
+    * @param _b right hand sides (one per column)
+    * @param _x resulting solutions (one per column)
+    *
+    * @return number of iterations needed
+    */
+    int solveLin ( const GenericBlockMatrix & _gm,
+                   const NICE::Matrix & _b,
+                   NICE::Matrix & _x
+                 );
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,303 @@
+/**
+* @file LogDetApproxStochasticLanczos.cpp
+* @brief LogDet approximation using Hutchinson probes and Lanczos quadrature (Implementation)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// NICE-core includes
+#include <core/basics/Exception.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/algebra/LogDetApproxStochasticLanczos.h"
+
+using namespace NICE;
+
+// a Lanczos run stops early if the next off-diagonal element becomes smaller than
+// this fraction of the first diagonal element (invariant subspace found)
+static const double LANCZOS_BREAKDOWN_TOLERANCE = 1e-10;
+
+// maximum number of implicit QL iterations per eigenvalue of the tridiagonal matrix
+static const int TRIDIAGONAL_MAX_ITERATIONS = 60;
+
+/**
+* @brief eigenvalues and first components of the eigenvectors of a symmetric tridiagonal matrix
+* (implicit QL with Wilkinson shifts, only the first row of the eigenvector matrix is tracked, see Golub and Welsch)
+*
+* @param _d diagonal, overwritten with the eigenvalues
+* @param _e off-diagonal with _e[i] = T(i,i+1) and an additional trailing zero (same size as _d), destroyed
+* @param _z overwritten with the first component of every eigenvector
+*/
+static void tridiagonalEigenFirstComponents ( std::vector<double> & _d,
+                                              std::vector<double> & _e,
+                                              std::vector<double> & _z
+                                            )
+{
+  int n = _d.size();
+  _z.assign ( n, 0.0 );
+  if ( n == 0 )
+    return;
+  _z[0] = 1.0;
+
+  for ( int l = 0; l < n; l++ )
+  {
+    int iter = 0;
+    int m;
+    do
+    {
+      // look for a single small off-diagonal element to split the matrix
+      for ( m = l; m < n - 1; m++ )
+      {
+        double dd = fabs ( _d[m] ) + fabs ( _d[m+1] );
+        if ( fabs ( _e[m] ) + dd == dd )
+          break;
+      }
+
+      if ( m != l )
+      {
+        if ( iter++ == TRIDIAGONAL_MAX_ITERATIONS )
+          fthrow ( Exception, "LogDetApproxStochasticLanczos: eigendecomposition of the Lanczos matrix did not converge" );
+
+        double g = ( _d[l+1] - _d[l] ) / ( 2.0 * _e[l] );
+        double r = sqrt ( g * g + 1.0 );
+        g = _d[m] - _d[l] + _e[l] / ( g + ( g >= 0.0 ? fabs ( r ) : -fabs ( r ) ) );
+
+        double s = 1.0;
+        double c = 1.0;
+        double p = 0.0;
+        int i;
+        for ( i = m - 1; i >= l; i-- )
+        {
+          double f = s * _e[i];
+          double b = c * _e[i];
+          r = sqrt ( f * f + g * g );
+          _e[i+1] = r;
+          if ( r == 0.0 )
+          {
+            // underflow, recover
+            _d[i+1] -= p;
+            _e[m] = 0.0;
+            break;
+          }
+          s = f / r;
+          c = g / r;
+          g = _d[i+1] - p;
+          r = ( _d[i] - g ) * s + 2.0 * c * b;
+          p = s * r;
+          _d[i+1] = g + p;
+          g = c * r - b;
+
+          // apply the rotation to the first row of the eigenvector matrix
+          f = _z[i+1];
+          _z[i+1] = s * _z[i] + c * f;
+          _z[i] = c * _z[i] - s * f;
+        }
+        if ( r == 0.0 && i >= l )
+          continue;
+
+        _d[l] -= p;
+        _e[l] = g;
+        _e[m] = 0.0;
+      }
+    } while ( m != l );
+  }
+}
+
+namespace {
+
+// wrapper for explicitly given matrices (multiplyBlock falls back to column-wise multiplications)
+class DenseBlockMatrix : public GenericBlockMatrix
+{
+  protected:
+    const NICE::Matrix & matrix;
+
+  public:
+    DenseBlockMatrix ( const NICE::Matrix & _matrix ) : matrix ( _matrix ) {};
+
+    virtual uint rows () const { return this->matrix.rows(); };
+    virtual uint cols () const { return this->matrix.cols(); };
+
+    virtual void multiply ( NICE::Vector & _y, const NICE::Vector & _x ) const
+    {
+      _y.resize ( this->matrix.rows() );
+      for ( uint i = 0; i < this->matrix.rows(); i++ )
+      {
+        double sum ( 0.0 );
+        for ( uint j = 0; j < this->matrix.cols(); j++ )
+          sum += this->matrix(i,j) * _x[j];
+        _y[i] = sum;
+      }
+    };
+};
+
+} // namespace
+
+LogDetApproxStochasticLanczos::LogDetApproxStochasticLanczos ( const uint & _numProbes,
+                                                               const uint & _lanczosDepth,
+                                                               const uint & _seed
+                                                             )
+{
+  this->b_verbose = false;
+  this->ui_numProbes = std::max ( (uint) 1, _numProbes );
+  this->ui_lanczosDepth = std::max ( (uint) 1, _lanczosDepth );
+  this->ui_seed = _seed;
+}
+
+LogDetApproxStochasticLanczos::~LogDetApproxStochasticLanczos()
+{
+}
+
+void LogDetApproxStochasticLanczos::setVerbose ( const bool & _verbose )
+{
+  this->b_verbose = _verbose;
+}
+
+void LogDetApproxStochasticLanczos::resetProbes ()
+{
+  this->probes.resize ( 0, 0 );
+}
+
+void LogDetApproxStochasticLanczos::drawProbes ( const uint & _n )
+{
+  // own linear congruential generator, such that the probes neither depend on
+  // nor change the state of the global random number generator
+  unsigned int state = this->ui_seed;
+
+  this->probes.resize ( _n, this->ui_numProbes );
+  for ( uint c = 0; c < this->ui_numProbes; c++ )
+    for ( uint i = 0; i < _n; i++ )
+    {
+      state = 1664525u * state + 1013904223u;
+      // the highest bit has the longest period
+      this->probes(i,c) = ( state & 0x80000000u ) ? 1.0 : -1.0;
+    }
+}
+
+double LogDetApproxStochasticLanczos::getLogDetApproximation ( const NICE::Matrix & A )
+{
+  DenseBlockMatrix gm ( A );
+  return this->getLogDetApproximation ( gm );
+}
+
+double LogDetApproxStochasticLanczos::getLogDetApproximation ( const GenericBlockMatrix & _A )
+{
+  uint n = _A.rows();
+  if ( _A.cols() != n )
+    fthrow ( Exception, "LogDetApproxStochasticLanczos: matrix is not square (" << n << " x " << _A.cols() << ")" );
+
+  if ( n == 0 )
+    return 0.0;
+
+  // draw the probes only once, such that all evaluations for the same number of examples share them
+  if ( ( this->probes.rows() != n ) || ( this->probes.cols() != this->ui_numProbes ) )
+    this->drawProbes ( n );
+
+  uint m = this->ui_numProbes;
+  uint depth = std::min ( this->ui_lanczosDepth, n );
+
+  // current and previous Lanczos vectors of every run (one per column)
+  NICE::Matrix q ( n, m );
+  NICE::Matrix qPrev ( n, m );
+  std::vector<double> normsSquared ( m, 0.0 );
+  for ( uint c = 0; c < m; c++ )
+  {
+    for ( uint i = 0; i < n; i++ )
+      normsSquared[c] += this->probes(i,c) * this->probes(i,c);
+
+    double norm = sqrt ( normsSquared[c] );
+    for ( uint i = 0; i < n; i++ )
+    {
+      q(i,c) = this->probes(i,c) / norm;
+      qPrev(i,c) = 0.0;
+    }
+  }
+
+  // entries of the tridiagonal Lanczos matrix of every run
+  std::vector< std::vector<double> > alphas ( m );
+  std::vector< std::vector<double> > betas ( m );
+
+  // runs which did not stop yet
+  std::vector<uint> active;
+  for ( uint c = 0; c < m; c++ )
+    active.push_back ( c );
+
+  NICE::Matrix qActive;
+  NICE::Matrix w;
+  for ( uint step = 0; ( step < depth ) && ( ! active.empty() ); step++ )
+  {
+    // a single multiplication for the current Lanczos vectors of all active runs
+    qActive.resize ( n, active.size() );
+    for ( uint a = 0; a < active.size(); a++ )
+      for ( uint i = 0; i < n; i++ )
+        qActive(i,a) = q(i,active[a]);
+
+    _A.multiplyBlock ( w, qActive );
+
+    std::vector<uint> stillActive;
+    for ( uint a = 0; a < active.size(); a++ )
+    {
+      uint c = active[a];
+
+      double alpha ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+        alpha += q(i,c) * w(i,a);
+      alphas[c].push_back ( alpha );
+
+      if ( step + 1 == depth )
+        continue;
+
+      double betaPrev = betas[c].empty() ? 0.0 : betas[c].back();
+      double beta ( 0.0 );
+      for ( uint i = 0; i < n; i++ )
+      {
+        w(i,a) -= alpha * q(i,c) + betaPrev * qPrev(i,c);
+        beta += w(i,a) * w(i,a);
+      }
+      beta = sqrt ( beta );
+
+      if ( beta <= LANCZOS_BREAKDOWN_TOLERANCE * fabs ( alphas[c][0] ) )
+        continue;
+
+      betas[c].push_back ( beta );
+      for ( uint i = 0; i < n; i++ )
+      {
+        qPrev(i,c) = q(i,c);
+        q(i,c) = w(i,a) / beta;
+      }
+      stillActive.push_back ( c );
+    }
+    active.swap ( stillActive );
+  }
+
+  // Gauss quadrature of z^T log(A) z for every probe
+  double logdet ( 0.0 );
+  std::vector<double> d;
+  std::vector<double> e;
+  std::vector<double> tau;
+  for ( uint c = 0; c < m; c++ )
+  {
+    d = alphas[c];
+    e = betas[c];
+    e.resize ( d.size(), 0.0 );
+    tridiagonalEigenFirstComponents ( d, e, tau );
+
+    double quadrature ( 0.0 );
+    for ( uint k = 0; k < d.size(); k++ )
+    {
+      if ( d[k] <= 0.0 )
+        fthrow ( Exception, "LogDetApproxStochasticLanczos: non-positive Ritz value " << d[k] << ", matrix is not positive definite" );
+      quadrature += tau[k] * tau[k] * log ( d[k] );
+    }
+    logdet += normsSquared[c] * quadrature;
+  }
+  logdet /= m;
+
+  if ( this->b_verbose )
+    std::cerr << "LogDetApproxStochasticLanczos: logdet approximation " << logdet << " (" << m << " probes, depth " << depth << ")" << std::endl;
+
+  return logdet;
+}
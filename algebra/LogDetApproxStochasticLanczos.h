@@ -0,0 +1,100 @@
+/**
+* @file LogDetApproxStochasticLanczos.h
+* @brief LogDet approximation using Hutchinson probes and Lanczos quadrature (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_LOGDETAPPROXSTOCHASTICLANCZOSINCLUDE
+#define _NICE_LOGDETAPPROXSTOCHASTICLANCZOSINCLUDE
+
+// STL includes
+#include <vector>
+
+// NICE-core includes
+#include <core/vector/MatrixT.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/algebra/LogDetApprox.h"
+#include "gp-hik-core/algebra/GenericBlockMatrix.h"
+
+namespace NICE {
+
+ /**
+ * @class LogDetApproxStochasticLanczos
+ * @brief Stochastic Lanczos quadrature estimate of logdet(A) = trace(log(A)) for a symmetric positive definite A.
+ *
+ * For m Rademacher probe vectors z_i, the quadratic forms z_i^T log(A) z_i are approximated by
+ * Gauss quadrature with the Ritz values theta_k and the first components tau_k of the
+ * Ritz vectors of a Lanczos run of depth k started at z_i:
+ * logdet(A) \approx 1/m \sum_i ||z_i||^2 \sum_k tau_k^2 log(theta_k).
+ * A is only accessed by multiplications, the probes of all Lanczos runs are multiplied
+ * with a single call of GenericBlockMatrix::multiplyBlock per step.
+ *
+ * The probe vectors are drawn once (with a fixed seed) and reused as long as the size of A
+ * does not change. Hence, successive evaluations with different hyperparameters share the
+ * same random error, which keeps the approximated likelihood smooth in the hyperparameters.
+ */
+
+class LogDetApproxStochasticLanczos : public LogDetApprox
+{
+
+  protected:
+    /** verbose flag */
+    bool b_verbose;
+
+    /** number of probe vectors */
+    uint ui_numProbes;
+
+    /** maximum number of Lanczos steps per probe vector */
+    uint ui_lanczosDepth;
+
+    /** seed of the random number generator used for the probe vectors */
+    uint ui_seed;
+
+    /** current probe vectors (one per column), empty if not drawn yet */
+    NICE::Matrix probes;
+
+    /** draw new probe vectors with _n rows */
+    void drawProbes ( const uint & _n );
+
+  public:
+
+    /**
+    * @brief simple constructor
+    * @param _numProbes number of probe vectors
+    * @param _lanczosDepth maximum number of Lanczos steps (i.e., quadrature nodes) per probe vector
+    * @param _seed seed of the random number generator used for the probe vectors
+    */
+    LogDetApproxStochasticLanczos ( const uint & _numProbes = 30,
+                                    const uint & _lanczosDepth = 20,
+                                    const uint & _seed = 0
+                                  );
+
+    /** simple destructor */
+    virtual ~LogDetApproxStochasticLanczos();
+
+    void setVerbose ( const bool & _verbose );
+
+    uint getNumProbes () const { return this->ui_numProbes; };
+    uint getLanczosDepth () const { return this->ui_lanczosDepth; };
+
+    /** forget the current probe vectors, new ones are drawn in the next call */
+    void resetProbes ();
+
+    /**
+    * @brief approximate logdet(A) for an explicitly given matrix
+    * @pre A has to be symmetric and positive definite
+    */
+    virtual double getLogDetApproximation ( const NICE::Matrix & A );
+
+    /**
+    * @brief approximate logdet(A) using multiplications with A only
+    * @pre A has to be symmetric and positive definite
+    * @param _A square matrix, e.g., an ImplicitKernelMatrix
+    * @return approximated logdet of A
+    */
+    double getLogDetApproximation ( const GenericBlockMatrix & _A );
+};
+
+} // namespace
+
+#endif
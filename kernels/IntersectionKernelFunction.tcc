@@ -73,7 +73,7 @@ NICE::Matrix IntersectionKernelFunction<T>::computeKernelMatrix ( const NICE::Fe
   //run over every dimension and add the corresponding min-values to the entries in the kernel matrix
   for (int dim = 0; dim < X.get_d(); dim++)
   {
-   const std::multimap< double, typename SortedVectorSparse<double>::dataelement> & nonzeroElements = X.getFeatureValues(dim).nonzeroElements();
+   const SortedVectorSparse<double>::elementcontainer & nonzeroElements = X.getFeatureValues(dim).nonzeroElements();
     
     //compute the min-values (similarities) between every pair in this dimension, zero elements do not influence this
     SortedVectorSparse<double>::const_elementpointer it1 = nonzeroElements.begin();  
@@ -49,8 +49,68 @@ class PFAbsExp : public ParameterizedFunction
     return pow(fabs(x),m_parameters[0]); 
   }
 
+  void f ( uint index, const double * x, double * y, uint n ) const {
+    const double exponent = m_parameters[0];
+    // pow dominates the transformation, avoid it for common exponents
+    if ( exponent == 1.0 )
+    {
+      for ( uint i = 0; i < n; i++ )
+        y[i] = fabs(x[i]);
+    }
+    else if ( exponent == 2.0 )
+    {
+      for ( uint i = 0; i < n; i++ )
+        y[i] = x[i] * x[i];
+    }
+    else if ( exponent == 0.5 )
+    {
+      for ( uint i = 0; i < n; i++ )
+        y[i] = sqrt(fabs(x[i]));
+    }
+    else
+    {
+      // sorted feature values often contain runs of equal values, pow is evaluated once per run
+      double lastX ( 0.0 );
+      double lastY ( pow(0.0,exponent) );
+      for ( uint i = 0; i < n; i++ )
+      {
+        const double absX = fabs(x[i]);
+        if ( absX != lastX )
+        {
+          lastX = absX;
+          lastY = pow(absX,exponent);
+        }
+        y[i] = lastY;
+      }
+    }
+  }
+
+  void fPerDimension ( const uint * indices, const double * x, double * y, uint n ) const { f ( 0, x, y, n ); }
+
+  bool parameterDerivatives ( uint index, const double * x, uint n, std::vector<uint> & parameterIndices, std::vector<double> & derivatives ) const {
+    // d/de |x|^e = |x|^e log|x|, which vanishes for x = 0
+    const double exponent = m_parameters[0];
+    parameterIndices.assign ( 1, 0 );
+    derivatives.resize ( n );
+    double lastX ( 0.0 );
+    double lastD ( 0.0 );
+    for ( uint i = 0; i < n; i++ )
+    {
+      const double absX = fabs(x[i]);
+      if ( absX != lastX )
+      {
+        lastX = absX;
+        lastD = pow(absX,exponent) * log(absX);
+      }
+      derivatives[i] = lastD;
+    }
+    return true;
+  }
+
   bool isOrderPreserving() const { return true; };
 
+  ParameterizedFunction * clone() const { return new PFAbsExp ( *this ); };
+
   Vector getParameterUpperBounds() const { return NICE::Vector(1, upperBound); };
   Vector getParameterLowerBounds() const { return NICE::Vector(1, lowerBound); };
   
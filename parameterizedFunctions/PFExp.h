@@ -46,8 +46,53 @@ class PFExp : public ParameterizedFunction
 
   double f ( uint index, double x ) const { return (exp(fabs(x) * m_parameters[0]) - 1.0) / (exp(m_parameters[0]) - 1.0); }
 
+  void f ( uint index, const double * x, double * y, uint n ) const {
+    const double exponent = m_parameters[0];
+    const double normalization = exp(exponent) - 1.0;
+    // sorted feature values often contain runs of equal values, exp is evaluated once per run
+    double lastX ( 0.0 );
+    double lastY ( 0.0 );
+    for ( uint i = 0; i < n; i++ )
+    {
+      const double absX = fabs(x[i]);
+      if ( absX != lastX )
+      {
+        lastX = absX;
+        lastY = (exp(absX * exponent) - 1.0) / normalization;
+      }
+      y[i] = lastY;
+    }
+  }
+
+  void fPerDimension ( const uint * indices, const double * x, double * y, uint n ) const { f ( 0, x, y, n ); }
+
+  bool parameterDerivatives ( uint index, const double * x, uint n, std::vector<uint> & parameterIndices, std::vector<double> & derivatives ) const {
+    // quotient rule for (exp(e|x|) - 1) / (exp(e) - 1)
+    const double exponent = m_parameters[0];
+    const double normalization = exp(exponent) - 1.0;
+    const double normalizationDerivative = exp(exponent) / ( normalization * normalization );
+    parameterIndices.assign ( 1, 0 );
+    derivatives.resize ( n );
+    double lastX ( 0.0 );
+    double lastD ( 0.0 );
+    for ( uint i = 0; i < n; i++ )
+    {
+      const double absX = fabs(x[i]);
+      if ( absX != lastX )
+      {
+        lastX = absX;
+        const double e = exp(absX * exponent);
+        lastD = absX * e / normalization - (e - 1.0) * normalizationDerivative;
+      }
+      derivatives[i] = lastD;
+    }
+    return true;
+  }
+
   bool isOrderPreserving() const { return true; };
 
+  ParameterizedFunction * clone() const { return new PFExp ( *this ); };
+
   Vector getParameterUpperBounds() const { return NICE::Vector(1, upperBound); };
   Vector getParameterLowerBounds() const { return NICE::Vector(1, lowerBound); };
   
@@ -9,6 +9,7 @@
 
 // STL includes
 #include <math.h>
+#include <algorithm>
 
 // NICE-core includes
 #include <core/vector/VectorT.h>
@@ -42,8 +43,24 @@ class PFIdentity : public ParameterizedFunction
     return _x; 
   }
 
+  void f ( uint _index, const double * _x, double * _y, uint _n ) const {
+    if ( _y != _x )
+      std::copy ( _x, _x + _n, _y );
+  }
+
+  void fPerDimension ( const uint * _indices, const double * _x, double * _y, uint _n ) const { f ( 0, _x, _y, _n ); }
+
+  bool parameterDerivatives ( uint _index, const double * _x, uint _n, std::vector<uint> & _parameterIndices, std::vector<double> & _derivatives ) const {
+    // no parameters at all
+    _parameterIndices.clear();
+    _derivatives.clear();
+    return true;
+  }
+
   bool isOrderPreserving() const { return true; };
 
+  ParameterizedFunction * clone() const { return new PFIdentity ( *this ); };
+
   Vector getParameterUpperBounds() const { return NICE::Vector(0); };
   Vector getParameterLowerBounds() const { return NICE::Vector(0); };
   
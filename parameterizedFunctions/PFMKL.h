@@ -62,8 +62,38 @@ class PFMKL : public ParameterizedFunction
     return 0.0;
   }
 
+  void f ( uint index, const double * x, double * y, uint n ) const
+  {
+    // linear in x, the weight only depends on the dimension
+    const double weight = f ( index, 1.0 );
+    for ( uint i = 0; i < n; i++ )
+      y[i] = x[i] * weight;
+  }
+
+  bool parameterDerivatives ( uint index, const double * x, uint n, std::vector<uint> & parameterIndices, std::vector<double> & derivatives ) const
+  {
+    // only the weight of the group containing this dimension is involved, see f
+    uint group ( 0 );
+    for (std::set<int>::const_iterator it = steps.begin(); it != steps.end(); it++, group++)
+    {
+      if ( (int)index < *it)
+        break;
+    }
+    if ( group >= steps.size() )
+    {
+      parameterIndices.clear();
+      derivatives.clear();
+      return true;
+    }
+    parameterIndices.assign ( 1, group );
+    derivatives.assign ( x, x + n );
+    return true;
+  }
+
   bool isOrderPreserving() const { return true; };
 
+  ParameterizedFunction * clone() const { return new PFMKL ( *this ); };
+
   Vector getParameterUpperBounds() const { return NICE::Vector(m_parameters.size(), upperBound); };
   Vector getParameterLowerBounds() const { return NICE::Vector(m_parameters.size(), lowerBound); };
   
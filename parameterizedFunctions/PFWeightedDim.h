@@ -50,8 +50,34 @@ class PFWeightedDim : public ParameterizedFunction
     
   double f ( uint index, double x ) const { return m_parameters[index] * m_parameters[index] * x; }
 
+  void f ( uint index, const double * x, double * y, uint n ) const {
+    const double weight = m_parameters[index] * m_parameters[index];
+    for ( uint i = 0; i < n; i++ )
+      y[i] = weight * x[i];
+  }
+
+  void fPerDimension ( const uint * indices, const double * x, double * y, uint n ) const {
+    for ( uint i = 0; i < n; i++ )
+    {
+      const uint index = ( indices != NULL ) ? indices[i] : i;
+      y[i] = m_parameters[index] * m_parameters[index] * x[i];
+    }
+  }
+
+  bool parameterDerivatives ( uint index, const double * x, uint n, std::vector<uint> & parameterIndices, std::vector<double> & derivatives ) const {
+    // only the weight of this dimension is involved
+    const double weightDerivative = 2.0 * m_parameters[index];
+    parameterIndices.assign ( 1, index );
+    derivatives.resize ( n );
+    for ( uint i = 0; i < n; i++ )
+      derivatives[i] = weightDerivative * x[i];
+    return true;
+  }
+
   bool isOrderPreserving() const { return true; };
 
+  ParameterizedFunction * clone() const { return new PFWeightedDim ( *this ); };
+
   Vector getParameterUpperBounds() const { return NICE::Vector(m_parameters.size(), upperBound); };
   Vector getParameterLowerBounds() const { return NICE::Vector(m_parameters.size(), lowerBound); };
   
@@ -20,6 +20,18 @@ ParameterizedFunction::ParameterizedFunction( uint dimension )
   m_parameters.resize(dimension);
 }
       
+void ParameterizedFunction::f ( uint index, const double * x, double * y, uint n ) const
+{
+  for ( uint i = 0; i < n; i++ )
+    y[i] = f ( index, x[i] );
+}
+
+void ParameterizedFunction::fPerDimension ( const uint * indices, const double * x, double * y, uint n ) const
+{
+  for ( uint i = 0; i < n; i++ )
+    y[i] = f ( ( indices != NULL ) ? indices[i] : i, x[i] );
+}
+
 void ParameterizedFunction::applyFunctionToDataMatrix ( std::vector< std::vector< double > > & dataMatrix ) const
 {
   // REMARK: might be inefficient due to virtual calls
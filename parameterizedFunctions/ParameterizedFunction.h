@@ -61,6 +61,44 @@ class ParameterizedFunction : public NICE::Persistent
     * @return function value, which depends on the stored parameters
     */
     virtual double f ( uint index, double x ) const = 0;
+
+    /**
+    * @brief Function evaluation for several values of the same component at once,
+    * without a virtual call per value
+    *
+    * @param index component of the vectors
+    * @param x function arguments
+    * @param y resulting function values (y[i] = f(index, x[i]), might be equal to x)
+    * @param n number of values
+    */
+    virtual void f ( uint index, const double * x, double * y, uint n ) const;
+
+    /**
+    * @brief Function evaluation for values of different components, e.g., the non-zero elements of a sparse vector
+    *
+    * @param indices component of every value (y[i] = f(indices[i], x[i])), or NULL if x[i] belongs to component i (dense vector)
+    * @param x function arguments
+    * @param y resulting function values (might be equal to x)
+    * @param n number of values
+    */
+    virtual void fPerDimension ( const uint * indices, const double * x, double * y, uint n ) const;
+
+    /**
+    * @brief Derivatives of f(index, x[i]) with respect to the parameters, for several values of the same component
+    * (needed for gradient-based hyperparameter optimization)
+    *
+    * @param index component of the values
+    * @param x function arguments
+    * @param n number of values
+    * @param parameterIndices resulting indices of the parameters f(index, .) depends on
+    * @param derivatives resulting derivatives, derivatives[k*n + i] is the derivative of f(index, x[i]) with respect to parameter parameterIndices[k]
+    *
+    * @return false if the function does not provide analytic derivatives
+    */
+    virtual bool parameterDerivatives ( uint index, const double * x, uint n,
+                                        std::vector<uint> & parameterIndices,
+                                        std::vector<double> & derivatives
+                                      ) const { return false; };
     
     /**
     * @brief Tell whether this function is order-preserving in the sense that
@@ -71,6 +109,14 @@ class ParameterizedFunction : public NICE::Persistent
     */
     virtual bool isOrderPreserving () const = 0;
 
+    /**
+    * @brief create a copy of this function (including its parameters and bounds),
+    * e.g., for evaluating several parameter values concurrently
+    *
+    * @return new object, which has to be deleted by the caller, or NULL if the function does not support copying
+    */
+    virtual ParameterizedFunction * clone () const { return NULL; };
+
     /**
     * @brief get the lower bound for each parameter
     *
@@ -0,0 +1,425 @@
+/**
+* @file CompactLookupTable.cpp
+* @brief Lookup table stored with reduced precision (Implementation)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// NICE-core includes
+#include <core/basics/Exception.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/quantization/CompactLookupTable.h"
+
+using namespace NICE;
+
+// largest absolute value of the int16 representation
+static const double INT16_RANGE = 32767.0;
+
+CompactLookupTable::CompactLookupTable()
+{
+  this->precision = PRECISION_DOUBLE;
+  this->ui_d = 0;
+  this->dimOffsets.assign ( 1, 0 );
+}
+
+CompactLookupTable::CompactLookupTable ( const double * _table,
+                                         const uint & _d,
+                                         const uint & _numPerDim,
+                                         const Precision & _precision
+                                       )
+{
+  this->precision = _precision;
+  this->ui_d = _d;
+
+  this->dimOffsets.resize ( _d + 1 );
+  for ( uint dim = 0; dim <= _d; dim++ )
+    this->dimOffsets[dim] = (size_t) dim * _numPerDim;
+
+  std::vector<double> values ( _table, _table + this->dimOffsets[_d] );
+  this->setValues ( values );
+}
+
+CompactLookupTable::CompactLookupTable ( const double * const * _table,
+                                         const uint & _d,
+                                         const uint * _numPerDim,
+                                         const Precision & _precision
+                                       )
+{
+  this->precision = _precision;
+  this->ui_d = _d;
+
+  this->dimOffsets.resize ( _d + 1 );
+  this->dimOffsets[0] = 0;
+  for ( uint dim = 0; dim < _d; dim++ )
+    this->dimOffsets[dim+1] = this->dimOffsets[dim] + _numPerDim[dim];
+
+  std::vector<double> values ( this->dimOffsets[_d] );
+  for ( uint dim = 0; dim < _d; dim++ )
+    for ( uint k = 0; k < _numPerDim[dim]; k++ )
+      values[ this->dimOffsets[dim] + k ] = _table[dim][k];
+
+  this->setValues ( values );
+}
+
+CompactLookupTable::~CompactLookupTable()
+{
+}
+
+void CompactLookupTable::setValues ( const std::vector<double> & _values )
+{
+  this->valuesDouble.clear();
+  this->valuesFloat.clear();
+  this->valuesInt16.clear();
+  this->scales.clear();
+
+  switch ( this->precision )
+  {
+    case PRECISION_FLOAT:
+      this->valuesFloat.assign ( _values.begin(), _values.end() );
+      break;
+    case PRECISION_INT16:
+      this->valuesInt16.resize ( _values.size() );
+      this->scales.resize ( this->ui_d, 0.0 );
+      for ( uint dim = 0; dim < this->ui_d; dim++ )
+      {
+        double maxAbs ( 0.0 );
+        for ( size_t k = this->dimOffsets[dim]; k < this->dimOffsets[dim+1]; k++ )
+          maxAbs = std::max ( maxAbs, fabs ( _values[k] ) );
+
+        // all entries of this dimension are zero
+        if ( maxAbs == 0.0 )
+        {
+          for ( size_t k = this->dimOffsets[dim]; k < this->dimOffsets[dim+1]; k++ )
+            this->valuesInt16[k] = 0;
+          continue;
+        }
+
+        this->scales[dim] = maxAbs / INT16_RANGE;
+        for ( size_t k = this->dimOffsets[dim]; k < this->dimOffsets[dim+1]; k++ )
+          this->valuesInt16[k] = (short) floor ( _values[k] / this->scales[dim] + 0.5 );
+      }
+      break;
+    default:
+      this->valuesDouble = _values;
+      break;
+  }
+}
+
+CompactLookupTable::Precision CompactLookupTable::precisionFromString ( const std::string & _precision )
+{
+  if ( _precision == "double" )
+    return PRECISION_DOUBLE;
+  else if ( _precision == "float" )
+    return PRECISION_FLOAT;
+  else if ( _precision == "int16" )
+    return PRECISION_INT16;
+
+  fthrow ( Exception, "CompactLookupTable: unknown precision " << _precision << " (use double, float, or int16)" );
+}
+
+std::string CompactLookupTable::precisionToString ( const Precision & _precision )
+{
+  switch ( _precision )
+  {
+    case PRECISION_FLOAT:
+      return "float";
+    case PRECISION_INT16:
+      return "int16";
+    default:
+      return "double";
+  }
+}
+
+size_t CompactLookupTable::getMemoryUsage() const
+{
+  return this->valuesDouble.size() * sizeof(double)
+       + this->valuesFloat.size() * sizeof(float)
+       + this->valuesInt16.size() * sizeof(short)
+       + this->scales.size() * sizeof(double);
+}
+
+double CompactLookupTable::sumQuantized ( const NICE::SparseVector & _xstar,
+                                          const Quantization * _q
+                                        ) const
+{
+  std::vector<uint> dims;
+  std::vector<uint> bins;
+  _q->quantize ( _xstar, dims, bins, this->ui_d );
+
+  double beta ( 0.0 );
+  for ( uint k = 0; k < dims.size(); k++ )
+    beta += this->get ( dims[k], bins[k] );
+  return beta;
+}
+
+double CompactLookupTable::sumQuantized ( const NICE::Vector & _xstar,
+                                          const Quantization * _q
+                                        ) const
+{
+  if ( _xstar.size() != this->ui_d )
+    fthrow ( Exception, "CompactLookupTable::sumQuantized: size of the example (" << _xstar.size() << ") does not match the number of dimensions (" << this->ui_d << ")" );
+
+  double beta ( 0.0 );
+  if ( this->ui_d == 0 )
+    return beta;
+
+  std::vector<uint> dims ( this->ui_d );
+  std::vector<uint> bins ( this->ui_d );
+  for ( uint dim = 0; dim < this->ui_d; dim++ )
+    dims[dim] = dim;
+  _q->quantize ( _xstar.getDataPointer(), &(dims[0]), &(bins[0]), this->ui_d );
+
+  for ( uint dim = 0; dim < this->ui_d; dim++ )
+    beta += this->get ( dim, bins[dim] );
+  return beta;
+}
+
+///////////////////// INTERFACE PERSISTENT /////////////////////
+// interface specific methods for store and restore
+///////////////////// INTERFACE PERSISTENT /////////////////////
+
+void CompactLookupTable::restore ( std::istream & _is,
+                                   int _format
+                                 )
+{
+  if ( _is.good() )
+  {
+    std::string tmp;
+    _is >> tmp; //class name
+
+    if ( ! this->isStartTag( tmp, "CompactLookupTable" ) )
+    {
+      std::cerr << " WARNING - attempt to restore CompactLookupTable, but start flag " << tmp << " does not match! Aborting... " << std::endl;
+      throw;
+    }
+
+    this->clear();
+    _is.precision ( std::numeric_limits<double>::digits10 + 2 );
+
+    bool b_endOfBlock ( false ) ;
+
+    while ( !b_endOfBlock )
+    {
+      _is >> tmp; // start of block
+
+      if ( this->isEndTag( tmp, "CompactLookupTable" ) )
+      {
+        b_endOfBlock = true;
+        continue;
+      }
+
+      tmp = this->removeStartTag ( tmp );
+
+      if ( tmp.compare("precision") == 0 )
+      {
+        std::string s_precision;
+        _is >> s_precision;
+        this->precision = precisionFromString ( s_precision );
+      }
+      else if ( tmp.compare("ui_d") == 0 )
+      {
+        _is >> this->ui_d;
+      }
+      else if ( tmp.compare("dimOffsets") == 0 )
+      {
+        this->dimOffsets.resize ( this->ui_d + 1 );
+        for ( uint dim = 0; dim <= this->ui_d; dim++ )
+          _is >> this->dimOffsets[dim];
+      }
+      else if ( tmp.compare("scales") == 0 )
+      {
+        size_t size ( 0 );
+        _is >> size;
+        this->scales.resize ( size );
+        for ( size_t k = 0; k < size; k++ )
+          _is >> this->scales[k];
+      }
+      else if ( tmp.compare("values") == 0 )
+      {
+        size_t size ( 0 );
+        _is >> size;
+        switch ( this->precision )
+        {
+          case PRECISION_FLOAT:
+            this->valuesFloat.resize ( size );
+            for ( size_t k = 0; k < size; k++ )
+              _is >> this->valuesFloat[k];
+            break;
+          case PRECISION_INT16:
+            this->valuesInt16.resize ( size );
+            for ( size_t k = 0; k < size; k++ )
+              _is >> this->valuesInt16[k];
+            break;
+          default:
+            this->valuesDouble.resize ( size );
+            for ( size_t k = 0; k < size; k++ )
+              _is >> this->valuesDouble[k];
+            break;
+        }
+      }
+      else
+      {
+        std::cerr << "WARNING -- unexpected CompactLookupTable object -- " << tmp << " -- for restoration... aborting" << std::endl;
+        throw;
+      }
+
+      _is >> tmp; // end of block
+      tmp = this->removeEndTag ( tmp );
+    }
+  }
+  else
+  {
+    std::cerr << "CompactLookupTable::restore -- InStream not initialized - restoring not possible!" << std::endl;
+  }
+}
+
+void CompactLookupTable::store ( std::ostream & _os,
+                                 int _format
+                               ) const
+{
+  if ( _os.good() )
+  {
+    // show starting point
+    _os << this->createStartTag( "CompactLookupTable" ) << std::endl;
+
+    // 17 significant digits are needed to restore the scale factors exactly
+    _os.precision ( std::numeric_limits<double>::digits10 + 2 );
+
+    // the precision has to be restored first, since it determines how the values are read
+    _os << this->createStartTag( "precision" ) << std::endl;
+    _os << precisionToString ( this->precision ) << std::endl;
+    _os << this->createEndTag( "precision" ) << std::endl;
+
+    _os << this->createStartTag( "ui_d" ) << std::endl;
+    _os << this->ui_d << std::endl;
+    _os << this->createEndTag( "ui_d" ) << std::endl;
+
+    _os << this->createStartTag( "dimOffsets" ) << std::endl;
+    for ( uint dim = 0; dim <= this->ui_d; dim++ )
+      _os << this->dimOffsets[dim] << " ";
+    _os << std::endl;
+    _os << this->createEndTag( "dimOffsets" ) << std::endl;
+
+    _os << this->createStartTag( "scales" ) << std::endl;
+    _os << this->scales.size() << std::endl;
+    for ( size_t k = 0; k < this->scales.size(); k++ )
+      _os << this->scales[k] << " ";
+    _os << std::endl;
+    _os << this->createEndTag( "scales" ) << std::endl;
+
+    // values are written in their storage precision
+    _os << this->createStartTag( "values" ) << std::endl;
+    switch ( this->precision )
+    {
+      case PRECISION_FLOAT:
+        _os << this->valuesFloat.size() << std::endl;
+        for ( size_t k = 0; k < this->valuesFloat.size(); k++ )
+          _os << this->valuesFloat[k] << " ";
+        break;
+      case PRECISION_INT16:
+        _os << this->valuesInt16.size() << std::endl;
+        for ( size_t k = 0; k < this->valuesInt16.size(); k++ )
+          _os << this->valuesInt16[k] << " ";
+        break;
+      default:
+        _os << this->valuesDouble.size() << std::endl;
+        for ( size_t k = 0; k < this->valuesDouble.size(); k++ )
+          _os << this->valuesDouble[k] << " ";
+        break;
+    }
+    _os << std::endl;
+    _os << this->createEndTag( "values" ) << std::endl;
+
+    // done
+    _os << this->createEndTag( "CompactLookupTable" ) << std::endl;
+  }
+  else
+  {
+    std::cerr << "OutStream not initialized - storing not possible!" << std::endl;
+  }
+}
+
+void CompactLookupTable::clear ()
+{
+  this->ui_d = 0;
+  this->dimOffsets.assign ( 1, 0 );
+  this->valuesDouble.clear();
+  this->valuesFloat.clear();
+  this->valuesInt16.clear();
+  this->scales.clear();
+}
+
+void CompactLookupTable::storeBinary ( BinaryModelWriter & _writer,
+                                       const std::string & _prefix
+                                     ) const
+{
+  std::vector<uint> layout ( 2 );
+  layout[0] = this->precision;
+  layout[1] = this->ui_d;
+  _writer.addArrayCopy ( _prefix + "layout", layout );
+
+  std::vector<uint64_t> offsets ( this->dimOffsets.begin(), this->dimOffsets.end() );
+  _writer.addArrayCopy ( _prefix + "offsets", offsets );
+
+  _writer.addArrayCopy ( _prefix + "scales", this->scales );
+
+  switch ( this->precision )
+  {
+    case PRECISION_FLOAT:
+      _writer.addArrayCopy ( _prefix + "values", this->valuesFloat );
+      break;
+    case PRECISION_INT16:
+      _writer.addArrayCopy ( _prefix + "values", this->valuesInt16 );
+      break;
+    default:
+      _writer.addArrayCopy ( _prefix + "values", this->valuesDouble );
+      break;
+  }
+}
+
+void CompactLookupTable::restoreBinary ( const BinaryModelReader & _reader,
+                                         const std::string & _prefix
+                                       )
+{
+  this->clear();
+
+  std::vector<uint> layout;
+  _reader.getArrayCopy ( _prefix + "layout", layout );
+  if ( ( layout.size() != 2 ) || ( layout[0] > PRECISION_INT16 ) )
+    fthrow ( Exception, "CompactLookupTable::restoreBinary: invalid layout of " << _prefix );
+  this->precision = static_cast<Precision> ( layout[0] );
+  this->ui_d = layout[1];
+
+  std::vector<uint64_t> offsets;
+  _reader.getArrayCopy ( _prefix + "offsets", offsets );
+  if ( offsets.size() != this->ui_d + 1 )
+    fthrow ( Exception, "CompactLookupTable::restoreBinary: " << offsets.size() << " offsets given for " << this->ui_d << " dimensions" );
+  this->dimOffsets.assign ( offsets.begin(), offsets.end() );
+
+  _reader.getArrayCopy ( _prefix + "scales", this->scales );
+
+  size_t numValues ( 0 );
+  switch ( this->precision )
+  {
+    case PRECISION_FLOAT:
+      _reader.getArrayCopy ( _prefix + "values", this->valuesFloat );
+      numValues = this->valuesFloat.size();
+      break;
+    case PRECISION_INT16:
+      _reader.getArrayCopy ( _prefix + "values", this->valuesInt16 );
+      numValues = this->valuesInt16.size();
+      break;
+    default:
+      _reader.getArrayCopy ( _prefix + "values", this->valuesDouble );
+      numValues = this->valuesDouble.size();
+      break;
+  }
+
+  if ( numValues != this->dimOffsets[this->ui_d] )
+    fthrow ( Exception, "CompactLookupTable::restoreBinary: " << numValues << " values given, but " << this->dimOffsets[this->ui_d] << " expected" );
+}
@@ -0,0 +1,176 @@
+/**
+* @file CompactLookupTable.h
+* @brief Lookup table stored with reduced precision (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_COMPACTLOOKUPTABLEINCLUDE
+#define _NICE_COMPACTLOOKUPTABLEINCLUDE
+
+// STL includes
+#include <string>
+#include <vector>
+
+// NICE-core includes
+#include <core/basics/types.h>
+#include <core/basics/Persistent.h>
+#include <core/vector/VectorT.h>
+#include <core/vector/SparseVectorT.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/BinaryModelFile.h"
+#include "gp-hik-core/quantization/Quantization.h"
+
+namespace NICE {
+
+ /**
+ * @class CompactLookupTable
+ * @brief Per-dimension lookup table (e.g., the LUT T or the arrays A and B of a single class)
+ * stored with a configurable precision.
+ *
+ * Values are kept as double, as float, or as int16 together with a scale factor per dimension,
+ * i.e., value = scale[dim] * int16value with scale[dim] = max_k |value_k| / 32767.
+ * The int16 storage needs a quarter of the memory of the double storage, the maximum absolute
+ * error of a single entry is scale[dim] / 2.
+ */
+
+class CompactLookupTable : public NICE::Persistent
+{
+
+  public:
+
+    /** storage precision of the table entries */
+    enum Precision
+    {
+      PRECISION_DOUBLE = 0,
+      PRECISION_FLOAT,
+      PRECISION_INT16
+    };
+
+  protected:
+
+    /** storage precision */
+    Precision precision;
+
+    /** number of dimensions */
+    uint ui_d;
+
+    /** offsets of the first entry of every dimension, ui_d+1 elements */
+    std::vector<size_t> dimOffsets;
+
+    /** entries, only the vector corresponding to precision is used */
+    std::vector<double> valuesDouble;
+    std::vector<float> valuesFloat;
+    std::vector<short> valuesInt16;
+
+    /** scale factor of every dimension (only used for PRECISION_INT16) */
+    std::vector<double> scales;
+
+    /** store the given entries (layout given by dimOffsets) with the current precision */
+    void setValues ( const std::vector<double> & _values );
+
+  public:
+
+    /** simple constructor creating an empty table */
+    CompactLookupTable();
+
+    /**
+    * @brief constructor for tables with the same number of entries in each dimension (e.g., quantized LUTs)
+    *
+    * @param _table entries with layout [dim][entry], i.e., _d * _numPerDim values
+    * @param _d number of dimensions
+    * @param _numPerDim number of entries per dimension (e.g., number of quantization bins)
+    * @param _precision storage precision
+    */
+    CompactLookupTable ( const double * _table,
+                         const uint & _d,
+                         const uint & _numPerDim,
+                         const Precision & _precision
+                       );
+
+    /**
+    * @brief constructor for tables with a varying number of entries per dimension (e.g., the arrays A and B of GMHIKernelRaw)
+    *
+    * @param _table one array per dimension
+    * @param _d number of dimensions
+    * @param _numPerDim number of entries of every dimension
+    * @param _precision storage precision
+    */
+    CompactLookupTable ( const double * const * _table,
+                         const uint & _d,
+                         const uint * _numPerDim,
+                         const Precision & _precision
+                       );
+
+    /** simple destructor */
+    virtual ~CompactLookupTable();
+
+    /** convert a config string ("double", "float", or "int16") into a precision */
+    static Precision precisionFromString ( const std::string & _precision );
+
+    /** convert a precision into the corresponding config string */
+    static std::string precisionToString ( const Precision & _precision );
+
+    /** get the storage precision */
+    Precision getPrecision() const { return this->precision; };
+
+    /** number of bytes used for storing the entries and scale factors */
+    size_t getMemoryUsage() const;
+
+    /** get entry _idx of dimension _dim */
+    inline double get ( const uint & _dim,
+                        const size_t & _idx
+                      ) const
+    {
+      size_t k = this->dimOffsets[_dim] + _idx;
+      switch ( this->precision )
+      {
+        case PRECISION_FLOAT:
+          return this->valuesFloat[k];
+        case PRECISION_INT16:
+          return this->scales[_dim] * this->valuesInt16[k];
+        default:
+          return this->valuesDouble[k];
+      }
+    };
+
+    /**
+    * @brief sum up the entries of the quantized test example (see FastMinKernel::hik_kernel_sum_fast)
+    * dimensions beyond the size of the table are skipped
+    */
+    double sumQuantized ( const NICE::SparseVector & _xstar,
+                          const Quantization * _q
+                        ) const;
+
+    /** non-sparse version of sumQuantized, the size of _xstar has to match the number of dimensions */
+    double sumQuantized ( const NICE::Vector & _xstar,
+                          const Quantization * _q
+                        ) const;
+
+    ///////////////////// INTERFACE PERSISTENT /////////////////////
+    // interface specific methods for store and restore
+    ///////////////////// INTERFACE PERSISTENT /////////////////////
+    virtual void restore ( std::istream & _is,
+                           int _format = 0
+                         );
+    virtual void store ( std::ostream & _os,
+                         int _format = 0
+                       ) const;
+    virtual void clear ();
+
+    /**
+    * @brief add the table to a binary model (sections _prefix + "layout", "offsets", "scales", and "values"),
+    * the values are written in their storage precision and only referenced (see BinaryModelWriter::addSection)
+    */
+    void storeBinary ( BinaryModelWriter & _writer,
+                       const std::string & _prefix
+                     ) const;
+
+    /** restore a table written by storeBinary (the entries are copied) */
+    void restoreBinary ( const BinaryModelReader & _reader,
+                         const std::string & _prefix
+                       );
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,209 @@
+/**
+* @file PackedLookupTables.cpp
+* @brief Lookup tables of all classes packed into a single contiguous array (Implementation)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// NICE-core includes
+#include <core/basics/Exception.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/quantization/PackedLookupTables.h"
+
+using namespace NICE;
+
+// alignment of the packed array and of every row in bytes (size of a cache line)
+static const size_t PACKED_LUT_ALIGNMENT = 64;
+
+PackedLookupTables::PackedLookupTables()
+{
+  this->table      = NULL;
+  this->b_ownsTable = true;
+  this->ui_d       = 0;
+  this->ui_numBins = 0;
+  this->ui_stride  = 0;
+}
+
+PackedLookupTables::~PackedLookupTables()
+{
+  this->clear();
+}
+
+void PackedLookupTables::clear()
+{
+  if ( ( this->table != NULL ) && this->b_ownsTable )
+    free ( this->table );
+  this->table = NULL;
+  this->b_ownsTable = true;
+  this->ui_d       = 0;
+  this->ui_numBins = 0;
+  this->ui_stride  = 0;
+  this->classNumbers.clear();
+}
+
+void PackedLookupTables::pack ( const std::map<uint, double *> & _T,
+                                const uint & _d,
+                                const uint & _numBins
+                              )
+{
+  this->clear();
+
+  if ( _T.empty() )
+    return;
+
+  // round the number of classes up, such that every row starts at an aligned address
+  const uint doublesPerLine = PACKED_LUT_ALIGNMENT / sizeof(double);
+  uint numClasses = _T.size();
+
+  this->ui_d       = _d;
+  this->ui_numBins = _numBins;
+  this->ui_stride  = ( ( numClasses + doublesPerLine - 1 ) / doublesPerLine ) * doublesPerLine;
+
+  size_t numRows = (size_t) _d * _numBins;
+  void * memory ( NULL );
+  if ( posix_memalign ( &memory, PACKED_LUT_ALIGNMENT, numRows * this->ui_stride * sizeof(double) ) != 0 )
+  {
+    this->clear();
+    fthrow ( Exception, "PackedLookupTables::pack: unable to allocate " << numRows * this->ui_stride * sizeof(double) << " bytes" );
+  }
+  this->table = static_cast<double *> ( memory );
+  // padding columns stay zero
+  memset ( this->table, 0, numRows * this->ui_stride * sizeof(double) );
+
+  uint c = 0;
+  for ( std::map<uint, double *>::const_iterator itT = _T.begin(); itT != _T.end(); itT++, c++ )
+  {
+    this->classNumbers.push_back ( itT->first );
+
+    const double * T = itT->second;
+    double * dst = this->table + c;
+    for ( size_t row = 0; row < numRows; row++, dst += this->ui_stride )
+      *dst = T[row];
+  }
+}
+
+void PackedLookupTables::unpack ( std::map<uint, double *> & _T ) const
+{
+  size_t numRows = (size_t) this->ui_d * this->ui_numBins;
+  for ( uint c = 0; c < this->classNumbers.size(); c++ )
+  {
+    double * T = new double [ numRows ];
+    const double * src = this->table + c;
+    for ( size_t row = 0; row < numRows; row++, src += this->ui_stride )
+      T[row] = *src;
+
+    _T.insert ( std::pair<uint, double *> ( this->classNumbers[c], T ) );
+  }
+}
+
+void PackedLookupTables::setExternal ( const double * _table,
+                                       const uint & _d,
+                                       const uint & _numBins,
+                                       const uint & _stride,
+                                       const std::vector<uint> & _classNumbers
+                                     )
+{
+  this->clear();
+
+  if ( _table == NULL )
+    return;
+
+  if ( _stride < _classNumbers.size() )
+    fthrow ( Exception, "PackedLookupTables::setExternal: stride (" << _stride << ") is smaller than the number of classes (" << _classNumbers.size() << ")" );
+
+  // the table is only read, see addRow
+  this->table       = const_cast<double *> ( _table );
+  this->b_ownsTable = false;
+  this->ui_d        = _d;
+  this->ui_numBins  = _numBins;
+  this->ui_stride   = _stride;
+  this->classNumbers = _classNumbers;
+}
+
+void PackedLookupTables::assign ( const double * _table,
+                                  const uint & _d,
+                                  const uint & _numBins,
+                                  const uint & _stride,
+                                  const std::vector<uint> & _classNumbers
+                                )
+{
+  this->clear();
+
+  if ( _table == NULL )
+    return;
+
+  if ( _stride < _classNumbers.size() )
+    fthrow ( Exception, "PackedLookupTables::assign: stride (" << _stride << ") is smaller than the number of classes (" << _classNumbers.size() << ")" );
+
+  size_t size = (size_t) _d * _numBins * _stride * sizeof(double);
+  void * memory ( NULL );
+  if ( posix_memalign ( &memory, PACKED_LUT_ALIGNMENT, size ) != 0 )
+    fthrow ( Exception, "PackedLookupTables::assign: unable to allocate " << size << " bytes" );
+  memcpy ( memory, _table, size );
+
+  this->table        = static_cast<double *> ( memory );
+  this->ui_d         = _d;
+  this->ui_numBins   = _numBins;
+  this->ui_stride    = _stride;
+  this->classNumbers = _classNumbers;
+}
+
+bool PackedLookupTables::empty() const
+{
+  return ( this->table == NULL );
+}
+
+const std::vector<uint> & PackedLookupTables::getClassNumbers() const
+{
+  return this->classNumbers;
+}
+
+void PackedLookupTables::computeScores ( const NICE::SparseVector & _xstar,
+                                         const Quantization * _q,
+                                         NICE::Vector & _scores
+                                       ) const
+{
+  std::vector<double> rowSums ( this->ui_stride, 0.0 );
+
+  std::vector<uint> dims;
+  std::vector<uint> bins;
+  _q->quantize ( _xstar, dims, bins, this->ui_d );
+
+  for ( uint k = 0; k < dims.size(); k++ )
+    this->addRow ( (size_t) dims[k] * this->ui_numBins + bins[k], &(rowSums[0]) );
+
+  _scores.resize ( this->classNumbers.size() );
+  for ( uint c = 0; c < this->classNumbers.size(); c++ )
+    _scores[c] = rowSums[c];
+}
+
+void PackedLookupTables::computeScores ( const NICE::Vector & _xstar,
+                                         const Quantization * _q,
+                                         NICE::Vector & _scores
+                                       ) const
+{
+  if ( _xstar.size() != this->ui_d )
+    fthrow ( Exception, "PackedLookupTables::computeScores: size of the example (" << _xstar.size() << ") does not match the number of dimensions (" << this->ui_d << ")" );
+
+  std::vector<double> rowSums ( this->ui_stride, 0.0 );
+
+  if ( this->ui_d > 0 )
+  {
+    std::vector<uint> dims ( this->ui_d );
+    std::vector<uint> bins ( this->ui_d );
+    for ( uint dim = 0; dim < this->ui_d; dim++ )
+      dims[dim] = dim;
+    _q->quantize ( _xstar.getDataPointer(), &(dims[0]), &(bins[0]), this->ui_d );
+
+    for ( uint dim = 0; dim < this->ui_d; dim++ )
+      this->addRow ( (size_t) dim * this->ui_numBins + bins[dim], &(rowSums[0]) );
+  }
+
+  _scores.resize ( this->classNumbers.size() );
+  for ( uint c = 0; c < this->classNumbers.size(); c++ )
+    _scores[c] = rowSums[c];
+}
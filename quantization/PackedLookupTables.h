@@ -0,0 +1,178 @@
+/**
+* @file PackedLookupTables.h
+* @brief Lookup tables of all classes packed into a single contiguous array (Interface)
+* @date 16-10-2026 (dd-mm-yyyy)
+*/
+#ifndef _NICE_PACKEDLOOKUPTABLESINCLUDE
+#define _NICE_PACKEDLOOKUPTABLESINCLUDE
+
+// STL includes
+#include <map>
+#include <vector>
+
+// NICE-core includes
+#include <core/basics/types.h>
+#include <core/vector/VectorT.h>
+#include <core/vector/SparseVectorT.h>
+
+// gp-hik-core includes
+#include "gp-hik-core/quantization/Quantization.h"
+
+namespace NICE {
+
+ /**
+ * @class PackedLookupTables
+ * @brief Lookup tables T (one per class, layout [dim][bin]) packed into a single array with layout [dim][bin][class].
+ *
+ * All class contributions of a quantized test value are located next to each other, such that
+ * scoring a test example requires a single contiguous read per non-zero dimension instead of
+ * one scattered read per class. Every [dim][bin] row is padded to a multiple of 64 bytes
+ * and the array is 64-byte aligned, which allows for vectorized additions of complete rows.
+ */
+
+class PackedLookupTables
+{
+
+  protected:
+
+    /** packed tables with layout [dim][bin][class], 64-byte aligned (NULL if empty) */
+    double *table;
+
+    /** false if table refers to external memory (see setExternal) */
+    bool b_ownsTable;
+
+    /** number of dimensions */
+    uint ui_d;
+
+    /** number of quantization bins per dimension */
+    uint ui_numBins;
+
+    /** number of doubles per [dim][bin] row (number of classes rounded up to multiples of 64 bytes) */
+    uint ui_stride;
+
+    /** class numbers in the order of the packed columns */
+    std::vector<uint> classNumbers;
+
+  private:
+
+    // copying the packed array is not supported
+    PackedLookupTables ( const PackedLookupTables & );
+    PackedLookupTables & operator= ( const PackedLookupTables & );
+
+  public:
+
+    /** simple constructor */
+    PackedLookupTables();
+
+    /** simple destructor */
+    virtual ~PackedLookupTables();
+
+    /** free the packed tables */
+    void clear();
+
+    /**
+    * @brief pack the given lookup tables, previous content is discarded
+    *
+    * @param _T lookup tables of all classes, each of size _d * _numBins with layout [dim][bin]
+    * @param _d number of dimensions
+    * @param _numBins number of quantization bins per dimension
+    */
+    void pack ( const std::map<uint, double *> & _T,
+                const uint & _d,
+                const uint & _numBins
+              );
+
+    /**
+    * @brief extract the lookup table of every class (layout [dim][bin]), i.e., the inverse of pack
+    *
+    * @param _T the tables of all classes are added, they are allocated with new [] and owned by the caller
+    */
+    void unpack ( std::map<uint, double *> & _T ) const;
+
+    /**
+    * @brief use packed tables located in external memory (e.g., a mapped binary model) without copying them,
+    * previous content is discarded. The memory has to stay valid until clear is called.
+    *
+    * @param _table packed tables with layout [dim][bin][class] as returned by getTable, 64-byte aligned
+    * @param _d number of dimensions
+    * @param _numBins number of quantization bins per dimension
+    * @param _stride number of doubles per [dim][bin] row
+    * @param _classNumbers class numbers in the order of the packed columns
+    */
+    void setExternal ( const double * _table,
+                       const uint & _d,
+                       const uint & _numBins,
+                       const uint & _stride,
+                       const std::vector<uint> & _classNumbers
+                     );
+
+    /** same as setExternal, but the packed tables are copied */
+    void assign ( const double * _table,
+                  const uint & _d,
+                  const uint & _numBins,
+                  const uint & _stride,
+                  const std::vector<uint> & _classNumbers
+                );
+
+    /** check whether there are any tables packed */
+    bool empty() const;
+
+    /** class numbers in the order used by computeScores */
+    const std::vector<uint> & getClassNumbers() const;
+
+    /**
+    * @brief compute the scores of all classes for a sparse test example
+    *
+    * @param _xstar test example
+    * @param _q quantization used for creating the lookup tables
+    * @param _scores resulting scores in the order of getClassNumbers()
+    */
+    void computeScores ( const NICE::SparseVector & _xstar,
+                         const Quantization * _q,
+                         NICE::Vector & _scores
+                       ) const;
+
+    /**
+    * @brief compute the scores of all classes for a non-sparse test example
+    *
+    * @param _xstar test example
+    * @param _q quantization used for creating the lookup tables
+    * @param _scores resulting scores in the order of getClassNumbers()
+    */
+    void computeScores ( const NICE::Vector & _xstar,
+                         const Quantization * _q,
+                         NICE::Vector & _scores
+                       ) const;
+
+    /**
+    * @brief add the class contributions of row _row = dim * numBins + bin to _scores,
+    * which has to provide at least getStride() elements
+    */
+    inline void addRow ( const size_t & _row,
+                         double * _scores
+                       ) const
+    {
+      const double * row = this->table + _row * this->ui_stride;
+      for ( uint c = 0; c < this->ui_stride; c++ )
+        _scores[c] += row[c];
+    };
+
+    /** number of doubles per packed row (at least the number of classes) */
+    uint getStride() const { return this->ui_stride; };
+
+    /** packed tables with layout [dim][bin][class] (NULL if empty) */
+    const double * getTable() const { return this->table; };
+
+    /** number of doubles of the packed tables */
+    size_t getTableSize() const { return (size_t) this->ui_d * this->ui_numBins * this->ui_stride; };
+
+    /** number of dimensions */
+    uint getNumberOfDimensions() const { return this->ui_d; };
+
+    /** number of quantization bins per dimension */
+    uint getNumberOfBins() const { return this->ui_numBins; };
+};
+
+} // namespace
+
+#endif
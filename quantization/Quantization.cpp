@@ -30,6 +30,61 @@ uint Quantization::getNumberOfBins() const
 {
   return this->ui_numBins;
 }
+
+const NICE::Vector & Quantization::getUpperBounds() const
+{
+  return this->v_upperBounds;
+}
+
+void Quantization::quantize ( const double * _values,
+                              const uint & _dim,
+                              uint * _bins,
+                              const uint & _n
+                            ) const
+{
+  for ( uint k = 0; k < _n; k++ )
+    _bins[k] = this->quantize ( _values[k], _dim );
+}
+
+void Quantization::quantize ( const double * _values,
+                              const uint * _dims,
+                              uint * _bins,
+                              const uint & _n
+                            ) const
+{
+  for ( uint k = 0; k < _n; k++ )
+    _bins[k] = this->quantize ( _values[k], _dims[k] );
+}
+
+void Quantization::quantize ( const NICE::SparseVector & _x,
+                              std::vector<uint> & _dims,
+                              std::vector<uint> & _bins,
+                              const uint & _numDimensions
+                            ) const
+{
+  _dims.resize ( _x.size() );
+  std::vector<double> values ( _x.size() );
+
+  // unknown dimensions are removed first, the batch versions do not check the dimensions
+  uint n = 0;
+  for ( NICE::SparseVector::const_iterator i = _x.begin(); i != _x.end(); i++ )
+  {
+    if ( i->first >= _numDimensions )
+      continue;
+
+    _dims[n]  = i->first;
+    values[n] = i->second;
+    n++;
+  }
+
+  _dims.resize ( n );
+  _bins.resize ( n );
+  if ( n == 0 )
+    return;
+
+  // a single virtual call for the whole example
+  this->quantize ( &(values[0]), &(_dims[0]), &(_bins[0]), n );
+}
  
 // ---------------------- STORE AND RESTORE FUNCTIONS ----------------------
 
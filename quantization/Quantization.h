@@ -7,11 +7,15 @@
 #ifndef _NICE_QUANTIZATIONINCLUDE
 #define _NICE_QUANTIZATIONINCLUDE
 
+// STL includes
+#include <vector>
+
 // NICE-core includes
 #include <core/basics/types.h>
 #include <core/basics/Persistent.h>
 // 
 #include <core/vector/VectorT.h>
+#include <core/vector/SparseVectorT.h>
 
 namespace NICE {
   
@@ -67,6 +71,11 @@ class Quantization  : public NICE::Persistent
   */
   virtual uint getNumberOfBins() const;  
 
+  /**
+  * @brief get the upper bounds of the quantization (empty if the quantization does not depend on the data)
+  */
+  const NICE::Vector & getUpperBounds() const;
+
   /**
   * @brief get specific word or prototype element of the quantization
   *
@@ -89,6 +98,48 @@ class Quantization  : public NICE::Persistent
   virtual uint quantize ( double _value, 
                           const uint & _dim = 0
                         ) const = 0;
+
+  /**
+  * @brief Quantize _n values of the same dimension at once, i.e., _bins[k] = quantize ( _values[k], _dim ).
+  * The default implementation calls quantize for every single value. Subclasses override it 
+  * with a plain loop without virtual calls, which should be preferred in loops over many values.
+  *
+  * @param _values array of _n signal values
+  * @param _dim dimension of all values
+  * @param _bins resulting bin indices, has to provide space for _n elements
+  * @param _n number of values
+  */
+  virtual void quantize ( const double * _values,
+                          const uint & _dim,
+                          uint * _bins,
+                          const uint & _n
+                        ) const;
+
+  /**
+  * @brief Quantize _n values of possibly different dimensions at once, i.e., _bins[k] = quantize ( _values[k], _dims[k] ).
+  * See the version above for details.
+  */
+  virtual void quantize ( const double * _values,
+                          const uint * _dims,
+                          uint * _bins,
+                          const uint & _n
+                        ) const;
+
+  /**
+  * @brief Quantize all non-zero elements of a sparse vector with a single batch call.
+  * Elements of dimensions not smaller than _numDimensions (i.e., unknown during training) are skipped
+  * before quantization, since the quantizer has no parameters for them.
+  *
+  * @param _x sparse signal
+  * @param _dims resulting dimensions of the quantized non-zero elements
+  * @param _bins resulting bin indices of the quantized non-zero elements (same size as _dims)
+  * @param _numDimensions number of dimensions known to the quantizer
+  */
+  void quantize ( const NICE::SparseVector & _x,
+                  std::vector<uint> & _dims,
+                  std::vector<uint> & _bins,
+                  const uint & _numDimensions
+                ) const;
                         
                         
                         
@@ -38,18 +38,46 @@ double Quantization1DAequiDist0To1::getPrototype ( uint _bin,
   return _bin / (double)(this->ui_numBins-1);
 }
   
-uint Quantization1DAequiDist0To1::quantize ( double _value,
-                                             const uint & _dim
-                                           ) const
+// non-virtual helper shared by all versions of quantize, such that single and batch quantization yield identical bins
+static inline uint quantizeValue ( const double & _value,
+                                   const uint & _numBins
+                                 )
 {
-  //  _dim will be ignored for this type of quantization. all dimensions are treated equally...
-  
   if ( _value <= 0.0 ) 
     return 0;
   else if ( _value >= 1.0 ) 
-    return this->ui_numBins-1;
+    return _numBins-1;
   else 
-    return static_cast<uint> ( _value * (this->ui_numBins-1) + 0.5 );
+    return static_cast<uint> ( _value * (_numBins-1) + 0.5 );
+}
+
+uint Quantization1DAequiDist0To1::quantize ( double _value,
+                                             const uint & _dim
+                                           ) const
+{
+  //  _dim will be ignored for this type of quantization. all dimensions are treated equally...
+  return quantizeValue ( _value, this->ui_numBins );
+}
+
+void Quantization1DAequiDist0To1::quantize ( const double * _values,
+                                             const uint & _dim,
+                                             uint * _bins,
+                                             const uint & _n
+                                           ) const
+{
+  const uint numBins = this->ui_numBins;
+  for ( uint k = 0; k < _n; k++ )
+    _bins[k] = quantizeValue ( _values[k], numBins );
+}
+
+void Quantization1DAequiDist0To1::quantize ( const double * _values,
+                                             const uint * _dims,
+                                             uint * _bins,
+                                             const uint & _n
+                                           ) const
+{
+  //  _dims will be ignored for this type of quantization. all dimensions are treated equally...
+  this->quantize ( _values, 0u, _bins, _n );
 }
 
 void Quantization1DAequiDist0To1::computeParametersFromData ( const NICE::Vector & _maxValuesPerDimension )
@@ -42,18 +42,48 @@ double Quantization1DAequiDist0ToMax::getPrototype ( uint _bin,
   return (this->v_upperBounds[0]*_bin) / (double)(this->ui_numBins-1);
 }
   
+// non-virtual helper shared by all versions of quantize, such that single and batch quantization yield identical bins
+static inline uint quantizeValue ( const double & _value,
+                                   const double & _upperBound,
+                                   const uint & _numBins
+                                 )
+{
+  if ( _value <= 0.0 ) 
+    return 0;
+  else if ( _value >= _upperBound ) 
+    return _numBins-1;
+  else 
+    return static_cast<uint> ( floor( _value/_upperBound  * (_numBins-1) + 0.5 ) );
+}
+
 uint Quantization1DAequiDist0ToMax::quantize ( double _value,
                                                const uint & _dim
                                              ) const
 {
   //  _dim will be ignored for this type of quantization. all dimensions are treated equally...
-  
-  if ( _value <= 0.0 ) 
-    return 0;
-  else if ( _value >= this->v_upperBounds[0] ) 
-    return this->ui_numBins-1;
-  else 
-    return static_cast<uint> ( floor( _value/this->v_upperBounds[0]  * (this->ui_numBins-1) + 0.5 ) );
+  return quantizeValue ( _value, this->v_upperBounds[0], this->ui_numBins );
+}
+
+void Quantization1DAequiDist0ToMax::quantize ( const double * _values,
+                                               const uint & _dim,
+                                               uint * _bins,
+                                               const uint & _n
+                                             ) const
+{
+  const double upperBound = this->v_upperBounds[0];
+  const uint numBins = this->ui_numBins;
+  for ( uint k = 0; k < _n; k++ )
+    _bins[k] = quantizeValue ( _values[k], upperBound, numBins );
+}
+
+void Quantization1DAequiDist0ToMax::quantize ( const double * _values,
+                                               const uint * _dims,
+                                               uint * _bins,
+                                               const uint & _n
+                                             ) const
+{
+  //  _dims will be ignored for this type of quantization. all dimensions are treated equally...
+  this->quantize ( _values, 0u, _bins, _n );
 }
 
 
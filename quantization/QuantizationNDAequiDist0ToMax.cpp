@@ -40,16 +40,49 @@ double QuantizationNDAequiDist0ToMax::getPrototype ( uint _bin,
   return (this->v_upperBounds[_dim]*_bin) / (double)(this->ui_numBins-1);
 }
   
-uint QuantizationNDAequiDist0ToMax::quantize ( double _value,
-                                               const uint & _dim
-                                             ) const
+// non-virtual helper shared by all versions of quantize, such that single and batch quantization yield identical bins
+static inline uint quantizeValue ( const double & _value,
+                                   const double & _upperBound,
+                                   const uint & _numBins
+                                 )
 {
   if ( _value <= 0.0 ) 
     return 0;
-  else if ( _value >= this->v_upperBounds[_dim] ) 
-    return this->ui_numBins-1;
+  else if ( _value >= _upperBound ) 
+    return _numBins-1;
   else 
-      return static_cast<uint> ( floor( _value/this->v_upperBounds[_dim]  * (this->ui_numBins-1) + 0.5 ) );
+    return static_cast<uint> ( floor( _value/_upperBound  * (_numBins-1) + 0.5 ) );
+}
+
+uint QuantizationNDAequiDist0ToMax::quantize ( double _value,
+                                               const uint & _dim
+                                             ) const
+{
+  return quantizeValue ( _value, this->v_upperBounds[_dim], this->ui_numBins );
+}
+
+void QuantizationNDAequiDist0ToMax::quantize ( const double * _values,
+                                               const uint & _dim,
+                                               uint * _bins,
+                                               const uint & _n
+                                             ) const
+{
+  const double upperBound = this->v_upperBounds[_dim];
+  const uint numBins = this->ui_numBins;
+  for ( uint k = 0; k < _n; k++ )
+    _bins[k] = quantizeValue ( _values[k], upperBound, numBins );
+}
+
+void QuantizationNDAequiDist0ToMax::quantize ( const double * _values,
+                                               const uint * _dims,
+                                               uint * _bins,
+                                               const uint & _n
+                                             ) const
+{
+  const double * upperBounds = this->v_upperBounds.getDataPointer();
+  const uint numBins = this->ui_numBins;
+  for ( uint k = 0; k < _n; k++ )
+    _bins[k] = quantizeValue ( _values[k], upperBounds[ _dims[k] ], numBins );
 }
 
 
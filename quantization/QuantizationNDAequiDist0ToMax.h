@@ -76,6 +76,23 @@ class QuantizationNDAequiDist0ToMax  : public NICE::Quantization
   virtual uint quantize ( double _value, 
                           const uint & _dim = 0
                         ) const;
+
+  /** batch version of quantize for values of a single dimension, see Quantization */
+  virtual void quantize ( const double * _values,
+                          const uint & _dim,
+                          uint * _bins,
+                          const uint & _n
+                        ) const;
+
+  /** batch version of quantize for values of different dimensions, see Quantization */
+  virtual void quantize ( const double * _values,
+                          const uint * _dims,
+                          uint * _bins,
+                          const uint & _n
+                        ) const;
+
+  // the sparse vector version of the base class is not hidden by the overrides above
+  using Quantization::quantize;
                         
                         
   virtual void computeParametersFromData ( const NICE::Vector & _maxValuesPerDimension );
@@ -1,10 +1,14 @@
 #ifdef NICE_USELIB_CPPUNIT
 
 #include <string>
+#include <sstream>
 #include <exception>
+#include <algorithm>
+#include <set>
 
 #include <core/algebra/ILSConjugateGradients.h>
 #include <core/algebra/GMStandard.h>
+#include <core/basics/Config.h>
 #include <core/basics/Timer.h>
 
 #include <gp-hik-core/tools.h>
@@ -12,11 +16,26 @@
 #include <gp-hik-core/kernels/GeneralizedIntersectionKernelFunction.h>
 #include <gp-hik-core/parameterizedFunctions/ParameterizedFunction.h>
 #include <gp-hik-core/parameterizedFunctions/PFAbsExp.h>
+#include <gp-hik-core/parameterizedFunctions/PFExp.h>
+#include <gp-hik-core/parameterizedFunctions/PFIdentity.h>
+#include <gp-hik-core/parameterizedFunctions/PFMKL.h>
+#include <gp-hik-core/parameterizedFunctions/PFWeightedDim.h>
+#include <gp-hik-core/BinaryModelFile.h>
+#include <gp-hik-core/FMKGPHyperparameterOptimization.h>
 #include <gp-hik-core/GMHIKernelRaw.h>
+#include <gp-hik-core/GPHIKRawClassifier.h>
+#include <gp-hik-core/IKMNoise.h>
+#include <gp-hik-core/algebra/BoundedLBFGS.h>
+#include <gp-hik-core/algebra/EVSubspaceIteration.h>
+#include <gp-hik-core/algebra/ILSBlockConjugateGradients.h>
+#include <gp-hik-core/algebra/LogDetApproxStochasticLanczos.h>
 //
 //
 #include "gp-hik-core/quantization/Quantization.h"
 #include "gp-hik-core/quantization/Quantization1DAequiDist0To1.h"
+#include "gp-hik-core/quantization/Quantization1DAequiDist0ToMax.h"
+#include "gp-hik-core/quantization/QuantizationNDAequiDist0ToMax.h"
+#include "gp-hik-core/quantization/CompactLookupTable.h"
 
 #include "TestFastHIK.h"
 
@@ -339,6 +358,13 @@ void TestFastHIK::testKernelMultiplicationFast()
   if ( b_debug )
     std::cerr << "Sparse multiplication [galpha, galphaFast, galpha_slow]: " << std::endl <<  galpha << std::endl << galphaFast << std::endl << galpha_slow << std::endl << std::endl;
 
+  // bin indices of the training data cached in advance have to give the same result
+  fmk.prepareBinIndices ( q );
+  CPPUNIT_ASSERT ( fmk.hasBinIndices ( q ) );
+  Vector galphaFastCached;
+  gmkFast.multiply ( galphaFastCached, y );
+  CPPUNIT_ASSERT_DOUBLES_EQUAL((galphaFastCached-galphaFast).normL1(), 0.0, 1e-8);
+
   // clean-up
   delete q_gen;
   delete q;
@@ -352,6 +378,109 @@ void TestFastHIK::testKernelMultiplicationFast()
 }
 
 
+void TestFastHIK::testKernelMultiplicationBlock()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKernelMultiplicationBlock ===================== " << std::endl;
+
+  vector< vector<double> > dataMatrix;
+
+  generateRandomFeatures ( d, n, dataMatrix );
+
+  for ( uint i = 0 ; i < d; i++ )
+  {
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+
+  double noise = 1.0;
+  FastMinKernel fmk ( dataMatrix, noise );
+  GMHIKernel gmk ( &fmk );
+  gmk.setVerbose(false);
+
+  std::vector<std::vector<double> > dataMatrix_transposed (dataMatrix);
+  transposeVectorOfVectors(dataMatrix_transposed);
+  std::vector< const NICE::SparseVector * > dataMatrix_sparse;
+  for ( std::vector< std::vector<double> >::const_iterator i = dataMatrix_transposed.begin(); i != dataMatrix_transposed.end(); i++ )
+  {
+    Vector w ( *i );
+    SparseVector *v = new SparseVector ( w );
+    dataMatrix_sparse.push_back(v);
+  }
+  GMHIKernelRaw gmk_raw ( dataMatrix_sparse, noise );
+
+  // several right hand sides, as for a multi-class problem
+  const uint m = 5;
+  NICE::Matrix Y ( n, m );
+  for ( uint i = 0; i < n; i++ )
+    for ( uint c = 0; c < m; c++ )
+      Y(i,c) = sin( (double)(i*m + c) );
+
+  NICE::Timer t;
+  NICE::Matrix alphaBlock;
+  t.start();
+  gmk.multiplyBlock ( alphaBlock, Y );
+  t.stop();
+  if (verbose)
+    std::cerr << "Time for block kernel multiplication with GMHIKernel: " << t.getLast() << std::endl;
+
+  NICE::Matrix alphaBlock_raw;
+  t.start();
+  gmk_raw.multiplyBlock ( alphaBlock_raw, Y );
+  t.stop();
+  if (verbose)
+    std::cerr << "Time for block kernel multiplication with GMHIKernelRaw: " << t.getLast() << std::endl;
+
+  CPPUNIT_ASSERT_EQUAL ( n, (uint) alphaBlock.rows() );
+  CPPUNIT_ASSERT_EQUAL ( m, (uint) alphaBlock.cols() );
+
+  // every column has to be identical to the single vector multiplication
+  for ( uint c = 0; c < m; c++ )
+  {
+    Vector y ( n );
+    for ( uint i = 0; i < n; i++ )
+      y[i] = Y(i,c);
+
+    Vector alpha;
+    gmk.multiply ( alpha, y );
+
+    double err ( 0.0 );
+    double err_raw ( 0.0 );
+    for ( uint i = 0; i < n; i++ )
+    {
+      err += fabs ( alpha[i] - alphaBlock(i,c) );
+      err_raw += fabs ( alpha[i] - alphaBlock_raw(i,c) );
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(err, 0.0, 1e-8);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(err_raw, 0.0, 1e-8);
+  }
+
+  // solve for all right hand sides at once and check the residuals
+  ILSBlockConjugateGradients blockSolver ( false, solveLinMaxIterations, 1e-10, 1e-10 );
+  NICE::Matrix X;
+  blockSolver.solveLin ( gmk, Y, X );
+
+  NICE::Matrix KX;
+  gmk.multiplyBlock ( KX, X );
+  for ( uint c = 0; c < m; c++ )
+  {
+    double residual ( 0.0 );
+    for ( uint i = 0; i < n; i++ )
+      residual += fabs ( KX(i,c) - Y(i,c) );
+    if (verbose)
+      std::cerr << "residual of the block solver for column " << c << ": " << residual << std::endl;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(residual, 0.0, 1e-4);
+  }
+
+  for ( std::vector< const NICE::SparseVector * >::iterator i = dataMatrix_sparse.begin(); i != dataMatrix_sparse.end(); i++ )
+    delete *i;
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKernelMultiplicationBlock done ===================== " << std::endl;
+}
+
+
 void TestFastHIK::testKernelSum()
 {
   if (verboseStartEnd)
@@ -568,6 +697,184 @@ void TestFastHIK::testKernelSumFast()
 
 }
 
+void TestFastHIK::testLUTPrecision()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLUTPrecision ===================== " << std::endl;
+
+  NICE::Quantization * q = new Quantization1DAequiDist0To1 ( numBins );
+
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( d, n, dataMatrix );
+  for ( uint i = 0 ; i < d; i++ )
+  {
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+
+  double noise = 1.0;
+  FastMinKernel fmk ( dataMatrix, noise );
+  Vector alpha = Vector::UniformRandom( n, -1.0, 1.0, 0 );
+
+  // LUT with double precision as reference
+  NICE::VVector A;
+  NICE::VVector B;
+  fmk.hik_prepare_alpha_multiplications ( alpha, A, B );
+  double *T = fmk.hik_prepare_alpha_multiplications_fast ( A, B, q );
+
+  double maxAbsT ( 0.0 );
+  for ( uint i = 0; i < d*numBins; i++ )
+    maxAbsT = std::max ( maxAbsT, fabs ( T[i] ) );
+
+  // arrays A and B as used by GPHIKRawClassifier
+  std::vector<std::vector<double> > dataMatrix_transposed (dataMatrix);
+  transposeVectorOfVectors(dataMatrix_transposed);
+  std::vector< const NICE::SparseVector * > dataMatrix_sparse;
+  for ( std::vector< std::vector<double> >::const_iterator i = dataMatrix_transposed.begin(); i != dataMatrix_transposed.end(); i++ )
+  {
+    Vector w ( *i );
+    dataMatrix_sparse.push_back ( new SparseVector ( w ) );
+  }
+  GMHIKernelRaw gmk_raw ( dataMatrix_sparse, noise );
+  double **tableA;
+  double **tableB;
+  double *tableT;
+  gmk_raw.computeLookupTables ( alpha, tableA, tableB, tableT );
+  uint *nnz = gmk_raw.getNNZPerDimension();
+  uint dRaw = gmk_raw.getNumberOfDimensions();
+
+  CompactLookupTable::Precision precisions[2] = { CompactLookupTable::PRECISION_FLOAT, CompactLookupTable::PRECISION_INT16 };
+  for ( uint p = 0; p < 2; p++ )
+  {
+    CompactLookupTable compactT ( T, d, numBins, precisions[p] );
+    CompactLookupTable compactA ( tableA, dRaw, nnz, precisions[p] );
+
+    // float: relative error of a single entry is below 1e-7,
+    // int16: absolute error of a single entry is below max_k |value_k| / 65534 of its dimension
+    double tolerance = ( precisions[p] == CompactLookupTable::PRECISION_FLOAT ) ? 1e-6 * maxAbsT : maxAbsT / 32767.0;
+    if (verbose)
+      std::cerr << "testing LUT precision " << CompactLookupTable::precisionToString ( precisions[p] ) << " with memory usage " << compactT.getMemoryUsage() << " bytes instead of " << d*numBins*sizeof(double) << std::endl;
+
+    // the scores of the test examples have to match the ones obtained with double precision
+    for ( uint trial = 0; trial < 10; trial++ )
+    {
+      Vector xstar (d);
+      for ( uint i = 0 ; i < d ; i++ )
+        xstar[i] = ( drand48() < sparse_prob ) ? 0.0 : drand48();
+      SparseVector xstar_sparse ( xstar );
+
+      double beta_double;
+      fmk.hik_kernel_sum_fast ( T, q, xstar_sparse, beta_double );
+      double beta_compact = compactT.sumQuantized ( xstar_sparse, q );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(beta_double, beta_compact, d * tolerance);
+
+      double beta_double_dense;
+      fmk.hik_kernel_sum_fast ( T, q, xstar, beta_double_dense );
+      double beta_compact_dense = compactT.sumQuantized ( xstar, q );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(beta_double_dense, beta_compact_dense, d * tolerance);
+    }
+
+    for ( uint dim = 0; dim < dRaw; dim++ )
+    {
+      double maxAbsA ( 0.0 );
+      for ( uint k = 0; k < nnz[dim]; k++ )
+        maxAbsA = std::max ( maxAbsA, fabs ( tableA[dim][k] ) );
+      for ( uint k = 0; k < nnz[dim]; k++ )
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(tableA[dim][k], compactA.get ( dim, k ), maxAbsA / 32767.0);
+    }
+
+    // the persistent form stores the reduced precision values, i.e., restoring has to be exact
+    std::stringstream ss;
+    compactT.store ( ss );
+    CompactLookupTable compactTRestored;
+    compactTRestored.restore ( ss );
+    CPPUNIT_ASSERT ( compactTRestored.getPrecision() == precisions[p] );
+    for ( uint dim = 0; dim < d; dim++ )
+      for ( uint k = 0; k < numBins; k++ )
+        CPPUNIT_ASSERT_EQUAL ( compactT.get ( dim, k ), compactTRestored.get ( dim, k ) );
+  }
+
+  // clean-up
+  for ( uint dim = 0; dim < dRaw; dim++ )
+  {
+    delete [] tableA[dim];
+    delete [] tableB[dim];
+  }
+  delete [] tableA;
+  delete [] tableB;
+  delete [] nnz;
+  for ( std::vector< const NICE::SparseVector * >::iterator i = dataMatrix_sparse.begin(); i != dataMatrix_sparse.end(); i++ )
+    delete *i;
+  delete [] T;
+  delete q;
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLUTPrecision done ===================== " << std::endl;
+}
+
+void TestFastHIK::testBatchQuantization()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testBatchQuantization ===================== " << std::endl;
+
+  // upper bounds of the quantizers with data dependent range
+  NICE::Vector maxValues = Vector::UniformRandom( d, 0.5, 2.0, 0 );
+
+  std::vector<NICE::Quantization *> quantizers;
+  quantizers.push_back ( new Quantization1DAequiDist0To1 ( numBins ) );
+  quantizers.push_back ( new Quantization1DAequiDist0ToMax ( numBins ) );
+  quantizers.push_back ( new QuantizationNDAequiDist0ToMax ( numBins ) );
+  for ( uint k = 0; k < quantizers.size(); k++ )
+    quantizers[k]->computeParametersFromData ( maxValues );
+
+  // values also cover the clamped ranges below zero and above the upper bounds
+  uint numValues = 5*d;
+  std::vector<double> values ( numValues );
+  std::vector<uint> dims ( numValues );
+  NICE::SparseVector x;
+  for ( uint k = 0; k < numValues; k++ )
+  {
+    values[k] = -0.5 + 3.0 * drand48();
+    dims[k]   = k % d;
+    x.insert ( std::pair<uint, double> ( k, values[k] ) );
+  }
+
+  for ( uint qIdx = 0; qIdx < quantizers.size(); qIdx++ )
+  {
+    const NICE::Quantization * q = quantizers[qIdx];
+
+    // batch of a single dimension
+    std::vector<uint> bins ( numValues );
+    q->quantize ( &(values[0]), d-1, &(bins[0]), numValues );
+    for ( uint k = 0; k < numValues; k++ )
+      CPPUNIT_ASSERT_EQUAL ( q->quantize ( values[k], d-1 ), bins[k] );
+
+    // batch of different dimensions
+    q->quantize ( &(values[0]), &(dims[0]), &(bins[0]), numValues );
+    for ( uint k = 0; k < numValues; k++ )
+      CPPUNIT_ASSERT_EQUAL ( q->quantize ( values[k], dims[k] ), bins[k] );
+
+    // all elements of a sparse vector, elements of dimensions beyond d are skipped
+    std::vector<uint> sparseDims;
+    std::vector<uint> sparseBins;
+    q->quantize ( x, sparseDims, sparseBins, d );
+    CPPUNIT_ASSERT_EQUAL ( d, (uint) sparseDims.size() );
+    CPPUNIT_ASSERT_EQUAL ( d, (uint) sparseBins.size() );
+    for ( uint k = 0; k < sparseDims.size(); k++ )
+    {
+      CPPUNIT_ASSERT ( sparseDims[k] < d );
+      CPPUNIT_ASSERT_EQUAL ( q->quantize ( x[ sparseDims[k] ], sparseDims[k] ), sparseBins[k] );
+    }
+  }
+
+  for ( uint k = 0; k < quantizers.size(); k++ )
+    delete quantizers[k];
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testBatchQuantization done ===================== " << std::endl;
+}
+
 void TestFastHIK::testLUTUpdate()
 {
   if (verboseStartEnd)
@@ -891,4 +1198,1394 @@ void TestFastHIK::testKernelVector()
 
 }
 
+void TestFastHIK::testLogDetApprox()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLogDetApprox ===================== " << std::endl;
+
+  // a diagonal matrix is estimated exactly by every Rademacher probe
+  const uint nDiag = 20;
+  NICE::Matrix D ( nDiag, nDiag, 0.0 );
+  double logdetDiag ( 0.0 );
+  for ( uint i = 0; i < nDiag; i++ )
+  {
+    D(i,i) = 1.0 + i;
+    logdetDiag += log ( D(i,i) );
+  }
+  LogDetApproxStochasticLanczos slqDiag ( 3, nDiag );
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(logdetDiag, slqDiag.getLogDetApproximation ( D ), 1e-8);
+
+  // small HIK kernel matrix with noise
+  const uint nSmall = 200;
+  const uint dSmall = 10;
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dSmall, nSmall, dataMatrix );
+  for ( uint i = 0 ; i < dSmall; i++ )
+  {
+    for ( uint k = 0; k < nSmall; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+
+  double noise = 1.0;
+  FastMinKernel fmk ( dataMatrix, noise );
+  GMHIKernel gmk ( &fmk );
+  gmk.setVerbose(false);
+
+  NICE::Matrix K ( nSmall, nSmall, 0.0 );
+  for ( uint i = 0; i < nSmall; i++ )
+  {
+    for ( uint j = 0; j < nSmall; j++ )
+      for ( uint dim = 0; dim < dSmall; dim++ )
+        K(i,j) += std::min ( dataMatrix[dim][i], dataMatrix[dim][j] );
+    K(i,i) += noise;
+  }
+
+  // exact logdet using the Cholesky decomposition K = L L^T
+  NICE::Matrix L ( nSmall, nSmall, 0.0 );
+  double logdetExact ( 0.0 );
+  for ( uint j = 0; j < nSmall; j++ )
+  {
+    double diag = K(j,j);
+    for ( uint k = 0; k < j; k++ )
+      diag -= L(j,k) * L(j,k);
+    L(j,j) = sqrt ( diag );
+    logdetExact += 2.0 * log ( L(j,j) );
+
+    for ( uint i = j + 1; i < nSmall; i++ )
+    {
+      double sum = K(i,j);
+      for ( uint k = 0; k < j; k++ )
+        sum -= L(i,k) * L(j,k);
+      L(i,j) = sum / L(j,j);
+    }
+  }
+
+  LogDetApproxStochasticLanczos slq ( 100, 15 );
+  double logdetImplicit = slq.getLogDetApproximation ( gmk );
+  double logdetDense = slq.getLogDetApproximation ( K );
+
+  if (verbose)
+    std::cerr << "logdet exact: " << logdetExact << " stochastic Lanczos: " << logdetImplicit << std::endl;
+
+  // implicit and explicit matrix share the probes and lead to the same estimate
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(logdetDense, logdetImplicit, 1e-6 * fabs ( logdetDense ));
+  // the probes are reused, hence, evaluating again gives exactly the same value
+  CPPUNIT_ASSERT_EQUAL(logdetImplicit, slq.getLogDetApproximation ( gmk ));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(logdetExact, logdetImplicit, 0.05 * fabs ( logdetExact ));
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLogDetApprox done ===================== " << std::endl;
+}
+
+void TestFastHIK::testKrylovRecycling()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKrylovRecycling ===================== " << std::endl;
+
+  const uint nSmall = 300;
+  const uint dSmall = 20;
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dSmall, nSmall, dataMatrix );
+  for ( uint i = 0 ; i < dSmall; i++ )
+  {
+    for ( uint k = 0; k < nSmall; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+
+  double noise = 1.0;
+  FastMinKernel fmk ( dataMatrix, noise );
+  GMHIKernel gmk ( &fmk );
+  gmk.setVerbose(false);
+
+  // cold start from an arbitrary subspace
+  const uint k = 3;
+  NICE::Matrix start ( nSmall, k );
+  for ( uint i = 0; i < nSmall; i++ )
+    for ( uint c = 0; c < k; c++ )
+      start(i,c) = 1.0 + sin ( (double)(i*k + c) );
+
+  EVSubspaceIteration subspaceIteration ( 1000, 1e-8 );
+  subspaceIteration.setSubspace ( start );
+  CPPUNIT_ASSERT ( subspaceIteration.hasSubspace ( nSmall, k ) );
+
+  NICE::Vector eigenvalues;
+  NICE::Matrix eigenvectors;
+  uint coldIterations = subspaceIteration.getEigenvalues ( gmk, eigenvalues, eigenvectors );
+
+  CPPUNIT_ASSERT_EQUAL ( k, (uint) eigenvalues.size() );
+  for ( uint c = 0; c < k; c++ )
+  {
+    NICE::Vector w ( nSmall );
+    for ( uint i = 0; i < nSmall; i++ )
+      w[i] = eigenvectors(i,c);
+    NICE::Vector Aw;
+    gmk.multiply ( Aw, w );
+
+    double residual ( 0.0 );
+    for ( uint i = 0; i < nSmall; i++ )
+    {
+      residual += ( Aw[i] - eigenvalues[c] * w[i] ) * ( Aw[i] - eigenvalues[c] * w[i] );
+      // the stored products are A times the Ritz vectors
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(Aw[i], subspaceIteration.getProducts()(i,c), 1e-8);
+    }
+    CPPUNIT_ASSERT ( sqrt ( residual ) <= 1e-6 * eigenvalues[0] );
+    if ( c > 0 )
+      CPPUNIT_ASSERT ( eigenvalues[c-1] >= eigenvalues[c] );
+  }
+
+  // more noise only shifts the eigenvalues, the warm start is already converged
+  FastMinKernel fmkNoisy ( dataMatrix, noise + 0.5 );
+  GMHIKernel gmkNoisy ( &fmkNoisy );
+  gmkNoisy.setVerbose(false);
+
+  NICE::Vector eigenvaluesNoisy;
+  NICE::Matrix eigenvectorsNoisy;
+  uint warmIterations = subspaceIteration.getEigenvalues ( gmkNoisy, eigenvaluesNoisy, eigenvectorsNoisy );
+  if (verbose)
+    std::cerr << "subspace iterations cold: " << coldIterations << " warm: " << warmIterations << std::endl;
+  CPPUNIT_ASSERT_EQUAL ( (uint) 1, warmIterations );
+  for ( uint c = 0; c < k; c++ )
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(eigenvalues[c] + 0.5, eigenvaluesNoisy[c], 1e-6 * eigenvalues[0]);
+
+  // deflated block CG has to find the same solutions
+  const uint m = 4;
+  NICE::Matrix Y ( nSmall, m );
+  for ( uint i = 0; i < nSmall; i++ )
+    for ( uint c = 0; c < m; c++ )
+      Y(i,c) = sin( (double)(i*m + c) );
+
+  ILSBlockConjugateGradients blockSolver ( false, solveLinMaxIterations, 1e-10, 1e-10 );
+  NICE::Matrix X;
+  int plainIterations = blockSolver.solveLin ( gmkNoisy, Y, X );
+
+  blockSolver.setDeflationSubspace ( subspaceIteration.getEigenvectors(), subspaceIteration.getProducts() );
+  NICE::Matrix XDeflated;
+  int deflatedIterations = blockSolver.solveLin ( gmkNoisy, Y, XDeflated );
+  blockSolver.clearDeflationSubspace();
+
+  if (verbose)
+    std::cerr << "block CG iterations plain: " << plainIterations << " deflated: " << deflatedIterations << std::endl;
+
+  CPPUNIT_ASSERT ( deflatedIterations <= plainIterations );
+  for ( uint c = 0; c < m; c++ )
+  {
+    double err ( 0.0 );
+    for ( uint i = 0; i < nSmall; i++ )
+      err += fabs ( X(i,c) - XDeflated(i,c) );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(err, 0.0, 1e-5);
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKrylovRecycling done ===================== " << std::endl;
+}
+
+void TestFastHIK::testLazyTransform()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLazyTransform ===================== " << std::endl;
+
+  const uint nSmall = 200;
+  const uint dSmall = 15;
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dSmall, nSmall, dataMatrix );
+  for ( uint i = 0 ; i < dSmall; i++ )
+  {
+    for ( uint k = 0; k < nSmall; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+
+  double noise = 1.0;
+  FastMinKernel fmkEager ( dataMatrix, noise );
+  FastMinKernel fmkLazy ( dataMatrix, noise );
+
+  Quantization * q = new Quantization1DAequiDist0To1 ( numBins );
+
+  PFAbsExp pfEager ( 1.0 );
+  PFAbsExp pfLazy ( 1.0 );
+  GMHIKernel gmkEager ( &fmkEager, &pfEager );
+  GMHIKernel gmkLazy ( &fmkLazy, &pfLazy );
+  gmkLazy.setLazyTransform ( true );
+
+  PFAbsExp pfEagerFast ( 1.0 );
+  PFAbsExp pfLazyFast ( 1.0 );
+  GMHIKernel gmkEagerFast ( &fmkEager, &pfEagerFast, q );
+  GMHIKernel gmkLazyFast ( &fmkLazy, &pfLazyFast, q );
+  gmkLazyFast.setLazyTransform ( true );
+
+  NICE::Vector alpha ( nSmall );
+  for ( uint i = 0; i < nSmall; i++ )
+    alpha[i] = drand48() - 0.5;
+
+  const uint m = 3;
+  NICE::Matrix alphas ( nSmall, m );
+  for ( uint i = 0; i < nSmall; i++ )
+    for ( uint c = 0; c < m; c++ )
+      alphas(i,c) = drand48() - 0.5;
+
+  double exponents[] = { 0.5, 1.7 };
+  for ( uint e = 0; e < 2; e++ )
+  {
+    NICE::Vector parameters ( 1, exponents[e] );
+    gmkEager.setParameters ( parameters );
+    gmkLazy.setParameters ( parameters );
+
+    NICE::Vector betaEager;
+    NICE::Vector betaLazy;
+    gmkEager.multiply ( betaEager, alpha );
+    gmkLazy.multiply ( betaLazy, alpha );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, ( betaEager - betaLazy ).normL1(), 1e-8 );
+
+    NICE::Matrix blockEager;
+    NICE::Matrix blockLazy;
+    gmkEager.multiplyBlock ( blockEager, alphas );
+    gmkLazy.multiplyBlock ( blockLazy, alphas );
+    for ( uint i = 0; i < nSmall; i++ )
+      for ( uint c = 0; c < m; c++ )
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( blockEager(i,c), blockLazy(i,c), 1e-8 );
+
+    NICE::Vector diagonalEager;
+    NICE::Vector diagonalLazy;
+    gmkEager.getDiagonalElements ( diagonalEager );
+    gmkLazy.getDiagonalElements ( diagonalLazy );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, ( diagonalEager - diagonalLazy ).normL1(), 1e-8 );
+
+    // quantized multiplication, the stored features of fmkEager are already transformed
+    pfEagerFast.parameters() = parameters;
+    gmkLazyFast.setParameters ( parameters );
+    gmkEagerFast.multiply ( betaEager, alpha );
+    gmkLazyFast.multiply ( betaLazy, alpha );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, ( betaEager - betaLazy ).normL1(), 1e-8 );
+  }
+
+  // the lazy kernels did not touch the stored features
+  for ( uint dim = 0; dim < dSmall; dim++ )
+  {
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = fmkLazy.featureMatrix().getFeatureValues(dim).nonzeroElements();
+    for ( uint i = 0; i < nonzeroElements.size(); i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( nonzeroElements.getValues()[i], nonzeroElements.getTransformedValues()[i], 1e-12 );
+  }
+
+  // switching the lazy mode off transforms the stored features with the current parameters
+  gmkLazy.setLazyTransform ( false );
+  for ( uint dim = 0; dim < dSmall; dim++ )
+  {
+    const SortedVectorSparse<double>::elementcontainer & nonzeroElements = fmkLazy.featureMatrix().getFeatureValues(dim).nonzeroElements();
+    for ( uint i = 0; i < nonzeroElements.size(); i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( pfLazy.f ( dim, nonzeroElements.getValues()[i] ), nonzeroElements.getTransformedValues()[i], 1e-12 );
+  }
+
+  delete q;
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLazyTransform done ===================== " << std::endl;
+}
+
+void TestFastHIK::testBatchTransform()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testBatchTransform ===================== " << std::endl;
+
+  // sorted values with runs of equal values, as found in the dimensions of the feature matrix
+  const uint nValues = 200;
+  std::vector<double> values;
+  for ( uint i = 0; i < nValues; i++ )
+    values.push_back ( floor ( 20.0 * drand48() ) / 20.0 );
+  std::sort ( values.begin(), values.end() );
+
+  const uint nDims = 4;
+  std::vector<uint> dims;
+  for ( uint i = 0; i < nValues; i++ )
+    dims.push_back ( i % nDims );
+
+  std::set<int> steps;
+  steps.insert ( 2 );
+  steps.insert ( nDims );
+
+  std::vector<ParameterizedFunction *> functions;
+  // exponents with and without a special case
+  functions.push_back ( new PFAbsExp ( 1.0 ) );
+  functions.push_back ( new PFAbsExp ( 2.0 ) );
+  functions.push_back ( new PFAbsExp ( 0.5 ) );
+  functions.push_back ( new PFAbsExp ( 1.3 ) );
+  functions.push_back ( new PFExp ( 2.5 ) );
+  functions.push_back ( new PFIdentity ( ) );
+  PFWeightedDim *pfWeightedDim = new PFWeightedDim ( nDims );
+  for ( uint dim = 0; dim < nDims; dim++ )
+    pfWeightedDim->parameters()[dim] = 0.5 + dim;
+  functions.push_back ( pfWeightedDim );
+  PFMKL *pfMKL = new PFMKL ( steps );
+  pfMKL->parameters()[1] = 0.3;
+  functions.push_back ( pfMKL );
+
+  std::vector<double> batch ( nValues );
+  for ( uint f = 0; f < functions.size(); f++ )
+  {
+    // values of a single dimension
+    functions[f]->f ( 1, &(values[0]), &(batch[0]), nValues );
+    for ( uint i = 0; i < nValues; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( functions[f]->f ( 1, values[i] ), batch[i], 1e-12 );
+
+    // in-place
+    batch = values;
+    functions[f]->f ( 3, &(batch[0]), &(batch[0]), nValues );
+    for ( uint i = 0; i < nValues; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( functions[f]->f ( 3, values[i] ), batch[i], 1e-12 );
+
+    // values of different dimensions
+    functions[f]->fPerDimension ( &(dims[0]), &(values[0]), &(batch[0]), nValues );
+    for ( uint i = 0; i < nValues; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( functions[f]->f ( dims[i], values[i] ), batch[i], 1e-12 );
+
+    // dense vector
+    functions[f]->fPerDimension ( NULL, &(values[0]), &(batch[0]), nDims );
+    for ( uint i = 0; i < nDims; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( functions[f]->f ( i, values[i] ), batch[i], 1e-12 );
+
+    delete functions[f];
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testBatchTransform done ===================== " << std::endl;
+}
+
+/** sum_c w_c U(:,c)^T (K + noise I) V(:,c) computed with block multiplications */
+static double bilinearForms ( const NICE::ImplicitKernelMatrix & _ikm,
+                              const NICE::Matrix & _U,
+                              const NICE::Matrix & _V,
+                              const NICE::Vector & _weights
+                            )
+{
+  NICE::Matrix KV;
+  _ikm.multiplyBlock ( KV, _V );
+  double sum ( 0.0 );
+  for ( uint c = 0; c < _U.cols(); c++ )
+    for ( uint i = 0; i < _U.rows(); i++ )
+      sum += _weights[c] * _U(i,c) * KV(i,c);
+  return sum;
+}
+
+void TestFastHIK::testParameterGradient()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testParameterGradient ===================== " << std::endl;
+
+  const uint nSmall = 60;
+  const uint dSmall = 8;
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dSmall, nSmall, dataMatrix );
+  for ( uint i = 0 ; i < dSmall; i++ )
+  {
+    for ( uint k = 0; k < nSmall; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+  // ties between examples
+  dataMatrix[0][1] = dataMatrix[0][2];
+
+  const uint m = 4;
+  NICE::Matrix U ( nSmall, m );
+  NICE::Matrix V ( nSmall, m );
+  NICE::Vector weights ( m );
+  for ( uint c = 0; c < m; c++ )
+  {
+    for ( uint i = 0; i < nSmall; i++ )
+    {
+      U(i,c) = drand48() - 0.5;
+      V(i,c) = drand48() - 0.5;
+    }
+    weights[c] = drand48() - 0.5;
+  }
+
+  std::set<int> steps;
+  steps.insert ( 3 );
+  steps.insert ( dSmall );
+
+  std::vector<NICE::ParameterizedFunction *> functions;
+  functions.push_back ( new PFAbsExp ( 1.3 ) );
+  functions.push_back ( new PFExp ( 2.0 ) );
+  functions.push_back ( new PFWeightedDim ( dSmall ) );
+  functions.push_back ( new PFMKL ( steps ) );
+  for ( uint k = 0; k < dSmall; k++ )
+    functions[2]->parameters()[k] = 0.5 + drand48();
+  functions[3]->parameters()[0] = 0.7;
+  functions[3]->parameters()[1] = 1.4;
+
+  const double h = 1e-5;
+  for ( uint f = 0; f < functions.size(); f++ )
+  {
+    FastMinKernel fmk ( dataMatrix, 0.5 );
+    GMHIKernel gmk ( &fmk, functions[f] );
+    NICE::Vector parameters ( functions[f]->parameters() );
+    gmk.setParameters ( parameters );
+
+    NICE::Vector gradient;
+    CPPUNIT_ASSERT( gmk.getBilinearFormGradient ( U, V, weights, gradient ) );
+    CPPUNIT_ASSERT_EQUAL( parameters.size(), gradient.size() );
+
+    // central differences
+    for ( uint k = 0; k < parameters.size(); k++ )
+    {
+      NICE::Vector shifted ( parameters );
+      shifted[k] = parameters[k] + h;
+      gmk.setParameters ( shifted );
+      double valuePlus = bilinearForms ( gmk, U, V, weights );
+      shifted[k] = parameters[k] - h;
+      gmk.setParameters ( shifted );
+      double valueMinus = bilinearForms ( gmk, U, V, weights );
+      gmk.setParameters ( parameters );
+
+      double numerical = ( valuePlus - valueMinus ) / ( 2.0 * h );
+      if ( verbose )
+        std::cerr << functions[f]->sayYourName() << " parameter " << k << ": analytic " << gradient[k] << " numerical " << numerical << std::endl;
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( numerical, gradient[k], 1e-5 * std::max ( 1.0, fabs ( numerical ) ) );
+    }
+
+    // the lazy mode does not change the gradient
+    gmk.setLazyTransform ( true );
+    NICE::Vector gradientLazy;
+    CPPUNIT_ASSERT( gmk.getBilinearFormGradient ( U, V, weights, gradientLazy ) );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, ( gradient - gradientLazy ).normL1(), 1e-10 );
+    gmk.setLazyTransform ( false );
+
+    delete functions[f];
+  }
+
+  // noise matrix, parametrized by log(noise)
+  IKMNoise noiseMatrix ( nSmall, 0.3, true );
+  NICE::Vector noiseGradient;
+  CPPUNIT_ASSERT( noiseMatrix.getBilinearFormGradient ( U, V, weights, noiseGradient ) );
+  NICE::Vector logNoise;
+  noiseMatrix.getParameters ( logNoise );
+  NICE::Vector shifted ( logNoise );
+  shifted[0] = logNoise[0] + h;
+  noiseMatrix.setParameters ( shifted );
+  double valuePlus = bilinearForms ( noiseMatrix, U, V, weights );
+  shifted[0] = logNoise[0] - h;
+  noiseMatrix.setParameters ( shifted );
+  double valueMinus = bilinearForms ( noiseMatrix, U, V, weights );
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( ( valuePlus - valueMinus ) / ( 2.0 * h ), noiseGradient[0], 1e-6 );
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testParameterGradient done ===================== " << std::endl;
+}
+
+namespace {
+
+// scaled Rosenbrock function plus a separable quadratic in the remaining variables
+class TestObjective : public NICE::DifferentiableFunction
+{
+  public:
+    NICE::Vector center;
+
+    virtual double evaluate ( const NICE::Vector & _x, NICE::Vector & _gradient )
+    {
+      _gradient.resize ( _x.size() );
+      double a = 1.0 - _x[0];
+      double b = _x[1] - _x[0] * _x[0];
+      double value = a * a + 10.0 * b * b;
+      _gradient[0] = -2.0 * a - 40.0 * b * _x[0];
+      _gradient[1] = 20.0 * b;
+      for ( uint i = 2; i < _x.size(); i++ )
+      {
+        double diff = _x[i] - this->center[i];
+        value += i * diff * diff;
+        _gradient[i] = 2.0 * i * diff;
+      }
+      return value;
+    };
+};
+
+} // namespace
+
+void TestFastHIK::testBoundedLBFGS()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testBoundedLBFGS ===================== " << std::endl;
+
+  const uint dim = 8;
+  TestObjective objective;
+  objective.center.resize ( dim );
+  NICE::Vector lowerBounds ( dim, -2.0 );
+  NICE::Vector upperBounds ( dim, 2.0 );
+  for ( uint i = 2; i < dim; i++ )
+    objective.center[i] = 4.0 * ( drand48() - 0.5 );
+
+  BoundedLBFGS optimizer ( 200, 5, 1e-8, 0.0 );
+
+  NICE::Vector x ( dim, 0.0 );
+  double value;
+  optimizer.minimize ( objective, x, lowerBounds, upperBounds, value );
+  if ( verbose )
+    std::cerr << "BoundedLBFGS: " << optimizer.getNumberOfEvaluations() << " evaluations, solution " << x << std::endl;
+
+  // interior solution
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, x[0], 1e-4 );
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, x[1], 1e-4 );
+  for ( uint i = 2; i < dim; i++ )
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( objective.center[i], x[i], 1e-4 );
+
+  // active bounds: the solution is the projection of the unconstrained one
+  for ( uint i = 0; i < dim; i++ )
+  {
+    lowerBounds[i] = ( i % 2 == 0 ) ? -2.0 : 0.5;
+    upperBounds[i] = ( i % 2 == 0 ) ? 0.5 : 2.0;
+  }
+  x.set ( 0.0 );
+  optimizer.minimize ( objective, x, lowerBounds, upperBounds, value );
+  if ( verbose )
+    std::cerr << "BoundedLBFGS: " << optimizer.getNumberOfEvaluations() << " evaluations, solution " << x << std::endl;
+
+  // x_0 is at its upper bound, x_1 = x_0^2 is below its lower bound
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, x[0], 1e-6 );
+  CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, x[1], 1e-6 );
+  for ( uint i = 2; i < dim; i++ )
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( std::min ( std::max ( objective.center[i], lowerBounds[i] ), upperBounds[i] ), x[i], 1e-4 );
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testBoundedLBFGS done ===================== " << std::endl;
+}
+
+
+void TestFastHIK::testIncrementalAlphaUpdate()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testIncrementalAlphaUpdate ===================== " << std::endl;
+
+  NICE::Quantization * q = new Quantization1DAequiDist0To1 ( numBins );
+
+  // data is generated, such that there is no approximation error
+  std::vector< std::vector<double> > dataMatrix;
+  for ( uint i = 0; i < d ; i++ )
+  {
+    std::vector<double> v;
+    v.resize(n);
+    for ( uint k = 0; k < n; k++ ) {
+      if ( drand48() < sparse_prob ) {
+        v[k] = 0;
+      } else {
+        v[k] = q->getPrototype( (rand() % numBins) );
+      }
+    }
+
+    dataMatrix.push_back(v);
+  }
+
+  double noise = 1.0;
+  NICE::FastMinKernel fmk ( dataMatrix, noise );
+
+  NICE::Vector alpha ( n );
+  for ( uint i = 0; i < alpha.size(); i++ )
+    alpha[i] = sin(i);
+
+  NICE::VVector A;
+  NICE::VVector B;
+  fmk.hik_prepare_alpha_multiplications ( alpha, A, B );
+  double * T = fmk.hik_prepare_alpha_multiplications_fast ( A, B, q, NULL );
+
+  // two new examples
+  uint numNew ( 2 );
+  for ( uint k = 0; k < numNew; k++ )
+  {
+    NICE::SparseVector example ( d );
+    for ( uint i = 0; i < d; i++ )
+      if ( drand48() >= sparse_prob )
+        example[i] = q->getPrototype( (rand() % numBins) );
+    fmk.addExample ( &example );
+  }
+  fmk.prepareBinIndices ( q );
+
+  // (1) a few changes, the changed examples are located in every dimension
+  NICE::Vector diffOfAlpha ( n + numNew, 0.0 );
+  diffOfAlpha[2]     = 0.5;
+  diffOfAlpha[n/2]   = -0.3;
+  diffOfAlpha[n]     = 1.2;
+  diffOfAlpha[n+1]   = -0.7;
+  std::vector<uint> changedExamples;
+  for ( uint i = 0; i < diffOfAlpha.size(); i++ )
+    if ( diffOfAlpha[i] != 0.0 )
+      changedExamples.push_back ( i );
+
+  NICE::Vector alphaNew ( n + numNew, 0.0 );
+  for ( uint i = 0; i < alphaNew.size(); i++ )
+    alphaNew[i] = ( ( i < n ) ? alpha[i] : 0.0 ) + diffOfAlpha[i];
+
+  fmk.hik_update_alpha_multiplications ( diffOfAlpha, changedExamples, n, A, B );
+  fmk.hikUpdateLookupTable ( T, diffOfAlpha, changedExamples, q, NULL );
+
+  NICE::VVector ANew;
+  NICE::VVector BNew;
+  fmk.hik_prepare_alpha_multiplications ( alphaNew, ANew, BNew );
+  double * TNew = fmk.hik_prepare_alpha_multiplications_fast ( ANew, BNew, q, NULL );
+
+  CPPUNIT_ASSERT( compareVVector ( A, ANew ) );
+  CPPUNIT_ASSERT( compareVVector ( B, BNew ) );
+  CPPUNIT_ASSERT( compareLUTs ( T, TNew, q->getNumberOfBins()*d ) );
+
+  // (2) all alpha values change, every dimension is swept completely
+  changedExamples.clear();
+  for ( uint i = 0; i < diffOfAlpha.size(); i++ )
+  {
+    diffOfAlpha[i] = 0.1 * cos(i);
+    alphaNew[i] += diffOfAlpha[i];
+    changedExamples.push_back ( i );
+  }
+
+  fmk.hik_update_alpha_multiplications ( diffOfAlpha, changedExamples, n + numNew, A, B );
+  fmk.hik_prepare_alpha_multiplications ( alphaNew, ANew, BNew );
+
+  CPPUNIT_ASSERT( compareVVector ( A, ANew ) );
+  CPPUNIT_ASSERT( compareVVector ( B, BNew ) );
+
+  // clean-up
+  delete q;
+  delete [] T;
+  delete [] TNew;
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testIncrementalAlphaUpdate done ===================== " << std::endl;
+}
+
+void TestFastHIK::testKernelVectorsBatch()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKernelVectorsBatch ===================== " << std::endl;
+
+  std::vector< std::vector<double> > dataMatrix;
+  generateRandomFeatures ( d, n, dataMatrix );
+  // sparse training data
+  for ( uint i = 0; i < d; i++ )
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+
+  double noise = 1.0;
+  NICE::FastMinKernel fmk ( dataMatrix, noise );
+
+  // sparse test examples, some of them with values equal to training values
+  uint numTestExamples ( 37 );
+  std::vector< NICE::SparseVector > testExamples ( numTestExamples );
+  std::vector< const NICE::SparseVector * > testExamplePointers;
+  for ( uint j = 0; j < numTestExamples; j++ )
+  {
+    for ( uint i = 0; i < d; i++ )
+      if ( drand48() >= sparse_prob )
+        testExamples[j].insert ( std::pair<uint, double> ( i, ( j % 5 == 0 ) ? dataMatrix[i][j] : drand48() ) );
+    testExamplePointers.push_back ( &(testExamples[j]) );
+  }
+
+  NICE::Matrix kStars;
+  fmk.hikComputeKernelVectors ( testExamplePointers, kStars );
+
+  CPPUNIT_ASSERT_EQUAL ( n, (uint) kStars.rows() );
+  CPPUNIT_ASSERT_EQUAL ( numTestExamples, (uint) kStars.cols() );
+
+  for ( uint j = 0; j < numTestExamples; j++ )
+  {
+    NICE::Vector kStar;
+    fmk.hikComputeKernelVector ( testExamples[j], kStar );
+    for ( uint i = 0; i < n; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( kStar[i], kStars ( i, j ), 1e-10 );
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKernelVectorsBatch done ===================== " << std::endl;
+}
+
+void TestFastHIK::testEigenVectorProjection()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testEigenVectorProjection ===================== " << std::endl;
+
+  std::vector< std::vector<double> > dataMatrix;
+  generateRandomFeatures ( d, n, dataMatrix );
+  for ( uint i = 0; i < d; i++ )
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+
+  double noise = 1.0;
+  NICE::FastMinKernel fmk ( dataMatrix, noise );
+
+  // a vector with entries of both signs, like an eigenvector of the kernel matrix
+  NICE::Vector eigenVector ( n );
+  for ( uint k = 0; k < n; k++ )
+    eigenVector[k] = drand48() - 0.5;
+
+  // tables of the approximate-fine variance are computed with the original feature values
+  NICE::PFIdentity originalValues;
+  NICE::VVector A;
+  NICE::VVector B;
+  fmk.hik_prepare_alpha_multiplications ( eigenVector, A, B, &originalValues );
+
+  for ( uint j = 0; j < 20; j++ )
+  {
+    NICE::SparseVector xstar;
+    for ( uint i = 0; i < d; i++ )
+      if ( drand48() >= sparse_prob )
+        xstar.insert ( std::pair<uint, double> ( i, ( j % 5 == 0 ) ? dataMatrix[i][j] : drand48() ) );
+
+    NICE::Vector kStar;
+    fmk.hikComputeKernelVector ( xstar, kStar );
+
+    double projection ( 0.0 );
+    fmk.hik_kernel_sum ( A, B, xstar, projection );
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL ( kStar.scalarProduct ( eigenVector ), projection, 1e-8 );
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testEigenVectorProjection done ===================== " << std::endl;
+}
+
+void TestFastHIK::testLUTUpdatePrototypeCache()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLUTUpdatePrototypeCache ===================== " << std::endl;
+
+  std::vector< std::vector<double> > dataMatrix;
+  generateRandomFeatures ( d, n, dataMatrix );
+  for ( uint i = 0; i < d; i++ )
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+
+  double noise = 1.0;
+  NICE::FastMinKernel fmk ( dataMatrix, noise );
+
+  NICE::Vector alpha ( n );
+  for ( uint i = 0; i < n; i++ )
+    alpha[i] = sin(i);
+
+  // the prototypes kept between updates have to follow the upper bounds of the quantization
+  NICE::Quantization * q = new Quantization1DAequiDist0ToMax ( numBins );
+  double upperBounds[2] = { 1.0, 0.5 };
+  for ( uint run = 0; run < 2; run++ )
+  {
+    q->computeParametersFromData ( NICE::Vector ( 1, upperBounds[run] ) );
+
+    uint idx ( 2 + run );
+    NICE::Vector alphaNew ( alpha );
+    alphaNew[idx] = 1.2;
+
+    double * T    = fmk.hikPrepareLookupTable ( alpha, q, NULL );
+    double * TNew = fmk.hikPrepareLookupTable ( alphaNew, q, NULL );
+    fmk.hikUpdateLookupTable ( T, alphaNew[idx], alpha[idx], idx, q, NULL );
+
+    for ( uint i = 0; i < q->getNumberOfBins()*d; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( TNew[i], T[i], 1e-8 );
+
+    delete [] T;
+    delete [] TNew;
+  }
+  delete q;
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLUTUpdatePrototypeCache done ===================== " << std::endl;
+}
+
+void TestFastHIK::testLUTUpdateTransformedFeatures()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLUTUpdateTransformedFeatures ===================== " << std::endl;
+
+  std::vector< std::vector<double> > dataMatrix;
+  generateRandomFeatures ( d, n, dataMatrix );
+  for ( uint i = 0; i < d; i++ )
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+
+  // the bins refer to the original values, which differ from the transformed ones for exponents other than 1
+  double noise = 1.0;
+  NICE::FastMinKernel fmk ( dataMatrix, noise );
+  NICE::PFAbsExp pf ( 2.0 );
+  fmk.applyFunctionToFeatureMatrix ( &pf );
+
+  NICE::Quantization * q = new Quantization1DAequiDist0ToMax ( numBins );
+  q->computeParametersFromData ( fmk.featureMatrix().getLargestValuePerDimension() );
+
+  NICE::Vector alpha ( n );
+  for ( uint i = 0; i < n; i++ )
+    alpha[i] = sin(i);
+
+  NICE::Vector alphaNew ( alpha );
+  std::vector<uint> changed;
+  for ( uint i = 0; i < n; i += 3 )
+  {
+    alphaNew[i] = cos(i);
+    changed.push_back ( i );
+  }
+
+  double * TNew = fmk.hikPrepareLookupTable ( alphaNew, q, &pf );
+
+  // the row-wise access with and without the example mirror
+  for ( uint run = 0; run < 2; run++ )
+  {
+    fmk.featureMatrix().setKeepExampleMirror ( run == 1 );
+
+    // single example
+    double * T = fmk.hikPrepareLookupTable ( alpha, q, &pf );
+    fmk.hikUpdateLookupTable ( T, alphaNew[0], alpha[0], 0, q, &pf );
+    NICE::Vector alphaSingle ( alpha );
+    alphaSingle[0] = alphaNew[0];
+    double * TSingle = fmk.hikPrepareLookupTable ( alphaSingle, q, &pf );
+    for ( uint i = 0; i < q->getNumberOfBins()*d; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( TSingle[i], T[i], 1e-8 );
+    delete [] T;
+    delete [] TSingle;
+
+    // several examples
+    T = fmk.hikPrepareLookupTable ( alpha, q, &pf );
+    fmk.hikUpdateLookupTable ( T, alphaNew - alpha, changed, q, &pf );
+    for ( uint i = 0; i < q->getNumberOfBins()*d; i++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( TNew[i], T[i], 1e-8 );
+    delete [] T;
+  }
+
+  delete [] TNew;
+  delete q;
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testLUTUpdateTransformedFeatures done ===================== " << std::endl;
+}
+
+void TestFastHIK::testRawClassifierSingleExamples()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testRawClassifierSingleExamples ===================== " << std::endl;
+
+  const uint nTrain = 100;
+  const uint dTrain = 10;
+  const uint nTest = 20;
+
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dTrain, nTrain + nTest, dataMatrix );
+
+  // the test examples additionally have values in dimensions unknown during training
+  std::vector< NICE::SparseVector > examples ( nTrain + nTest );
+  for ( uint k = 0; k < nTrain + nTest; k++ )
+  {
+    examples[k].setDim ( ( k < nTrain ) ? dTrain : dTrain + 3 );
+    for ( uint i = 0; i < dTrain; i++ )
+      if ( drand48() >= 0.3 )
+        examples[k].insert ( std::pair<uint, double> ( i, dataMatrix[i][k] ) );
+    if ( k >= nTrain )
+      examples[k].insert ( std::pair<uint, double> ( dTrain + k % 3, 0.5 ) );
+  }
+
+  std::vector< const NICE::SparseVector * > examplesTrain;
+  std::vector< const NICE::SparseVector * > examplesTest;
+  for ( uint k = 0; k < nTrain + nTest; k++ )
+  {
+    if ( k < nTrain )
+      examplesTrain.push_back ( &(examples[k]) );
+    else
+      examplesTest.push_back ( &(examples[k]) );
+  }
+
+  // every kind of lookup table: A and B, A and B with reduced precision, T, packed T, T with reduced precision
+  const int numSettings = 5;
+  const bool useQuantization[numSettings] = { false, false, true, true, true };
+  const bool usePackedLUT[numSettings]    = { false, false, false, true, false };
+  const char * lutPrecision[numSettings]  = { "double", "int16", "double", "double", "float" };
+
+  for ( uint numClasses = 2; numClasses <= 3; numClasses++ )
+  {
+    NICE::Vector labels ( nTrain );
+    for ( uint k = 0; k < nTrain; k++ )
+      labels[k] = k % numClasses;
+
+    for ( int setting = 0; setting < numSettings; setting++ )
+    {
+      NICE::Config conf;
+      conf.sB ( "GPHIKRawClassifier", "use_quantization", useQuantization[setting] );
+      conf.sB ( "GPHIKRawClassifier", "use_packed_lut", usePackedLUT[setting] );
+      conf.sS ( "GPHIKRawClassifier", "lut_precision", lutPrecision[setting] );
+      NICE::GPHIKRawClassifier classifier ( &conf );
+      classifier.train ( examplesTrain, labels );
+
+      NICE::Vector results;
+      NICE::Matrix scores;
+      classifier.classify ( examplesTest, results, scores );
+
+      // single examples are classified as a block of size one and yield exactly the same scores
+      for ( uint i = 0; i < nTest; i++ )
+      {
+        uint result;
+        NICE::Vector scoresSingle;
+        classifier.classify ( examplesTest[i], result, scoresSingle );
+        CPPUNIT_ASSERT_EQUAL ( results[i], (double) result );
+        CPPUNIT_ASSERT_EQUAL ( (size_t) scores.cols(), (size_t) scoresSingle.size() );
+        for ( uint j = 0; j < scores.cols(); j++ )
+          CPPUNIT_ASSERT_EQUAL ( scores(i,j), scoresSingle[j] );
+
+        uint resultSparse;
+        NICE::SparseVector scoresSparse;
+        classifier.classify ( examplesTest[i], resultSparse, scoresSparse );
+        CPPUNIT_ASSERT_EQUAL ( result, resultSparse );
+        CPPUNIT_ASSERT_EQUAL ( (size_t) numClasses, (size_t) scoresSparse.size() );
+        for ( NICE::SparseVector::const_iterator it = scoresSparse.begin(); it != scoresSparse.end(); it++ )
+          CPPUNIT_ASSERT_EQUAL ( scores(i,it->first), it->second );
+      }
+    }
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testRawClassifierSingleExamples done ===================== " << std::endl;
+}
+
+/**
+* @brief gives access to the transformation, which holds the best parameters of the likelihood after the optimization,
+* and to the tables of the fine variance approximation
+*/
+class FMKGPWithTransformation : public NICE::FMKGPHyperparameterOptimization
+{
+  public:
+    FMKGPWithTransformation ( const NICE::Config * _conf ) : FMKGPHyperparameterOptimization ( _conf ) {};
+
+    void setTransformation ( NICE::ParameterizedFunction * _pf )
+    {
+      if ( this->pf != NULL )
+        delete this->pf;
+      this->pf = _pf;
+    }
+
+    const NICE::Vector & getBestParameters () const { return this->pf->parameters(); }
+
+    using FMKGPHyperparameterOptimization::clearVarianceApproximationFineTables;
+    using FMKGPHyperparameterOptimization::hasVarianceApproximationFineTables;
+};
+
+void TestFastHIK::testVarianceApproximationFineTables()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testVarianceApproximationFineTables ===================== " << std::endl;
+
+  const uint nTrain = 100;
+  const uint dTrain = 15;
+  const uint nTest = 20;
+
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dTrain, nTrain + nTest, dataMatrix );
+
+  std::vector< NICE::SparseVector > examples ( nTrain + nTest );
+  std::vector< NICE::Vector > examplesDense ( nTrain + nTest );
+  for ( uint k = 0; k < nTrain + nTest; k++ )
+  {
+    examples[k].setDim ( dTrain );
+    examplesDense[k].resize ( dTrain );
+    examplesDense[k].set ( 0.0 );
+    for ( uint i = 0; i < dTrain; i++ )
+      if ( drand48() >= sparse_prob )
+      {
+        examples[k].insert ( std::pair<uint, double> ( i, dataMatrix[i][k] ) );
+        examplesDense[k][i] = dataMatrix[i][k];
+      }
+  }
+
+  std::vector< const NICE::SparseVector * > examplesTrain;
+  std::vector< const NICE::SparseVector * > examplesTest;
+  for ( uint k = 0; k < nTrain + nTest; k++ )
+  {
+    if ( k < nTrain )
+      examplesTrain.push_back ( &(examples[k]) );
+    else
+      examplesTest.push_back ( &(examples[k]) );
+  }
+
+  NICE::Vector labels ( nTrain );
+  for ( uint k = 0; k < nTrain; k++ )
+    labels[k] = k % 2;
+
+  for ( int quantization = 0; quantization <= 1; quantization++ )
+  {
+    // the tables are computed with the original feature values, although the kernel uses a non-identity transformation
+    NICE::Config conf;
+    conf.sS ( "FMKGPHyperparameterOptimization", "optimization_method", "greedy" );
+    conf.sD ( "FMKGPHyperparameterOptimization", "parameter_lower_bound", 1.5 );
+    conf.sD ( "FMKGPHyperparameterOptimization", "parameter_upper_bound", 1.5 );
+    conf.sI ( "FMKGPHyperparameterOptimization", "nrOfEigenvaluesToConsiderForVarApprox", 4 );
+    conf.sB ( "FMKGPHyperparameterOptimization", "use_quantization", quantization == 1 );
+    conf.sI ( "FMKGPHyperparameterOptimization", "num_bins", 1001 );
+
+    FMKGPWithTransformation gphyper ( &conf );
+    gphyper.setFastMinKernel ( new FastMinKernel ( examplesTrain, 0.1 ) );
+    gphyper.optimize ( labels );
+    CPPUNIT_ASSERT_EQUAL ( 1.5, gphyper.getBestParameters()[0] );
+
+    // variances with the tables of the projections onto the eigenvectors
+    gphyper.prepareVarianceApproximationFine();
+    CPPUNIT_ASSERT ( gphyper.hasVarianceApproximationFineTables() );
+
+    NICE::Vector varianceSparse ( nTest );
+    NICE::Vector varianceDense ( nTest );
+    NICE::Vector varianceBatch;
+    for ( uint k = 0; k < nTest; k++ )
+    {
+      gphyper.computePredictiveVarianceApproximateFine ( *(examplesTest[k]), varianceSparse[k] );
+      gphyper.computePredictiveVarianceApproximateFine ( examplesDense[nTrain + k], varianceDense[k] );
+    }
+    gphyper.computePredictiveVarianceApproximateFine ( examplesTest, varianceBatch );
+
+    // variances with the explicit kernel vectors
+    gphyper.clearVarianceApproximationFineTables();
+    CPPUNIT_ASSERT ( !gphyper.hasVarianceApproximationFineTables() );
+
+    NICE::Vector varianceBatchWithoutTables;
+    gphyper.computePredictiveVarianceApproximateFine ( examplesTest, varianceBatchWithoutTables );
+    CPPUNIT_ASSERT_EQUAL ( nTest, (uint) varianceBatch.size() );
+    CPPUNIT_ASSERT_EQUAL ( nTest, (uint) varianceBatchWithoutTables.size() );
+
+    // with quantization, the tables only approximate the projections, and the errors are amplified by the inverse eigenvalues
+    const double tolerance = ( quantization == 1 ) ? 5e-2 : 1e-8;
+    for ( uint k = 0; k < nTest; k++ )
+    {
+      double varianceWithoutTables;
+      gphyper.computePredictiveVarianceApproximateFine ( *(examplesTest[k]), varianceWithoutTables );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( varianceWithoutTables, varianceSparse[k], tolerance );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( varianceWithoutTables, varianceBatch[k], tolerance );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( varianceWithoutTables, varianceBatchWithoutTables[k], 1e-8 );
+
+      gphyper.computePredictiveVarianceApproximateFine ( examplesDense[nTrain + k], varianceWithoutTables );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( varianceWithoutTables, varianceDense[k], tolerance );
+    }
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testVarianceApproximationFineTables done ===================== " << std::endl;
+}
+
+#ifdef NICE_USELIB_OPENMP
+/**
+* @brief check that the lookup tables of two stored GPHIKRawClassifier models are bitwise identical
+* (A and B are the cumulative sums of alpha resp. alpha*x, T is computed from A and B)
+*/
+static void compareRawModelTables ( std::istream & _model1,
+                                    std::istream & _model2,
+                                    const uint & _numClasses
+                                  )
+{
+  std::string tag1, tag2;
+  _model1 >> tag1;
+  _model2 >> tag2;
+  NICE::BinaryModelReader reader1;
+  NICE::BinaryModelReader reader2;
+  reader1.read ( _model1 );
+  reader2.read ( _model2 );
+
+  const char * prefixes[3] = { "A.", "B.", "T." };
+  uint numTables ( 0 );
+  for ( uint classno = 0; classno < _numClasses; classno++ )
+    for ( int p = 0; p < 3; p++ )
+    {
+      std::ostringstream name;
+      name << prefixes[p] << classno;
+      CPPUNIT_ASSERT_EQUAL ( reader1.hasSection ( name.str() ), reader2.hasSection ( name.str() ) );
+      if ( !reader1.hasSection ( name.str() ) )
+        continue;
+
+      size_t size1, size2;
+      const char * table1 = reader1.getSection ( name.str(), size1 );
+      const char * table2 = reader2.getSection ( name.str(), size2 );
+      CPPUNIT_ASSERT_EQUAL ( size1, size2 );
+      CPPUNIT_ASSERT ( std::equal ( table1, table1 + size1, table2 ) );
+      numTables++;
+    }
+  CPPUNIT_ASSERT ( numTables > 0 );
+}
+
+void TestFastHIK::testRawClassifierNumberOfThreads()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testRawClassifierNumberOfThreads ===================== " << std::endl;
+
+  // enough dimensions to split the kernel multiplications into several chunks
+  const uint nTrain = 200;
+  const uint dTrain = 60;
+  const uint nTest = 50;
+
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dTrain, nTrain + nTest, dataMatrix );
+
+  std::vector< NICE::SparseVector > examples ( nTrain + nTest );
+  for ( uint k = 0; k < nTrain + nTest; k++ )
+  {
+    examples[k].setDim ( dTrain );
+    for ( uint i = 0; i < dTrain; i++ )
+      if ( drand48() >= 0.5 )
+        examples[k].insert ( std::pair<uint, double> ( i, dataMatrix[i][k] ) );
+  }
+
+  std::vector< const NICE::SparseVector * > examplesTrain;
+  std::vector< const NICE::SparseVector * > examplesTest;
+  for ( uint k = 0; k < nTrain + nTest; k++ )
+  {
+    if ( k < nTrain )
+      examplesTrain.push_back ( &(examples[k]) );
+    else
+      examplesTest.push_back ( &(examples[k]) );
+  }
+
+  // binary and multi-class setting, with and without quantization
+  for ( uint numClasses = 2; numClasses <= 3; numClasses++ )
+  {
+    NICE::Vector labels ( nTrain );
+    for ( uint k = 0; k < nTrain; k++ )
+      labels[k] = k % numClasses;
+
+    for ( int quantization = 0; quantization <= 1; quantization++ )
+    {
+      NICE::GPHIKRawClassifier * classifiers[2];
+      const int numThreads[2] = { 1, 4 };
+      std::stringstream models[2];
+      NICE::Vector results[2];
+      NICE::Matrix scores[2];
+
+      for ( int c = 0; c < 2; c++ )
+      {
+        NICE::Config conf;
+        conf.sB ( "GPHIKRawClassifier", "use_quantization", quantization == 1 );
+        conf.sI ( "GPHIKRawClassifier", "num_threads", numThreads[c] );
+        classifiers[c] = new NICE::GPHIKRawClassifier ( &conf );
+        classifiers[c]->train ( examplesTrain, labels );
+        classifiers[c]->store ( models[c] );
+        classifiers[c]->classify ( examplesTest, results[c], scores[c] );
+      }
+
+      compareRawModelTables ( models[0], models[1], numClasses );
+
+      CPPUNIT_ASSERT_EQUAL ( scores[0].rows(), scores[1].rows() );
+      CPPUNIT_ASSERT_EQUAL ( scores[0].cols(), scores[1].cols() );
+      for ( uint i = 0; i < scores[0].rows(); i++ )
+      {
+        CPPUNIT_ASSERT_EQUAL ( results[0][i], results[1][i] );
+        for ( uint j = 0; j < scores[0].cols(); j++ )
+          CPPUNIT_ASSERT_EQUAL ( scores[0](i,j), scores[1](i,j) );
+
+        uint result;
+        NICE::SparseVector scoresSingle[2];
+        for ( int c = 0; c < 2; c++ )
+          classifiers[c]->classify ( examplesTest[i], result, scoresSingle[c] );
+        CPPUNIT_ASSERT_EQUAL ( scoresSingle[0].size(), scoresSingle[1].size() );
+        for ( NICE::SparseVector::const_iterator it = scoresSingle[0].begin(); it != scoresSingle[0].end(); it++ )
+          CPPUNIT_ASSERT_EQUAL ( it->second, scoresSingle[1].get ( it->first ) );
+      }
+
+      delete classifiers[0];
+      delete classifiers[1];
+    }
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testRawClassifierNumberOfThreads done ===================== " << std::endl;
+}
+
+void TestFastHIK::testKernelMultiplicationNumberOfThreads()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKernelMultiplicationNumberOfThreads ===================== " << std::endl;
+
+  // enough dimensions to split the loops over the dimensions into several chunks
+  const uint nThreads = 300;
+  const uint dThreads = 50;
+
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dThreads, nThreads, dataMatrix );
+  for ( uint i = 0 ; i < dThreads; i++ )
+    for ( uint k = 0; k < nThreads; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+
+  std::vector< NICE::SparseVector > examples ( nThreads );
+  std::vector< const NICE::SparseVector * > examplePointers ( nThreads );
+  for ( uint k = 0; k < nThreads; k++ )
+  {
+    examples[k].setDim ( dThreads );
+    for ( uint i = 0; i < dThreads; i++ )
+      if ( dataMatrix[i][k] != 0.0 )
+        examples[k].insert ( std::pair<uint, double> ( i, dataMatrix[i][k] ) );
+    examplePointers[k] = &(examples[k]);
+  }
+
+  Vector alpha ( nThreads );
+  for ( uint i = 0; i < alpha.size(); i++ )
+    alpha[i] = sin(i);
+
+  double noise = 1.0;
+  PFAbsExp pf ( 0.7 );
+
+  // sequential results
+  FastMinKernel fmk ( dataMatrix, noise );
+  fmk.setNumberOfThreads ( 1 );
+  NICE::VVector A, B, ATransformed, BTransformed;
+  fmk.hik_prepare_alpha_multiplications ( alpha, A, B );
+  fmk.hik_prepare_alpha_multiplications ( alpha, ATransformed, BTransformed, &pf );
+  Vector beta, betaTransformed;
+  fmk.hik_kernel_multiply ( A, B, alpha, beta );
+  fmk.hik_kernel_multiply ( ATransformed, BTransformed, alpha, betaTransformed, &pf );
+
+  GMHIKernelRaw gmRaw ( examplePointers, noise );
+  gmRaw.setNumberOfThreads ( 1 );
+  Vector betaRaw;
+  gmRaw.multiply ( betaRaw, alpha );
+
+  // the sequential result agrees with the raw kernel matrix up to rounding errors
+  CPPUNIT_ASSERT_DOUBLES_EQUAL ( 0.0, ( beta - betaRaw ).normL1(), 1e-8 * beta.normL1() );
+
+  // any number of threads yields exactly the same results
+  const uint numThreads[4] = { 2, 3, 4, 7 };
+  for ( int t = 0; t < 4; t++ )
+  {
+    fmk.setNumberOfThreads ( numThreads[t] );
+    NICE::VVector AThreads, BThreads, ATransformedThreads, BTransformedThreads;
+    fmk.hik_prepare_alpha_multiplications ( alpha, AThreads, BThreads );
+    fmk.hik_prepare_alpha_multiplications ( alpha, ATransformedThreads, BTransformedThreads, &pf );
+    CPPUNIT_ASSERT ( compareVVector ( A, AThreads, 0.0 ) );
+    CPPUNIT_ASSERT ( compareVVector ( B, BThreads, 0.0 ) );
+    CPPUNIT_ASSERT ( compareVVector ( ATransformed, ATransformedThreads, 0.0 ) );
+    CPPUNIT_ASSERT ( compareVVector ( BTransformed, BTransformedThreads, 0.0 ) );
+
+    Vector betaThreads, betaTransformedThreads;
+    fmk.hik_kernel_multiply ( A, B, alpha, betaThreads );
+    fmk.hik_kernel_multiply ( ATransformed, BTransformed, alpha, betaTransformedThreads, &pf );
+
+    gmRaw.setNumberOfThreads ( numThreads[t] );
+    Vector betaRawThreads;
+    gmRaw.multiply ( betaRawThreads, alpha );
+
+    for ( uint i = 0; i < nThreads; i++ )
+    {
+      CPPUNIT_ASSERT_EQUAL ( beta[i], betaThreads[i] );
+      CPPUNIT_ASSERT_EQUAL ( betaTransformed[i], betaTransformedThreads[i] );
+      CPPUNIT_ASSERT_EQUAL ( betaRaw[i], betaRawThreads[i] );
+    }
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testKernelMultiplicationNumberOfThreads done ===================== " << std::endl;
+}
+
+/**
+* @brief absexp transformation that fails for exponents above a threshold,
+* such that some workers of the parallel grid search throw an exception
+*/
+class PFAbsExpFailing : public NICE::PFAbsExp
+{
+  protected:
+    double d_threshold;
+
+    void check () const
+    {
+      if ( m_parameters[0] > d_threshold )
+        fthrow ( Exception, "PFAbsExpFailing: exponent " << m_parameters[0] << " is not supported" );
+    }
+
+  public:
+    PFAbsExpFailing ( double _threshold, double _lB, double _uB ) : PFAbsExp ( 1.0, _lB, _uB ), d_threshold ( _threshold ) {};
+
+    double f ( uint index, double x ) const { check(); return PFAbsExp::f ( index, x ); }
+    void f ( uint index, const double * x, double * y, uint n ) const { check(); PFAbsExp::f ( index, x, y, n ); }
+    void fPerDimension ( const uint * indices, const double * x, double * y, uint n ) const { check(); PFAbsExp::fPerDimension ( indices, x, y, n ); }
+
+    ParameterizedFunction * clone() const { return new PFAbsExpFailing ( *this ); };
+};
+
+void TestFastHIK::testParallelGridSearch()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testParallelGridSearch ===================== " << std::endl;
+
+  const uint nTrain = 150;
+  const uint dTrain = 20;
+  const uint nTest = 30;
+  const uint numClasses = 3;
+
+  vector< vector<double> > dataMatrix;
+  generateRandomFeatures ( dTrain, nTrain + nTest, dataMatrix );
+
+  std::vector< NICE::SparseVector > examples ( nTrain + nTest );
+  for ( uint k = 0; k < nTrain + nTest; k++ )
+  {
+    examples[k].setDim ( dTrain );
+    for ( uint i = 0; i < dTrain; i++ )
+      if ( drand48() >= sparse_prob )
+        examples[k].insert ( std::pair<uint, double> ( i, dataMatrix[i][k] ) );
+  }
+
+  std::vector< const NICE::SparseVector * > examplesTrain;
+  for ( uint k = 0; k < nTrain; k++ )
+    examplesTrain.push_back ( &(examples[k]) );
+
+  NICE::Vector labels ( nTrain );
+  for ( uint k = 0; k < nTrain; k++ )
+    labels[k] = k % numClasses;
+
+  NICE::Config conf;
+  conf.sS ( "FMKGPHyperparameterOptimization", "optimization_method", "greedy" );
+  conf.sD ( "FMKGPHyperparameterOptimization", "parameter_lower_bound", 0.5 );
+  conf.sD ( "FMKGPHyperparameterOptimization", "parameter_upper_bound", 2.5 );
+  conf.sD ( "FMKGPHyperparameterOptimization", "parameter_step_size", 0.1 );
+  conf.sI ( "FMKGPHyperparameterOptimization", "num_threads", 4 );
+
+  // sequential and parallel evaluation of the grid
+  FMKGPWithTransformation * gphyper[2];
+  for ( int parallel = 0; parallel <= 1; parallel++ )
+  {
+    conf.sB ( "FMKGPHyperparameterOptimization", "parallel_grid_search", parallel == 1 );
+    gphyper[parallel] = new FMKGPWithTransformation ( &conf );
+    gphyper[parallel]->setFastMinKernel ( new FastMinKernel ( examplesTrain, 0.1 ) );
+    gphyper[parallel]->optimize ( labels );
+  }
+
+  // the grid points are the same, the best one has to be found by both
+  CPPUNIT_ASSERT_EQUAL ( (uint) 1, gphyper[0]->getBestParameters().size() );
+  CPPUNIT_ASSERT_EQUAL ( gphyper[0]->getBestParameters()[0], gphyper[1]->getBestParameters()[0] );
+
+  // the alphas only differ due to the warm starts of the linear solver
+  for ( uint k = nTrain; k < nTrain + nTest; k++ )
+  {
+    NICE::SparseVector scores[2];
+    uint results[2];
+    for ( int parallel = 0; parallel <= 1; parallel++ )
+      results[parallel] = gphyper[parallel]->classify ( examples[k], scores[parallel] );
+
+    CPPUNIT_ASSERT_EQUAL ( results[0], results[1] );
+    CPPUNIT_ASSERT_EQUAL ( scores[0].size(), scores[1].size() );
+    for ( NICE::SparseVector::const_iterator it = scores[0].begin(); it != scores[0].end(); it++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( it->second, scores[1].get ( it->first ), 1e-4 );
+  }
+
+  delete gphyper[0];
+  delete gphyper[1];
+
+  // exceptions of single workers are propagated to the caller
+  for ( int parallel = 0; parallel <= 1; parallel++ )
+  {
+    conf.sB ( "FMKGPHyperparameterOptimization", "parallel_grid_search", parallel == 1 );
+    FMKGPWithTransformation failingGphyper ( &conf );
+    failingGphyper.setTransformation ( new PFAbsExpFailing ( 2.0, 0.5, 2.5 ) );
+    failingGphyper.setFastMinKernel ( new FastMinKernel ( examplesTrain, 0.1 ) );
+
+    std::string message;
+    try
+    {
+      failingGphyper.optimize ( labels );
+    }
+    catch ( std::exception & e )
+    {
+      message = e.what();
+    }
+    CPPUNIT_ASSERT ( message.find ( "is not supported" ) != std::string::npos );
+    if ( parallel == 1 )
+      CPPUNIT_ASSERT ( message.find ( "parallel grid search failed" ) != std::string::npos );
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFastHIK::testParallelGridSearch done ===================== " << std::endl;
+}
+#endif
+
 #endif
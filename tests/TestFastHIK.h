@@ -14,11 +14,32 @@ class TestFastHIK : public CppUnit::TestFixture {
     
     CPPUNIT_TEST(testKernelMultiplication);
     CPPUNIT_TEST(testKernelMultiplicationFast);
+    CPPUNIT_TEST(testKernelMultiplicationBlock);
     CPPUNIT_TEST(testKernelSum);
     CPPUNIT_TEST(testKernelSumFast);
+    CPPUNIT_TEST(testLUTPrecision);
+    CPPUNIT_TEST(testBatchQuantization);
     CPPUNIT_TEST(testLUTUpdate);
     CPPUNIT_TEST(testLinSolve);
     CPPUNIT_TEST(testKernelVector);
+    CPPUNIT_TEST(testLogDetApprox);
+    CPPUNIT_TEST(testKrylovRecycling);
+    CPPUNIT_TEST(testLazyTransform);
+    CPPUNIT_TEST(testBatchTransform);
+    CPPUNIT_TEST(testParameterGradient);
+    CPPUNIT_TEST(testBoundedLBFGS);
+    CPPUNIT_TEST(testIncrementalAlphaUpdate);
+    CPPUNIT_TEST(testKernelVectorsBatch);
+    CPPUNIT_TEST(testEigenVectorProjection);
+    CPPUNIT_TEST(testLUTUpdatePrototypeCache);
+    CPPUNIT_TEST(testLUTUpdateTransformedFeatures);
+    CPPUNIT_TEST(testRawClassifierSingleExamples);
+    CPPUNIT_TEST(testVarianceApproximationFineTables);
+#ifdef NICE_USELIB_OPENMP
+    CPPUNIT_TEST(testRawClassifierNumberOfThreads);
+    CPPUNIT_TEST(testKernelMultiplicationNumberOfThreads);
+    CPPUNIT_TEST(testParallelGridSearch);
+#endif
     
     CPPUNIT_TEST_SUITE_END();
   
@@ -33,11 +54,44 @@ class TestFastHIK : public CppUnit::TestFixture {
     */  
     void testKernelMultiplication();
     void testKernelMultiplicationFast();
+    void testKernelMultiplicationBlock();
     void testKernelSum();
     void testKernelSumFast();
+    void testLUTPrecision();
+    void testBatchQuantization();
     void testLUTUpdate();
     void testLinSolve();
     void testKernelVector();
+    void testLogDetApprox();
+    void testKrylovRecycling();
+    void testLazyTransform();
+    void testBatchTransform();
+
+    void testParameterGradient();
+
+    void testBoundedLBFGS();
+
+    void testIncrementalAlphaUpdate();
+
+    void testKernelVectorsBatch();
+
+    void testEigenVectorProjection();
+
+    void testLUTUpdatePrototypeCache();
+
+    void testLUTUpdateTransformedFeatures();
+
+    void testRawClassifierSingleExamples();
+
+    void testVarianceApproximationFineTables();
+
+#ifdef NICE_USELIB_OPENMP
+    void testRawClassifierNumberOfThreads();
+
+    void testKernelMultiplicationNumberOfThreads();
+
+    void testParallelGridSearch();
+#endif
 
 };
 
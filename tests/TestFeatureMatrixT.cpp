@@ -1,11 +1,13 @@
 #ifdef NICE_USELIB_CPPUNIT
 
+#include <algorithm>
 #include <string>
 #include <exception>
 
 #include <core/matlabAccess/MatFileIO.h>
 
 #include <gp-hik-core/tools.h>
+#include <gp-hik-core/parameterizedFunctions/PFAbsExp.h>
 
 #include "TestFeatureMatrixT.h"
 
@@ -187,4 +189,435 @@ void TestFeatureMatrixT::testMatlabIO()
 }
 
 
+void TestFeatureMatrixT::testFindInDimension()
+{
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testFindInDimension ===================== " << std::endl;
+  
+  std::vector< std::vector<double> > dataMatrix;
+
+  generateRandomFeatures ( d, n, dataMatrix );
+
+  for ( uint i = 0 ; i < d; i++ )
+  {
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < 0.5 ) 
+        dataMatrix[i][k] = 0.0;
+    // include some duplicates
+    dataMatrix[i][n-1] = dataMatrix[i][0];
+  }
+
+  // the constructor expects examples x dimensions
+  transposeVectorOfVectors(dataMatrix);
+  NICE::FeatureMatrixT<double> fm(dataMatrix);
+  transposeVectorOfVectors(dataMatrix);
+
+  for ( uint i = 0 ; i < d; i++ )
+  {
+    // all values of the data, values in between, below the smallest and above the largest non-zero value
+    std::vector<double> queries;
+    for ( uint k = 0; k < n; k++ )
+      if ( dataMatrix[i][k] != 0.0 )
+        queries.push_back ( dataMatrix[i][k] );
+    std::sort ( queries.begin(), queries.end() );
+    if ( queries.empty() )
+      continue;
+    uint numValues ( queries.size() );
+    for ( uint k = 0; k+1 < numValues; k++ )
+      if ( queries[k] < queries[k+1] )
+        queries.push_back ( 0.5 * ( queries[k] + queries[k+1] ) );
+    queries.push_back ( 0.5 * queries[0] );
+    queries.push_back ( 2.0 * queries[numValues-1] );
+
+    for ( uint k = 0; k < queries.size(); k++ )
+    {
+      double elem = queries[k];
+
+      // brute force: number of entries smaller or equal / strictly smaller than elem
+      uint nrSmallerEqual ( 0 );
+      uint nrSmaller ( 0 );
+      for ( uint l = 0; l < n; l++ )
+      {
+        if ( dataMatrix[i][l] <= elem )
+          nrSmallerEqual++;
+        if ( dataMatrix[i][l] < elem )
+          nrSmaller++;
+      }
+
+      uint position;
+      fm.findFirstLargerInDimension ( i, elem, position );
+      CPPUNIT_ASSERT_EQUAL ( nrSmallerEqual, position );
+
+      fm.findLastInDimension ( i, elem, position );
+      CPPUNIT_ASSERT_EQUAL ( nrSmallerEqual, position );
+
+      fm.findFirstInDimension ( i, elem, position );
+      CPPUNIT_ASSERT_EQUAL ( nrSmaller, position );
+
+      fm.findLastSmallerInDimension ( i, elem, position );
+      CPPUNIT_ASSERT_EQUAL ( nrSmaller, position );
+    }
+
+    // no element is smaller than zero
+    uint position;
+    fm.findLastSmallerInDimension ( i, 0.0, position );
+    CPPUNIT_ASSERT_EQUAL ( (uint) 0, position );
+    fm.findFirstInDimension ( i, 0.0, position );
+    CPPUNIT_ASSERT_EQUAL ( (uint) 0, position );
+  }
+
+  // 2 non-zero and 3 zero elements, the query exceeds both non-zero values
+  std::vector< std::vector<double> > smallMatrix ( 1, std::vector<double> ( 5, 0.0 ) );
+  smallMatrix[0][1] = 0.25;
+  smallMatrix[0][3] = 0.5;
+  NICE::FeatureMatrixT<double> fmSmall;
+  fmSmall.set_features ( smallMatrix );
+  uint position;
+  fmSmall.findLastSmallerInDimension ( 0, 0.75, position );
+  CPPUNIT_ASSERT_EQUAL ( (uint) 5, position );
+  fmSmall.findLastSmallerInDimension ( 0, 0.5, position );
+  CPPUNIT_ASSERT_EQUAL ( (uint) 4, position );
+  fmSmall.findLastSmallerInDimension ( 0, 0.125, position );
+  CPPUNIT_ASSERT_EQUAL ( (uint) 3, position );
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testFindInDimension done ===================== " << std::endl;
+}
+
+// compare the example mirror with the element-wise access of the feature matrix
+static void checkExampleMirror ( const NICE::FeatureMatrixT<double> & _fm )
+{
+  for ( uint i = 0; i < _fm.get_n(); i++ )
+  {
+    const uint * dims;
+    const double * values;
+    const double * transformedValues;
+    uint nnz = _fm.getExample ( i, dims, values, transformedValues );
+
+    uint k = 0;
+    for ( uint dim = 0; dim < _fm.get_d(); dim++ )
+    {
+      if ( _fm.getOriginal ( dim, i ) == 0.0 )
+        continue;
+
+      CPPUNIT_ASSERT ( k < nnz );
+      CPPUNIT_ASSERT_EQUAL ( dim, dims[k] );
+      CPPUNIT_ASSERT_EQUAL ( _fm.getOriginal ( dim, i ), values[k] );
+      CPPUNIT_ASSERT_EQUAL ( _fm ( dim, i ), transformedValues[k] );
+      k++;
+    }
+    CPPUNIT_ASSERT_EQUAL ( nnz, k );
+  }
+}
+
+void TestFeatureMatrixT::testExampleMirror()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testExampleMirror ===================== " << std::endl;
+
+  std::vector< std::vector<double> > dataMatrix;
+  generateRandomFeatures ( d, n, dataMatrix );
+  for ( uint i = 0 ; i < d; i++ )
+  {
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+
+  NICE::FeatureMatrixT<double> fm;
+  std::vector<std::vector<uint> > permutations;
+  fm.set_features ( dataMatrix, permutations );
+  fm.setKeepExampleMirror ( true );
+  checkExampleMirror ( fm );
+
+  // new examples are appended to the mirror
+  NICE::SparseVector x;
+  x.insert ( std::pair<uint, double> ( 0, 0.5 ) );
+  x.insert ( std::pair<uint, double> ( d-1, 0.25 ) );
+  fm.add_feature ( x );
+  NICE::SparseVector x2;
+  x2.insert ( std::pair<uint, double> ( d/2, 0.75 ) );
+  fm.add_feature ( x2 );
+  CPPUNIT_ASSERT_EQUAL ( n+2, fm.get_n() );
+  checkExampleMirror ( fm );
+
+  // transformed values are updated as well
+  NICE::PFAbsExp pf ( 1.5 );
+  fm.applyFunctionToFeatureMatrix ( &pf );
+  checkExampleMirror ( fm );
+
+  // single elements are updated in place, inserted, or removed
+  fm.set ( 0, 1, 0.125 );
+  checkExampleMirror ( fm );
+  fm.setUnsafe ( 0, 1, 0.375, true /* _setTransformedValue */ );
+  checkExampleMirror ( fm );
+  for ( uint k = 0; k < fm.get_n(); k++ )
+  {
+    if ( fm.getOriginal ( 1, k ) == 0.0 )
+    {
+      fm.set ( 1, k, 0.625 );
+      checkExampleMirror ( fm );
+      fm.set ( 1, k, 0.0 );
+      checkExampleMirror ( fm );
+      break;
+    }
+  }
+  fm.setUnsafe ( d-1, n, 0.0 );
+  checkExampleMirror ( fm );
+
+  // examples given as dimensions x examples are appended as well
+  std::vector< std::vector<double> > newExamples;
+  generateRandomFeatures ( d, 3, newExamples );
+  newExamples[0][1] = 0.0;
+  fm.add_features ( newExamples );
+  CPPUNIT_ASSERT_EQUAL ( n+5, fm.get_n() );
+  checkExampleMirror ( fm );
+
+  // the mirror computed on demand equals the kept one
+  std::vector<uint> startKept, dimsKept, startComputed, dimsComputed;
+  std::vector<double> valuesKept, transformedKept, valuesComputed, transformedComputed;
+  fm.getExampleMirror ( startKept, dimsKept, valuesKept, transformedKept );
+  fm.setKeepExampleMirror ( false );
+  fm.getExampleMirror ( startComputed, dimsComputed, valuesComputed, transformedComputed );
+  CPPUNIT_ASSERT ( startKept == startComputed );
+  CPPUNIT_ASSERT ( dimsKept == dimsComputed );
+  CPPUNIT_ASSERT ( valuesKept == valuesComputed );
+  CPPUNIT_ASSERT ( transformedKept == transformedComputed );
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testExampleMirror done ===================== " << std::endl;
+}
+
+void TestFeatureMatrixT::testAddMultipleExamples()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testAddMultipleExamples ===================== " << std::endl;
+
+  std::vector< std::vector<double> > dataMatrix;
+  generateRandomFeatures ( d, n, dataMatrix );
+  for ( uint i = 0 ; i < d; i++ )
+  {
+    for ( uint k = 0; k < n; k++ )
+      if ( drand48() < sparse_prob )
+        dataMatrix[i][k] = 0.0;
+  }
+
+  NICE::PFAbsExp pf ( 1.5 );
+
+  NICE::FeatureMatrixT<double> fmSingle;
+  std::vector<std::vector<uint> > permutations;
+  fmSingle.set_features ( dataMatrix, permutations );
+  fmSingle.applyFunctionToFeatureMatrix ( &pf );
+  fmSingle.setKeepExampleMirror ( true );
+
+  NICE::FeatureMatrixT<double> fmBatch;
+  fmBatch.set_features ( dataMatrix, permutations );
+  fmBatch.applyFunctionToFeatureMatrix ( &pf );
+  fmBatch.setKeepExampleMirror ( true );
+
+  // new examples with duplicate values, duplicates of stored values, and explicit zeros
+  std::vector< NICE::SparseVector > batch ( 6 );
+  for ( uint k = 0; k < batch.size(); k++ )
+  {
+    for ( uint i = 0; i < d; i++ )
+    {
+      if ( ( k + i ) % 3 == 0 )
+        continue;
+      double value ( ( k % 2 == 0 ) ? 0.5 : drand48() );
+      if ( k == 3 )
+        value = dataMatrix[i][0];
+      if ( k == 5 )
+        value = 0.0;
+      batch[k].insert ( std::pair<uint, double> ( i, value ) );
+    }
+  }
+
+  std::vector< const NICE::SparseVector * > batchPointers;
+  for ( uint k = 0; k < batch.size(); k++ )
+  {
+    fmSingle.add_feature ( batch[k], &pf );
+    batchPointers.push_back ( &(batch[k]) );
+  }
+  fmBatch.add_features ( batchPointers, &pf );
+
+  CPPUNIT_ASSERT_EQUAL ( n + (uint) batch.size(), fmBatch.get_n() );
+  CPPUNIT_ASSERT_EQUAL ( fmSingle.get_n(), fmBatch.get_n() );
+  checkExampleMirror ( fmBatch );
+
+  // the sorted features are identical, including the order of equal values
+  for ( uint i = 0; i < d; i++ )
+  {
+    const NICE::SortedVectorSparse<double> & single = fmSingle.getFeatureValues ( i );
+    const NICE::SortedVectorSparse<double> & multiple = fmBatch.getFeatureValues ( i );
+    CPPUNIT_ASSERT_EQUAL ( fmBatch.get_n(), multiple.getN() );
+    CPPUNIT_ASSERT_EQUAL ( single.getNonZeros(), multiple.getNonZeros() );
+    for ( uint pos = 0; pos < single.getNonZeros(); pos++ )
+    {
+      CPPUNIT_ASSERT_EQUAL ( single.nonzeroElements().getValues()[pos], multiple.nonzeroElements().getValues()[pos] );
+      CPPUNIT_ASSERT_EQUAL ( single.nonzeroElements().getIndices()[pos], multiple.nonzeroElements().getIndices()[pos] );
+      CPPUNIT_ASSERT_EQUAL ( single.nonzeroElements().getTransformedValues()[pos], multiple.nonzeroElements().getTransformedValues()[pos] );
+    }
+    CPPUNIT_ASSERT ( single.nonzeroIndices() == multiple.nonzeroIndices() );
+  }
+
+  std::vector<uint> startSingle, dimsSingle, startBatch, dimsBatch;
+  std::vector<double> valuesSingle, transformedSingle, valuesBatch, transformedBatch;
+  fmSingle.getExampleMirror ( startSingle, dimsSingle, valuesSingle, transformedSingle );
+  fmBatch.getExampleMirror ( startBatch, dimsBatch, valuesBatch, transformedBatch );
+  CPPUNIT_ASSERT ( startSingle == startBatch );
+  CPPUNIT_ASSERT ( dimsSingle == dimsBatch );
+  CPPUNIT_ASSERT ( valuesSingle == valuesBatch );
+  CPPUNIT_ASSERT ( transformedSingle == transformedBatch );
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testAddMultipleExamples done ===================== " << std::endl;
+}
+
+void TestFeatureMatrixT::testRemoveExamples()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testRemoveExamples ===================== " << std::endl;
+
+  NICE::PFAbsExp pf ( 1.5 );
+
+  // sparse examples with duplicate values
+  std::vector< NICE::SparseVector > examples ( n );
+  for ( uint k = 0; k < n; k++ )
+  {
+    for ( uint i = 0; i < d; i++ )
+    {
+      if ( drand48() < sparse_prob / 2.0 )
+        continue;
+      examples[k].insert ( std::pair<uint, double> ( i, ( k % 4 == 0 ) ? 0.5 : drand48() ) );
+    }
+  }
+
+  std::vector< uint > indicesToRemove;
+  indicesToRemove.push_back ( n-1 );
+  indicesToRemove.push_back ( 0 );
+  indicesToRemove.push_back ( n/2 );
+  indicesToRemove.push_back ( n/2 );
+
+  std::vector< const NICE::SparseVector * > examplesAll;
+  std::vector< const NICE::SparseVector * > examplesRemaining;
+  for ( uint k = 0; k < n; k++ )
+  {
+    examplesAll.push_back ( &(examples[k]) );
+    if ( std::find ( indicesToRemove.begin(), indicesToRemove.end(), k ) == indicesToRemove.end() )
+      examplesRemaining.push_back ( &(examples[k]) );
+  }
+
+  NICE::FeatureMatrixT<double> fmRemoved;
+  fmRemoved.setKeepExampleMirror ( true );
+  fmRemoved.add_features ( examplesAll, &pf );
+  fmRemoved.remove_features ( indicesToRemove );
+
+  NICE::FeatureMatrixT<double> fmRemaining;
+  fmRemaining.setKeepExampleMirror ( true );
+  fmRemaining.add_features ( examplesRemaining, &pf );
+
+  CPPUNIT_ASSERT_EQUAL ( n - 3, fmRemoved.get_n() );
+  CPPUNIT_ASSERT_EQUAL ( fmRemaining.get_d(), fmRemoved.get_d() );
+  checkExampleMirror ( fmRemoved );
+
+  // the remaining examples are numbered consecutively and keep the order of equal values
+  for ( uint i = 0; i < fmRemaining.get_d(); i++ )
+  {
+    const NICE::SortedVectorSparse<double> & remaining = fmRemaining.getFeatureValues ( i );
+    const NICE::SortedVectorSparse<double> & removed = fmRemoved.getFeatureValues ( i );
+    CPPUNIT_ASSERT_EQUAL ( remaining.getN(), removed.getN() );
+    CPPUNIT_ASSERT_EQUAL ( remaining.getNonZeros(), removed.getNonZeros() );
+    for ( uint pos = 0; pos < remaining.getNonZeros(); pos++ )
+    {
+      CPPUNIT_ASSERT_EQUAL ( remaining.nonzeroElements().getValues()[pos], removed.nonzeroElements().getValues()[pos] );
+      CPPUNIT_ASSERT_EQUAL ( remaining.nonzeroElements().getIndices()[pos], removed.nonzeroElements().getIndices()[pos] );
+      CPPUNIT_ASSERT_EQUAL ( remaining.nonzeroElements().getTransformedValues()[pos], removed.nonzeroElements().getTransformedValues()[pos] );
+    }
+    CPPUNIT_ASSERT ( remaining.nonzeroIndices() == removed.nonzeroIndices() );
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testRemoveExamples done ===================== " << std::endl;
+}
+
+void TestFeatureMatrixT::testIndexMappingAfterSingleUpdates()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testIndexMappingAfterSingleUpdates ===================== " << std::endl;
+
+  // single insertions and deletions only update the index mapping on the next lookup,
+  // mix them with lookups and batch operations and compare against a dense reference
+  NICE::SortedVectorSparse<double> v;
+  std::vector<double> reference;
+
+  srand48 ( 7 );
+  for ( uint k = 0; k < 40; k++ )
+  {
+    double value ( ( k % 3 == 0 ) ? 0.0 : ( ( k % 5 == 0 ) ? 0.5 : drand48() ) );
+    v.insert ( value );
+    reference.push_back ( value );
+  }
+
+  for ( uint k = 0; k < 20; k++ )
+  {
+    uint a ( ( 7 * k ) % reference.size() );
+    double value ( ( k % 4 == 0 ) ? 0.0 : drand48() );
+    v.set ( a, value );
+    reference[a] = value;
+
+    // batch insertion while the mapping is outdated
+    if ( k % 6 == 5 )
+    {
+      std::vector<double> batch ( 3, 0.5 );
+      batch[1] = 0.0;
+      batch[2] = drand48();
+      v.insert ( batch );
+      reference.insert ( reference.end(), batch.begin(), batch.end() );
+    }
+
+    // batch removal while the mapping is outdated
+    if ( k % 7 == 6 )
+    {
+      std::vector<int> newIndices ( reference.size() );
+      std::vector<double> remaining;
+      for ( uint i = 0; i < reference.size(); i++ )
+      {
+        newIndices[i] = ( i % 9 == 4 ) ? -1 : (int) remaining.size();
+        if ( newIndices[i] >= 0 )
+          remaining.push_back ( reference[i] );
+      }
+      v.removeMultiple ( newIndices, remaining.size() );
+      reference = remaining;
+    }
+
+    if ( k % 2 == 0 )
+    {
+      CPPUNIT_ASSERT_EQUAL ( (uint) reference.size(), v.getN() );
+      for ( uint i = 0; i < reference.size(); i++ )
+        CPPUNIT_ASSERT_EQUAL ( reference[i], v.access ( i ) );
+    }
+  }
+
+  // the mapping equals the one of a vector built from scratch
+  NICE::SortedVectorSparse<double> fresh ( reference, 0.0 );
+  CPPUNIT_ASSERT_EQUAL ( fresh.getNonZeros(), v.getNonZeros() );
+  for ( uint i = 0; i < reference.size(); i++ )
+  {
+    CPPUNIT_ASSERT_EQUAL ( reference[i], v.access ( i ) );
+    CPPUNIT_ASSERT_EQUAL ( reference[i], v.accessOriginal ( i ) );
+  }
+  for ( uint pos = 0; pos < v.getNonZeros(); pos++ )
+  {
+    uint position;
+    uint index ( v.nonzeroElements().getIndices()[pos] );
+    CPPUNIT_ASSERT ( v.getNonZeroPosition ( index, position ) );
+    CPPUNIT_ASSERT_EQUAL ( pos, position );
+  }
+  CPPUNIT_ASSERT_EQUAL ( (size_t) v.getNonZeros(), v.nonzeroIndices().size() );
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestFeatureMatrixT::testIndexMappingAfterSingleUpdates done ===================== " << std::endl;
+}
+
 #endif
@@ -13,6 +13,11 @@ class TestFeatureMatrixT : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE( TestFeatureMatrixT );
 	 CPPUNIT_TEST(testSetup);
 	 CPPUNIT_TEST(testMatlabIO);
+	 CPPUNIT_TEST(testFindInDimension);
+	 CPPUNIT_TEST(testExampleMirror);
+	 CPPUNIT_TEST(testAddMultipleExamples);
+	 CPPUNIT_TEST(testRemoveExamples);
+	 CPPUNIT_TEST(testIndexMappingAfterSingleUpdates);
       
     CPPUNIT_TEST_SUITE_END();
   
@@ -27,6 +32,11 @@ class TestFeatureMatrixT : public CppUnit::TestFixture {
     */  
 		void testSetup();
 		void testMatlabIO();
+		void testFindInDimension();
+		void testExampleMirror();
+		void testAddMultipleExamples();
+		void testRemoveExamples();
+		void testIndexMappingAfterSingleUpdates();
 };
 
 #endif // _TESTFEATUREMATRIXT_H
@@ -225,6 +225,36 @@ void compareClassifierOutputsRaw ( const NICE::GPHIKClassifier * classifier,
   }
 }
 
+void compareBatchClassificationRaw ( const NICE::GPHIKRawClassifier * classifierRaw,
+                                     const NICE::Matrix & data
+                                   )
+{
+  std::vector< const NICE::SparseVector *> examples;
+  for (int i = 0; i < (int)data.rows(); i++)
+    examples.push_back ( new NICE::SparseVector( data.getRow(i) ) );
+
+  NICE::Vector results;
+  NICE::Matrix scores;
+  classifierRaw->classify( examples, results, scores );
+
+  CPPUNIT_ASSERT_EQUAL ( (uint)examples.size(), (uint)results.size() );
+
+  // batch classification has to be identical to classifying one example after another
+  for (int i = 0; i < (int)examples.size(); i++)
+  {
+    NICE::SparseVector scoresSingle;
+    uint resultSingle;
+    classifierRaw->classify( examples[i], resultSingle, scoresSingle );
+
+    CPPUNIT_ASSERT_EQUAL ( resultSingle, (uint)results[i] );
+    for ( NICE::SparseVector::const_iterator it = scoresSingle.begin(); it != scoresSingle.end(); it++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( it->second, scores( i, it->first ), 1e-10 );
+  }
+
+  for (std::vector< const NICE::SparseVector *>::iterator exIt = examples.begin(); exIt != examples.end(); exIt++)
+    delete *exIt;
+}
+
 void TestGPHIKOnlineLearnable::testOnlineLearningStartEmpty()
 {
   if (verboseStartEnd)
@@ -472,6 +502,7 @@ void TestGPHIKOnlineLearnable::testOnlineLearningOCCtoBinary()
   CPPUNIT_ASSERT_DOUBLES_EQUAL( arrScratch, arrScratchRaw, 1e-8);
 
   compareClassifierOutputsRaw(classifier, classifierScratchRaw, dataTest);
+  compareBatchClassificationRaw(classifierScratchRaw, dataTest);
   
   // don't waste memory
   
@@ -787,4 +818,329 @@ void TestGPHIKOnlineLearnable::testOnlineLearningMultiClass()
   
 }
 
+
+void TestGPHIKOnlineLearnable::testOnlineLearningIncrementalUpdate()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningIncrementalUpdate ===================== " << std::endl;
+
+  NICE::Config conf;
+
+  conf.sB ( "GPHIKClassifier", "eig_verbose", false);
+  conf.sS ( "GPHIKClassifier", "optimization_method", "none");
+  conf.sB ( "GPHIKClassifier", "use_quantization", true );
+  conf.sS ( "GPHIKClassifier", "varianceApproximation", "approximate_fine" );
+  conf.sI ( "GPHIKClassifier", "nrOfEigenvaluesToConsiderForVarApprox", 2 );
+
+  std::string s_trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+
+  //------------- read the training data --------------
+
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain;
+
+  readData ( s_trainData, dataTrain, yBinTrain, yMultiTrain );
+
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+
+  // the last four examples are added later on, two of them one after another and two at once
+  uint numInitial ( examplesTrain.size() - 4 );
+  std::vector< const NICE::SparseVector *> examplesInitial ( examplesTrain.begin(), examplesTrain.begin() + numInitial );
+  NICE::Vector yInitial ( yMultiTrain.getRangeRef( 0, numInitial-1 ) );
+
+  std::vector< const NICE::SparseVector *> examplesAtOnce ( examplesTrain.begin() + numInitial + 2, examplesTrain.end() );
+  NICE::Vector yAtOnce ( yMultiTrain.getRangeRef( numInitial+2, examplesTrain.size()-1 ) );
+
+  // the same increments with A, B, and T computed from scratch and updated incrementally
+  NICE::GPHIKClassifier * classifierScratch = new NICE::GPHIKClassifier ( &conf );
+  conf.sB ( "GPHIKClassifier", "incremental_update", true );
+  conf.sD ( "GPHIKClassifier", "incremental_alpha_tolerance", 0.0 );
+  NICE::GPHIKClassifier * classifierIncremental = new NICE::GPHIKClassifier ( &conf );
+
+  NICE::GPHIKClassifier * classifiers[2] = { classifierScratch, classifierIncremental };
+  for ( int c = 0; c < 2; c++ )
+  {
+    classifiers[c]->train ( examplesInitial, yInitial );
+    classifiers[c]->addExample ( examplesTrain[numInitial], yMultiTrain[numInitial], false );
+    classifiers[c]->addExample ( examplesTrain[numInitial+1], yMultiTrain[numInitial+1], false );
+    classifiers[c]->addMultipleExamples ( examplesAtOnce, yAtOnce, false );
+  }
+
+  //------------- read the test data --------------
+
+  NICE::Matrix dataTest;
+  NICE::Vector yBinTest;
+  NICE::Vector yMultiTest;
+
+  std::string s_testData = conf.gS( "main", "testData", "toyExampleTest.data" );
+
+  readData ( s_testData, dataTest, yBinTest, yMultiTest );
+
+  // both classifiers represent the solutions of the same linear systems
+  for (int i = 0; i < (int)dataTest.rows(); i++)
+  {
+    NICE::SparseVector example ( dataTest.getRow(i) );
+
+    NICE::SparseVector scoresScratch;
+    uint resultScratch;
+    classifierScratch->classify( &example, resultScratch, scoresScratch );
+
+    NICE::SparseVector scoresIncremental;
+    uint resultIncremental;
+    classifierIncremental->classify( &example, resultIncremental, scoresIncremental );
+
+    CPPUNIT_ASSERT_EQUAL ( resultScratch, resultIncremental );
+    for ( NICE::SparseVector::const_iterator it = scoresScratch.begin(); it != scoresScratch.end(); it++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( it->second, scoresIncremental[ it->first ], 1e-5 );
+  }
+
+  // don't waste memory
+
+  delete classifierScratch;
+  delete classifierIncremental;
+
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+  {
+    delete *exTrainIt;
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningIncrementalUpdate done ===================== " << std::endl;
+}
+
+void compareClassifiersOnTestData ( const GPHIKClassifier * classifierScratch,
+                                    const GPHIKClassifier * classifierOnline,
+                                    const std::string & s_testData
+                                  )
+{
+  NICE::Matrix dataTest;
+  NICE::Vector yBinTest;
+  NICE::Vector yMultiTest;
+
+  readData ( s_testData, dataTest, yBinTest, yMultiTest );
+
+  CPPUNIT_ASSERT ( classifierScratch->getKnownClassNumbers() == classifierOnline->getKnownClassNumbers() );
+
+  for (int i = 0; i < (int)dataTest.rows(); i++)
+  {
+    NICE::SparseVector example ( dataTest.getRow(i) );
+
+    NICE::SparseVector scoresScratch;
+    uint resultScratch;
+    classifierScratch->classify( &example, resultScratch, scoresScratch );
+
+    NICE::SparseVector scoresOnline;
+    uint resultOnline;
+    classifierOnline->classify( &example, resultOnline, scoresOnline );
+
+    CPPUNIT_ASSERT_EQUAL ( resultScratch, resultOnline );
+    for ( NICE::SparseVector::const_iterator it = scoresScratch.begin(); it != scoresScratch.end(); it++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( it->second, scoresOnline[ it->first ], 1e-5 );
+  }
+}
+
+void TestGPHIKOnlineLearnable::testOnlineLearningRemoveExamples()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningRemoveExamples ===================== " << std::endl;
+
+  NICE::Config conf;
+
+  conf.sB ( "GPHIKClassifier", "eig_verbose", false);
+  conf.sS ( "GPHIKClassifier", "optimization_method", "none");
+
+  std::string s_trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+
+  //------------- read the training data --------------
+
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain;
+
+  readData ( s_trainData, dataTrain, yBinTrain, yMultiTrain );
+
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+
+  // examples 5 and 11 as well as all examples of the last class are removed later on
+  uint lastClass ( yMultiTrain.Max() );
+  std::vector< const NICE::SparseVector *> examplesRemaining;
+  std::vector< double > yRemainingTmp;
+  std::vector< uint > indicesToRemove;
+  for ( uint i = 0; i < examplesTrain.size(); i++ )
+  {
+    if ( ( i == 5 ) || ( i == 11 ) )
+      continue;
+    if ( yMultiTrain[i] == lastClass )
+    {
+      // indices after removing example 5 before
+      indicesToRemove.push_back ( i - 1 );
+      continue;
+    }
+    examplesRemaining.push_back ( examplesTrain[i] );
+    yRemainingTmp.push_back ( yMultiTrain[i] );
+  }
+  indicesToRemove.push_back ( 10 );
+  NICE::Vector yRemaining ( yRemainingTmp );
+
+  NICE::GPHIKClassifier * classifierScratch = new NICE::GPHIKClassifier ( &conf );
+  classifierScratch->train ( examplesRemaining, yRemaining );
+
+  // the multi-class problem turns into a binary one
+  NICE::GPHIKClassifier * classifierOnline = new NICE::GPHIKClassifier ( &conf );
+  classifierOnline->train ( examplesTrain, yMultiTrain );
+  classifierOnline->removeExample ( 5, false );
+  classifierOnline->removeMultipleExamples ( indicesToRemove, false );
+
+  //------------- compare both classifiers --------------
+
+  compareClassifiersOnTestData ( classifierScratch, classifierOnline, conf.gS( "main", "testData", "toyExampleTest.data" ) );
+
+  // don't waste memory
+
+  delete classifierScratch;
+  delete classifierOnline;
+
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+  {
+    delete *exTrainIt;
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningRemoveExamples done ===================== " << std::endl;
+}
+
+void TestGPHIKOnlineLearnable::testOnlineLearningSlidingWindow()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningSlidingWindow ===================== " << std::endl;
+
+  NICE::Config conf;
+
+  conf.sB ( "GPHIKClassifier", "eig_verbose", false);
+  conf.sS ( "GPHIKClassifier", "optimization_method", "none");
+
+  std::string s_trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+
+  //------------- read the training data --------------
+
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain;
+
+  readData ( s_trainData, dataTrain, yBinTrain, yMultiTrain );
+
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+
+  // the training data is sorted by class, while sliding the window over it, the last class
+  // appears and the first one vanishes
+  uint windowSize ( 2 * examplesTrain.size() / 3 );
+  uint numAtOnce ( ( examplesTrain.size() - windowSize ) / 2 );
+
+  std::vector< const NICE::SparseVector *> examplesInitial ( examplesTrain.begin(), examplesTrain.begin() + windowSize );
+  NICE::Vector yInitial ( yMultiTrain.getRangeRef( 0, windowSize-1 ) );
+
+  std::vector< const NICE::SparseVector *> examplesAtOnce ( examplesTrain.begin() + windowSize, examplesTrain.begin() + windowSize + numAtOnce );
+  NICE::Vector yAtOnce ( yMultiTrain.getRangeRef( windowSize, windowSize + numAtOnce - 1 ) );
+
+  std::vector< const NICE::SparseVector *> examplesWindow ( examplesTrain.end() - windowSize, examplesTrain.end() );
+  NICE::Vector yWindow ( yMultiTrain.getRangeRef( examplesTrain.size() - windowSize, examplesTrain.size() - 1 ) );
+
+  NICE::GPHIKClassifier * classifierScratch = new NICE::GPHIKClassifier ( &conf );
+  classifierScratch->train ( examplesWindow, yWindow );
+
+  conf.sI ( "GPHIKClassifier", "max_num_examples", windowSize );
+  conf.sS ( "GPHIKClassifier", "forgetting_strategy", "sliding_window" );
+  NICE::GPHIKClassifier * classifierOnline = new NICE::GPHIKClassifier ( &conf );
+  classifierOnline->train ( examplesInitial, yInitial );
+  classifierOnline->addMultipleExamples ( examplesAtOnce, yAtOnce, false );
+  for ( uint i = windowSize + numAtOnce; i < examplesTrain.size(); i++ )
+    classifierOnline->addExample ( examplesTrain[i], yMultiTrain[i], false );
+
+  //------------- compare both classifiers --------------
+
+  compareClassifiersOnTestData ( classifierScratch, classifierOnline, conf.gS( "main", "testData", "toyExampleTest.data" ) );
+
+  // don't waste memory
+
+  delete classifierScratch;
+  delete classifierOnline;
+
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+  {
+    delete *exTrainIt;
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningSlidingWindow done ===================== " << std::endl;
+}
+
+void TestGPHIKOnlineLearnable::testOnlineLearningReservoirSeed()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningReservoirSeed ===================== " << std::endl;
+
+  NICE::Config conf;
+
+  conf.sB ( "GPHIKClassifier", "eig_verbose", false);
+  conf.sS ( "GPHIKClassifier", "optimization_method", "none");
+
+  std::string s_trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+
+  //------------- read the training data --------------
+
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain;
+
+  readData ( s_trainData, dataTrain, yBinTrain, yMultiTrain );
+
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+
+  uint reservoirSize ( examplesTrain.size() / 2 );
+
+  std::vector< const NICE::SparseVector *> examplesInitial ( examplesTrain.begin(), examplesTrain.begin() + reservoirSize );
+  NICE::Vector yInitial ( yMultiTrain.getRangeRef( 0, reservoirSize-1 ) );
+
+  // the same seed yields the same reservoir, regardless of the global random number generator
+  conf.sI ( "GPHIKClassifier", "max_num_examples", reservoirSize );
+  conf.sS ( "GPHIKClassifier", "forgetting_strategy", "reservoir" );
+  conf.sI ( "GPHIKClassifier", "forgetting_seed", 7 );
+
+  NICE::GPHIKClassifier * classifiers[2];
+  for ( uint run = 0; run < 2; run++ )
+  {
+    srand ( run );
+    classifiers[run] = new NICE::GPHIKClassifier ( &conf );
+    classifiers[run]->train ( examplesInitial, yInitial );
+    for ( uint i = reservoirSize; i < examplesTrain.size(); i++ )
+      classifiers[run]->addExample ( examplesTrain[i], yMultiTrain[i], false );
+  }
+
+  //------------- compare both classifiers --------------
+
+  compareClassifiersOnTestData ( classifiers[0], classifiers[1], conf.gS( "main", "testData", "toyExampleTest.data" ) );
+
+  // don't waste memory
+
+  delete classifiers[0];
+  delete classifiers[1];
+
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+  {
+    delete *exTrainIt;
+  }
+
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKOnlineLearnable::testOnlineLearningReservoirSeed done ===================== " << std::endl;
+}
+
 #endif
@@ -17,6 +17,10 @@ class TestGPHIKOnlineLearnable : public CppUnit::TestFixture {
       CPPUNIT_TEST(testOnlineLearningOCCtoBinary);
       CPPUNIT_TEST(testOnlineLearningBinarytoMultiClass);
       CPPUNIT_TEST(testOnlineLearningMultiClass);
+      CPPUNIT_TEST(testOnlineLearningIncrementalUpdate);
+      CPPUNIT_TEST(testOnlineLearningRemoveExamples);
+      CPPUNIT_TEST(testOnlineLearningSlidingWindow);
+      CPPUNIT_TEST(testOnlineLearningReservoirSeed);
       
     CPPUNIT_TEST_SUITE_END();
   
@@ -33,6 +37,14 @@ class TestGPHIKOnlineLearnable : public CppUnit::TestFixture {
     void testOnlineLearningBinarytoMultiClass();
 
     void testOnlineLearningMultiClass();
+
+    void testOnlineLearningIncrementalUpdate();
+
+    void testOnlineLearningRemoveExamples();
+
+    void testOnlineLearningSlidingWindow();
+
+    void testOnlineLearningReservoirSeed();
 };
 
 #endif // _TESTGPHIKONLINELEARNABLE_H
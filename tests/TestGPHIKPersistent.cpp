@@ -9,7 +9,10 @@
 
 // STL includes
 #include <iostream>
+#include <sstream>
 #include <vector>
+#include <cstdlib>
+#include <unistd.h>
 
 // NICE-core includes
 #include <core/basics/Config.h>
@@ -17,6 +20,8 @@
 
 // gp-hik-core includes
 #include "gp-hik-core/GPHIKClassifier.h"
+#include "gp-hik-core/GPHIKRawClassifier.h"
+#include "gp-hik-core/BinaryModelFile.h"
 
 #include "TestGPHIKPersistent.h"
 
@@ -269,4 +274,466 @@ void TestGPHIKPersistent::testPersistentMethods()
   
 }
 
+void TestGPHIKPersistent::testPersistentMethodsBinary()
+{
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPersistentMethodsBinary ===================== " << std::endl;  
+  
+  NICE::Config conf;
+  std::string trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+  std::string testData = conf.gS( "main", "testData", "toyExampleTest.data" );  
+  
+  //------------- read the training and test data --------------
+  
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain; 
+
+  std::ifstream ifsTrain ( trainData.c_str() , ios::in );
+  CPPUNIT_ASSERT ( ifsTrain.good() );
+  ifsTrain >> dataTrain;
+  ifsTrain >> yBinTrain;
+  ifsTrain >> yMultiTrain;
+  ifsTrain.close();  
+  
+  NICE::Matrix dataTest;
+  NICE::Vector yBinTest;
+  NICE::Vector yMultiTest; 
+
+  std::ifstream ifsTest ( testData.c_str(), ios::in );
+  CPPUNIT_ASSERT ( ifsTest.good() );
+  ifsTest >> dataTest;
+  ifsTest >> yBinTest;
+  ifsTest >> yMultiTest;
+  ifsTest.close();  
+  
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+  
+  // TRAIN CLASSIFIER FROM SCRATCH (multi-class, with variance estimates)
+  std::string confsection ( "GPHIKClassifier" );  
+  conf.sB ( confsection, "use_quantization", true );
+  conf.sS ( confsection, "s_quantType", "1d-aequi-0-1" );
+  conf.sS ( confsection, "transform", "identity");  
+  conf.sS ( confsection, "varianceApproximation", "approximate_fine");  
+  
+  NICE::GPHIKClassifier * classifier = new GPHIKClassifier ( &conf );  
+  classifier->train ( examplesTrain , yMultiTrain );
+  
+  // STORE IN BINARY FORMAT
+  
+  // temporary file, removed at the end of the test
+  char s_template[] = "/tmp/TestGPHIKPersistentXXXXXX";
+  int fd = mkstemp ( s_template );
+  CPPUNIT_ASSERT ( fd >= 0 );
+  close ( fd );
+  std::string s_destination ( s_template );
+  
+  std::ofstream ofs ( s_destination.c_str(), ios::out | ios::binary );
+  classifier->store ( ofs, NICE::BinaryModelFile::FORMAT_BINARY );
+  ofs.close();
+  
+  // RESTORE FROM A STREAM
+  
+  NICE::GPHIKClassifier * classifierRestored = new GPHIKClassifier();  
+  std::ifstream ifs ( s_destination.c_str(), ios::in | ios::binary );
+  classifierRestored->restore ( ifs, NICE::BinaryModelFile::FORMAT_BINARY );
+  ifs.close();
+  
+  // RESTORE BY MAPPING THE FILE
+  
+  NICE::GPHIKClassifier * classifierMapped = new GPHIKClassifier();  
+  classifierMapped->restoreMapped ( s_destination );
+  
+  // all classifiers have to produce the same scores and variances
+  
+  for (int i = 0; i < (int)dataTest.rows(); i++)
+  {
+    NICE::SparseVector example ( dataTest.getRow(i) );
+    NICE::SparseVector scores;
+    NICE::SparseVector scoresRestored;
+    NICE::SparseVector scoresMapped;
+    uint result;
+    uint resultRestored;
+    uint resultMapped;
+    
+    classifier->classify( &example, result, scores );
+    classifierRestored->classify( &example, resultRestored, scoresRestored );
+    classifierMapped->classify( &example, resultMapped, scoresMapped );
+    
+    CPPUNIT_ASSERT_EQUAL ( result, resultRestored );
+    CPPUNIT_ASSERT_EQUAL ( result, resultMapped );
+    for ( NICE::SparseVector::const_iterator it = scores.begin(); it != scores.end(); it++ )
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( it->second, scoresRestored.get ( it->first ), 1e-10 );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( it->second, scoresMapped.get ( it->first ), 1e-10 );
+    }
+    
+    double uncertainty;
+    double uncertaintyMapped;
+    classifier->predictUncertainty( &example, uncertainty );
+    classifierMapped->predictUncertainty( &example, uncertaintyMapped );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL ( uncertainty, uncertaintyMapped, 1e-10 );
+  }
+  
+  delete classifier;
+  delete classifierRestored;
+  delete classifierMapped;
+  
+  unlink ( s_destination.c_str() );
+  
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+  {
+    delete *exTrainIt;
+  } 
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPersistentMethodsBinary done ===================== " << std::endl;  
+  
+}
+
+void TestGPHIKPersistent::testPersistentMethodsRaw()
+{
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPersistentMethodsRaw ===================== " << std::endl;  
+  
+  NICE::Config conf;
+  std::string trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+  std::string testData = conf.gS( "main", "testData", "toyExampleTest.data" );  
+  
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain; 
+
+  std::ifstream ifsTrain ( trainData.c_str() , ios::in );
+  CPPUNIT_ASSERT ( ifsTrain.good() );
+  ifsTrain >> dataTrain;
+  ifsTrain >> yBinTrain;
+  ifsTrain >> yMultiTrain;
+  ifsTrain.close();  
+  
+  NICE::Matrix dataTest;
+  NICE::Vector yBinTest;
+  NICE::Vector yMultiTest; 
+
+  std::ifstream ifsTest ( testData.c_str(), ios::in );
+  CPPUNIT_ASSERT ( ifsTest.good() );
+  ifsTest >> dataTest;
+  ifsTest >> yBinTest;
+  ifsTest >> yMultiTest;
+  ifsTest.close();  
+  
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+
+  std::vector< const NICE::SparseVector *> examplesTest;
+  for (int i = 0; i < (int)dataTest.rows(); i++)
+    examplesTest.push_back ( new NICE::SparseVector( dataTest.getRow(i) ) );
+  
+  // settings: quantization, packed LUT, LUT precision, classification-only
+  const int numSettings = 5;
+  const bool useQuantization[numSettings]    = { false, false, true,  true,  true  };
+  const bool usePackedLUT[numSettings]       = { false, false, false, true,  false };
+  const char * lutPrecision[numSettings]     = { "double", "int16", "double", "double", "float" };
+  const bool classificationOnly[numSettings] = { false, true,  false, true,  true  };
+  
+  std::string confsection ( "GPHIKRawClassifier" );  
+  for ( int setting = 0; setting < numSettings; setting++ )
+  {
+    conf.sB ( confsection, "use_quantization", useQuantization[setting] );
+    conf.sB ( confsection, "use_packed_lut", usePackedLUT[setting] );
+    conf.sS ( confsection, "lut_precision", lutPrecision[setting] );
+    conf.sB ( confsection, "store_classification_only", classificationOnly[setting] );
+    
+    NICE::GPHIKRawClassifier * classifier = new GPHIKRawClassifier ( &conf, confsection );  
+    classifier->train ( examplesTrain , yMultiTrain );
+    
+    std::stringstream ss;
+    classifier->store ( ss );
+    
+    NICE::GPHIKRawClassifier * classifierRestored = new GPHIKRawClassifier();  
+    classifierRestored->restore ( ss );
+    
+    // single and batch classification have to yield exactly the same scores
+    NICE::Vector results;
+    NICE::Matrix scores;
+    classifier->classify ( examplesTest, results, scores );
+    
+    NICE::Vector resultsRestored;
+    NICE::Matrix scoresRestored;
+    classifierRestored->classify ( examplesTest, resultsRestored, scoresRestored );
+    
+    CPPUNIT_ASSERT_EQUAL ( scores.rows(), scoresRestored.rows() );
+    CPPUNIT_ASSERT_EQUAL ( scores.cols(), scoresRestored.cols() );
+    for ( uint i = 0; i < scores.rows(); i++ )
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( results[i], resultsRestored[i], 1e-12 );
+      for ( uint j = 0; j < scores.cols(); j++ )
+        CPPUNIT_ASSERT_DOUBLES_EQUAL ( scores(i,j), scoresRestored(i,j), 1e-12 );
+      
+      uint result;
+      NICE::SparseVector scoresSingle;
+      classifierRestored->classify ( examplesTest[i], result, scoresSingle );
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( results[i], (double) result, 1e-12 );
+    }
+    
+    delete classifier;
+    delete classifierRestored;
+  }
+  
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+    delete *exTrainIt;
+  for (std::vector< const NICE::SparseVector *>::iterator exTestIt = examplesTest.begin(); exTestIt != examplesTest.end(); exTestIt++)
+    delete *exTestIt;
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPersistentMethodsRaw done ===================== " << std::endl;  
+  
+}
+
+void TestGPHIKPersistent::testPersistentMethodsBinaryCompactLUT()
+{
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPersistentMethodsBinaryCompactLUT ===================== " << std::endl;  
+  
+  NICE::Config conf;
+  std::string trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+  std::string testData = conf.gS( "main", "testData", "toyExampleTest.data" );  
+  
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain;
+
+  std::ifstream ifsTrain ( trainData.c_str() , ios::in );
+  CPPUNIT_ASSERT ( ifsTrain.good() );
+  ifsTrain >> dataTrain;
+  ifsTrain >> yBinTrain;
+  ifsTrain >> yMultiTrain;
+  ifsTrain.close();  
+  
+  NICE::Matrix dataTest;
+  NICE::Vector yBinTest;
+  NICE::Vector yMultiTest; 
+
+  std::ifstream ifsTest ( testData.c_str(), ios::in );
+  CPPUNIT_ASSERT ( ifsTest.good() );
+  ifsTest >> dataTest;
+  ifsTest >> yBinTest;
+  ifsTest >> yMultiTest;
+  ifsTest.close();  
+  
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+  
+  // the LUTs with reduced precision are stored as separate sections of the binary model
+  std::string confsection ( "GPHIKClassifier" );  
+  conf.sB ( confsection, "use_quantization", true );
+  conf.sS ( confsection, "s_quantType", "1d-aequi-0-1" );
+  conf.sS ( confsection, "transform", "identity");  
+  conf.sS ( confsection, "lut_precision", "int16");  
+  
+  NICE::GPHIKClassifier * classifier = new GPHIKClassifier ( &conf );  
+  classifier->train ( examplesTrain , yMultiTrain );
+  
+  std::stringstream ss;
+  classifier->store ( ss, NICE::BinaryModelFile::FORMAT_BINARY );
+  
+  NICE::GPHIKClassifier * classifierRestored = new GPHIKClassifier();  
+  classifierRestored->restore ( ss, NICE::BinaryModelFile::FORMAT_BINARY );
+  
+  for (int i = 0; i < (int)dataTest.rows(); i++)
+  {
+    NICE::SparseVector example ( dataTest.getRow(i) );
+    NICE::SparseVector scores;
+    NICE::SparseVector scoresRestored;
+    uint result;
+    uint resultRestored;
+    
+    classifier->classify( &example, result, scores );
+    classifierRestored->classify( &example, resultRestored, scoresRestored );
+    
+    CPPUNIT_ASSERT_EQUAL ( result, resultRestored );
+    for ( NICE::SparseVector::const_iterator it = scores.begin(); it != scores.end(); it++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( it->second, scoresRestored.get ( it->first ), 1e-10 );
+  }
+  
+  delete classifier;
+  delete classifierRestored;
+  
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+  {
+    delete *exTrainIt;
+  } 
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPersistentMethodsBinaryCompactLUT done ===================== " << std::endl;  
+  
+}
+
+void TestGPHIKPersistent::testPackedLUT()
+{
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPackedLUT ===================== " << std::endl;  
+  
+  NICE::Config conf;
+  std::string trainData = conf.gS( "main", "trainData", "toyExampleSmallScaleTrain.data" );
+  std::string testData = conf.gS( "main", "testData", "toyExampleTest.data" );  
+  
+  NICE::Matrix dataTrain;
+  NICE::Vector yBinTrain;
+  NICE::Vector yMultiTrain; 
+
+  std::ifstream ifsTrain ( trainData.c_str() , ios::in );
+  CPPUNIT_ASSERT ( ifsTrain.good() );
+  ifsTrain >> dataTrain;
+  ifsTrain >> yBinTrain;
+  ifsTrain >> yMultiTrain;
+  ifsTrain.close();  
+  
+  NICE::Matrix dataTest;
+  NICE::Vector yBinTest;
+  NICE::Vector yMultiTest; 
+
+  std::ifstream ifsTest ( testData.c_str(), ios::in );
+  CPPUNIT_ASSERT ( ifsTest.good() );
+  ifsTest >> dataTest;
+  ifsTest >> yBinTest;
+  ifsTest >> yMultiTest;
+  ifsTest.close();  
+  
+  std::vector< const NICE::SparseVector *> examplesTrain;
+  for (int i = 0; i < (int)dataTrain.rows(); i++)
+    examplesTrain.push_back ( new NICE::SparseVector( dataTrain.getRow(i) ) );
+
+  std::vector< const NICE::SparseVector *> examplesTest;
+  for (int i = 0; i < (int)dataTest.rows(); i++)
+    examplesTest.push_back ( new NICE::SparseVector( dataTest.getRow(i) ) );
+
+  // the last two examples are added incrementally, such that the packed LUTs have to be updated
+  uint numInitial ( examplesTrain.size() - 2 );
+  std::vector< const NICE::SparseVector *> examplesInitial ( examplesTrain.begin(), examplesTrain.begin() + numInitial );
+  NICE::Vector yInitial ( yMultiTrain.getRangeRef( 0, numInitial-1 ) );
+
+  //------------- GPHIKClassifier: packed and separate LUTs, also after storing and restoring --------------
+
+  std::string confsection ( "GPHIKClassifier" );  
+  conf.sB ( confsection, "use_quantization", true );
+  conf.sS ( confsection, "s_quantType", "1d-aequi-0-1" );
+  conf.sB ( confsection, "incremental_update", true );
+  conf.sD ( confsection, "incremental_alpha_tolerance", 0.0 );
+
+  NICE::GPHIKClassifier * classifiers[4];
+  for ( int c = 0; c < 2; c++ )
+  {
+    conf.sB ( confsection, "use_packed_lut", c == 1 );
+    classifiers[c] = new GPHIKClassifier ( &conf );
+    classifiers[c]->train ( examplesInitial, yInitial );
+    classifiers[c]->addExample ( examplesTrain[numInitial], yMultiTrain[numInitial], false );
+    classifiers[c]->addExample ( examplesTrain[numInitial+1], yMultiTrain[numInitial+1], false );
+  }
+
+  // binary and text model of the packed classifier
+  for ( int c = 2; c < 4; c++ )
+  {
+    std::stringstream ss;
+    int format = ( c == 2 ) ? NICE::BinaryModelFile::FORMAT_BINARY : 0;
+    classifiers[1]->store ( ss, format );
+    classifiers[c] = new GPHIKClassifier();
+    classifiers[c]->restore ( ss, format );
+  }
+  
+  for (int i = 0; i < (int)dataTest.rows(); i++)
+  {
+    NICE::Vector example ( dataTest.getRow(i) );
+
+    uint resultSeparate;
+    NICE::SparseVector scoresSeparate;
+    classifiers[0]->classify ( examplesTest[i], resultSeparate, scoresSeparate );
+
+    uint resultSeparateDense;
+    NICE::SparseVector scoresSeparateDense;
+    classifiers[0]->classify ( &example, resultSeparateDense, scoresSeparateDense );
+
+    for ( int c = 1; c < 4; c++ )
+    {
+      uint result;
+      NICE::SparseVector scores;
+      classifiers[c]->classify ( examplesTest[i], result, scores );
+      CPPUNIT_ASSERT_EQUAL ( resultSeparate, result );
+      CPPUNIT_ASSERT_EQUAL ( scoresSeparate.size(), scores.size() );
+      for ( NICE::SparseVector::const_iterator it = scoresSeparate.begin(); it != scoresSeparate.end(); it++ )
+        CPPUNIT_ASSERT_DOUBLES_EQUAL ( it->second, scores.get ( it->first ), 1e-10 );
+
+      uint resultDense;
+      NICE::SparseVector scoresDense;
+      classifiers[c]->classify ( &example, resultDense, scoresDense );
+      CPPUNIT_ASSERT_EQUAL ( resultSeparateDense, resultDense );
+      for ( NICE::SparseVector::const_iterator it = scoresSeparateDense.begin(); it != scoresSeparateDense.end(); it++ )
+        CPPUNIT_ASSERT_DOUBLES_EQUAL ( it->second, scoresDense.get ( it->first ), 1e-10 );
+    }
+  }
+
+  // the packed classifier keeps its LUTs in packed form only
+  std::stringstream ssSeparate;
+  std::stringstream ssPacked;
+  classifiers[0]->store ( ssSeparate, NICE::BinaryModelFile::FORMAT_BINARY );
+  classifiers[1]->store ( ssPacked, NICE::BinaryModelFile::FORMAT_BINARY );
+  CPPUNIT_ASSERT ( ssSeparate.str().find ( "packedT" ) == std::string::npos );
+  CPPUNIT_ASSERT ( ssPacked.str().find ( "packedT" ) != std::string::npos );
+  std::set<uint> classNumbers ( classifiers[1]->getKnownClassNumbers() );
+  for ( std::set<uint>::const_iterator it = classNumbers.begin(); it != classNumbers.end(); it++ )
+  {
+    // zero-terminated name of the section of the separate LUT of this class in the section table
+    std::ostringstream name;
+    name << '\0' << "T." << *it << '\0';
+    CPPUNIT_ASSERT ( ssSeparate.str().find ( name.str() ) != std::string::npos );
+    CPPUNIT_ASSERT ( ssPacked.str().find ( name.str() ) == std::string::npos );
+  }
+
+  for ( int c = 0; c < 4; c++ )
+    delete classifiers[c];
+
+  //------------- GPHIKRawClassifier: packed and separate LUTs --------------
+
+  confsection = "GPHIKRawClassifier";
+  conf.sB ( confsection, "use_quantization", true );
+
+  NICE::GPHIKRawClassifier * classifiersRaw[2];
+  NICE::Vector resultsRaw[2];
+  NICE::Matrix scoresRaw[2];
+  for ( int c = 0; c < 2; c++ )
+  {
+    conf.sB ( confsection, "use_packed_lut", c == 1 );
+    classifiersRaw[c] = new GPHIKRawClassifier ( &conf, confsection );
+    classifiersRaw[c]->train ( examplesTrain, yMultiTrain );
+    classifiersRaw[c]->classify ( examplesTest, resultsRaw[c], scoresRaw[c] );
+  }
+
+  CPPUNIT_ASSERT_EQUAL ( scoresRaw[0].rows(), scoresRaw[1].rows() );
+  CPPUNIT_ASSERT_EQUAL ( scoresRaw[0].cols(), scoresRaw[1].cols() );
+  for ( uint i = 0; i < scoresRaw[0].rows(); i++ )
+  {
+    CPPUNIT_ASSERT_DOUBLES_EQUAL ( resultsRaw[0][i], resultsRaw[1][i], 1e-12 );
+    for ( uint j = 0; j < scoresRaw[0].cols(); j++ )
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ( scoresRaw[0](i,j), scoresRaw[1](i,j), 1e-10 );
+  }
+
+  delete classifiersRaw[0];
+  delete classifiersRaw[1];
+  
+  for (std::vector< const NICE::SparseVector *>::iterator exTrainIt = examplesTrain.begin(); exTrainIt != examplesTrain.end(); exTrainIt++)
+    delete *exTrainIt;
+  for (std::vector< const NICE::SparseVector *>::iterator exTestIt = examplesTest.begin(); exTestIt != examplesTest.end(); exTestIt++)
+    delete *exTestIt;
+  
+  if (verboseStartEnd)
+    std::cerr << "================== TestGPHIKPersistent::testPackedLUT done ===================== " << std::endl;  
+}
+
 #endif
@@ -14,6 +14,10 @@ class TestGPHIKPersistent : public CppUnit::TestFixture {
 
     CPPUNIT_TEST_SUITE( TestGPHIKPersistent );
 	 CPPUNIT_TEST(testPersistentMethods);
+	 CPPUNIT_TEST(testPersistentMethodsBinary);
+	 CPPUNIT_TEST(testPersistentMethodsRaw);
+	 CPPUNIT_TEST(testPersistentMethodsBinaryCompactLUT);
+	 CPPUNIT_TEST(testPackedLUT);
       
     CPPUNIT_TEST_SUITE_END();
   
@@ -25,6 +29,10 @@ class TestGPHIKPersistent : public CppUnit::TestFixture {
 
 
     void testPersistentMethods();
+    void testPersistentMethodsBinary();
+    void testPersistentMethodsRaw();
+    void testPersistentMethodsBinaryCompactLUT();
+    void testPackedLUT();
 };
 
 #endif // _TESTGPHIKPERSISTENT_H